@@ -117,6 +117,9 @@ static struct {
   CONSTANT(NOT_ARM_ENDIAN,   "GD_NA", GDMP_OFLAG_L),
   CONSTANT(PERMISSIVE,       "GD_PM", GDMP_OFLAG),
   CONSTANT(TRUNCSUB,         "GD_TS", GDMP_OFLAG),
+  CONSTANT(MMAP,             "GD_MM", GDMP_OFLAG),
+  CONSTANT(LAZY_INCLUDE,     "GD_LI", GDMP_OFLAG),
+  CONSTANT(SNAPSHOT,         "GD_SN", GDMP_OFLAG),
 
   CONSTANT(AUTO_ENCODED,     "GDE_AU", GDMP_OFLAG),
   CONSTANT(BZIP2_ENCODED,    "GDE_BZ", GDMP_OFLAG_L),
@@ -193,6 +193,11 @@ static gd_entry_t *_GD_Add(DIRFILE *restrict D,
     return NULL;
   }
 
+  if (_GD_ParseLazyForWrite(D)) {
+    dreturn("%p", NULL);
+    return NULL;
+  }
+
   /* check for include index out of range */
   if (parent == NULL && (entry->fragment_index < 0 ||
         entry->fragment_index >= D->n_fragment))
@@ -687,10 +692,13 @@ static gd_entry_t *_GD_Add(DIRFILE *restrict D,
   _GD_InsertSort(D, E, u);
   D->n_entries++;
   D->fragment[E->fragment_index].modified = 1;
-  D->flags &= ~GD_HAVE_VERSION;
+  _GD_UpdateVersion(D, E);
+  D->gen++;
 
-  /* Update aliases - no reason to do a reset: all we did was add a field */
-  _GD_UpdateAliases(D, 0);
+  /* Update aliases - no reason to do a reset: all we did was add a field.
+   * During a bulk addition, this is left to gd_add_commit() */
+  if (!D->add_batch)
+    _GD_UpdateAliases(D, 0);
 
   dreturn("%p", E);
   return E;
@@ -713,6 +721,9 @@ static int _GD_AddSpec(DIRFILE* D, const char* line, const char* parent,
   if ((D->flags & GD_ACCMODE) == GD_RDONLY)
     GD_SET_RETURN_ERROR(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
 
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
   if (parent) {
     /* Find parent -- we don't do code mungeing here because we don't know
      * which fragment this is yet.  */
@@ -749,14 +760,50 @@ static int _GD_AddSpec(DIRFILE* D, const char* line, const char* parent,
     GD_RETURN_ERROR(D);
 
   /* Update aliases */
-  _GD_UpdateAliases(D, 0);
+  if (!D->add_batch)
+    _GD_UpdateAliases(D, 0);
 
   D->fragment[me].modified = 1;
   D->flags &= ~GD_HAVE_VERSION;
+  D->gen++;
   dreturn("%i", GD_E_OK);
   return GD_E_OK;
 }
 
+/* start a bulk addition */
+int gd_add_begin(DIRFILE *D) gd_nothrow
+{
+  dtrace("%p", D);
+
+  GD_RETURN_ERR_IF_INVALID(D);
+
+  if ((D->flags & GD_ACCMODE) == GD_RDONLY)
+    GD_SET_RETURN_ERROR(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
+
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
+  D->add_batch = 1;
+
+  dreturn("%i", 0);
+  return 0;
+}
+
+/* finish a bulk addition: sort the entries added and resolve aliases */
+int gd_add_commit(DIRFILE *D) gd_nothrow
+{
+  dtrace("%p", D);
+
+  GD_RETURN_ERR_IF_INVALID(D);
+
+  _GD_SortEntries(D);
+  D->add_batch = 0;
+
+  _GD_UpdateAliases(D, 0);
+
+  GD_RETURN_ERROR(D);
+}
+
 int gd_madd_spec(DIRFILE* D, const char* line, const char *parent)
 {
   dtrace("%p, \"%s\", \"%s\"", D, line, parent);
@@ -1904,6 +1951,9 @@ static int _GD_AddAlias(DIRFILE *restrict D, const char *restrict parent,
   /* Early checks */
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
   if ((D->flags & GD_ACCMODE) == GD_RDONLY)
     GD_SET_RETURN_ERROR(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
   else if (fragment_index < 0 || fragment_index >= D->n_fragment)
@@ -2005,7 +2055,8 @@ static int _GD_AddAlias(DIRFILE *restrict D, const char *restrict parent,
   _GD_InsertSort(D, E, u);
   D->n_entries++;
   D->fragment[fragment_index].modified = 1;
-  D->flags &= ~GD_HAVE_VERSION;
+  _GD_UpdateVersion(D, E);
+  D->gen++;
 
   /* Invalidate the field lists */
   if (P) {
@@ -2017,7 +2068,8 @@ static int _GD_AddAlias(DIRFILE *restrict D, const char *restrict parent,
   }
 
   /* Update aliases */
-  _GD_UpdateAliases(D, 0);
+  if (!D->add_batch)
+    _GD_UpdateAliases(D, 0);
 
   dreturn("%i", GD_E_OK);
   return GD_E_OK;
@@ -19,14 +19,59 @@
  * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 #include "internal.h"
+#include <locale.h>
 
-/* The ASCII encoding uses file->edata for the stream pointer */
+/* The ASCII encoding uses file->edata for a struct gd_asciidata.
+ *
+ * Reads don't go through stdio's formatted input, which is slow, and depends
+ * on the locale.  Instead, the file is read in large blocks into a buffer,
+ * which is parsed in place.  The stream is positioned at the end of the
+ * buffered data; the logical position in the file is base + off.
+ *
+ * To make seeks cheap, the offset of the start of every GD_ASCII_STRIDE-th
+ * line is recorded as it's passed.  A seek starts from the closest recorded
+ * line before the target.
+ */
+#define GD_ASCII_BUFSIZE 65536
+
+/* the most we look ahead to parse a number */
+#define GD_ASCII_LOOKAHEAD 128
+
+/* the number of lines between entries in the line index */
+#define GD_ASCII_STRIDE 1024
+
+/* the characters scanf(3) treats as white space in the "C" locale */
+#define GD_ASCII_SPACE(c) ((c) == ' ' || ((c) >= '\t' && (c) <= '\r'))
+#define GD_ASCII_DIGIT(c) ((c) >= '0' && (c) <= '9')
+
+struct gd_asciidata {
+  FILE *fp; /* stream */
+
+  char *buf; /* read buffer, NUL-terminated */
+  size_t len; /* the amount of data in buf */
+  size_t off; /* the read position in buf */
+  off64_t base; /* the file offset of buf[0] */
+  int eof; /* the end of the file has been buffered */
+
+  off64_t *line; /* the line index: line[i] is the offset of line
+                    i * GD_ASCII_STRIDE */
+  size_t n_line, line_size;
+};
 
 int _GD_AsciiOpen(int fd, struct gd_raw_file_* file, gd_type_t type gd_unused_,
     int swap gd_unused_, unsigned int mode)
 {
+  struct gd_asciidata *a;
+
   dtrace("%i, %p, <unused>, <unused>, %u", fd, file, mode);
 
+  a = malloc(sizeof(*a));
+  if (a == NULL) {
+    dreturn("%i", -1);
+    return -1;
+  }
+  memset(a, 0, sizeof(*a));
+
   if (!(mode & GD_FILE_TEMP))
     file->idata = gd_OpenAt(file->D, fd, file->name, ((mode & GD_FILE_WRITE)
           ? (O_RDWR | O_CREAT) : O_RDONLY) | O_BINARY, 0666);
@@ -34,177 +79,508 @@ int _GD_AsciiOpen(int fd, struct gd_raw_file_* file, gd_type_t type gd_unused_,
     file->idata = _GD_MakeTempFile(file->D, fd, file->name);
 
   if (file->idata < 0) {
+    free(a);
     dreturn("%i", -1);
     return -1;
   }
 
-  file->edata = fdopen(file->idata, (mode & GD_FILE_WRITE) ? "rb+" : "rb");
+  a->fp = fdopen(file->idata, (mode & GD_FILE_WRITE) ? "rb+" : "rb");
 
-  if (file->edata == NULL) {
+  if (a->fp == NULL) {
     close(file->idata);
     file->idata = -1;
+    free(a);
     dreturn("%i", -1);
     return -1;
   }
 
+  /* line zero starts at offset zero; if this fails, we just go without an
+   * index */
+  a->line = malloc(sizeof(*a->line) * 16);
+  if (a->line) {
+    a->line[0] = 0;
+    a->n_line = 1;
+    a->line_size = 16;
+  }
+
+  file->edata = a;
   file->mode = mode | GD_FILE_READ;
   file->pos = 0;
   dreturn("%i", 0);
   return 0;
 }
 
+/* reposition the stream at offset, discarding the buffer; returns non-zero on
+ * error */
+static int _GD_AsciiJump(struct gd_asciidata *a, off64_t offset)
+{
+  dtrace("%p, %" PRId64, a, (int64_t)offset);
+
+  if (fseeko64(a->fp, offset, SEEK_SET)) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  a->base = offset;
+  a->len = a->off = 0;
+  a->eof = 0;
+
+  dreturn("%i", 0);
+  return 0;
+}
+
+/* buffer at least GD_ASCII_LOOKAHEAD bytes after the read position, unless
+ * we hit the end of the file; returns non-zero on error */
+static int _GD_AsciiFill(struct gd_asciidata *a)
+{
+  size_t n;
+
+  while (!a->eof && a->len - a->off < GD_ASCII_LOOKAHEAD) {
+    if (a->buf == NULL) {
+      a->buf = malloc(GD_ASCII_BUFSIZE + 1);
+      if (a->buf == NULL)
+        return 1;
+    }
+
+    /* keep the unread data */
+    memmove(a->buf, a->buf + a->off, a->len - a->off);
+    a->base += a->off;
+    a->len -= a->off;
+    a->off = 0;
+
+    n = fread(a->buf + a->len, 1, GD_ASCII_BUFSIZE - a->len, a->fp);
+    if (n < GD_ASCII_BUFSIZE - a->len) {
+      if (ferror(a->fp))
+        return 1;
+      a->eof = 1;
+    }
+    a->len += n;
+    a->buf[a->len] = 0;
+  }
+
+  return 0;
+}
+
+/* skip white space, and buffer the start of the next token; returns non-zero
+ * on error */
+static int _GD_AsciiToken(struct gd_asciidata *a)
+{
+  for (;;) {
+    if (_GD_AsciiFill(a))
+      return 1;
+
+    while (a->off < a->len && GD_ASCII_SPACE(a->buf[a->off]))
+      a->off++;
+
+    if (a->off < a->len)
+      return _GD_AsciiFill(a);
+    else if (a->eof)
+      return 0;
+  }
+}
+
+/* record the current position in the line index, if it's the start of the
+ * next indexed line */
+static void _GD_AsciiMark(struct gd_asciidata *a, off64_t n)
+{
+  if (n % GD_ASCII_STRIDE || n / GD_ASCII_STRIDE != (off64_t)a->n_line ||
+      a->n_line == 0)
+  {
+    return;
+  }
+
+  if (a->n_line == a->line_size) {
+    off64_t *ptr = realloc(a->line, sizeof(*a->line) * a->line_size * 2);
+    if (ptr == NULL)
+      return;
+    a->line = ptr;
+    a->line_size *= 2;
+  }
+
+  a->line[a->n_line++] = a->base + a->off;
+}
+
 off64_t _GD_AsciiSeek(struct gd_raw_file_* file, off64_t count,
     gd_type_t data_type gd_unused_, unsigned int mode)
 {
-  char line[64];
+  struct gd_asciidata *a = (struct gd_asciidata *)file->edata;
+  const char *nl;
 
   dtrace("%p, %" PRId64 ", <unused>, 0x%X", file, (int64_t)count, mode);
 
-  if (count < file->pos) {
-    rewind((FILE *)file->edata);
-    file->pos = 0;
-  } else if (count > file->pos) {
-    /* reposition between output and input on the update stream */
-    if (fseeko64((FILE *)file->edata, 0, SEEK_CUR)) {
+  if (a->n_line > 0) {
+    /* start from the closest indexed line, if that's better than where we
+     * are */
+    off64_t j = count / GD_ASCII_STRIDE;
+    if (j >= (off64_t)a->n_line)
+      j = a->n_line - 1;
+
+    if (count < file->pos || j * GD_ASCII_STRIDE > file->pos) {
+      if (_GD_AsciiJump(a, a->line[j])) {
+        dreturn("%i", -1);
+        return -1;
+      }
+      file->pos = j * GD_ASCII_STRIDE;
+      if (j > 0)
+        _GD_CountIndexSeek(file);
+    }
+  } else if (count < file->pos) {
+    if (_GD_AsciiJump(a, 0)) {
       dreturn("%i", -1);
       return -1;
     }
+    file->pos = 0;
   }
 
-  for (; count > file->pos; ++file->pos)
-    if (fgets(line, 64, (FILE *)file->edata) == NULL)
-      break;
+  /* count lines */
+  while (count > file->pos) {
+    if (a->off == a->len) {
+      if (_GD_AsciiFill(a)) {
+        dreturn("%i", -1);
+        return -1;
+      }
+      if (a->off == a->len)
+        break;
+    }
+
+    nl = memchr(a->buf + a->off, '\n', a->len - a->off);
+    if (nl) {
+      a->off = nl + 1 - a->buf;
+      _GD_AsciiMark(a, ++file->pos);
+    } else {
+      /* the rest of the buffer is part of a line; an unterminated last line
+       * counts as a line */
+      a->off = a->len;
+      if (a->eof)
+        file->pos++;
+    }
+  }
 
   if (mode & GD_FILE_WRITE && count > file->pos) {
-    strcpy(line, "0\n");
     /* reposition between input and output on the update stream */
-    if (fseeko64((FILE *)file->edata, 0, SEEK_CUR)) {
+    if (_GD_AsciiJump(a, a->base + a->off)) {
+      dreturn("%i", -1);
+      return -1;
+    }
+    while (count > file->pos) {
+      if (fputs("0\n", a->fp) == EOF) {
+        dreturn("%i", -1);
+        return -1;
+      }
+      a->base += 2;
+      _GD_AsciiMark(a, ++file->pos);
+    }
+    /* and back again */
+    if (_GD_AsciiJump(a, a->base)) {
       dreturn("%i", -1);
       return -1;
     }
-    for (; count > file->pos; ++file->pos)
-      fputs(line, (FILE *)file->edata);
   }
 
   dreturn("%" PRId64, (int64_t)file->pos);
   return file->pos;
 }
 
-static const char * _GD_ScanFormat(gd_type_t data_type)
-{ 
-  const char *fmt;
-  dtrace("0x%X", data_type);
+/* Parse an unsigned decimal integer, like strtoull(3); returns the end of the
+ * number, or NULL if there isn't one */
+static const char *_GD_AsciiParseUInt(const char *p, uint64_t *v)
+{
+  const char *s = p;
+  uint64_t u = 0;
+  int neg = 0, over = 0;
 
-  switch(data_type) {
-    case GD_UINT8:
-#ifndef NO_8BIT_INT_PREFIX
-      fmt = "%" SCNu8 "\n";
-      break;
-#else
-      /* FALLTHROUGH */
-#endif
-    case GD_UINT16:
-      fmt = "%" SCNu16 "\n";
-      break;
-    case GD_INT8:
-#ifndef NO_8BIT_INT_PREFIX
-      fmt = "%" SCNi8 "\n";
-      break;
-#else
-      /* FALLTHROUGH */
-#endif
-    case GD_INT16:
-      fmt = "%" SCNi16 "\n";
-      break;
-    case GD_UINT32:
-      fmt = "%" SCNu32 "\n";
-      break;
-    case GD_INT32:
-      fmt = "%" SCNi32 "\n";
-      break;
-    case GD_UINT64:
-      fmt = "%" SCNu64 "\n";
-      break;
-    case GD_INT64:
-      fmt = "%" SCNi64 "\n";
-      break;
-    case GD_FLOAT32:
-      fmt = "%f\n";
-      break;
-    case GD_FLOAT64:
-      fmt = "%lf\n";
-      break;
-    case GD_COMPLEX64:
-      fmt = "%f;%f\n";
-      break;
-    case GD_COMPLEX128:
-      fmt = "%lf;%lf\n";
+  if (*s == '+' || *s == '-')
+    neg = (*s++ == '-');
+
+  if (!GD_ASCII_DIGIT(*s))
+    return NULL;
+
+  for (; GD_ASCII_DIGIT(*s); ++s) {
+    const unsigned d = *s - '0';
+    if (u > (~(uint64_t)0 - d) / 10)
+      over = 1;
+    u = u * 10 + d;
+  }
+
+  if (over)
+    *v = ~(uint64_t)0;
+  else
+    *v = neg ? (uint64_t)0 - u : u;
+  return s;
+}
+
+/* Parse a signed integer, with a base given by its prefix, like scanf(3)'s
+ * "%i" conversion; returns the end of the number, or NULL if there isn't
+ * one */
+static const char *_GD_AsciiParseInt(const char *p, int64_t *v)
+{
+  const char *s = p;
+  uint64_t u = 0;
+  unsigned base = 10, d;
+  int neg = 0, over = 0;
+
+  if (*s == '+' || *s == '-')
+    neg = (*s++ == '-');
+
+  if (!GD_ASCII_DIGIT(*s))
+    return NULL;
+
+  if (s[0] == '0') {
+    base = 8;
+    if ((s[1] == 'x' || s[1] == 'X') && isxdigit((unsigned char)s[2])) {
+      base = 16;
+      s += 2;
+    }
+  }
+
+  for (;; ++s) {
+    if (GD_ASCII_DIGIT(*s))
+      d = *s - '0';
+    else if (base == 16 && *s >= 'a' && *s <= 'f')
+      d = *s - 'a' + 10;
+    else if (base == 16 && *s >= 'A' && *s <= 'F')
+      d = *s - 'A' + 10;
+    else
       break;
-    default:
-      fmt = NULL;
+
+    if (d >= base)
       break;
+
+    if (u > ((uint64_t)GD_INT64_MAX + 1 - d) / base)
+      over = 1;
+    u = u * base + d;
+  }
+
+  if (over || u > (uint64_t)GD_INT64_MAX + neg)
+    *v = neg ? -GD_INT64_MAX - 1 : GD_INT64_MAX;
+  else
+    *v = neg ? (int64_t)((uint64_t)0 - u) : (int64_t)u;
+  return s;
+}
+
+/* Parse a floating point number; returns the end of the number, or NULL if
+ * there isn't one.  A decimal number whose significant digits fit in 53 bits,
+ * with a small exponent (which covers nearly everything we write) is converted
+ * exactly with one multiplication or division.  Everything else (long mantissas, large
+ * exponents, hexadecimal, infinities, NaNs) goes to strtod(3), with the
+ * input adjusted for the locale's radix character.
+ */
+static const char *_GD_AsciiParseDouble(const char *p, double *v)
+{
+  static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+    1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+    1e20, 1e21, 1e22 };
+  const char *s = p;
+  uint64_t m = 0;
+  int neg = 0, nd = 0, digits = 0, exact = 1;
+  long e = 0;
+  const struct lconv *lc;
+
+  if (*s == '+' || *s == '-')
+    neg = (*s++ == '-');
+
+  if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X'))
+    goto slow;
+
+  /* integer part */
+  for (; GD_ASCII_DIGIT(*s); ++s, ++digits) {
+    if (nd < 19) {
+      if (m || *s != '0') {
+        m = m * 10 + (*s - '0');
+        nd++;
+      }
+    } else {
+      e++;
+      if (*s != '0')
+        exact = 0;
+    }
+  }
+
+  /* fraction */
+  if (*s == '.')
+    for (++s; GD_ASCII_DIGIT(*s); ++s, ++digits) {
+      if (nd < 19) {
+        if (m || *s != '0') {
+          m = m * 10 + (*s - '0');
+          nd++;
+        }
+        e--;
+      } else if (*s != '0')
+        exact = 0;
+    }
+
+  if (digits == 0)
+    goto slow;
+
+  /* exponent */
+  if (*s == 'e' || *s == 'E') {
+    const char *t = s + 1;
+    int eneg = 0;
+    long x = 0;
+
+    if (*t == '+' || *t == '-')
+      eneg = (*t++ == '-');
+
+    if (GD_ASCII_DIGIT(*t)) {
+      for (; GD_ASCII_DIGIT(*t); ++t)
+        if (x < 100000)
+          x = x * 10 + (*t - '0');
+      e += eneg ? -x : x;
+      s = t;
+    }
+  }
+
+  if (m == 0) {
+    *v = neg ? -0. : 0.;
+    return s;
+  }
+
+  if (exact && m <= ((uint64_t)1 << 53) && e >= -22 && e <= 22) {
+    double d = (double)m;
+    if (e < 0)
+      d /= pow10[-e];
+    else
+      d *= pow10[e];
+    *v = neg ? -d : d;
+    return s;
   }
 
-  dreturn("\"%s\"", fmt);
-  return fmt;
+slow:
+  lc = localeconv();
+  if (lc->decimal_point[0] == '.' && lc->decimal_point[1] == 0) {
+    char *end;
+    *v = gd_strtod(p, &end);
+    return (end == p) ? NULL : end;
+  } else {
+    /* translate to the locale's radix character, and stop at the locale's
+     * radix character in the input, which isn't ours */
+    char tmp[GD_ASCII_LOOKAHEAD + 1], *end;
+    size_t i;
+
+    for (i = 0; i < GD_ASCII_LOOKAHEAD && p[i] && !GD_ASCII_SPACE(p[i]); ++i)
+      if (p[i] == '.')
+        tmp[i] = lc->decimal_point[0];
+      else if (p[i] == lc->decimal_point[0])
+        tmp[i] = 0;
+      else
+        tmp[i] = p[i];
+    tmp[i] = 0;
+
+    *v = gd_strtod(tmp, &end);
+    return (end == tmp) ? NULL : p + (end - tmp);
+  }
 }
 
+#define STORE_ASCII(t,v) do { if (end) *(t*)slot = (t)(v); } while (0)
+
 ssize_t _GD_AsciiRead(struct gd_raw_file_ *restrict file, void *restrict ptr,
     gd_type_t data_type, size_t nmemb)
 {
-  const char *fmt;
-  ssize_t n = 0;
-#ifdef NO_8BIT_INT_PREFIX
-  short int i16;
-#endif
+  struct gd_asciidata *a = (struct gd_asciidata *)file->edata;
+  const size_t size = GD_SIZE(data_type);
+  const char *end;
+  char *slot;
+  ssize_t n;
+  uint64_t u = 0;
+  int64_t i = 0;
+  double d[2] = {0, 0};
 
   dtrace("%p, %p, 0x%X, %" PRIuSIZE, file, ptr, data_type, nmemb);
 
-  fmt = _GD_ScanFormat(data_type);
-  if (data_type & GD_COMPLEX) {
-    for (n = 0; n < (ssize_t)nmemb; ++n) {
-      if (feof((FILE *)file->edata))
-        break;
+  /* look for data appended since we last hit the end of the file */
+  if (a->eof) {
+    clearerr(a->fp);
+    a->eof = 0;
+  }
 
-      if (fscanf((FILE *)file->edata, fmt, (char *)ptr + GD_SIZE(data_type) * n,
-            (char *)ptr + GD_SIZE(data_type) * n + GD_SIZE(data_type) / 2) < 2)
-      {
-        if (ferror((FILE *)file->edata))
-          n = -1;
+  if (_GD_AsciiToken(a)) {
+    dreturn("%i", -1);
+    return -1;
+  }
+
+  for (n = 0; n < (ssize_t)nmemb; ++n) {
+    if (a->off == a->len)
+      break;
+
+    slot = (char *)ptr + size * n;
+    switch (data_type) {
+      case GD_UINT8:
+        end = _GD_AsciiParseUInt(a->buf + a->off, &u);
+        STORE_ASCII(uint8_t, u);
         break;
-      }
-      file->pos++;
-    }
-  } else {
-    for (n = 0; n < (ssize_t)nmemb; ++n) {
-      if (ferror((FILE *)file->edata))
+      case GD_UINT16:
+        end = _GD_AsciiParseUInt(a->buf + a->off, &u);
+        STORE_ASCII(uint16_t, u);
+        break;
+      case GD_UINT32:
+        end = _GD_AsciiParseUInt(a->buf + a->off, &u);
+        STORE_ASCII(uint32_t, u);
+        break;
+      case GD_UINT64:
+        end = _GD_AsciiParseUInt(a->buf + a->off, &u);
+        STORE_ASCII(uint64_t, u);
+        break;
+      case GD_INT8:
+        end = _GD_AsciiParseInt(a->buf + a->off, &i);
+        STORE_ASCII(int8_t, i);
+        break;
+      case GD_INT16:
+        end = _GD_AsciiParseInt(a->buf + a->off, &i);
+        STORE_ASCII(int16_t, i);
         break;
+      case GD_INT32:
+        end = _GD_AsciiParseInt(a->buf + a->off, &i);
+        STORE_ASCII(int32_t, i);
+        break;
+      case GD_INT64:
+        end = _GD_AsciiParseInt(a->buf + a->off, &i);
+        STORE_ASCII(int64_t, i);
+        break;
+      case GD_FLOAT32:
+        end = _GD_AsciiParseDouble(a->buf + a->off, d);
+        STORE_ASCII(float, d[0]);
+        break;
+      case GD_FLOAT64:
+        end = _GD_AsciiParseDouble(a->buf + a->off, d);
+        STORE_ASCII(double, d[0]);
+        break;
+      case GD_COMPLEX64:
+      case GD_COMPLEX128:
+        /* "re;im" */
+        end = _GD_AsciiParseDouble(a->buf + a->off, d);
+        if (end && *end == ';') {
+          a->off = end + 1 - a->buf;
+          if (_GD_AsciiToken(a)) {
+            dreturn("%i", -1);
+            return -1;
+          }
+          end = _GD_AsciiParseDouble(a->buf + a->off, d + 1);
+        } else
+          end = NULL;
+
+        if (end && data_type == GD_COMPLEX64) {
+          ((float *)slot)[0] = (float)d[0];
+          ((float *)slot)[1] = (float)d[1];
+        } else if (end) {
+          ((double *)slot)[0] = d[0];
+          ((double *)slot)[1] = d[1];
+        }
+        break;
+      default:
+        errno = EINVAL;
+        dreturn("%i", -1);
+        return -1;
+    }
 
+    if (end == NULL)
+      break;
 
-#ifdef NO_8BIT_INT_PREFIX
-      if (GD_SIZE(data_type) == 1) {
-        if (fscanf((FILE *)file->edata, fmt, &i16) < 1) {
-          if (ferror((FILE *)file->edata))
-            n = -1;
-          break;
-        }
-        if (data_type & GD_SIGNED)
-          *((int8_t *)ptr + GD_SIZE(data_type) * n) = (int8_t)i16;
-        else
-          *((uint8_t *)ptr + GD_SIZE(data_type) * n) = (uint8_t)i16;
-      } else
-#endif
-      {
-        if (fscanf((FILE *)file->edata, fmt, (char *)ptr + GD_SIZE(data_type) *
-              n) < 1)
-        {
-          if (ferror((FILE *)file->edata))
-            n = -1;
-          break;
-        }
-      }
-      file->pos++;
+    a->off = end - a->buf;
+    if (_GD_AsciiToken(a)) {
+      dreturn("%i", -1);
+      return -1;
     }
+    _GD_AsciiMark(a, ++file->pos);
   }
 
   dreturn("%" PRIdSIZE, n);
@@ -213,22 +589,23 @@ ssize_t _GD_AsciiRead(struct gd_raw_file_ *restrict file, void *restrict ptr,
 
 #define WRITE_ASCII(fmt,t) do { \
   for (n = 0; n < (ssize_t)nmemb; ++n) \
-    if (fprintf((FILE *)file->edata, "%" fmt "\n", ((t*)ptr)[n]) < 0) { n = -1; break; } \
+    if (fprintf(stream, "%" fmt "\n", ((t*)ptr)[n]) < 0) { n = -1; break; } \
 } while (0)
 #define WRITE_CASCII(fmt,t) do { \
   for (n = 0; n < (ssize_t)nmemb; ++n) \
-    if (fprintf((FILE *)file->edata, "%" fmt ";%" fmt "\n", ((t*)ptr)[n*2], ((t*)ptr)[n*2+1]) < 0) \
+    if (fprintf(stream, "%" fmt ";%" fmt "\n", ((t*)ptr)[n*2], ((t*)ptr)[n*2+1]) < 0) \
       { n = -1; break; } \
 } while (0)
 
 ssize_t _GD_AsciiWrite(struct gd_raw_file_ *restrict file,
     const void *restrict ptr, gd_type_t data_type, size_t nmemb)
 {
-  FILE *stream = (FILE *)file->edata;
+  struct gd_asciidata *a = (struct gd_asciidata *)file->edata;
+  FILE *stream = a->fp;
   ssize_t n = -1;
   char *tail = NULL;
   size_t i, tail_len = 0;
-  off64_t start;
+  off64_t start, end = -1;
   char line[64];
 
   dtrace("%p, %p, 0x%X, %" PRIuSIZE, file, ptr, data_type, nmemb);
@@ -241,18 +618,17 @@ ssize_t _GD_AsciiWrite(struct gd_raw_file_ *restrict file,
    * maximally consistent with other plugins (and ASCII encodings were
    * already inefficient.) */
 
-  /* reposition between output and input on the update stream: ftello()
-   * is not a file-positioning function */
-  if (fseeko64(stream, 0, SEEK_CUR)) {
+  /* move the stream to our read position, discarding the read buffer.  The
+   * lines we're about to replace, and everything after them, drop out of
+   * the line index */
+  if (_GD_AsciiJump(a, a->base + a->off)) {
     dreturn("%i", -1);
     return -1;
   }
+  start = a->base;
 
-  start = ftello64(stream);
-  if (start == -1) {
-    dreturn("%i", -1);
-    return -1;
-  }
+  if (a->n_line > (size_t)(file->pos / GD_ASCII_STRIDE + 1))
+    a->n_line = file->pos / GD_ASCII_STRIDE + 1;
 
   for (i = 0; i < nmemb; ++i) {
     /* consume one full line per sample; a line too long for the buffer
@@ -311,6 +687,10 @@ ssize_t _GD_AsciiWrite(struct gd_raw_file_ *restrict file,
     default:                            errno = EINVAL; break;
   }
 
+  /* where the next sample starts */
+  if (n >= 0 && (end = ftello64(stream)) == -1)
+    n = -1;
+
   if (n >= 0 && (i > 0 || tail_len > 0)) {
     /* replace the tail displaced by the overwrite, and discard whatever
      * remains of the old lines */
@@ -323,6 +703,10 @@ ssize_t _GD_AsciiWrite(struct gd_raw_file_ *restrict file,
   }
   free(tail);
 
+  /* and go there */
+  if (n >= 0 && _GD_AsciiJump(a, end))
+    n = -1;
+
   file->pos += nmemb;
 
   dreturn("%" PRIdSIZE, n);
@@ -335,11 +719,11 @@ int _GD_AsciiSync(struct gd_raw_file_ *file)
 
   dtrace("%p", file);
 
-  ret = fflush((FILE *)file->edata);
+  ret = fflush(((struct gd_asciidata *)file->edata)->fp);
 
 #ifndef __MSVCRT__
   if (!ret)
-    ret = fsync(fileno((FILE *)file->edata));
+    ret = fsync(fileno(((struct gd_asciidata *)file->edata)->fp));
 #endif
 
   dreturn("%i", ret);
@@ -349,15 +733,20 @@ int _GD_AsciiSync(struct gd_raw_file_ *file)
 int _GD_AsciiClose(struct gd_raw_file_* file)
 {
   int ret;
+  struct gd_asciidata *a = (struct gd_asciidata *)file->edata;
 
   dtrace("%p", file);
 
-  ret = fclose((FILE *)file->edata);
+  ret = fclose(a->fp);
   if (ret == EOF) {
     dreturn("%i", 1);
     return 1;
   }
 
+  free(a->buf);
+  free(a->line);
+  free(a);
+  file->edata = NULL;
   file->idata = -1;
   file->mode = 0;
   dreturn("%i", 0);
@@ -368,10 +757,10 @@ off64_t _GD_AsciiSize(int dirfd, struct gd_raw_file_* file,
     gd_type_t data_type gd_unused_, int swap gd_unused_)
 {
   FILE* stream;
-  char *buffer = NULL;
-  size_t len = 0;
+  char *buffer, *p;
+  size_t len;
   off64_t n = 0;
-  int fd;
+  int fd, last = '\n';
 
   dtrace("%i, %p, <unused>, <unused>", dirfd, file);
 
@@ -384,16 +773,36 @@ off64_t _GD_AsciiSize(int dirfd, struct gd_raw_file_* file,
   stream = fdopen(fd, "rb");
 
   if (stream == NULL) {
+    close(fd);
     dreturn("%i", -1);
     return -1;
   }
 
-  while (getdelim(&buffer, &len, '\n', stream) != -1)
-    n++;
+  buffer = malloc(GD_ASCII_BUFSIZE);
+  if (buffer == NULL) {
+    fclose(stream);
+    dreturn("%i", -1);
+    return -1;
+  }
+
+  /* count newlines; an unterminated last line also counts */
+  while ((len = fread(buffer, 1, GD_ASCII_BUFSIZE, stream)) > 0) {
+    for (p = buffer; (p = memchr(p, '\n', buffer + len - p)) != NULL; ++p)
+      n++;
+    last = buffer[len - 1];
+  }
   free(buffer);
 
+  if (ferror(stream)) {
+    fclose(stream);
+    dreturn("%i", -1);
+    return -1;
+  }
   fclose(stream);
 
+  if (last != '\n')
+    n++;
+
   dreturn("%" PRId64, (int64_t)n);
   return n;
 }
@@ -30,6 +30,34 @@
 #define GD_BZIP_BUFFER_SIZE 1000000
 #endif
 
+/* Each bzip2 block starts with the 48-bit block magic number, and each
+ * bzip2 stream ends with the 48-bit end-of-stream magic number followed by the
+ * stream CRC.  Neither is byte-aligned. */
+#define GD_BZ_BLOCK_MAGIC (((uint64_t)0x3141 << 32) | 0x59265359)
+#define GD_BZ_EOS_MAGIC   (((uint64_t)0x1772 << 32) | 0x45385090)
+#define GD_BZ_MAGIC_MASK  (((uint64_t)1 << 48) - 1)
+
+/* the sidecar magic number, including a format version */
+#define GD_BZ_IDX_MAGIC "GDBZIX01"
+
+/* the number of spurious magic numbers we're prepared to find in a block */
+#define GD_BZ_MAX_SPURIOUS 8
+
+/* A block index entry.  Because blocks are decoded independently of each
+ * other, any block can be decompressed on its own, given its extent in the
+ * compressed stream. */
+struct gd_bzblock_ {
+  off64_t bit; /* the bit offset of the block magic */
+  off64_t end; /* the bit offset of the end of the block */
+  off64_t out; /* the uncompressed offset of the block's data */
+};
+
+struct gd_bzindex_ {
+  struct gd_bzblock_ *block;
+  size_t n_block;
+  off64_t total; /* the uncompressed size */
+};
+
 struct gd_bzdata {
   BZFILE* bzfile;
   FILE* stream;
@@ -37,17 +65,423 @@ struct gd_bzdata {
   int stream_end;
   int pos, end;
   off64_t base;
+
+  /* the block index, once we've needed it */
+  int dirfd;
+  int indexed;
+  struct gd_bzindex_ index;
+
+  /* when appending: the size of the file before the new stream */
+  off64_t append_at;
+
+  /* when reading from the index: the block being decoded, or -1 */
+  int blk;
+  bz_stream strm;
+  char *in;
+
   char data[GD_BZIP_BUFFER_SIZE];
 };
 
 /* The bzip encoding scheme uses edata as a gd_bzdata pointer.  If a file is
- * open, idata = 0 otherwise idata = -1. */
+ * open, idata = 0 otherwise idata = -1.
+ *
+ * When reading, the data is normally decompressed sequentially through the
+ * BZFILE.  The first time a seek has to go backwards, we instead find the
+ * blocks in the file, by looking for the block magic numbers, and decompress
+ * each of them once, to find out how much data it holds.  This index is kept
+ * in a sidecar (see sidecar.c), from which it's picked up when the file is
+ * next opened.  It lets seeks start decompressing at the right block, and
+ * _GD_Bzip2Size skip decompression altogether.
+ *
+ * libbz2 can't start decompression at an arbitrary bit offset, so to
+ * decompress a single block we wrap it in a bzip2 stream of its own, in the
+ * manner of bzip2recover.
+ *
+ * A write which starts at the end of the data is done by appending a new
+ * stream to the file (GD_FILE_APPEND), which bzip2 readers take to be part of
+ * the same data.  The index is then extended by scanning only the new stream.
+ */
+
+/* _GD_Bzip2BlockInit: prepare strm to decompress the block b of the file fd.
+ * The synthetic stream is allocated and returned in *in.  Returns a libbz2
+ * error code.
+ */
+static int _GD_Bzip2BlockInit(int fd, const struct gd_bzblock_ *b,
+    bz_stream *strm, char **in)
+{
+  const off64_t first = b->bit / 8;
+  const int shift = (int)(b->bit % 8);
+  const off64_t nbits = b->end - b->bit;
+  const size_t nread = (size_t)((b->end + 7) / 8 - first);
+  /* header + block + end-of-stream magic and stream CRC */
+  const size_t len = 4 + (size_t)((nbits + 48 + 32 + 7) / 8);
+  unsigned char *src, *dst;
+  uint64_t trailer;
+  off64_t bit;
+  size_t i;
+  int r;
+
+  dtrace("%i, %p, %p, %p", fd, b, strm, in);
+
+  src = malloc(nread + 1);
+  dst = calloc(len, 1);
+  if (src == NULL || dst == NULL) {
+    free(src);
+    free(dst);
+    dreturn("%i", BZ_MEM_ERROR);
+    return BZ_MEM_ERROR;
+  }
+
+  if (lseek64(fd, first, SEEK_SET) == -1 || read(fd, src, nread) !=
+      (ssize_t)nread)
+  {
+    free(src);
+    free(dst);
+    dreturn("%i", BZ_IO_ERROR);
+    return BZ_IO_ERROR;
+  }
+  src[nread] = 0;
+
+  /* a header: we don't know the block size of the original stream, so claim
+   * the largest */
+  memcpy(dst, "BZh9", 4);
+
+  /* the block, shifted to a byte boundary */
+  for (i = 0; i < (size_t)((nbits + 7) / 8); ++i)
+    dst[4 + i] = shift ? (unsigned char)((src[i] << shift) |
+        (src[i + 1] >> (8 - shift))) : src[i];
+  free(src);
+
+  if (nbits % 8)
+    dst[4 + nbits / 8] &= (unsigned char)(0xFF << (8 - nbits % 8));
+
+  /* the end of stream magic, followed by the stream CRC, which, for a single
+   * block stream, is just the block CRC, which follows the block magic */
+  bit = 32 + nbits;
+  trailer = GD_BZ_EOS_MAGIC;
+  for (i = 0; i < 48; ++i, ++bit)
+    if ((trailer >> (47 - i)) & 1)
+      dst[bit / 8] |= (unsigned char)(0x80 >> (bit % 8));
+  for (i = 0; i < 32; ++i, ++bit)
+    if ((dst[10 + i / 8] >> (7 - i % 8)) & 1)
+      dst[bit / 8] |= (unsigned char)(0x80 >> (bit % 8));
+
+  memset(strm, 0, sizeof(*strm));
+  r = BZ2_bzDecompressInit(strm, 0, 0);
+  if (r != BZ_OK) {
+    free(dst);
+    dreturn("%i", r);
+    return r;
+  }
+
+  strm->next_in = (char*)dst;
+  strm->avail_in = (unsigned int)len;
+  *in = (char*)dst;
+
+  dreturn("%i", BZ_OK);
+  return BZ_OK;
+}
+
+/* _GD_Bzip2BlockSize: decompress the block b, to find out how big it is.
+ * buf is scratch space.  Returns a libbz2 error code.
+ */
+static int _GD_Bzip2BlockSize(int fd, const struct gd_bzblock_ *b,
+    char *buf, off64_t *size)
+{
+  bz_stream strm;
+  char *in;
+  int r;
+
+  dtrace("%i, %p, %p, %p", fd, b, buf, size);
+
+  r = _GD_Bzip2BlockInit(fd, b, &strm, &in);
+  if (r != BZ_OK) {
+    dreturn("%i", r);
+    return r;
+  }
+
+  *size = 0;
+  do {
+    strm.next_out = buf;
+    strm.avail_out = GD_BZIP_BUFFER_SIZE;
+    r = BZ2_bzDecompress(&strm);
+    *size += GD_BZIP_BUFFER_SIZE - strm.avail_out;
+
+    /* out of input before the end of the stream: the block is truncated */
+    if (r == BZ_OK && strm.avail_in == 0 && strm.avail_out > 0)
+      r = BZ_UNEXPECTED_EOF;
+  } while (r == BZ_OK);
+
+  BZ2_bzDecompressEnd(&strm);
+  free(in);
+
+  if (r == BZ_STREAM_END)
+    r = BZ_OK;
+
+  dreturn("%i (%" PRId64 ")", r, (int64_t)*size);
+  return r;
+}
+
+/* _GD_Bzip2BuildIndex: find the blocks in the file fd, by scanning it for
+ * magic numbers.  Because these aren't escaped, the scan may turn up spurious
+ * ones, so each candidate block is decompressed to check it, and extended
+ * over the next magic number if that fails.  If start is non-zero, it's the
+ * offset of a stream appended to the part of the file already in idx, and only
+ * the rest of the file is scanned, for blocks to add to idx.  Returns a libbz2
+ * error code.
+ */
+static int _GD_Bzip2BuildIndex(int fd, struct gd_bzindex_ *idx, char *buf,
+    off64_t start)
+{
+  struct gd_bzblock_ *cand = NULL;
+  size_t i, j, n_new = 0, n_cand = 0, size_cand = 0;
+  uint64_t w = 0;
+  off64_t bit = start * 8;
+  ssize_t n;
+  int r = BZ_OK;
+
+  dtrace("%i, %p, %p, %" PRId64, fd, idx, buf, (int64_t)start);
+
+  if (start == 0) {
+    idx->block = NULL;
+    idx->n_block = 0;
+    idx->total = 0;
+  }
+
+  /* find the magic numbers: cand[i].out is non-zero for a block */
+  if (lseek64(fd, start, SEEK_SET) == -1) {
+    dreturn("%i", BZ_IO_ERROR);
+    return BZ_IO_ERROR;
+  }
+
+  while ((n = read(fd, buf, GD_BZIP_BUFFER_SIZE)) > 0) {
+    ssize_t k;
+    int b;
+
+    /* not bzip2 data at all */
+    if (bit == start * 8 && (n < 4 || memcmp(buf, "BZh", 3))) {
+      dreturn("%i", BZ_DATA_ERROR_MAGIC);
+      return BZ_DATA_ERROR_MAGIC;
+    }
+
+    for (k = 0; k < n; ++k)
+      for (b = 7; b >= 0; --b) {
+        uint64_t m;
+
+        w = (w << 1) | ((buf[k] >> b) & 1);
+        m = w & GD_BZ_MAGIC_MASK;
+        ++bit;
+
+        if (bit >= 48 && (m == GD_BZ_BLOCK_MAGIC || m == GD_BZ_EOS_MAGIC)) {
+          if (n_cand == size_cand) {
+            struct gd_bzblock_ *ptr;
+            size_cand = size_cand ? 2 * size_cand : 64;
+            ptr = realloc(cand, sizeof(*cand) * size_cand);
+            if (ptr == NULL) {
+              free(cand);
+              dreturn("%i", BZ_MEM_ERROR);
+              return BZ_MEM_ERROR;
+            }
+            cand = ptr;
+          }
+          cand[n_cand].bit = bit - 48;
+          cand[n_cand].end = 0;
+          cand[n_cand++].out = (m == GD_BZ_BLOCK_MAGIC);
+        }
+      }
+  }
+
+  if (n < 0 || bit == start * 8) {
+    free(cand);
+    dreturn("%i", n < 0 ? BZ_IO_ERROR : BZ_DATA_ERROR_MAGIC);
+    return n < 0 ? BZ_IO_ERROR : BZ_DATA_ERROR_MAGIC;
+  }
+
+  /* now find out which are real.  The blocks found are stored over the
+   * candidates, which we're finished with by the time they're overwritten */
+  for (i = 0; i < n_cand; ) {
+    struct gd_bzblock_ b;
+    off64_t size = 0;
+
+    if (!cand[i].out) {
+      ++i;
+      continue;
+    }
+
+    b.bit = cand[i].bit;
+    r = BZ_DATA_ERROR;
+    for (j = i + 1; j < n_cand && j <= i + GD_BZ_MAX_SPURIOUS; ++j) {
+      b.end = cand[j].bit;
+      r = _GD_Bzip2BlockSize(fd, &b, buf, &size);
+      if (r != BZ_DATA_ERROR && r != BZ_DATA_ERROR_MAGIC &&
+          r != BZ_UNEXPECTED_EOF)
+      {
+        break;
+      }
+    }
+
+    if (r == BZ_OK) {
+      b.out = idx->total;
+      idx->total += size;
+      cand[n_new++] = b;
+      i = j;
+    } else if (r == BZ_DATA_ERROR || r == BZ_DATA_ERROR_MAGIC ||
+        r == BZ_UNEXPECTED_EOF)
+    {
+      /* a spurious block magic, or a truncated block at the end of the file;
+       * either way, there's no data here */
+      ++i;
+      r = BZ_OK;
+    } else
+      break;
+  }
+
+  if (r != BZ_OK) {
+    free(cand);
+    if (start == 0)
+      idx->n_block = 0;
+  } else if (idx->n_block == 0) {
+    idx->block = cand;
+    idx->n_block = n_new;
+  } else {
+    /* add the new blocks to the old ones */
+    struct gd_bzblock_ *ptr = realloc(idx->block,
+        sizeof(*ptr) * (idx->n_block + n_new));
+    if (ptr == NULL)
+      r = BZ_MEM_ERROR;
+    else {
+      memcpy(ptr + idx->n_block, cand, sizeof(*ptr) * n_new);
+      idx->block = ptr;
+      idx->n_block += n_new;
+    }
+    free(cand);
+  }
+
+  dreturn("%i (%" PRIuSIZE ")", r, idx->n_block);
+  return r;
+}
+
+/* _GD_Bzip2LoadIndex: read the index from the sidecar of the data file.
+ * Returns non-zero if there isn't a usable one.
+ */
+static int _GD_Bzip2LoadIndex(const DIRFILE *D, int dirfd, const char *name,
+    const struct gd_stamp_ *stamp, struct gd_bzindex_ *idx)
+{
+  int64_t total;
+  uint64_t n;
+  size_t i;
+  int fd, bad = 0;
+
+  dtrace("%p, %i, \"%s\", %p, %p", D, dirfd, name, stamp, idx);
+
+  fd = _GD_OpenSidecar(D, dirfd, name, GD_BZ_IDX_MAGIC, stamp);
+  if (fd < 0) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  idx->block = NULL;
+  if (_GD_SidecarRead(fd, &total, 8) || _GD_SidecarRead(fd, &n, 8) ||
+      total < 0 || _GD_SidecarBadCount(n, sizeof(*idx->block), stamp) ||
+      (n > 0 && (idx->block = malloc(sizeof(*idx->block) * n)) == NULL))
+  {
+    bad = 1;
+  }
+
+  for (i = 0; !bad && i < n; ++i) {
+    int64_t v[3];
+    bad = _GD_SidecarRead(fd, v, sizeof(v)) || v[0] < 0 || v[1] <= v[0] ||
+      v[2] < 0 || v[2] > total;
+    idx->block[i].bit = v[0];
+    idx->block[i].end = v[1];
+    idx->block[i].out = v[2];
+  }
+  close(fd);
+
+  if (bad)
+    free(idx->block);
+  else {
+    idx->n_block = n;
+    idx->total = total;
+  }
+
+  dreturn("%i", bad);
+  return bad;
+}
+
+/* _GD_Bzip2SaveIndex: write the index to the sidecar of the data file.  Failure
+ * isn't an error: the index is just rebuilt the next time it's needed.
+ */
+static void _GD_Bzip2SaveIndex(const DIRFILE *D, int dirfd, const char *name,
+    const struct gd_stamp_ *stamp, const struct gd_bzindex_ *idx)
+{
+  int64_t total;
+  uint64_t n;
+  size_t i;
+  char *tmp;
+  int sfd, bad;
+
+  dtrace("%p, %i, \"%s\", %p, %p", D, dirfd, name, stamp, idx);
+
+  sfd = _GD_CreateSidecar(D, dirfd, name, GD_BZ_IDX_MAGIC, stamp, &tmp);
+  if (sfd >= 0) {
+    total = idx->total;
+    n = idx->n_block;
+    bad = _GD_SidecarWrite(sfd, &total, 8) || _GD_SidecarWrite(sfd, &n, 8);
+    for (i = 0; !bad && i < idx->n_block; ++i) {
+      const int64_t v[3] = { idx->block[i].bit, idx->block[i].end,
+        idx->block[i].out };
+      bad = _GD_SidecarWrite(sfd, v, sizeof(v));
+    }
+    _GD_FinishSidecar(D, dirfd, name, sfd, tmp, bad);
+  }
+
+  dreturnvoid();
+}
+
+/* _GD_Bzip2GetIndex: read the index from the sidecar of the data file, or, if
+ * there isn't a usable one, build it and try to save it.  Returns a libbz2
+ * error code.
+ */
+static int _GD_Bzip2GetIndex(const DIRFILE *D, int dirfd, const char *name,
+    struct gd_bzindex_ *idx, char *buf)
+{
+  struct gd_stamp_ stamp;
+  int fd, r;
+
+  dtrace("%p, %i, \"%s\", %p, %p", D, dirfd, name, idx, buf);
+
+  fd = gd_OpenAt(D, dirfd, name, O_RDONLY | O_BINARY, 0666);
+  if (fd < 0 || _GD_FileStamp(fd, &stamp)) {
+    if (fd >= 0)
+      close(fd);
+    dreturn("%i", BZ_IO_ERROR);
+    return BZ_IO_ERROR;
+  }
+
+  if (_GD_Bzip2LoadIndex(D, dirfd, name, &stamp, idx) == 0) {
+    close(fd);
+    dreturn("%i (%" PRIuSIZE ")", BZ_OK, idx->n_block);
+    return BZ_OK;
+  }
+
+  r = _GD_Bzip2BuildIndex(fd, idx, buf, 0);
+  close(fd);
+
+  if (r == BZ_OK)
+    _GD_Bzip2SaveIndex(D, dirfd, name, &stamp, idx);
+
+  dreturn("%i", r);
+  return r;
+}
 
 static struct gd_bzdata *_GD_Bzip2DoOpen(int dirfd, struct gd_raw_file_* file,
     unsigned int mode)
 {
   int fd;
   struct gd_bzdata *ptr;
+  struct gd_bzindex_ index = { NULL, 0, 0 }; /* only used when appending */
+  off64_t append_at = 0;
   FILE *stream;
   const char *fdmode = "rb";
 
@@ -57,6 +491,32 @@ static struct gd_bzdata *_GD_Bzip2DoOpen(int dirfd, struct gd_raw_file_* file,
 
   if (mode & GD_FILE_READ) {
     fd = gd_OpenAt(file->D, dirfd, file->name, O_RDONLY | O_BINARY, 0666);
+  } else if (mode & GD_FILE_APPEND) {
+    /* the index of the existing data, which the new stream will extend; this
+     * borrows a buffer, since we haven't got one of our own yet */
+    char *buf = malloc(GD_BZIP_BUFFER_SIZE);
+    if (buf == NULL) {
+      file->error = BZ_MEM_ERROR;
+      dreturn("%p", NULL);
+      return NULL;
+    }
+    file->error = _GD_Bzip2GetIndex(file->D, dirfd, file->name, &index, buf);
+    free(buf);
+    if (file->error != BZ_OK) {
+      dreturn("%p", NULL);
+      return NULL;
+    }
+    file->error = BZ_IO_ERROR;
+
+    fd = gd_OpenAt(file->D, dirfd, file->name, O_WRONLY | O_APPEND | O_BINARY,
+        0666);
+    if (fd >= 0 && (append_at = lseek64(fd, 0, SEEK_END)) < 0) {
+      close(fd);
+      fd = -1;
+    }
+    if (fd < 0)
+      free(index.block);
+    fdmode = "ab";
   } else if (mode & GD_FILE_TEMP) {
     fd = _GD_MakeTempFile(file->D, dirfd, file->name);
     fdmode = "wb";
@@ -73,12 +533,14 @@ static struct gd_bzdata *_GD_Bzip2DoOpen(int dirfd, struct gd_raw_file_* file,
 
   if ((stream = fdopen(fd, fdmode)) == NULL) {
     close(fd);
+    free(index.block);
     dreturn("%p", NULL);
     return NULL;
   }
 
   if ((ptr = malloc(sizeof(struct gd_bzdata))) == NULL) {
     fclose(stream);
+    free(index.block);
     dreturn("%p", NULL);
     return NULL;
   }
@@ -100,22 +562,44 @@ static struct gd_bzdata *_GD_Bzip2DoOpen(int dirfd, struct gd_raw_file_* file,
     fclose(stream);
     file->error = ptr->bzerror;
     free(ptr);
+    free(index.block);
     dreturn("%p", NULL);
     return NULL;
   }
 
   ptr->pos = ptr->end = 0;
   ptr->base = 0;
+  ptr->dirfd = dirfd;
+  ptr->indexed = 0;
+  ptr->blk = -1;
+  ptr->in = NULL;
+  ptr->append_at = append_at;
+
+  /* new data goes after the old */
+  if (mode & GD_FILE_APPEND) {
+    ptr->index = index;
+    ptr->indexed = 1;
+    ptr->base = index.total;
+  }
+
+  /* pick up an existing index */
+  if (mode & GD_FILE_READ) {
+    struct gd_stamp_ stamp;
+    if (_GD_FileStamp(fd, &stamp) == 0 && _GD_Bzip2LoadIndex(file->D, dirfd,
+          file->name, &stamp, &ptr->index) == 0)
+    {
+      ptr->indexed = 1;
+    }
+  }
 
   dreturn("%p", ptr);
   return ptr;
 }
 
-int _GD_Bzip2Open(int dirfd, struct gd_raw_file_* file,
-    gd_type_t type gd_unused_, int swap gd_unused_,
-    unsigned int mode)
+int _GD_Bzip2Open(int dirfd, struct gd_raw_file_* file, gd_type_t type,
+    int swap gd_unused_, unsigned int mode)
 {
-  dtrace("%i, %p, <unused>, <unused>, 0x%X", dirfd, file, mode);
+  dtrace("%i, %p, 0x%X, <unused>, 0x%X", dirfd, file, type, mode);
 
   file->edata = _GD_Bzip2DoOpen(dirfd, file, mode);
 
@@ -124,13 +608,136 @@ int _GD_Bzip2Open(int dirfd, struct gd_raw_file_* file,
     return 1;
   }
 
-  file->pos = 0;
+  file->pos = ((struct gd_bzdata *)file->edata)->base / GD_SIZE(type);
   file->mode = mode;
   file->idata = 0;
   dreturn("%i", 0);
   return 0;
 }
 
+/* _GD_Bzip2NextStream: at the end of a bzip2 stream, start reading the next
+ * one, if there is one.  Returns a libbz2 error code.
+ */
+static int _GD_Bzip2NextStream(struct gd_bzdata *ptr)
+{
+  void *unused;
+  char buf[BZ_MAX_UNUSED];
+  int nunused, e = BZ_OK;
+
+  dtrace("%p", ptr);
+
+  BZ2_bzReadGetUnused(&e, ptr->bzfile, &unused, &nunused);
+  if (e != BZ_OK) {
+    dreturn("%i", e);
+    return e;
+  }
+  memcpy(buf, unused, nunused);
+  BZ2_bzReadClose(&e, ptr->bzfile);
+
+  /* the end of the file */
+  if (nunused == 0) {
+    int c = fgetc(ptr->stream);
+    if (c == EOF) {
+      ptr->bzfile = NULL;
+      dreturn("%i", BZ_STREAM_END);
+      return BZ_STREAM_END;
+    }
+    buf[0] = (char)c;
+    nunused = 1;
+  }
+
+  ptr->bzfile = BZ2_bzReadOpen(&e, ptr->stream, 0, 0, buf, nunused);
+
+  dreturn("%i", e);
+  return e;
+}
+
+/* _GD_Bzip2Fill: read the next buffer full of data.  Returns non-zero on
+ * error.
+ */
+static int _GD_Bzip2Fill(struct gd_raw_file_ *file, struct gd_bzdata *ptr)
+{
+  int n;
+
+  dtrace("%p, %p", file, ptr);
+
+  ptr->base += ptr->end;
+  ptr->pos = ptr->end = 0;
+
+  if (ptr->blk >= 0) {
+    /* reading from the index */
+    ptr->strm.next_out = ptr->data;
+    ptr->strm.avail_out = GD_BZIP_BUFFER_SIZE;
+    ptr->bzerror = BZ2_bzDecompress(&ptr->strm);
+    ptr->end = GD_BZIP_BUFFER_SIZE - ptr->strm.avail_out;
+
+    if (ptr->bzerror == BZ_STREAM_END) {
+      /* on to the next block */
+      BZ2_bzDecompressEnd(&ptr->strm);
+      free(ptr->in);
+      ptr->in = NULL;
+
+      if ((size_t)++ptr->blk >= ptr->index.n_block) {
+        ptr->blk = -1;
+        ptr->stream_end = 1;
+      } else {
+        ptr->bzerror = _GD_Bzip2BlockInit(fileno(ptr->stream),
+            ptr->index.block + ptr->blk, &ptr->strm, &ptr->in);
+        if (ptr->bzerror != BZ_OK) {
+          ptr->blk = -1;
+          file->error = ptr->bzerror;
+          dreturn("%i", 1);
+          return 1;
+        }
+      }
+    } else if (ptr->bzerror != BZ_OK) {
+      file->error = ptr->bzerror;
+      dreturn("%i", 1);
+      return 1;
+    }
+  } else if (ptr->bzfile == NULL) {
+    ptr->stream_end = 1;
+  } else {
+    /* reading sequentially: if we hit the end of a stream, there may be
+     * another one following it */
+    int start = 0;
+
+    while (ptr->end == 0 && !ptr->stream_end) {
+      ptr->bzerror = 0;
+      n = BZ2_bzRead(&ptr->bzerror, ptr->bzfile, ptr->data,
+          GD_BZIP_BUFFER_SIZE);
+
+      if (ptr->bzerror == BZ_OK || ptr->bzerror == BZ_STREAM_END)
+        ptr->end = n;
+      else if (start && ptr->bzerror == BZ_DATA_ERROR_MAGIC) {
+        /* trailing garbage after the last stream: ignore it, as bzip2 does */
+        ptr->stream_end = 1;
+        break;
+      } else {
+        file->error = ptr->bzerror;
+        dreturn("%i", 1);
+        return 1;
+      }
+
+      start = 0;
+      if (ptr->bzerror == BZ_STREAM_END) {
+        ptr->bzerror = _GD_Bzip2NextStream(ptr);
+        if (ptr->bzerror == BZ_STREAM_END)
+          ptr->stream_end = 1;
+        else if (ptr->bzerror != BZ_OK) {
+          file->error = ptr->bzerror;
+          dreturn("%i", 1);
+          return 1;
+        }
+        start = 1;
+      }
+    }
+  }
+
+  dreturn("%i", 0);
+  return 0;
+}
+
 ssize_t _GD_Bzip2Read(struct gd_raw_file_ *restrict file, void *restrict data,
     gd_type_t data_type, size_t nmemb)
 {
@@ -140,48 +747,23 @@ ssize_t _GD_Bzip2Read(struct gd_raw_file_ *restrict file, void *restrict data,
 
   dtrace("%p, %p, 0x%X, %" PRIuSIZE, file, data, data_type, nmemb);
 
-  while (nbytes > (uint64_t)(ptr->end - ptr->pos)) {
-    int n;
-
-    memcpy(output, ptr->data + ptr->pos, ptr->end - ptr->pos);
-    output += ptr->end - ptr->pos;
-    nbytes -= ptr->end - ptr->pos;
-    ptr->pos = ptr->end;
+  for (;;) {
+    uint64_t n = ptr->end - ptr->pos;
+    if (n > nbytes)
+      n = nbytes;
 
-    if (ptr->stream_end) {
-      dreturn("%li", (long)(nmemb - nbytes / GD_SIZE(data_type)));
-      return nmemb - nbytes / GD_SIZE(data_type);
-    }
+    memcpy(output, ptr->data + ptr->pos, n);
+    output += n;
+    nbytes -= n;
+    ptr->pos += n;
 
-    ptr->bzerror = 0;
-    n = BZ2_bzRead(&ptr->bzerror, ptr->bzfile, ptr->data,
-        GD_BZIP_BUFFER_SIZE);
+    if (nbytes == 0 || ptr->stream_end)
+      break;
 
-    if (ptr->bzerror == BZ_OK || ptr->bzerror == BZ_STREAM_END) {
-      ptr->base += ptr->end;
-      ptr->pos = 0;
-      ptr->end = n;
-    } else {
-      file->error = ptr->bzerror;
+    if (_GD_Bzip2Fill(file, ptr)) {
       dreturn("%i", -1);
       return -1;
     }
-
-    /* eof */
-    if (ptr->bzerror != BZ_OK) {
-      ptr->stream_end = 1;
-      break;
-    }
-  }
-
-  if (nbytes > (uint64_t)(ptr->end - ptr->pos)) {
-    memcpy(output, ptr->data + ptr->pos, ptr->end - ptr->pos);
-    ptr->pos = ptr->end;
-    nbytes -= ptr->end;
-  } else {
-    memcpy(output, ptr->data + ptr->pos, nbytes);
-    ptr->pos += nbytes;
-    nbytes = 0;
   }
 
   file->pos = (ptr->base + ptr->pos) / GD_SIZE(data_type);
@@ -217,6 +799,57 @@ ssize_t _GD_Bzip2Write(struct gd_raw_file_ *file, const void *data,
   return n;
 }
 
+/* _GD_Bzip2SeekBlock: restart decompression at the start of the block which
+ * holds the byte at offset.  Returns non-zero on error. */
+static int _GD_Bzip2SeekBlock(struct gd_raw_file_ *file,
+    struct gd_bzdata *ptr, off64_t offset)
+{
+  size_t lo, hi;
+
+  dtrace("%p, %p, %" PRId64, file, ptr, (int64_t)offset);
+
+  /* find the last block starting at or before offset */
+  for (lo = 0, hi = ptr->index.n_block; lo < hi; ) {
+    size_t mid = (lo + hi) / 2;
+    if (ptr->index.block[mid].out <= offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (ptr->blk >= 0) {
+    BZ2_bzDecompressEnd(&ptr->strm);
+    free(ptr->in);
+    ptr->in = NULL;
+    ptr->blk = -1;
+  }
+
+  ptr->pos = ptr->end = 0;
+
+  if (lo == 0) {
+    /* an empty file */
+    ptr->base = 0;
+    ptr->stream_end = 1;
+  } else {
+    ptr->blk = (int)lo - 1;
+    ptr->base = ptr->index.block[ptr->blk].out;
+    ptr->stream_end = 0;
+    ptr->bzerror = _GD_Bzip2BlockInit(fileno(ptr->stream),
+        ptr->index.block + ptr->blk, &ptr->strm, &ptr->in);
+
+    if (ptr->bzerror != BZ_OK) {
+      ptr->blk = -1;
+      file->error = ptr->bzerror;
+      dreturn("%i", 1);
+      return 1;
+    }
+    _GD_CountIndexSeek(file);
+  }
+
+  dreturn("%i", 0);
+  return 0;
+}
+
 off64_t _GD_Bzip2Seek(struct gd_raw_file_* file, off64_t offset,
     gd_type_t data_type, unsigned int mode)
 {
@@ -248,31 +881,45 @@ off64_t _GD_Bzip2Seek(struct gd_raw_file_* file, off64_t offset,
       remaining -= n;
     }
   } else {
-    /* seek forward the slow way */
-    while (ptr->base + ptr->end < offset) {
-      int n;
-
-      /* eof */
-      if (ptr->stream_end)
-        break;
-
-      ptr->bzerror = 0;
-      n = BZ2_bzRead(&ptr->bzerror, ptr->bzfile, ptr->data,
-          GD_BZIP_BUFFER_SIZE);
-
-      if (ptr->bzerror == BZ_OK || ptr->bzerror == BZ_STREAM_END) {
-        ptr->base += ptr->end;
-        ptr->end = n;
-        if (ptr->bzerror == BZ_STREAM_END)
-          ptr->stream_end = 1;
-      } else {
+    /* going backwards, we need the index */
+    if (offset < ptr->base && !ptr->indexed) {
+      ptr->bzerror = _GD_Bzip2GetIndex(file->D, ptr->dirfd, file->name,
+          &ptr->index, ptr->data);
+      if (ptr->bzerror != BZ_OK) {
         file->error = ptr->bzerror;
         dreturn("%i", -1);
         return -1;
       }
+      ptr->indexed = 1;
+      ptr->end = 0; /* the buffer has been clobbered */
     }
 
-    ptr->pos = (ptr->stream_end && offset >= ptr->base + ptr->end) ? ptr->end :
+    /* use the index to skip to the right block, unless it's the one we're
+     * already in */
+    if (ptr->indexed && (offset < ptr->base ||
+          offset >= ptr->base + ptr->end))
+    {
+      const off64_t here = ptr->base + ptr->end;
+      size_t k;
+      for (k = ptr->index.n_block; k > 0; --k)
+        if (ptr->index.block[k - 1].out <= offset)
+          break;
+
+      if (offset < ptr->base || (k > 0 && ptr->index.block[k - 1].out > here))
+        if (_GD_Bzip2SeekBlock(file, ptr, offset)) {
+          dreturn("%i", -1);
+          return -1;
+        }
+    }
+
+    /* seek forward the slow way */
+    while (ptr->base + ptr->end < offset && !ptr->stream_end)
+      if (_GD_Bzip2Fill(file, ptr)) {
+        dreturn("%i", -1);
+        return -1;
+      }
+
+    ptr->pos = (offset >= ptr->base + ptr->end) ? ptr->end :
       offset - ptr->base;
   }
   
@@ -288,9 +935,13 @@ int _GD_Bzip2Close(struct gd_raw_file_ *file)
   dtrace("%p", file);
 
   ptr->bzerror = 0;
-  if (file->mode & GD_FILE_READ)
-    BZ2_bzReadClose(&ptr->bzerror, ptr->bzfile);
-  else
+  if (file->mode & GD_FILE_READ) {
+    if (ptr->bzfile)
+      BZ2_bzReadClose(&ptr->bzerror, ptr->bzfile);
+    if (ptr->blk >= 0)
+      BZ2_bzDecompressEnd(&ptr->strm);
+    free(ptr->in);
+  } else
     BZ2_bzWriteClose(&ptr->bzerror, ptr->bzfile, 0, NULL, NULL);
 
   if (ptr->bzerror || fclose(ptr->stream)) {
@@ -300,6 +951,25 @@ int _GD_Bzip2Close(struct gd_raw_file_ *file)
     return 1;
   }
 
+  /* extend the index over the stream just appended */
+  if (file->mode & GD_FILE_APPEND) {
+    struct gd_stamp_ stamp;
+    int fd = gd_OpenAt(file->D, ptr->dirfd, file->name, O_RDONLY | O_BINARY,
+        0666);
+    if (fd >= 0) {
+      if (_GD_FileStamp(fd, &stamp) == 0 && _GD_Bzip2BuildIndex(fd,
+            &ptr->index, ptr->data, ptr->append_at) == BZ_OK)
+      {
+        _GD_Bzip2SaveIndex(file->D, ptr->dirfd, file->name, &stamp,
+            &ptr->index);
+      }
+      close(fd);
+    }
+  }
+
+  if (ptr->indexed)
+    free(ptr->index.block);
+
   file->idata = -1;
   file->mode = 0;
   free(file->edata);
@@ -310,49 +980,34 @@ int _GD_Bzip2Close(struct gd_raw_file_ *file)
 off64_t _GD_Bzip2Size(int dirfd, struct gd_raw_file_ *file, gd_type_t data_type,
     int swap gd_unused_)
 {
-  struct gd_bzdata *ptr;
+  struct gd_bzindex_ idx;
+  char *buf;
   off_t n;
 
   dtrace("%i, %p, 0x%X, <unused>", dirfd, file, data_type);
 
-  ptr = _GD_Bzip2DoOpen(dirfd, file, GD_FILE_READ);
-
-  if (ptr == NULL) {
+  buf = malloc(GD_BZIP_BUFFER_SIZE);
+  if (buf == NULL) {
+    file->error = BZ_MEM_ERROR;
     dreturn("%i", -1);
     return -1;
   }
 
-  /* seek forward the slow way to the end */
-  while (ptr->bzerror != BZ_STREAM_END) {
-    int n;
-
-    ptr->bzerror = 0;
-    n = BZ2_bzRead(&ptr->bzerror, ptr->bzfile, ptr->data,
-        GD_BZIP_BUFFER_SIZE);
+  /* the index knows the size */
+  file->error = _GD_Bzip2GetIndex(file->D, dirfd, file->name, &idx, buf);
+  free(buf);
 
-    if (ptr->bzerror == BZ_OK || ptr->bzerror == BZ_STREAM_END) {
-      ptr->base += ptr->end;
-      ptr->pos = 0;
-      ptr->end = n;
-    } else {
-      file->error = ptr->bzerror;
-      BZ2_bzReadClose(&ptr->bzerror, ptr->bzfile);
-      fclose(ptr->stream);
-      free(ptr);
-      dreturn("%i", -1);
-      return -1;
-    }
+  if (file->error != BZ_OK) {
+    dreturn("%i", -1);
+    return -1;
   }
-  BZ2_bzReadClose(&ptr->bzerror, ptr->bzfile);
-  fclose(ptr->stream);
+  free(idx.block);
 
-  n = (ptr->base + ptr->end) / GD_SIZE(data_type);
-  free(ptr);
+  n = idx.total / GD_SIZE(data_type);
 
   dreturn("%" PRId64, (int64_t)n);
   return n;
 }
-
 int _GD_Bzip2Strerr(const struct gd_raw_file_ *file, char *buf, size_t buflen)
 {
   int r = 0;
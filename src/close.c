@@ -38,6 +38,8 @@ void _GD_FreeF(DIRFILE *D, int start, int stop)
     free(D->fragment[j].ename);
     free(D->fragment[j].sname);
     free(D->fragment[j].ref_name);
+    if (D->fragment[j].lazy)
+      D->n_lazy--;
   }
 
   dreturnvoid();
@@ -51,11 +53,19 @@ static void _GD_FreeD(DIRFILE *D, int keep_dirfile)
 
   dtrace("%p, %i", D, keep_dirfile);
 
+  _GD_DetachFrameWriters(D);
+  _GD_WBStop(D);
+
+  /* no need to keep these up to date while the entries are freed */
+  _GD_HashClear(D);
+  free(D->handle);
+  D->handle = NULL;
+  D->n_handle = D->handle_size = 0;
+
   for (i = 0; i < D->n_entries; ++i)
     _GD_FreeE(D, D->entry[i], 1);
 
   free(D->entry);
-  free(D->opened);
   free(D->tok_base);
   free(D->error_prefix);
   free(D->error_string);
@@ -96,6 +106,9 @@ int _GD_ShutdownDirfile(DIRFILE* D, int flush_meta, int keep_dirfile)
   _GD_ClearError(D);
 
   /* Flush */
+  _GD_FlushFrameWriters(D);
+  _GD_WBDrain(D);
+
   if (flush_meta)
     _GD_FlushMeta(D, GD_ALL_FRAGMENTS, 0);
 
@@ -21,6 +21,11 @@
  */
 #include "internal.h"
 
+#if defined HAVE_SYS_MMAN_H && defined HAVE_MMAP
+#include <sys/mman.h>
+#define USE_MMAP
+#endif
+
 /* This is defined on BSD */
 #ifndef MAXSYMLINKS
 #define MAXSYMLINKS 20
@@ -149,19 +154,193 @@ gd_type_t _GD_LegacyType(char c)
   return GD_UNKNOWN;
 }
 
+/* The field code hash is an open-addressed table of the entries in D->entry,
+ * with linear probing, kept at most half full.  It's built by the first
+ * lookup which can use it, and kept up to date as entries are added and
+ * deleted.  Bulk changes, like renames, which re-sort D->entry anyway, just
+ * discard it, to be rebuilt when next needed.  Lookups which need the
+ * position of a field in D->entry still binary search the list.
+ */
+#define GD_HASH_SEED 2166136261U /* FNV-1a */
+
+static uint32_t _GD_Hash(uint32_t h, const char *s, size_t len)
+{
+  size_t i;
+
+  dtrace("0x%X, %p, %" PRIuSIZE, h, s, len);
+
+  for (i = 0; i < len; ++i)
+    h = (h ^ (unsigned char)s[i]) * 16777619U;
+
+  dreturn("0x%X", h);
+  return h;
+}
+
+#define _GD_HashE(E) _GD_Hash(GD_HASH_SEED, (E)->field, (E)->e->len)
+
+static void _GD_HashPut(gd_entry_t **hash, unsigned int size, gd_entry_t *E)
+{
+  unsigned int i;
+
+  dtrace("%p, %u, %p", hash, size, E);
+
+  i = _GD_HashE(E) & (size - 1);
+  while (hash[i])
+    i = (i + 1) & (size - 1);
+
+  hash[i] = E;
+
+  dreturn("(%u)", i);
+}
+
+/* Discard the hash */
+void _GD_HashClear(DIRFILE *D)
+{
+  dtrace("%p", D);
+
+  free(D->hash);
+  D->hash = NULL;
+  D->hash_size = 0;
+
+  dreturnvoid();
+}
+
+/* Build the hash.  Returns non-zero on error, which isn't reported, since
+ * the caller can fall back on a binary search */
+static int _GD_HashBuild(DIRFILE *D)
+{
+  unsigned int i, size = 64;
+
+  dtrace("%p", D);
+
+  while (size < 2 * D->n_entries + 2 && size < UINT_MAX / 2 + 1)
+    size *= 2;
+
+  D->hash = calloc(size, sizeof(*D->hash));
+  if (D->hash == NULL) {
+    dreturn("%i", 1);
+    return 1;
+  }
+  D->hash_size = size;
+
+  for (i = 0; i < D->n_entries; ++i)
+    _GD_HashPut(D->hash, size, D->entry[i]);
+
+  dreturn("%i", 0);
+  return 0;
+}
+
+/* Add E, which is about to join D->entry, to the hash, if it's built */
+static void _GD_HashAdd(DIRFILE *restrict D, gd_entry_t *restrict E)
+{
+  dtrace("%p, %p", D, E);
+
+  if (D->hash) {
+    if (2 * D->n_entries + 2 > D->hash_size)
+      _GD_HashClear(D); /* rebuilt larger when next needed */
+    else
+      _GD_HashPut(D->hash, D->hash_size, E);
+  }
+
+  dreturnvoid();
+}
+
+/* Remove E from the hash, if it's there */
+void _GD_HashDelete(DIRFILE *restrict D, const gd_entry_t *restrict E)
+{
+  unsigned int i, j, k, mask;
+
+  dtrace("%p, %p", D, E);
+
+  if (D->hash == NULL) {
+    dreturnvoid();
+    return;
+  }
+
+  mask = D->hash_size - 1;
+  for (i = _GD_HashE(E) & mask; D->hash[i] != E; i = (i + 1) & mask)
+    if (D->hash[i] == NULL) {
+      dreturnvoid();
+      return;
+    }
+
+  /* close the gap by moving back later entries of the probe sequence which
+   * hash to a slot at or before it */
+  for (j = (i + 1) & mask; D->hash[j]; j = (j + 1) & mask) {
+    k = _GD_HashE(D->hash[j]) & mask;
+    if ((j > i) ? (k <= i || k > j) : (k <= i && k > j)) {
+      D->hash[i] = D->hash[j];
+      i = j;
+    }
+  }
+  D->hash[i] = NULL;
+
+  dreturnvoid();
+}
+
+/* Look up the field code name, of length len, or, if parent is non-NULL, the
+ * code parent/name, in the hash, building it if necessary.  Returns non-zero
+ * if there's no hash to look in; otherwise, the entry found, or NULL, is
+ * stored in *E.
+ */
+static int _GD_HashFind(const DIRFILE *restrict D, const char *restrict parent,
+    size_t plen, const char *restrict name, size_t len,
+    gd_entry_t **restrict E)
+{
+  uint32_t h = GD_HASH_SEED;
+  unsigned int i, mask;
+  size_t total = len;
+
+  dtrace("%p, %p, %" PRIuSIZE ", \"%s\", %" PRIuSIZE ", %p", D, parent, plen,
+      name, len, E);
+
+  /* the hash is a cache, which doesn't change the dirfile */
+  if (D->hash == NULL && _GD_HashBuild((DIRFILE *)D)) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  if (parent) {
+    h = _GD_Hash(_GD_Hash(h, parent, plen), "/", 1);
+    total += plen + 1;
+  }
+  h = _GD_Hash(h, name, len);
+
+  mask = D->hash_size - 1;
+  for (i = h & mask; D->hash[i]; i = (i + 1) & mask) {
+    const gd_entry_t *C = D->hash[i];
+    if (C->e->len != total)
+      continue;
+    if (parent ? (memcmp(C->field, parent, plen) == 0 && C->field[plen] == '/'
+          && memcmp(C->field + plen + 1, name, len) == 0) :
+        memcmp(C->field, name, len) == 0)
+    {
+      *E = D->hash[i];
+      dreturn("%i (%p)", 0, *E);
+      return 0;
+    }
+  }
+
+  *E = NULL;
+  dreturn("%i (%p)", 0, NULL);
+  return 0;
+}
+
 /* Like _GD_FindField, but look for a subfield code with the parent and
  * subfield names separated.  This is only used when looking for a field code
  * which specified a subfield by alias name.  The plen count includes the / */
-static gd_entry_t *_GD_FindFieldWithParent(const char *restrict parent,
-    size_t plen, const char *restrict name, size_t len, gd_entry_t *const *list,
-    unsigned int u, int dealias, unsigned int *restrict index)
+static gd_entry_t *_GD_FindFieldWithParent(const DIRFILE *restrict D,
+    const char *restrict parent, size_t plen, const char *restrict name,
+    size_t len, gd_entry_t *const *list, unsigned int u, int dealias,
+    unsigned int *restrict index)
 {
   size_t total;
   int c;
   unsigned int i, l = 0;
+  gd_entry_t *E;
 
-  dtrace("\"%s\", %" PRIuSIZE ", \"%s\", %" PRIuSIZE ", %p, %u, %i, %p",
-      parent, plen, name, len, list, u, dealias, index);
+  dtrace("%p, \"%s\", %" PRIuSIZE ", \"%s\", %" PRIuSIZE ", %p, %u, %i, %p",
+      D, parent, plen, name, len, list, u, dealias, index);
 
   /* Drop an initial dot */
   if (parent[0] == '.' && len > 1) {
@@ -171,6 +350,19 @@ static gd_entry_t *_GD_FindFieldWithParent(const char *restrict parent,
 
   total = plen + len + 1;
 
+  if (index == NULL && list == D->entry &&
+      _GD_HashFind(D, parent, plen, name, len, &E) == 0)
+  {
+    if (dealias && E && E->field_type == GD_ALIAS_ENTRY)
+      E = E->e->entry[0];
+
+    dreturn("%p", E);
+    return E;
+  }
+
+  if (list == D->entry && D->unsorted)
+    _GD_SortEntries((DIRFILE *)D);
+
   /* Binary search */
   while (l < u) {
     i = (l + u) / 2;
@@ -181,7 +373,7 @@ static gd_entry_t *_GD_FindFieldWithParent(const char *restrict parent,
     else if (c > 0)
       l = i + 1;
     else {
-      gd_entry_t *E = list[i];
+      E = list[i];
       if (dealias && E && E->field_type == GD_ALIAS_ENTRY)
         E = E->e->entry[0];
 
@@ -201,7 +393,7 @@ static gd_entry_t *_GD_FindFieldWithParent(const char *restrict parent,
 /* Binary search list of length u to find field_code.  len = strlen(field_code).
  * If the field found is an alias, the target will be returned if dealias is
  * non-zero */
-gd_entry_t *_GD_FindField(const DIRFILE *restrict D,
+static gd_entry_t *_GD_FindFieldInList(const DIRFILE *restrict D,
     const char *restrict field_code, size_t len, gd_entry_t *const *list,
     unsigned int u, int dealias, unsigned int *restrict index)
 {
@@ -228,6 +420,26 @@ gd_entry_t *_GD_FindField(const DIRFILE *restrict D,
     len--;
   }
 
+  /* During a bulk addition, the position of a missing field isn't needed,
+   * since new entries are appended to the list */
+  if (list == D->entry && (index == NULL || D->unsorted) &&
+      _GD_HashFind(D, NULL, 0, field_code, len, &E) == 0)
+  {
+    if (E == NULL)
+      l = u; /* skip the binary search */
+    else if (index == NULL) {
+      if (dealias && E->field_type == GD_ALIAS_ENTRY)
+        E = E->e->entry[0];
+
+      dreturn("%p", E);
+      return E;
+    } else
+      E = NULL;
+  }
+
+  if (l < u && list == D->entry && D->unsorted)
+    _GD_SortEntries((DIRFILE *)D);
+
   while (l < u) {
     i = (l + u) / 2;
     c = _GD_strlencmp(field_code, len, list[i]->field, list[i]->e->len);
@@ -253,10 +465,11 @@ gd_entry_t *_GD_FindField(const DIRFILE *restrict D,
 
   /* not found perhaps it's an subfield of an aliased field? */
   if (dealias && (ptr = memchr(field_code, '/', len)) != NULL) {
-    E = _GD_FindField(D, field_code, ptr - field_code, list, ou, 0, NULL);
+    E = _GD_FindFieldInList(D, field_code, ptr - field_code, list, ou, 0,
+        NULL);
 
     if (E && E->field_type == GD_ALIAS_ENTRY && E->e->entry[0])
-      E = _GD_FindFieldWithParent(E->e->entry[0]->field,
+      E = _GD_FindFieldWithParent(D, E->e->entry[0]->field,
           E->e->entry[0]->e->len, ptr + 1, len - (ptr - field_code) - 1, list,
           ou, 1, NULL);
     else
@@ -267,16 +480,74 @@ gd_entry_t *_GD_FindField(const DIRFILE *restrict D,
   return E;
 }
 
-/* Insertion sort the entry list */
+/* As _GD_FindFieldInList.  Additionally, if a field isn't found in the
+ * entry list, and the caller doesn't need its position, try parsing fragments
+ * deferred by GD_LAZY_INCLUDE, which may change D->entry.  If that fails,
+ * D->error is set, and may be set even if the field is then found. */
+gd_entry_t *_GD_FindField(DIRFILE *restrict D,
+    const char *restrict field_code, size_t len, gd_entry_t *const *list,
+    unsigned int u, int dealias, unsigned int *restrict index)
+{
+  gd_entry_t *E;
+
+  dtrace("%p, \"%s\", %" PRIuSIZE ", %p, %u, %i, %p", D, field_code, len, list,
+      u, dealias, index);
+
+  E = _GD_FindFieldInList(D, field_code, len, list, u, dealias, index);
+
+  if (E == NULL && D->n_lazy > 0 && list == D->entry && index == NULL) {
+    if (_GD_ParseLazy(D, field_code, len))
+      E = _GD_FindFieldInList(D, field_code, len, D->entry, D->n_entries,
+          dealias, NULL);
+
+    /* It might be an alias whose target is still missing */
+    if (E == NULL && dealias && D->n_lazy > 0) {
+      E = _GD_FindFieldInList(D, field_code, len, D->entry, D->n_entries, 0,
+          NULL);
+      if (E && E->field_type == GD_ALIAS_ENTRY &&
+          _GD_ParseLazy(D, NULL, 0))
+      {
+        E = _GD_FindFieldInList(D, field_code, len, D->entry, D->n_entries, 1,
+            NULL);
+      } else
+        E = NULL;
+    }
+  }
+
+  dreturn("%p", E);
+  return E;
+}
+
+/* Insertion sort the entry list.  During a bulk addition, the entry is
+ * just appended, and the list sorted by _GD_SortEntries when needed */
 void _GD_InsertSort(DIRFILE *restrict D, gd_entry_t *restrict E, int u)
   gd_nothrow
 {
   dtrace("%p, %p, %i", D, E, u);
 
-  memmove(&D->entry[u + 1], &D->entry[u], sizeof(gd_entry_t*) *
-      (D->n_entries - u));
+  if (D->add_batch) {
+    if ((unsigned int)u < D->n_entries)
+      D->unsorted = 1;
+    u = D->n_entries;
+  } else
+    memmove(&D->entry[u + 1], &D->entry[u], sizeof(gd_entry_t*) *
+        (D->n_entries - u));
 
   D->entry[u] = E;
+  _GD_HashAdd(D, E);
+
+  dreturnvoid();
+}
+
+/* Sort entries appended by a bulk addition into the entry list */
+void _GD_SortEntries(DIRFILE *D) gd_nothrow
+{
+  dtrace("%p", D);
+
+  if (D->unsorted) {
+    qsort(D->entry, D->n_entries, sizeof(gd_entry_t*), _GD_EntryCmp);
+    D->unsorted = 0;
+  }
 
   dreturnvoid();
 }
@@ -342,6 +613,207 @@ static int lutcmp(const void* a, const void* b)
   return (dx < 0) ? -1 : (dx > 0) ? 1 : 0;
 }
 
+/* _GD_ReverseLut: reverse a LUT in place
+*/
+void _GD_ReverseLut(struct gd_lut_ *lut, size_t n)
+{
+  struct gd_lut_ t;
+  size_t i;
+
+  for (i = 0; i < n / 2; ++i) {
+    t = lut[i];
+    lut[i] = lut[n - 1 - i];
+    lut[n - 1 - i] = t;
+  }
+}
+
+/* A LINTERP table, sorted and indexed, is cached in a sidecar of the table
+ * file (see sidecar.c), which later opens map read-only instead of parsing the
+ * table again.  Because the mapping is shared, the pages of a table used by
+ * several dirfiles, or processes, are only in memory once.  After the sidecar
+ * header comes:
+ *
+ *   int64_t  n, complex_table, n_bucket, layout
+ *   double   x0, scale
+ *   struct gd_lut_ lut[n]
+ *   size_t   start[n_bucket + 1] (only if n_bucket > 0)
+ *   double   sx[n - 1], sy[n - 1], slope[n - 1] (only for real tables)
+ *
+ * where layout records the sizes of size_t and struct gd_lut_ on the machine
+ * which wrote it.
+ */
+#define GD_LUT_CACHE_MAGIC "GDLUTC01"
+#define GD_LUT_CACHE_LAYOUT ((int64_t)sizeof(size_t) | \
+    ((int64_t)sizeof(struct gd_lut_) << 8))
+#define GD_LUT_CACHE_HEADER (32 + 48) /* sidecar header + our header */
+
+/* the size of a cache, or zero if the header is invalid */
+static size_t _GD_LutCacheSize(int64_t n, int64_t complex_table,
+    int64_t n_bucket, int64_t layout)
+{
+  if (n < 2 || n > INT_MAX || (complex_table & ~1) ||
+      (n_bucket != 0 && n_bucket != n - 1) || layout != GD_LUT_CACHE_LAYOUT)
+  {
+    return 0;
+  }
+
+  return GD_LUT_CACHE_HEADER + sizeof(struct gd_lut_) * (size_t)n +
+    (n_bucket ? sizeof(size_t) * (size_t)(n_bucket + 1) : 0) +
+    (complex_table ? 0 : sizeof(double) * 3 * (size_t)(n - 1));
+}
+
+/* _GD_LoadLutCache: map the cache of E's table, whose stamp is given.
+ * Returns non-zero if there's no usable cache.
+ */
+static int _GD_LoadLutCache(DIRFILE *restrict D, gd_entry_t *restrict E,
+    const struct gd_stamp_ *restrict stamp)
+{
+#ifdef USE_MMAP
+  struct gd_private_entry_ *e = E->e;
+  gd_stat64_t statbuf;
+  int64_t h[4];
+  double xs[2];
+  size_t len, b;
+  char *base;
+  void *map;
+  int fd;
+
+  dtrace("%p, %p, %p", D, E, stamp);
+
+  fd = _GD_OpenSidecar(D, e->u.linterp.table_dirfd, e->u.linterp.table_file,
+      GD_LUT_CACHE_MAGIC, stamp);
+  if (fd < 0) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  if (_GD_SidecarRead(fd, h, sizeof(h)) || _GD_SidecarRead(fd, xs, sizeof(xs))
+      || (len = _GD_LutCacheSize(h[0], h[1], h[2], h[3])) == 0 ||
+      gd_fstat64(fd, &statbuf) || (uint64_t)statbuf.st_size != len)
+  {
+    close(fd);
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (map == MAP_FAILED) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  base = (char *)map + GD_LUT_CACHE_HEADER;
+  e->u.linterp.lut = (struct gd_lut_ *)base;
+  base += sizeof(struct gd_lut_) * h[0];
+
+  memset(&e->u.linterp.idx, 0, sizeof(e->u.linterp.idx));
+  if (h[2]) {
+    e->u.linterp.idx.n_bucket = (size_t)h[2];
+    e->u.linterp.idx.x0 = xs[0];
+    e->u.linterp.idx.scale = xs[1];
+    e->u.linterp.idx.start = (size_t *)base;
+    base += sizeof(size_t) * (h[2] + 1);
+
+    /* an index out of bounds would be fatal */
+    for (b = 0; b <= (size_t)h[2]; ++b)
+      if (e->u.linterp.idx.start[b] > (size_t)(h[0] - 1) ||
+          (b > 0 && e->u.linterp.idx.start[b] < e->u.linterp.idx.start[b - 1]))
+      {
+        munmap(map, len);
+        e->u.linterp.lut = NULL;
+        memset(&e->u.linterp.idx, 0, sizeof(e->u.linterp.idx));
+        dreturn("%i", 1);
+        return 1;
+      }
+  }
+
+  if (!h[1]) {
+    e->u.linterp.idx.sx = (double *)base;
+    e->u.linterp.idx.sy = e->u.linterp.idx.sx + h[0] - 1;
+    e->u.linterp.idx.slope = e->u.linterp.idx.sy + h[0] - 1;
+  }
+
+  e->u.linterp.map = map;
+  e->u.linterp.map_len = len;
+  e->u.linterp.complex_table = (int)h[1];
+  e->u.linterp.table_monotonic = -1;
+  e->u.linterp.table_len = (int)h[0];
+  D->counter[GD_COUNTER_LUT_CACHE]++;
+
+  dreturn("%i", 0);
+  return 0;
+#else
+  return 1;
+#endif
+}
+
+/* _GD_SaveLutCache: try to cache E's table, whose stamp is given */
+static void _GD_SaveLutCache(DIRFILE *restrict D, gd_entry_t *restrict E,
+    const struct gd_stamp_ *restrict stamp)
+{
+#ifdef USE_MMAP
+  const struct gd_private_entry_ *e = E->e;
+  const struct gd_lutidx_ *idx = &e->u.linterp.idx;
+  const int64_t n = e->u.linterp.table_len;
+  const int64_t h[4] = { n, e->u.linterp.complex_table,
+    (int64_t)idx->n_bucket, GD_LUT_CACHE_LAYOUT };
+  const double xs[2] = { idx->x0, idx->scale };
+  char *tmp;
+  int fd, bad;
+
+  dtrace("%p, %p, %p", D, E, stamp);
+
+  fd = _GD_CreateSidecar(D, e->u.linterp.table_dirfd, e->u.linterp.table_file,
+      GD_LUT_CACHE_MAGIC, stamp, &tmp);
+  if (fd < 0) {
+    dreturnvoid();
+    return;
+  }
+
+  bad = _GD_SidecarWrite(fd, h, sizeof(h)) ||
+    _GD_SidecarWrite(fd, xs, sizeof(xs)) ||
+    _GD_SidecarWrite(fd, e->u.linterp.lut, sizeof(struct gd_lut_) * n);
+
+  if (!bad && idx->n_bucket)
+    bad = _GD_SidecarWrite(fd, idx->start,
+        sizeof(size_t) * (idx->n_bucket + 1));
+
+  /* the segments are contiguous */
+  if (!bad && !e->u.linterp.complex_table)
+    bad = _GD_SidecarWrite(fd, idx->sx, sizeof(double) * 3 * (n - 1));
+
+  _GD_FinishSidecar(D, e->u.linterp.table_dirfd, e->u.linterp.table_file, fd,
+      tmp, bad);
+
+  dreturnvoid();
+#endif
+}
+
+/* _GD_FreeLut: release a LINTERP table read by _GD_ReadLinterpFile
+*/
+void _GD_FreeLut(struct gd_private_entry_ *e)
+{
+  dtrace("%p", e);
+
+#ifdef USE_MMAP
+  if (e->u.linterp.map) {
+    munmap(e->u.linterp.map, e->u.linterp.map_len);
+    memset(&e->u.linterp.idx, 0, sizeof(e->u.linterp.idx));
+  } else
+#endif
+  {
+    free(e->u.linterp.lut);
+    _GD_FreeLutIndex(&e->u.linterp.idx);
+  }
+
+  e->u.linterp.map = NULL;
+  e->u.linterp.lut = NULL;
+
+  dreturnvoid();
+}
+
 /* _GD_ReadLinterpFile: Read in the linterp data for this field
 */
 int _GD_ReadLinterpFile(DIRFILE *restrict D, gd_entry_t *restrict E)
@@ -355,6 +827,8 @@ int _GD_ReadLinterpFile(DIRFILE *restrict D, gd_entry_t *restrict E)
   int linenum = 0;
   double yr, yi;
   int buf_len = GD_LUT_CHUNK;
+  int have_stamp;
+  struct gd_stamp_ stamp;
 
   dtrace("%p, %p", D, E);
 
@@ -372,6 +846,14 @@ int _GD_ReadLinterpFile(DIRFILE *restrict D, gd_entry_t *restrict E)
     return 1;
   }
 
+  /* use the cache, if there's a current one */
+  have_stamp = (_GD_FileStamp(fd, &stamp) == 0);
+  if (have_stamp && _GD_LoadLutCache(D, E, &stamp) == 0) {
+    close(fd);
+    dreturn("%i", 0);
+    return 0;
+  }
+
   fp = fdopen(fd, "rb");
   if (fp == NULL) {
     _GD_SetError(D, GD_E_IO, GD_E_IO_OPEN, E->EN(linterp,table), 0, NULL);
@@ -464,13 +946,25 @@ int _GD_ReadLinterpFile(DIRFILE *restrict D, gd_entry_t *restrict E)
 
   E->e->u.linterp.table_monotonic = -1;
   E->e->u.linterp.lut = ptr;
-  E->e->u.linterp.table_len = i;
 
   /* sort the LUT */
   if (dir == -2)
-    qsort(E->e->u.linterp.lut, i, sizeof(struct gd_lut_), lutcmp);
+    qsort(ptr, i, sizeof(struct gd_lut_), lutcmp);
+  else if (dir == 0)
+    _GD_ReverseLut(ptr, i);
+
+  if (_GD_LutIndex(D, ptr, i, E->e->u.linterp.complex_table,
+        &E->e->u.linterp.idx))
+  {
+    goto LUT_ERROR;
+  }
+
+  E->e->u.linterp.table_len = i;
 
   fclose(fp);
+
+  if (have_stamp)
+    _GD_SaveLutCache(D, E, &stamp);
   dreturn("%i", 0);
   return 0;
 
@@ -483,61 +977,119 @@ LUT_ERROR:
   return 1;
 }
 
-/* _GD_GetIndex: get LUT index.
+/* The bucket of x in the index; this must be monotonic in x */
+static size_t _GD_LutBucket(double x, const struct gd_lutidx_ *idx)
+{
+  double f;
+
+  if (!(x >= idx->x0)) /* includes NaN */
+    return 0;
+
+  f = (x - idx->x0) * idx->scale;
+  return (f < (double)idx->n_bucket) ? (size_t)f : idx->n_bucket - 1;
+}
+
+/* _GD_FreeLutIndex: release a LINTERP lookup index
 */
-static size_t _GD_GetIndex(double x, const struct gd_lut_ *lut, size_t idx,
-    size_t n)
+void _GD_FreeLutIndex(struct gd_lutidx_ *idx)
 {
-  dtrace("%g, %p, %" PRIuSIZE ", %" PRIuSIZE, x, lut, idx, n);
+  dtrace("%p", idx);
+
+  free(idx->start);
+  free(idx->sx);
+  memset(idx, 0, sizeof(*idx));
+
+  dreturnvoid();
+}
+
+/* _GD_LutIndex: build the lookup index of a sorted LUT of length n
+*/
+int _GD_LutIndex(DIRFILE *restrict D, const struct gd_lut_ *restrict lut,
+    size_t n, int complex_table, struct gd_lutidx_ *restrict idx)
+{
+  size_t b, k;
+  const double range = lut[n - 1].x - lut[0].x;
+
+  dtrace("%p, %p, %" PRIuSIZE ", %i, %p", D, lut, n, complex_table, idx);
+
+  memset(idx, 0, sizeof(*idx));
+
+  /* one bucket per segment, unless the range is degenerate (zero or
+   * infinite), in which case lookups binary search the whole table */
+  if (range > 0 && range - range == 0) {
+    idx->n_bucket = n - 1;
+    idx->x0 = lut[0].x;
+    idx->scale = (double)idx->n_bucket / range;
+
+    idx->start = _GD_Malloc(D, sizeof(*idx->start) * (idx->n_bucket + 1));
+    if (idx->start == NULL) {
+      dreturn("%i", 1);
+      return 1;
+    }
 
-  /* Just linearly search - we're probably right to start    */
-  /* increment until we are bigger */
-  while ((idx < n - 2) && (x > lut[idx].x))
-    idx++;
+    for (k = b = 0; b <= idx->n_bucket; ++b) {
+      while (k <= n - 2 && _GD_LutBucket(lut[k].x, idx) < b)
+        k++;
+      idx->start[b] = k;
+    }
+  }
 
-  /* decrement until we are smaller */
-  while ((idx > 0) && (x < lut[idx].x))
-    idx--;
+  if (!complex_table) {
+    idx->sx = _GD_Malloc(D, sizeof(double) * 3 * (n - 1));
+    if (idx->sx == NULL) {
+      _GD_FreeLutIndex(idx);
+      dreturn("%i", 1);
+      return 1;
+    }
+    idx->sy = idx->sx + n - 1;
+    idx->slope = idx->sy + n - 1;
+
+    for (k = 0; k < n - 1; ++k) {
+      idx->sx[k] = lut[k].x;
+      idx->sy[k] = lut[k].y.r;
+      idx->slope[k] = (lut[k + 1].y.r - lut[k].y.r) /
+        (lut[k + 1].x - lut[k].x);
+    }
+  }
 
-  dreturn("%" PRIuSIZE, idx);
-  return idx;
+  dreturn("%i", 0);
+  return 0;
 }
 
-#ifdef GD_NO_C99_API
-#define CLINTERP(t) \
-  do { \
-    for (i = 0; i < npts; i++) { \
-      x = data_in[i]; \
-      idx = _GD_GetIndex(x, lut, idx, n_ln); \
-      ((t *)data)[i] = (t)(lut[idx].y.c[0] + \
-        (lut[idx + 1].y.c[0] - lut[idx].y.c[0]) / \
-        (lut[idx + 1].x - lut[idx].x) * (x - lut[idx].x)); \
-    } \
-  } while (0)
+/* _GD_LutFind: find the segment of a sorted LUT to interpolate x on: the
+ * last k <= n - 2 with lut[k].x <= x, or zero if there isn't one.
+*/
+static size_t _GD_LutFind(double x, const struct gd_lut_ *restrict lut,
+    size_t n, const struct gd_lutidx_ *restrict idx)
+{
+  size_t lo = 0, hi = n - 2, mid;
 
-#define LINTERPC(t) \
-  if (complex_table) CLINTERPC(t); else RLINTERPC(t)
-#else
-#define CLINTERP(t) \
-  do { \
-    for (i = 0; i < npts; i++) { \
-      x = data_in[i]; \
-      idx = _GD_GetIndex(x, lut, idx, n_ln); \
-      ((t *)data)[i] = (t)(lut[idx].y.c + (lut[idx + 1].y.c - lut[idx].y.c) / \
-        (lut[idx + 1].x - lut[idx].x) * (x - lut[idx].x)); \
-    } \
-  } while (0)
+  if (idx->n_bucket) {
+    const size_t b = _GD_LutBucket(x, idx);
+    lo = idx->start[b] ? idx->start[b] - 1 : 0;
+    hi = idx->start[b + 1] ? idx->start[b + 1] - 1 : 0;
+  }
 
-#define LINTERPC(t) LINTERP(_Complex t)
-#endif
+  while (lo < hi) {
+    mid = hi - (hi - lo) / 2;
+    if (lut[mid].x <= x)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
 
-#define RLINTERP(t) \
+  return lo;
+}
+
+#ifdef GD_NO_C99_API
+#define CLINTERP(t) \
   do { \
     for (i = 0; i < npts; i++) { \
       x = data_in[i]; \
-      idx = _GD_GetIndex(x, lut, idx, n_ln); \
-      ((t *)data)[i] = (t)(lut[idx].y.r + (lut[idx + 1].y.r - lut[idx].y.r) / \
-        (lut[idx + 1].x - lut[idx].x) * (x - lut[idx].x)); \
+      k = _GD_LutFind(x, lut, n_ln, idx); \
+      ((t *)data)[i] = (t)(lut[k].y.c[0] + \
+        (lut[k + 1].y.c[0] - lut[k].y.c[0]) / \
+        (lut[k + 1].x - lut[k].x) * (x - lut[k].x)); \
     } \
   } while (0)
 
@@ -546,59 +1098,90 @@ static size_t _GD_GetIndex(double x, const struct gd_lut_ *lut, size_t idx,
     for (i = 0; i < npts; i++) { \
       double tx, dx; \
       x = data_in[i]; \
-      idx = _GD_GetIndex(x, lut, idx, n_ln); \
-      tx = lut[idx + 1].x - lut[idx].x; \
-      dx = x - lut[idx].x; \
-      ((t *)data)[2 * i] = (t)(lut[idx].y.c[0] + \
-        (lut[idx + 1].y.c[0] - lut[idx].y.c[0]) / tx * dx); \
-      ((t *)data)[2 * i + 1] = (t)(lut[idx].y.c[1] + \
-        (lut[idx + 1].y.c[1] - lut[idx].y.c[1]) / tx * dx); \
+      k = _GD_LutFind(x, lut, n_ln, idx); \
+      tx = lut[k + 1].x - lut[k].x; \
+      dx = x - lut[k].x; \
+      ((t *)data)[2 * i] = (t)(lut[k].y.c[0] + \
+        (lut[k + 1].y.c[0] - lut[k].y.c[0]) / tx * dx); \
+      ((t *)data)[2 * i + 1] = (t)(lut[k].y.c[1] + \
+        (lut[k + 1].y.c[1] - lut[k].y.c[1]) / tx * dx); \
     } \
   } while (0)
-
-#define RLINTERPC(t) \
+#else
+#define CLINTERP(t) \
   do { \
     for (i = 0; i < npts; i++) { \
       x = data_in[i]; \
-      idx = _GD_GetIndex(x, lut, idx, n_ln); \
-      ((t *)data)[2 * i] = (t)(lut[idx].y.r + \
-        (lut[idx + 1].y.r - lut[idx].y.r) / \
-        (lut[idx + 1].x - lut[idx].x) * (x - lut[idx].x)); \
-      ((t *)data)[2 * i + 1] = 0; \
+      k = _GD_LutFind(x, lut, n_ln, idx); \
+      ((t *)data)[i] = (t)(lut[k].y.c + (lut[k + 1].y.c - lut[k].y.c) / \
+        (lut[k + 1].x - lut[k].x) * (x - lut[k].x)); \
     } \
   } while (0)
 
-#define LINTERP(t) \
-  if (complex_table) CLINTERP(t); else RLINTERP(t)
+#define CLINTERPC(t) CLINTERP(_Complex t)
+#endif
 
-/* _GD_LinterpData: calibrate data using lookup table lut
+/* _GD_LinterpData: calibrate data using lookup table lut, which must be
+ * sorted, and its index idx.  data and data_in may be the same buffer only if
+ * type is GD_FLOAT64.
 */
 void _GD_LinterpData(DIRFILE *restrict D, void *data, gd_type_t type,
     int complex_table, const double *data_in, size_t npts,
-    const struct gd_lut_ *restrict lut, size_t n_ln)
+    const struct gd_lut_ *restrict lut, size_t n_ln,
+    const struct gd_lutidx_ *restrict idx)
 {
-  int idx = 0;
-  size_t i;
+  size_t i, k;
   double x;
 
-  dtrace("%p, %p, 0x%x, %i, %p, %" PRIuSIZE ", %p, %" PRIuSIZE, D, data, type,
-      complex_table, data_in, npts, lut, n_ln);
+  dtrace("%p, %p, 0x%x, %i, %p, %" PRIuSIZE ", %p, %" PRIuSIZE ", %p", D,
+      data, type, complex_table, data_in, npts, lut, n_ln, idx);
+
+  if (type == GD_NULL) {
+    dreturnvoid();
+    return;
+  }
+
+  if (!complex_table) {
+    /* find the segments a block at a time, then interpolate the block */
+    int32_t seg[GD_LINTERP_BLOCK];
+    double tmp[GD_LINTERP_BLOCK];
+    size_t i0, m;
+
+    for (i0 = 0; i0 < npts; i0 += m) {
+      m = (npts - i0 < GD_LINTERP_BLOCK) ? npts - i0 : GD_LINTERP_BLOCK;
+
+      for (i = 0; i < m; ++i)
+        seg[i] = (int32_t)_GD_LutFind(data_in[i0 + i], lut, n_ln, idx);
+
+      if (type == GD_FLOAT64)
+        _GD_KernelLinterp((double *)data + i0, data_in + i0, seg, m, idx->sx,
+            idx->sy, idx->slope);
+      else {
+        _GD_KernelLinterp(tmp, data_in + i0, seg, m, idx->sx, idx->sy,
+            idx->slope);
+        _GD_ConvertType(D, tmp, GD_FLOAT64, (char *)data + i0 * GD_SIZE(type),
+            type, m);
+      }
+    }
+
+    dreturnvoid();
+    return;
+  }
 
   switch (type) {
-    case GD_NULL:                          break;
-    case GD_INT8:       LINTERP(int8_t  ); break;
-    case GD_UINT8:      LINTERP(uint8_t ); break;
-    case GD_INT16:      LINTERP(int16_t ); break;
-    case GD_UINT16:     LINTERP(uint16_t); break;
-    case GD_INT32:      LINTERP(int32_t ); break;
-    case GD_UINT32:     LINTERP(uint32_t); break;
-    case GD_INT64:      LINTERP(int64_t ); break;
-    case GD_UINT64:     LINTERP(uint64_t); break;
-    case GD_FLOAT32:    LINTERP(float   ); break;
-    case GD_FLOAT64:    LINTERP(double  ); break;
-    case GD_COMPLEX64:  LINTERPC(float  ); break;
-    case GD_COMPLEX128: LINTERPC(double ); break;
-    default:         _GD_InternalError(D); break;
+    case GD_INT8:       CLINTERP(int8_t  ); break;
+    case GD_UINT8:      CLINTERP(uint8_t ); break;
+    case GD_INT16:      CLINTERP(int16_t ); break;
+    case GD_UINT16:     CLINTERP(uint16_t); break;
+    case GD_INT32:      CLINTERP(int32_t ); break;
+    case GD_UINT32:     CLINTERP(uint32_t); break;
+    case GD_INT64:      CLINTERP(int64_t ); break;
+    case GD_UINT64:     CLINTERP(uint64_t); break;
+    case GD_FLOAT32:    CLINTERP(float   ); break;
+    case GD_FLOAT64:    CLINTERP(double  ); break;
+    case GD_COMPLEX64:  CLINTERPC(float  ); break;
+    case GD_COMPLEX128: CLINTERPC(double ); break;
+    default:          _GD_InternalError(D); break;
   }
 
   dreturnvoid();
@@ -701,6 +1284,15 @@ void _GD_LincomData(DIRFILE *restrict D, int n, void *restrict data1,
   dtrace("%p, %i, %p, 0x%x, %p, %p, %p, %p, %p, %" PRIuSIZE, D, n, data1,
       return_type, data2, data3, m, b, spf, n_read);
 
+  /* real-valued inputs which needn't be resampled are vectorised */
+  if (return_type == GD_FLOAT64 && n >= 1 && n <= 3 && (n == 1 ||
+        (spf[1] == spf[0] && (n == 2 || spf[2] == spf[0]))))
+  {
+    _GD_KernelLincom(n, (double *)data1, data2, data3, m, b, n_read);
+    dreturnvoid();
+    return;
+  }
+
   switch(return_type) {
     case GD_NULL:                                 break;
     case GD_UINT8:      LINCOM(uint8_t,  double); break;
@@ -966,7 +1558,8 @@ gd_entry_t *_GD_FindEntry(DIRFILE *restrict D, const char *restrict field_code)
     E = _GD_FindField(D, field_code, strlen(field_code), D->entry, D->n_entries,
         1, NULL);
 
-  if (E == NULL)
+  /* don't hide a parse error */
+  if (E == NULL && !D->error)
     _GD_SetError(D, GD_E_BAD_CODE, GD_E_CODE_MISSING, NULL, 0, field_code);
 
   dreturn("%p", E);
@@ -1010,8 +1603,8 @@ gd_entry_t *_GD_FindFieldAndRepr(DIRFILE *restrict D,
     E = _GD_FindField(D, field_code, old_len, D->entry, D->n_entries, 1, index);
   }
 
-  /* Set error, if requested */
-  if (E == NULL && err)
+  /* Set error, if requested, unless a parse error is already set */
+  if (E == NULL && err && !D->error)
     _GD_SetError(D, GD_E_BAD_CODE, GD_E_CODE_MISSING, NULL, 0, field_code);
 
   dreturn("%p 0x%X", E, *repr);
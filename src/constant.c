@@ -155,6 +155,10 @@ static void _GD_PutCarraySlice(DIRFILE* D, gd_entry_t *E, unsigned long first,
   for (i = 0; i < E->e->u.scalar.n_client; ++i)
     E->e->u.scalar.client[i]->flags &= ~GD_EN_CALC;
 
+  /* the clients' SPFs may have changed */
+  if (E->e->u.scalar.n_client > 0)
+    D->gen++;
+
   /* Clear the client list */
   free(E->e->u.scalar.client);
   E->e->u.scalar.client = NULL;
@@ -451,6 +451,7 @@ static void _GD_Delete(DIRFILE *restrict D, gd_entry_t *restrict E,
    * already modified D->entry, since E is guaranteed to be before the stuff
    * we've already removed */
   D->fragment[E->fragment_index].modified = 1;
+  D->gen++;
   _GD_FreeE(D, E, 1);
 
   memmove(D->entry + index, D->entry + index + 1,
@@ -469,6 +470,9 @@ int gd_delete(DIRFILE *D, const char *field_code, unsigned int flags)
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
   E = _GD_FindField(D, field_code, strlen(field_code), D->entry, D->n_entries,
       0, &index);
 
@@ -75,8 +75,8 @@ struct encoding_t _GD_ef[GD_N_SUBENCODINGS] = {
 #define GD_EF_PROVIDES 0
 #define GD_INT_FUNCS GD_EF_GENERICNOP_SET
 #endif
-  GD_EXT_ENCODING_GENOP(GD_GZIP_ENCODED, ".gz", GD_EF_ECOR | GD_EF_OOP, "Gzip",
-      "gzip"),
+  GD_EXT_ENCODING_GENOP(GD_GZIP_ENCODED, ".gz",
+      GD_EF_ECOR | GD_EF_OOP | GD_EF_APPEND, "Gzip", "gzip"),
 #undef GD_INT_FUNCS
 #undef GD_EF_PROVIDES
 
@@ -93,8 +93,8 @@ struct encoding_t _GD_ef[GD_N_SUBENCODINGS] = {
 #define GD_INT_FUNCS GD_EF_GENERICNOP_SET
 #define GD_EF_PROVIDES 0
 #endif
-  GD_EXT_ENCODING_GENOP(GD_BZIP2_ENCODED, ".bz2", GD_EF_ECOR | GD_EF_OOP,
-      "Bzip2", "bzip2"),
+  GD_EXT_ENCODING_GENOP(GD_BZIP2_ENCODED, ".bz2",
+      GD_EF_ECOR | GD_EF_OOP | GD_EF_APPEND, "Bzip2", "bzip2"),
 #undef GD_INT_FUNCS
 #undef GD_EF_PROVIDES
 
@@ -128,8 +128,8 @@ struct encoding_t _GD_ef[GD_N_SUBENCODINGS] = {
 #define GD_INT_FUNCS GD_EF_GENERIC_SET
 #define GD_EF_PROVIDES 0
 #endif
-  GD_EXT_ENCODING_GEN(GD_LZMA_ENCODED, ".xz", GD_EF_ECOR | GD_EF_OOP, "Lzma",
-      "lzma"),
+  GD_EXT_ENCODING_GEN(GD_LZMA_ENCODED, ".xz",
+      GD_EF_ECOR | GD_EF_OOP | GD_EF_APPEND, "Lzma", "lzma"),
 #undef GD_INT_FUNCS
 #undef GD_EF_PROVIDES
 
@@ -345,6 +345,9 @@ int _GD_MissingFramework(int encoding, unsigned int funcs)
     if (_GD_ef[encoding].provides & GD_EF_SYNC)
       _GD_ef[encoding].sync = (gd_ef_sync_t)_GD_ResolveSymbol(lib,
           _GD_ef + encoding, "Sync");
+    if (_GD_ef[encoding].provides & GD_EF_MOVE)
+      _GD_ef[encoding].move = (gd_ef_move_t)_GD_ResolveSymbol(lib,
+          _GD_ef + encoding, "Move");
     if (_GD_ef[encoding].provides & GD_EF_UNLINK)
       _GD_ef[encoding].unlink = (gd_ef_unlink_t)_GD_ResolveSymbol(lib,
           _GD_ef + encoding, "Unlink");
@@ -366,6 +369,7 @@ int _GD_MissingFramework(int encoding, unsigned int funcs)
     (funcs & GD_EF_SIZE    && _GD_ef[encoding].size    == NULL) ||
     (funcs & GD_EF_WRITE   && _GD_ef[encoding].write   == NULL) ||
     (funcs & GD_EF_SYNC    && _GD_ef[encoding].sync    == NULL) ||
+    (funcs & GD_EF_MOVE    && _GD_ef[encoding].move    == NULL) ||
     (funcs & GD_EF_UNLINK  && _GD_ef[encoding].unlink  == NULL) ||
     (funcs & GD_EF_STRERR  && _GD_ef[encoding].strerr  == NULL);
 
@@ -431,8 +435,12 @@ int _GD_FiniRawIO(DIRFILE *D, const gd_entry_t *E, int fragment, int flags)
   const int old_mode = E->e->u.raw.file[0].mode;
   const int oop_write = ((_GD_ef[E->e->u.raw.file[0].subenc].flags & GD_EF_OOP)
       && (old_mode & GD_FILE_WRITE)) ? 1 : 0;
+  const int append = (oop_write && !clotemp &&
+      (E->e->u.raw.file[1].mode & GD_FILE_APPEND)) ? 1 : 0;
   dtrace("%p, %p, %i, 0x%X", D, E, fragment, flags);
 
+  _GD_WBWait(D, E);
+
   if ((E->e->u.raw.file[clotemp].idata >= 0) ||
       (clotemp == 0 && oop_write && (E->e->u.raw.file[1].idata >= 0)))
   {
@@ -492,6 +500,15 @@ int _GD_FiniRawIO(DIRFILE *D, const gd_entry_t *E, int fragment, int flags)
     }
   }
 
+  /* An append was written in place, so there's nothing to move, or discard:
+   * the data are already in the file.  The read side was closed when the
+   * append started. */
+  if (append) {
+    free(E->e->u.raw.file[1].name);
+    E->e->u.raw.file[1].name = NULL;
+    E->e->u.raw.file[0].mode = 0;
+  }
+
   if (flags & GD_FINIRAW_DEFER) {
     dreturn("%i", 0);
     return 0;
@@ -522,27 +539,96 @@ int _GD_FiniRawIO(DIRFILE *D, const gd_entry_t *E, int fragment, int flags)
     E->e->u.raw.file[1].name = NULL;
   }
 
-  /* Clear atime */
-  E->e->u.raw.atime = 0;
-
-  /* Delete this entry from the opened list if it's there */
-  if (D->open_limit) {
-    long i;
-    
-    for (i = 0; i < D->open_raws; ++i)
-      if (D->opened[i] == E) {
-        memmove(D->opened + i, D->opened + i + 1,
-            sizeof(D->opened[0]) * (D->open_raws - i - 1));
-        D->open_raws--;
-        D->open_fds -= E->e->u.raw.fd_count;
-        break;
-      }
-  }
+  /* Clear atime and delete this entry from the open list if it's there */
+  _GD_LRURemove(D, E);
 
   dreturn("%i", 0);
   return 0;
 }
 
+/* Turn an out-of-place write which hasn't written anything yet into an append,
+ * if it starts at or after the end of the existing data.  The encoding then
+ * writes a new member (or stream) at the end of the data file, instead of us
+ * copying all the existing data into a new file.  On success, the write-side
+ * file is open in GD_FILE_APPEND mode, positioned at the end of the data, and
+ * the read-side file is closed.  If an append isn't possible, nothing
+ * happens.  Returns non-zero on error. */
+int _GD_AppendRawIO(DIRFILE *D, gd_entry_t *E, off64_t offset)
+{
+  struct gd_raw_file_ *file = E->e->u.raw.file;
+  struct gd_raw_file_ app;
+  const struct encoding_t *enc = _GD_ef + file[0].subenc;
+  const int dirfd = D->fragment[E->fragment_index].dirfd;
+  const int swap = _GD_FileSwapBytes(D, E);
+  off64_t n;
+
+  dtrace("%p, %p, %" PRId64, D, E, (int64_t)offset);
+
+  if (!(enc->flags & GD_EF_APPEND) || file[0].idata < 0 || file[1].idata < 0
+      || file[1].pos > 0 || (file[1].mode & GD_FILE_APPEND))
+  {
+    dreturn("%i (no)", 0);
+    return 0;
+  }
+
+  n = (*enc->size)(dirfd, file, E->EN(raw,data_type), swap);
+  if (n <= 0 || offset < n) {
+    dreturn("%i (no)", 0);
+    return 0;
+  }
+
+  /* Open the file for appending before giving up on the out-of-place write.
+   * The encoding refuses if it can't tell exactly how much data there is
+   * already, in which case the size above may have been wrong, too, and the
+   * out-of-place write is the safe thing to do.  Nothing has been written to
+   * the file yet. */
+  memset(&app, 0, sizeof(app));
+  app.idata = -1;
+  app.subenc = file[0].subenc;
+  app.D = D;
+  app.name = _GD_Strdup(D, file[0].name);
+  if (app.name == NULL) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  if ((*enc->open)(dirfd, &app, E->EN(raw,data_type), swap,
+        GD_FILE_WRITE | GD_FILE_APPEND))
+  {
+    free(app.name);
+    dreturn("%i (no)", 0);
+    return 0;
+  }
+
+  /* discard the (empty) temporary file */
+  if ((*enc->close)(file + 1)) {
+    _GD_SetEncIOError(D, GD_E_IO_CLOSE, file + 1);
+  } else if (gd_UnlinkAt(D, dirfd, file[1].name, 0)) {
+    _GD_SetEncIOError(D, GD_E_IO_UNLINK, file + 1);
+  } else {
+    free(file[1].name);
+    file[1].name = NULL;
+
+    /* and the read-side file */
+    if ((*enc->close)(file))
+      _GD_SetEncIOError(D, GD_E_IO_CLOSE, file);
+  }
+
+  if (D->error) {
+    (*enc->close)(&app);
+    free(app.name);
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  /* the field is still open for writing, though */
+  file[0].mode = GD_FILE_RDWR;
+  file[1] = app;
+
+  dreturn("%i (%" PRId64 ")", 0, (int64_t)file[1].pos);
+  return 0;
+}
+
 /* Perform a RAW field write */
 ssize_t _GD_WriteOut(const gd_entry_t *E, const struct encoding_t *enc,
     const void *ptr, gd_type_t type, size_t n, int temp)
@@ -584,19 +670,11 @@ int _GD_InitRawIO(DIRFILE *D, gd_entry_t *E, const char *filebase, int fragment,
   dtrace("%p, %p, \"%s\", %i, %p, 0x%X, 0x%X, %i", D, E, filebase, fragment,
       enc, funcs, mode, swap);
 
+  _GD_WBWait(D, E);
+
   if (mode & (GD_FILE_WRITE | GD_FILE_TOUCH))
     funcs |= GD_EF_WRITE;
 
-	/* If this is a temp file or we're just touching it, we don't register
-	 * it in the open field list, otherwise, try autoclosing first */
-  if (!(mode & (GD_FILE_TEMP | GD_FILE_TOUCH))) {
-    E->e->u.raw.fd_count = 1;
-    if (_GD_AutoClose(D, 1)) {
-      dreturn("%i", 1);
-      return 1;
-    }
-  }
-
   mode &= ~GD_FILE_TOUCH;
 
   if (!(mode & GD_FILE_TEMP)) {
@@ -608,21 +686,13 @@ int _GD_InitRawIO(DIRFILE *D, gd_entry_t *E, const char *filebase, int fragment,
     enc = _GD_ef + E->e->u.raw.file[0].subenc;
     oop_write = ((enc->flags & GD_EF_OOP) && mode == GD_FILE_WRITE) ? 1 : 0;
 
-    /* In this case, we need two free descriptors */
-    if (oop_write) {
-      E->e->u.raw.fd_count = 2;
-      if (_GD_AutoClose(D, 2)) {
-        dreturn("%i", 1);
-        return 1;
-      }
-    }
-
     /* Do nothing, if possible */
     if (!touch && (((mode & GD_FILE_READ) && (E->e->u.raw.file[0].idata >= 0)
             && (E->e->u.raw.file[0].mode & GD_FILE_READ))
           || ((mode & GD_FILE_WRITE) && (E->e->u.raw.file[oop_write].idata >= 0)
             && (E->e->u.raw.file[0].mode & GD_FILE_WRITE))))
     {
+      _GD_LRUTouch(D, E);
       dreturn("%i", 0);
       return 0;
     }
@@ -640,6 +710,20 @@ int _GD_InitRawIO(DIRFILE *D, gd_entry_t *E, const char *filebase, int fragment,
         return 1;
       }
     }
+
+    /* If we're just touching the file, we don't register it in the open
+     * field list, otherwise, try autoclosing first.  If it's still open, take
+     * it off the list while its descriptor count changes, so it isn't closed
+     * out from under us.  An out-of-place write needs two descriptors. */
+    if (!touch || oop_write) {
+      _GD_LRURemove(D, E);
+      E->e->u.raw.fd_count = oop_write ? 2 : 1;
+      if (_GD_AutoClose(D, E->e->u.raw.fd_count)) {
+        dreturn("%i", 1);
+        return 1;
+      }
+    }
+
     if (oop_write)
       E->e->u.raw.file[1].subenc = E->e->u.raw.file[0].subenc;
   }
@@ -698,17 +782,8 @@ int _GD_InitRawIO(DIRFILE *D, gd_entry_t *E, const char *filebase, int fragment,
 
   if (touch)
     _GD_FiniRawIO(D, E, fragment, GD_FINIRAW_KEEP);
-  else {
-    E->e->u.raw.atime = time(NULL);
-    if (D->open_limit > 0 && !(mode & GD_FILE_TEMP)) {
-      /* Add this file to the top of the opened list.  This keeps the list
-       * sorted if it was already */
-      memmove(D->opened + 1, D->opened, sizeof(D->opened[0]) * D->open_raws);
-      D->opened[0] = E;
-      D->open_raws++;
-      D->open_fds += E->e->u.raw.fd_count;
-    }
-  }
+  else /* Add this file to the front of the open list */
+    _GD_LRUPush(D, E);
 
   dreturn("%i", 0);
   return 0;
@@ -775,6 +850,9 @@ int _GD_Supports(DIRFILE *D, const gd_entry_t *E, unsigned int funcs)
 {
   dtrace("%p, %p, 0x%X", D, E, funcs);
 
+  /* Don't touch the file while queued writes to it are pending */
+  _GD_WBWait(D, E);
+
   /* Figure out the dirfile encoding type, if required */
   if (D->fragment[E->fragment_index].encoding == GD_AUTO_ENCODED) {
     D->fragment[E->fragment_index].encoding =
@@ -856,8 +934,6 @@ static void _GD_RecodeFragment(DIRFILE* D, unsigned long encoding, int fragment,
       return;
     }
 
-    /* Because it may fail, the move must occur out-of-place and then be copied
-     * back over the affected files once success is assured */
     for (i = 0; i < D->n_entries; ++i)
       if (D->entry[i]->fragment_index == fragment &&
           D->entry[i]->field_type == GD_RAW_ENTRY)
@@ -867,14 +943,14 @@ static void _GD_RecodeFragment(DIRFILE* D, unsigned long encoding, int fragment,
 
         /* add this raw field to the list */
         raw_entry[n_raw++] = D->entry[i];
-
-        if (_GD_MogrifyFile(D, D->entry[i], encoding,
-              D->fragment[D->entry[i]->fragment_index].byte_sex,
-              D->fragment[D->entry[i]->fragment_index].frame_offset, 0, -1,
-              NULL))
-          break;
       }
 
+    /* Because it may fail, the move must occur out-of-place and then be copied
+     * back over the affected files once success is assured */
+    if (!D->error)
+      n_raw = _GD_MogrifyFields(D, raw_entry, n_raw, encoding,
+          D->fragment[fragment].byte_sex, D->fragment[fragment].frame_offset);
+
     /* If successful, move the temporary file over the old file, otherwise
      * remove the temporary files */
     if (D->error) {
@@ -945,6 +1021,7 @@ static void _GD_RecodeFragment(DIRFILE* D, unsigned long encoding, int fragment,
   D->fragment[fragment].encoding = encoding;
   D->fragment[fragment].modified = 1;
   D->flags &= ~GD_HAVE_VERSION;
+  D->gen++;
 
   dreturnvoid();
 }
@@ -958,6 +1035,9 @@ int gd_alter_encoding(DIRFILE* D, unsigned long encoding, int fragment,
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
   if ((D->flags & GD_ACCMODE) != GD_RDWR)
     _GD_SetError(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
   else if (fragment < GD_ALL_FRAGMENTS || fragment >= D->n_fragment)
@@ -986,6 +1066,8 @@ unsigned long gd_encoding(DIRFILE* D, int fragment) gd_nothrow
 
   GD_RETURN_IF_INVALID(D, "%i", 0);
 
+  _GD_ParseLazyIndex(D, fragment);
+
   if (fragment < 0 || fragment >= D->n_fragment) {
     _GD_SetError(D, GD_E_BAD_INDEX, 0, NULL, 0, NULL);
     dreturn("%i", 0);
@@ -1105,6 +1187,10 @@ int _GD_GenericUnlink(int dirfd, struct gd_raw_file_* file)
 
   r = gd_UnlinkAt(file->D, dirfd, file->name, 0);
 
+  /* any index goes with it */
+  if (r == 0)
+    _GD_UnlinkSidecar(file->D, dirfd, file->name);
+
   dreturn("%i", r);
   return r;
 }
@@ -1121,6 +1207,7 @@ int _GD_GenericMove(int olddirfd, struct gd_raw_file_ *restrict file,
   rename_errno = errno;
 
   if (!r) {
+    _GD_MoveSidecar(file->D, olddirfd, file->name, newdirfd, new_path);
     free(file->name);
     file->name = new_path;
   } else
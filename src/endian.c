@@ -52,8 +52,6 @@ static void _GD_ByteSwapFragment(DIRFILE* D, unsigned long byte_sex,
       return;
     }
 
-    /* Because it may fail, the move must occur out-of-place and then be copied
-     * back over the affected files once success is assured */
     for (i = 0; i < D->n_entries; ++i)
       if (D->entry[i]->fragment_index == fragment &&
           D->entry[i]->field_type == GD_RAW_ENTRY)
@@ -70,14 +68,15 @@ static void _GD_ByteSwapFragment(DIRFILE* D, unsigned long byte_sex,
 
         /* add this raw field to the list */
         raw_entry[n_raw++] = D->entry[i];
-
-        if (_GD_MogrifyFile(D, D->entry[i],
-              D->fragment[D->entry[i]->fragment_index].encoding, byte_sex,
-              D->fragment[D->entry[i]->fragment_index].frame_offset, 0, -1,
-              NULL))
-          break;
       }
 
+    /* Because it may fail, the move must occur out-of-place and then be copied
+     * back over the affected files once success is assured */
+    if (!D->error)
+      n_raw = _GD_MogrifyFields(D, raw_entry, n_raw,
+          D->fragment[fragment].encoding, byte_sex,
+          D->fragment[fragment].frame_offset);
+
     /* If successful, move the temporary file over the old file, otherwise
      * remove the temporary files */
     if (D->error) {
@@ -101,6 +100,7 @@ static void _GD_ByteSwapFragment(DIRFILE* D, unsigned long byte_sex,
   D->fragment[fragment].byte_sex = byte_sex;
   D->fragment[fragment].modified = 1;
   D->flags &= ~GD_HAVE_VERSION;
+  D->gen++;
 
   dreturnvoid();
 }
@@ -114,6 +114,9 @@ int gd_alter_endianness(DIRFILE* D, unsigned long byte_sex, int fragment,
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
   if ((D->flags & GD_ACCMODE) != GD_RDWR) 
     _GD_SetError(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
   else if (fragment < GD_ALL_FRAGMENTS || fragment >= D->n_fragment)
@@ -139,6 +142,8 @@ unsigned long gd_endianness(DIRFILE* D, int fragment) gd_nothrow
 
   GD_RETURN_IF_INVALID(D, "%i", 0);
 
+  _GD_ParseLazyIndex(D, fragment);
+
   if (fragment < 0 || fragment >= D->n_fragment) {
     _GD_SetError(D, GD_E_BAD_INDEX, 0, NULL, 0, NULL);
     dreturn("%i", 0);
@@ -274,7 +279,6 @@ int _GD_FileSwapBytes(const DIRFILE *restrict D, const gd_entry_t *restrict E)
 void _GD_FixEndianness(void* databuffer, size_t ns, gd_type_t type, unsigned
     old_sex, unsigned new_sex)
 {
-  size_t i;
   int endian_fix, arm_fix;
 
   dtrace("%p, %" PRIuSIZE ", 0x%X, 0x%X, 0x%X", databuffer, ns, type, old_sex,
@@ -293,20 +297,7 @@ void _GD_FixEndianness(void* databuffer, size_t ns, gd_type_t type, unsigned
     _GD_ArmEndianise(databuffer, ns);
 
   if (endian_fix)
-    switch (GD_SIZE(type)) {
-      case 2:
-        for (i = 0; i < ns; ++i)
-          ((uint16_t*)databuffer)[i] = gd_swap16(((uint16_t*)databuffer)[i]);
-        break;
-      case 4:
-        for (i = 0; i < ns; ++i)
-          ((uint32_t*)databuffer)[i] = gd_swap32(((uint32_t*)databuffer)[i]);
-        break;
-      case 8:
-        for (i = 0; i < ns; ++i)
-          ((uint64_t*)databuffer)[i] = gd_swap64(((uint64_t*)databuffer)[i]);
-        break;
-    }
+    _GD_KernelSwap(databuffer, ns, GD_SIZE(type));
 
   dreturnvoid();
 }
@@ -62,6 +62,16 @@ void _GD_FreeE(DIRFILE *restrict D, gd_entry_t *restrict entry, int priv)
     return;
   }
 
+  if (priv && entry->e) {
+    _GD_HashDelete(D, entry);
+
+    /* invalidate handles to this entry */
+    if (entry->e->handled)
+      for (i = 0; i < D->n_handle; ++i)
+        if (D->handle[i].E == entry)
+          D->handle[i].E = NULL;
+  }
+
   free_(entry->field);
 
   switch(entry->field_type) {
@@ -84,7 +94,7 @@ void _GD_FreeE(DIRFILE *restrict D, gd_entry_t *restrict entry, int priv)
         if (entry->e->u.linterp.table_dirfd > 0)
           _GD_ReleaseDir(D, entry->e->u.linterp.table_dirfd);
         free(entry->e->u.linterp.table_file);
-        free(entry->e->u.linterp.lut);
+        _GD_FreeLut(entry->e);
       } else
         entry->EN(linterp,table) = NULL;
       break;
@@ -138,6 +148,7 @@ void _GD_FreeE(DIRFILE *restrict D, gd_entry_t *restrict entry, int priv)
     case GD_RAW_ENTRY:
       free_(entry->scalar[0]);
       if (priv) {
+        _GD_WBWait(D, entry);
         free(entry->e->u.raw.filebase);
         free(entry->e->u.raw.file[0].name);
         free(entry->e->u.raw.file[1].name);
@@ -153,6 +164,11 @@ void _GD_FreeE(DIRFILE *restrict D, gd_entry_t *restrict entry, int priv)
       free_(entry->scalar[1]);
       free_(entry->in_fields[0]);
       free_(entry->in_fields[1]);
+      if (priv && entry->e->u.mplex.idx) {
+        free(entry->e->u.mplex.idx->pos);
+        free(entry->e->u.mplex.idx->range);
+        free(entry->e->u.mplex.idx);
+      }
       break;
     case GD_ALIAS_ENTRY:
       free_(entry->in_fields[0]);
@@ -548,7 +564,8 @@ const char *gd_alias_target(DIRFILE *D, const char *field_code) gd_nothrow
       0, NULL);
 
   if (E == NULL) {
-    _GD_SetError(D, GD_E_BAD_CODE, GD_E_CODE_MISSING, NULL, 0, field_code);
+    if (!D->error)
+      _GD_SetError(D, GD_E_BAD_CODE, GD_E_CODE_MISSING, NULL, 0, field_code);
     dreturn("%p", NULL);
     return NULL;
   }
@@ -574,7 +591,11 @@ const char **gd_aliases(DIRFILE *D, const char *field_code) gd_nothrow
 
   E = _GD_FindEntry(D, field_code);
 
-  if (E == NULL) {
+  /* aliases may be defined anywhere */
+  if (E)
+    _GD_ParseLazy(D, NULL, 0);
+
+  if (D->error) {
     dreturn("%p", NULL);
     return NULL;
   }
@@ -625,7 +646,11 @@ unsigned int gd_naliases(DIRFILE *D, const char *field_code) gd_nothrow
 
   E = _GD_FindEntry(D, field_code);
 
-  if (E == NULL) {
+  /* aliases may be defined anywhere */
+  if (E)
+    _GD_ParseLazy(D, NULL, 0);
+
+  if (D->error) {
     dreturn("%u", 0);
     return 0;
   }
@@ -671,9 +696,11 @@ int gd_fragment_index(DIRFILE *D, const char *field_code) gd_nothrow
   E = _GD_FindField(D, field_code, strlen(field_code), D->entry, D->n_entries,
       0, NULL);
 
-  if (E == NULL)
-    GD_SET_RETURN_ERROR(D, GD_E_BAD_CODE, GD_E_CODE_MISSING, NULL, 0,
-        field_code);
+  if (E == NULL) {
+    if (!D->error)
+      _GD_SetError(D, GD_E_BAD_CODE, GD_E_CODE_MISSING, NULL, 0, field_code);
+    GD_RETURN_ERROR(D);
+  }
 
   dreturn("%i", E->fragment_index);
   return E->fragment_index;
@@ -693,9 +720,11 @@ int gd_hide(DIRFILE *D, const char *field_code) gd_nothrow
     E = _GD_FindField(D, field_code, strlen(field_code), D->entry, D->n_entries,
         0, NULL);
 
-    if (E == NULL)
-      _GD_SetError(D, GD_E_BAD_CODE, GD_E_CODE_MISSING, NULL, 0, field_code);
-    else if (D->fragment[E->fragment_index].protection & GD_PROTECT_FORMAT)
+    if (E == NULL) {
+      if (!D->error)
+        _GD_SetError(D, GD_E_BAD_CODE, GD_E_CODE_MISSING, NULL, 0,
+            field_code);
+    } else if (D->fragment[E->fragment_index].protection & GD_PROTECT_FORMAT)
       _GD_SetError(D, GD_E_PROTECTED, GD_E_PROTECTED_FORMAT, NULL, 0,
           D->fragment[E->fragment_index].cname);
     else if (!(E->flags & GD_EN_HIDDEN)) {
@@ -718,9 +747,11 @@ int gd_hidden(DIRFILE *D, const char *field_code) gd_nothrow
   E = _GD_FindField(D, field_code, strlen(field_code), D->entry, D->n_entries,
       0, NULL);
 
-  if (E == NULL)
-    GD_SET_RETURN_ERROR(D, GD_E_BAD_CODE, GD_E_CODE_MISSING, NULL, 0,
-        field_code);
+  if (E == NULL) {
+    if (!D->error)
+      _GD_SetError(D, GD_E_BAD_CODE, GD_E_CODE_MISSING, NULL, 0, field_code);
+    GD_RETURN_ERROR(D);
+  }
 
   dreturn("%i", (E->flags & GD_EN_HIDDEN) ? 1 : 0);
   return (E->flags & GD_EN_HIDDEN) ? 1 : 0;
@@ -740,9 +771,11 @@ int gd_unhide(DIRFILE *D, const char *field_code) gd_nothrow
     E = _GD_FindField(D, field_code, strlen(field_code), D->entry, D->n_entries,
         0, NULL);
 
-    if (E == NULL)
-      _GD_SetError(D, GD_E_BAD_CODE, GD_E_CODE_MISSING, NULL, 0, field_code);
-    else if (D->fragment[E->fragment_index].protection & GD_PROTECT_FORMAT)
+    if (E == NULL) {
+      if (!D->error)
+        _GD_SetError(D, GD_E_BAD_CODE, GD_E_CODE_MISSING, NULL, 0,
+            field_code);
+    } else if (D->fragment[E->fragment_index].protection & GD_PROTECT_FORMAT)
       _GD_SetError(D, GD_E_PROTECTED, GD_E_PROTECTED_FORMAT, NULL, 0,
           D->fragment[E->fragment_index].cname);
     else if (E->flags & GD_EN_HIDDEN) {
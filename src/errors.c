@@ -132,6 +132,8 @@ static const struct {
   /* GD_E_UNSUPPORTED: 4 = regex type */
   { GD_E_UNSUPPORTED, GD_E_SUPPORT_REGEX,
     "Specified regular expression grammar not supported by library: {4}", 0 },
+  { GD_E_UNSUPPORTED, GD_E_SUPPORT_THREADS,
+    "Operation not supported by library: built without threads", 0 },
   { GD_E_UNSUPPORTED, 0, "Operation not supported by current encoding scheme",
     0 },
   /* GD_E_UNKNOWN_ENCODING: (nothing) */
@@ -194,8 +196,12 @@ static const struct {
   { GD_E_ARGUMENT, GD_E_ARG_REGEX, "Bad regular expression: {4}", 0},
   { GD_E_ARGUMENT, GD_E_ARG_PCRE, "Bad regular expression at offset {3}: {4}",
     0},
+  { GD_E_ARGUMENT, GD_E_ARG_COUNTER, "Unknown counter: {3}", 0 },
+  { GD_E_ARGUMENT, GD_E_ARG_HANDLE, "Invalid field handle: {3}", 0 },
   { GD_E_ARGUMENT, 0, "Bad argument", 0 },
   /* GD_E_CALLBACK: 3 = response */
+  { GD_E_CALLBACK, GD_E_CALLBACK_ABORT,
+    "Data conversion cancelled by callback function", 0 },
   { GD_E_CALLBACK, 0, "Unrecognised response from callback function: {3}", 0 },
   /* GD_E_ExISTS: (nothing) */
   { GD_E_EXISTS, 0, "Dirfile exists", 0 },
@@ -213,6 +213,11 @@ static const char **_GD_EntryList(DIRFILE *D, struct gd_private_entry_ *p,
     entry = p->p.meta_entry;
     l = &p->fl;
   } else {
+    if (_GD_ParseLazy(D, NULL, 0) && D->error) {
+      dreturn("%p", NULL);
+      return NULL;
+    }
+    _GD_SortEntries(D);
     nentries = D->n_entries;
     entry = D->entry;
     l = &D->fl;
@@ -336,6 +341,11 @@ static void *_GD_Constants(DIRFILE* D, const char* parent,
     entry = e->p.meta_entry;
     list = &e->fl.const_value_list;
   } else {
+    if (_GD_ParseLazy(D, NULL, 0) && D->error) {
+      dreturn("%p", NULL);
+      return NULL;
+    }
+    _GD_SortEntries(D);
     nentries = D->n_entries;
     entry = D->entry;
     list = &D->fl.const_value_list;
@@ -429,6 +439,11 @@ static gd_carray_t *_GD_Carrays(DIRFILE* D, const char* parent,
     entry = e->p.meta_entry;
     list = &e->fl.carray_value_list;
   } else {
+    if (_GD_ParseLazy(D, NULL, 0) && D->error) {
+      dreturn("%p", NULL);
+      return NULL;
+    }
+    _GD_SortEntries(D);
     nentries = D->n_entries;
     entry = D->entry;
     list = &D->fl.carray_value_list;
@@ -532,6 +547,11 @@ static const char **_GD_Strings(DIRFILE* D, const char* parent) gd_nothrow
     entry = e->p.meta_entry;
     list = &e->fl.string_value_list;
   } else {
+    if (_GD_ParseLazy(D, NULL, 0) && D->error) {
+      dreturn("%p", NULL);
+      return NULL;
+    }
+    _GD_SortEntries(D);
     nentries = D->n_entries;
     entry = D->entry;
     list = &D->fl.string_value_list;
@@ -610,6 +630,11 @@ static const char ***_GD_SArrays(DIRFILE* D, const char* parent) gd_nothrow
     entry = e->p.meta_entry;
     list = &e->fl.sarray_value_list;
   } else {
+    if (_GD_ParseLazy(D, NULL, 0) && D->error) {
+      dreturn("%p", NULL);
+      return NULL;
+    }
+    _GD_SortEntries(D);
     nentries = D->n_entries;
     entry = D->entry;
     list = &D->fl.sarray_value_list;
@@ -925,6 +950,11 @@ unsigned int gd_match_entries(DIRFILE *D, const char *regex, int fragment,
     return 0;
   }
 
+  if (_GD_ParseLazy(D, NULL, 0) && D->error) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
   if (list) {
     D->regex_list = _GD_Malloc(D, sizeof(D->regex_list[0]) * len);
     if (D->regex_list == NULL) {
@@ -958,6 +988,8 @@ unsigned int gd_match_entries(DIRFILE *D, const char *regex, int fragment,
     }
   }
 
+  _GD_SortEntries(D);
+
   /* Regex searches are always performed against the full entry list */
   for (i = n = 0; i < D->n_entries; ++i) {
     if (list && n == len - 1) { /* leave space for the terminating NULL */
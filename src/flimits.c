@@ -43,8 +43,6 @@ static void _GD_ShiftFragment(DIRFILE* D, off64_t offset, int fragment,
       return;
     }
 
-    /* Because it may fail, the move must occur out-of-place and then be copied
-     * back over the affected files once success is assured */
     for (i = 0; i < D->n_entries; ++i)
       if (D->entry[i]->fragment_index == fragment &&
           D->entry[i]->field_type == GD_RAW_ENTRY)
@@ -55,14 +53,15 @@ static void _GD_ShiftFragment(DIRFILE* D, off64_t offset, int fragment,
 
         /* add this raw field to the list */
         raw_entry[n_raw++] = D->entry[i];
-
-        if (_GD_MogrifyFile(D, D->entry[i],
-              D->fragment[D->entry[i]->fragment_index].encoding,
-              D->fragment[D->entry[i]->fragment_index].byte_sex, offset, 0, -1,
-              NULL))
-          break;
       }
 
+    /* Because it may fail, the move must occur out-of-place and then be copied
+     * back over the affected files once success is assured */
+    if (!D->error)
+      n_raw = _GD_MogrifyFields(D, raw_entry, n_raw,
+          D->fragment[fragment].encoding, D->fragment[fragment].byte_sex,
+          offset);
+
     /* If successful, move the temporary file over the old file, otherwise
      * remove the temporary files */
     if (D->error) {
@@ -86,6 +85,7 @@ static void _GD_ShiftFragment(DIRFILE* D, off64_t offset, int fragment,
   D->fragment[fragment].frame_offset = offset;
   D->fragment[fragment].modified = 1;
   D->flags &= ~GD_HAVE_VERSION;
+  D->gen++;
 
   dreturnvoid();
 }
@@ -98,6 +98,9 @@ int gd_alter_frameoffset64(DIRFILE* D, off64_t offset, int fragment, int move)
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
   if ((D->flags & GD_ACCMODE) != GD_RDWR)
     _GD_SetError(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
   else if (fragment < GD_ALL_FRAGMENTS || fragment >= D->n_fragment)
@@ -123,6 +126,8 @@ off64_t gd_frameoffset64(DIRFILE* D, int fragment)
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  _GD_ParseLazyIndex(D, fragment);
+
   if (fragment < 0 || fragment >= D->n_fragment)
     GD_SET_RETURN_ERROR(D, GD_E_BAD_INDEX, 0, NULL, 0, NULL);
 
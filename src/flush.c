@@ -906,6 +906,9 @@ static void _GD_FlushFragment(DIRFILE* D, int i, int permissive)
 
   dtrace("%p, %i, %i", D, i, permissive);
 
+  /* fields are written in order */
+  _GD_SortEntries(D);
+
 #ifdef HAVE_FCHMOD
   /* get the permissions of the old file */
   if (stat(D->fragment[i].cname, &stat_buf))
@@ -1179,7 +1182,7 @@ void _GD_FlushMeta(DIRFILE* D, int fragment, int force)
 
   if (fragment == GD_ALL_FRAGMENTS) {
     for (i = 0; i < D->n_fragment; ++i)
-      if (force || D->fragment[i].modified)
+      if ((force && !D->fragment[i].lazy) || D->fragment[i].modified)
         _GD_FlushFragment(D, i, D->flags & GD_NOSTANDARD);
   } else if (force || D->fragment[fragment].modified)
     _GD_FlushFragment(D, fragment, D->flags & GD_NOSTANDARD);
@@ -1207,6 +1210,9 @@ int gd_rewrite_fragment(DIRFILE* D, int fragment)
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
   if (fragment < GD_ALL_FRAGMENTS || fragment >= D->n_fragment)
     _GD_SetError(D, GD_E_BAD_INDEX, 0, NULL, 0, NULL);
   else if ((D->flags & GD_ACCMODE) == GD_RDONLY)
@@ -1226,8 +1232,18 @@ static int _GD_SyncOrClose(DIRFILE* D, const char* field_code, int syn, int clo)
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  /* Frame writers may queue more writes, so they go first; draining the
+   * write-behind queue reports any errors from the writes it held */
+  if (field_code == NULL)
+    _GD_FlushFrameWriters(D);
+  if (!D->error)
+    _GD_WBDrain(D);
+  if (D->error)
+    GD_RETURN_ERROR(D);
+
   if (field_code == NULL) {
-    _GD_FlushMeta(D, GD_ALL_FRAGMENTS, 0);
+    if (!D->error)
+      _GD_FlushMeta(D, GD_ALL_FRAGMENTS, 0);
     if (!D->error)
       for (i = 0; i < D->n_entries; ++i)
         if (D->entry[i]->field_type == GD_RAW_ENTRY)
@@ -1301,10 +1317,129 @@ int gd_flush(DIRFILE *D, const char *field_code)
 #define GD_VERS_LE_9   0x000003ffUL
 #define GD_VERS_LE_10  0x000007ffUL
 
+/* Restrict av, a set of Standards Versions, to those which can express the
+ * entry E */
+static uint64_t _GD_EntryVersion(const gd_entry_t *E, uint64_t av)
+{
+  const char *ptr;
+
+  dtrace("%p, 0x%04" PRIx64, E, av);
+
+  if (E->flags & GD_EN_HIDDEN)
+    av &= GD_VERS_GE_9;
+  else
+    switch (E->field_type) {
+      case GD_RAW_ENTRY:
+        switch (E->EN(raw,data_type)) {
+          case GD_COMPLEX128:
+          case GD_COMPLEX64:
+            av &= GD_VERS_GE_7;
+            break;
+          case GD_INT8:
+          case GD_INT64:
+          case GD_UINT64:
+            av &= GD_VERS_GE_5;
+            break;
+          default:
+            break;
+        }
+        break;
+      case GD_DIVIDE_ENTRY:
+      case GD_RECIP_ENTRY:
+      case GD_CARRAY_ENTRY:
+        av &= GD_VERS_GE_8;
+        break;
+      case GD_MULTIPLY_ENTRY:
+        av &= GD_VERS_GE_2;
+        break;
+      case GD_PHASE_ENTRY:
+        av &= GD_VERS_GE_4;
+        break;
+      case GD_POLYNOM_ENTRY:
+      case GD_SBIT_ENTRY:
+        av &= GD_VERS_GE_7;
+        break;
+      case GD_CONST_ENTRY:
+        if (E->EN(scalar,const_type) & GD_COMPLEX128)
+          av &= GD_VERS_GE_7;
+        else
+          av &= GD_VERS_GE_6;
+        break;
+      case GD_STRING_ENTRY:
+        av &= GD_VERS_GE_6;
+        break;
+      case GD_SARRAY_ENTRY:
+      case GD_INDIR_ENTRY:
+      case GD_SINDIR_ENTRY:
+        av &= GD_VERS_GE_10;
+        break;
+      case GD_BIT_ENTRY:
+        if (E->EN(bit,numbits) > 1)
+          av &= GD_VERS_GE_1;
+        else if (E->EN(bit,bitnum) + E->EN(bit,numbits)
+            - 1 > 32)
+        {
+          av &= GD_VERS_GE_5;
+        }
+        break;
+      case GD_ALIAS_ENTRY:
+      case GD_WINDOW_ENTRY:
+      case GD_MPLEX_ENTRY:
+        av &= GD_VERS_GE_9;
+        break;
+      case GD_LINTERP_ENTRY:
+      case GD_LINCOM_ENTRY:
+      case GD_INDEX_ENTRY:
+      case GD_NO_ENTRY:
+        break;
+    }
+
+  if (av & GD_VERS_GE_1 && strcmp(E->field, "FRAMEOFFSET") == 0)
+    av &= (GD_VERS_LE_0 | GD_VERS_GE_8);
+  else if (av & GD_VERS_GE_3 && strcmp(E->field, "INCLUDE") == 0)
+    av &= (GD_VERS_LE_2 | GD_VERS_GE_8);
+  else if (av & GD_VERS_GE_5 && (strcmp(E->field, "VERSION") == 0
+        || strcmp(E->field, "ENDIAN") == 0))
+    av &= (GD_VERS_LE_4 | GD_VERS_GE_8);
+  else if (av & GD_VERS_GE_6 &&
+      (strcmp(E->field, "ENCODING") == 0
+       || strcmp(E->field, "META") == 0
+       || strcmp(E->field, "PROTECT") == 0
+       || strcmp(E->field, "REFERENCE") == 0))
+    av &= (GD_VERS_LE_5 | GD_VERS_GE_8);
+  else if (av & GD_VERS_LE_5 && strcmp(E->field, "FILEFRAM") == 0)
+    av &= GD_VERS_GE_6;
+
+  for (ptr = E->field; *ptr != 0 && av; ++ptr)
+    switch(*ptr) {
+      case '/': /* a metafield */
+      case '#':
+      case ' ':
+        av &= GD_VERS_GE_6;
+        break;
+      case '.':
+        if (E->flags & GD_EN_EARLY)
+          av &= GD_VERS_LE_5;
+        else
+          av &= GD_VERS_GE_10;
+        break;
+      case '&':
+      case ';':
+      case '<':
+      case '>':
+      case '\\':
+      case '|':
+        av &= GD_VERS_LE_4;
+        break;
+    }
+
+  dreturn("0x%04" PRIx64, av);
+  return av;
+}
+
 uint64_t _GD_FindVersion(DIRFILE *D)
 {
   unsigned int i;
-  char* ptr;
   dtrace("%p", D);
 
   D->av = (1 << (1 + GD_DIRFILE_STANDARDS_VERSION)) - 1;
@@ -1341,122 +1476,26 @@ uint64_t _GD_FindVersion(DIRFILE *D)
         D->av &= GD_VERS_GE_1;
   }
 
-  for (i = 0; D->av && i < D->n_entries; ++i) {
-    if (D->entry[i]->flags & GD_EN_HIDDEN)
-      D->av &= GD_VERS_GE_9;
-    else
-      switch (D->entry[i]->field_type) {
-        case GD_RAW_ENTRY:
-          switch (D->entry[i]->EN(raw,data_type)) {
-            case GD_COMPLEX128:
-            case GD_COMPLEX64:
-              D->av &= GD_VERS_GE_7;
-              break;
-            case GD_INT8:
-            case GD_INT64:
-            case GD_UINT64:
-              D->av &= GD_VERS_GE_5;
-              break;
-            default:
-              break;
-          }
-          break;
-        case GD_DIVIDE_ENTRY:
-        case GD_RECIP_ENTRY:
-        case GD_CARRAY_ENTRY:
-          D->av &= GD_VERS_GE_8;
-          break;
-        case GD_MULTIPLY_ENTRY:
-          D->av &= GD_VERS_GE_2;
-          break;
-        case GD_PHASE_ENTRY:
-          D->av &= GD_VERS_GE_4;
-          break;
-        case GD_POLYNOM_ENTRY:
-        case GD_SBIT_ENTRY:
-          D->av &= GD_VERS_GE_7;
-          break;
-        case GD_CONST_ENTRY:
-          if (D->entry[i]->EN(scalar,const_type) & GD_COMPLEX128)
-            D->av &= GD_VERS_GE_7;
-          else
-            D->av &= GD_VERS_GE_6;
-          break;
-        case GD_STRING_ENTRY:
-          D->av &= GD_VERS_GE_6;
-          break;
-        case GD_SARRAY_ENTRY:
-        case GD_INDIR_ENTRY:
-        case GD_SINDIR_ENTRY:
-          D->av &= GD_VERS_GE_10;
-          break;
-        case GD_BIT_ENTRY:
-          if (D->entry[i]->EN(bit,numbits) > 1)
-            D->av &= GD_VERS_GE_1;
-          else if (D->entry[i]->EN(bit,bitnum) + D->entry[i]->EN(bit,numbits)
-              - 1 > 32)
-          {
-            D->av &= GD_VERS_GE_5;
-          }
-          break;
-        case GD_ALIAS_ENTRY:
-        case GD_WINDOW_ENTRY:
-        case GD_MPLEX_ENTRY:
-          D->av &= GD_VERS_GE_9;
-          break;
-        case GD_LINTERP_ENTRY:
-        case GD_LINCOM_ENTRY:
-        case GD_INDEX_ENTRY:
-        case GD_NO_ENTRY:
-          break;
-      }
-
-    if (D->av & GD_VERS_GE_1 && strcmp(D->entry[i]->field, "FRAMEOFFSET") == 0)
-      D->av &= (GD_VERS_LE_0 | GD_VERS_GE_8);
-    else if (D->av & GD_VERS_GE_3 && strcmp(D->entry[i]->field, "INCLUDE") == 0)
-      D->av &= (GD_VERS_LE_2 | GD_VERS_GE_8);
-    else if (D->av & GD_VERS_GE_5 && (strcmp(D->entry[i]->field, "VERSION") == 0
-          || strcmp(D->entry[i]->field, "ENDIAN") == 0))
-      D->av &= (GD_VERS_LE_4 | GD_VERS_GE_8);
-    else if (D->av & GD_VERS_GE_6 &&
-        (strcmp(D->entry[i]->field, "ENCODING") == 0
-         || strcmp(D->entry[i]->field, "META") == 0
-         || strcmp(D->entry[i]->field, "PROTECT") == 0
-         || strcmp(D->entry[i]->field, "REFERENCE") == 0))
-      D->av &= (GD_VERS_LE_5 | GD_VERS_GE_8);
-    else if (D->av & GD_VERS_LE_5 &&
-        strcmp(D->entry[i]->field, "FILEFRAM") == 0)
-      D->av &= GD_VERS_GE_6;
-
-    for (ptr = D->entry[i]->field; *ptr != 0 && D->av; ++ptr)
-      switch(*ptr) {
-        case '/': /* a metafield */
-        case '#':
-        case ' ':
-          D->av &= GD_VERS_GE_6;
-          break;
-        case '.':
-          if (D->entry[i]->flags & GD_EN_EARLY)
-            D->av &= GD_VERS_LE_5;
-          else
-            D->av &= GD_VERS_GE_10;
-          break;
-        case '&':
-        case ';':
-        case '<':
-        case '>':
-        case '\\':
-        case '|':
-          D->av &= GD_VERS_LE_4;
-          break;
-      }
-  }
+  for (i = 0; D->av && i < D->n_entries; ++i)
+    D->av = _GD_EntryVersion(D->entry[i], D->av);
 
   D->flags |= GD_HAVE_VERSION;
   dreturn("0x%04" PRIx64, D->av);
   return D->av;
 }
 
+/* Account for a newly added entry in the Standards Versions, if they're known,
+ * which avoids a call to _GD_FindVersion */
+void _GD_UpdateVersion(DIRFILE *restrict D, const gd_entry_t *restrict E)
+{
+  dtrace("%p, %p", D, E);
+
+  if (D->flags & GD_HAVE_VERSION)
+    D->av = _GD_EntryVersion(E, D->av);
+
+  dreturnvoid();
+}
+
 int gd_dirfile_standards(DIRFILE *D, int vers) gd_nothrow
 {
   /* log2(n) lut */
@@ -1492,6 +1531,10 @@ int gd_dirfile_standards(DIRFILE *D, int vers) gd_nothrow
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  /* every fragment counts */
+  if (_GD_ParseLazy(D, NULL, 0) && D->error)
+    GD_RETURN_ERROR(D);
+
   if (~D->flags & GD_HAVE_VERSION)
     _GD_FindVersion(D);
 
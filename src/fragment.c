@@ -26,6 +26,9 @@ const char *gd_fragmentname(DIRFILE* D, int index) gd_nothrow
 
   GD_RETURN_IF_INVALID(D, "%p", NULL);
 
+  if (index >= D->n_fragment)
+    _GD_ParseLazy(D, NULL, 0);
+
   if (index < 0 || index >= D->n_fragment) {
     _GD_SetError(D, GD_E_BAD_INDEX, 0, NULL, index, NULL);
     dreturn("%p", NULL);
@@ -43,6 +46,9 @@ int gd_fragment_affixes(DIRFILE *D, int index, char **px, char **sx) gd_nothrow
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (index >= D->n_fragment)
+    _GD_ParseLazy(D, NULL, 0);
+
   if (index < 0 || index >= D->n_fragment)
     GD_SET_RETURN_ERROR(D, GD_E_BAD_INDEX, 0, NULL, index, NULL);
 
@@ -438,8 +444,10 @@ static int _GD_UpdateAffixes(DIRFILE *D, int index, char *nsin, size_t nsl,
   free(codes);
 
   /* Resort */
-  if (resort)
+  if (resort) {
     qsort(D->entry, D->n_entries, sizeof(gd_entry_t*), _GD_EntryCmp);
+    _GD_HashClear(D);
+  }
 
   /* Kill the trailing '.', if it's present */
   if (nsl)
@@ -540,6 +548,9 @@ int gd_alter_affixes(DIRFILE *D, int index, const char *prefix,
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
   if (index <= 0 || index >= D->n_fragment) 
     GD_SET_RETURN_ERROR(D, GD_E_BAD_INDEX, 0, NULL, index, NULL);
 
@@ -584,6 +595,9 @@ int gd_nfragments(DIRFILE* D) gd_nothrow
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (_GD_ParseLazy(D, NULL, 0) && D->error)
+    GD_RETURN_ERROR(D);
+
   dreturn("%i", D->n_fragment);
   return D->n_fragment;
 }
@@ -594,6 +608,9 @@ int gd_parent_fragment(DIRFILE* D, int fragment_index) gd_nothrow
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (fragment_index >= D->n_fragment)
+    _GD_ParseLazy(D, NULL, 0);
+
   if (fragment_index <= 0 || fragment_index >= D->n_fragment)
     GD_SET_RETURN_ERROR(D, GD_E_BAD_INDEX, 0, NULL, fragment_index, NULL);
 
@@ -612,6 +629,13 @@ const char *gd_fragment_namespace(DIRFILE *D, int index, const char *nsin)
 
   GD_RETURN_IF_INVALID(D, "%p", NULL);
 
+  if (nsin ? _GD_ParseLazyForWrite(D) : index >= D->n_fragment &&
+      _GD_ParseLazy(D, NULL, 0) && D->error)
+  {
+    dreturn("%p", NULL);
+    return NULL;
+  }
+
   /* Modification of the root format file's root namespace is not permitted */
   if (index < 0 || index >= D->n_fragment || (nsin && index == 0)) {
     _GD_SetError(D, GD_E_BAD_INDEX, 0, NULL, index, NULL);
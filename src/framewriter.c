@@ -0,0 +1,330 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Buffered writing of whole frames of many fields; see gd_frame_writer_open */
+#include "internal.h"
+
+static void _GD_FreeFrameWriter(gd_frame_writer_t *W)
+{
+  size_t i;
+
+  dtrace("%p", W);
+
+  if (W->field)
+    for (i = 0; i < W->n_fields; ++i) {
+      free(W->field[i].field_code);
+      free(W->field[i].buffer);
+    }
+
+  free(W->field);
+  free(W);
+
+  dreturnvoid();
+}
+
+/* Write out the buffered frames.  On error, the buffers are kept, along with
+ * how much of each was written, so that trying again carries on where this
+ * stopped, rather than writing anything twice. */
+static int _GD_FlushFrameWriter(gd_frame_writer_t *W)
+{
+  size_t i, ns, n;
+  gd_entry_t *E;
+  struct gd_fw_field_ *f;
+  DIRFILE *const D = W->D;
+
+  dtrace("%p", W);
+
+  if (W->n_frames == 0) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  for (i = 0; i < W->n_fields; ++i) {
+    f = W->field + i;
+    ns = f->spf * W->n_frames;
+
+    if (f->n_done == ns)
+      continue;
+
+    /* Look the field up again, in case the metadata have changed */
+    E = _GD_FindEntry(D, f->field_code);
+
+    if (D->error)
+      break;
+
+    n = _GD_DoFieldOut(D, E, W->here ? GD_HERE : f->s0 + (off64_t)f->n_done,
+        ns - f->n_done, f->type, f->buffer + f->n_done * GD_SIZE(f->type));
+    f->n_done += n;
+
+    if (D->error)
+      break;
+    else if (f->n_done < ns) {
+      _GD_SetError(D, GD_E_IO, GD_E_IO_WRITE, f->field_code, 0, NULL);
+      break;
+    }
+  }
+
+  if (D->error)
+    GD_RETURN_ERROR(D);
+
+  for (i = 0; i < W->n_fields; ++i) {
+    if (!W->here)
+      W->field[i].s0 += W->field[i].n_done;
+    W->field[i].n_done = 0;
+  }
+  W->n_frames = 0;
+
+  dreturn("%i", 0);
+  return 0;
+}
+
+/* Write out the frames buffered by all the dirfile's writers */
+int _GD_FlushFrameWriters(DIRFILE *D)
+{
+  gd_frame_writer_t *W;
+
+  dtrace("%p", D);
+
+  for (W = D->writer; W; W = W->next)
+    if (_GD_FlushFrameWriter(W))
+      break;
+
+  dreturn("%i", D->error);
+  return D->error;
+}
+
+/* Called when the dirfile is freed; the writers themselves are freed by
+ * gd_frame_writer_close */
+void _GD_DetachFrameWriters(DIRFILE *D)
+{
+  gd_frame_writer_t *W, *next;
+
+  dtrace("%p", D);
+
+  for (W = D->writer; W; W = next) {
+    next = W->next;
+    W->D = NULL;
+    W->next = NULL;
+  }
+  D->writer = NULL;
+
+  dreturnvoid();
+}
+
+gd_frame_writer_t *gd_frame_writer_open64(DIRFILE *D, size_t n_fields,
+    const char **field_codes, off64_t first_frame, const gd_type_t *data_types,
+    size_t buffer_frames)
+{
+  size_t i, total = 0;
+  gd_entry_t *E;
+  gd_frame_writer_t *W;
+
+  dtrace("%p, %" PRIuSIZE ", %p, %" PRId64 ", %p, %" PRIuSIZE, D, n_fields,
+      field_codes, (int64_t)first_frame, data_types, buffer_frames);
+
+  GD_RETURN_IF_INVALID(D, "%p", NULL);
+
+  if ((D->flags & GD_ACCMODE) != GD_RDWR) {
+    _GD_SetError(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
+    dreturn("%p", NULL);
+    return NULL;
+  }
+
+  if (first_frame < 0 && first_frame != GD_HERE) {
+    _GD_SetError(D, GD_E_RANGE, GD_E_OUT_OF_RANGE, NULL, 0, NULL);
+    dreturn("%p", NULL);
+    return NULL;
+  }
+
+  W = _GD_Malloc(D, sizeof(*W));
+  if (W == NULL) {
+    dreturn("%p", NULL);
+    return NULL;
+  }
+  memset(W, 0, sizeof(*W));
+
+  W->field = _GD_Malloc(D, sizeof(*W->field) * (n_fields + 1));
+  if (W->field == NULL) {
+    free(W);
+    dreturn("%p", NULL);
+    return NULL;
+  }
+  memset(W->field, 0, sizeof(*W->field) * (n_fields + 1));
+  W->n_fields = n_fields;
+  W->here = (first_frame == GD_HERE);
+
+  for (i = 0; i < n_fields; ++i) {
+    E = _GD_FindEntry(D, field_codes[i]);
+
+    if (E == NULL)
+      break;
+
+    if (E->field_type & GD_SCALAR_ENTRY_BIT) {
+      _GD_SetError(D, GD_E_DIMENSION, GD_E_DIM_CALLER, NULL, 0,
+          field_codes[i]);
+      break;
+    } else if (_GD_BadType(GD_DIRFILE_STANDARDS_VERSION, data_types[i])
+        || data_types[i] == GD_NULL)
+    {
+      _GD_SetError(D, GD_E_BAD_TYPE, 0, NULL, data_types[i], NULL);
+      break;
+    }
+
+    W->field[i].spf = _GD_GetSPF(D, E);
+    if (D->error)
+      break;
+
+    /* don't overflow */
+    if (!W->here && first_frame > GD_INT64_MAX / W->field[i].spf) {
+      _GD_SetError(D, GD_E_RANGE, GD_E_OUT_OF_RANGE, NULL, 0, NULL);
+      break;
+    }
+
+    W->field[i].field_code = _GD_Strdup(D, field_codes[i]);
+    if (W->field[i].field_code == NULL)
+      break;
+
+    W->field[i].type = data_types[i];
+    W->field[i].s0 = W->here ? 0 : first_frame * W->field[i].spf;
+    W->field[i].frame_size = W->field[i].spf * GD_SIZE(data_types[i]);
+    total += W->field[i].frame_size;
+  }
+
+  /* By default, buffer about GD_BUFFER_SIZE bytes in all */
+  if (!D->error) {
+    if (buffer_frames == 0) {
+      buffer_frames = (total > 0) ? GD_BUFFER_SIZE / total : 1;
+      if (buffer_frames == 0)
+        buffer_frames = 1;
+    }
+    W->buffer_frames = buffer_frames;
+
+    for (i = 0; i < n_fields; ++i) {
+      W->field[i].buffer = _GD_Malloc(D, W->field[i].frame_size *
+          buffer_frames);
+      if (W->field[i].buffer == NULL)
+        break;
+    }
+  }
+
+  if (D->error) {
+    _GD_FreeFrameWriter(W);
+    dreturn("%p", NULL);
+    return NULL;
+  }
+
+  W->D = D;
+  W->next = D->writer;
+  D->writer = W;
+
+  dreturn("%p", W);
+  return W;
+}
+
+#if !(defined _FILE_OFFSET_BITS && _FILE_OFFSET_BITS == 64)
+/* 32(ish)-bit wrapper for the 64-bit version, when needed */
+gd_frame_writer_t *gd_frame_writer_open(DIRFILE *D, size_t n_fields,
+    const char **field_codes, off_t first_frame, const gd_type_t *data_types,
+    size_t buffer_frames)
+{
+  return gd_frame_writer_open64(D, n_fields, field_codes, first_frame,
+      data_types, buffer_frames);
+}
+#endif
+
+int gd_write_frame(gd_frame_writer_t *W, const void **data)
+{
+  size_t i;
+  DIRFILE *const D = W->D;
+
+  dtrace("%p, %p", W, data);
+
+  if (D == NULL) {
+    dreturn("%i", GD_E_BAD_DIRFILE);
+    return GD_E_BAD_DIRFILE;
+  }
+
+  _GD_ClearError(D);
+
+  /* the buffers are still full after a failed flush: try again, and if that
+   * fails, this frame can't be taken */
+  if (W->n_frames == W->buffer_frames && _GD_FlushFrameWriter(W))
+    GD_RETURN_ERROR(D);
+
+  for (i = 0; i < W->n_fields; ++i)
+    memcpy(W->field[i].buffer + W->field[i].frame_size * W->n_frames, data[i],
+        W->field[i].frame_size);
+
+  if (++W->n_frames == W->buffer_frames)
+    _GD_FlushFrameWriter(W);
+
+  GD_RETURN_ERROR(D);
+}
+
+int gd_frame_writer_flush(gd_frame_writer_t *W)
+{
+  DIRFILE *const D = W->D;
+
+  dtrace("%p", W);
+
+  if (D == NULL) {
+    dreturn("%i", GD_E_BAD_DIRFILE);
+    return GD_E_BAD_DIRFILE;
+  }
+
+  _GD_ClearError(D);
+
+  _GD_FlushFrameWriter(W);
+
+  GD_RETURN_ERROR(D);
+}
+
+int gd_frame_writer_close(gd_frame_writer_t *W)
+{
+  gd_frame_writer_t **prev;
+  DIRFILE *const D = W->D;
+
+  dtrace("%p", W);
+
+  /* the dirfile has already been closed; everything was flushed then */
+  if (D == NULL) {
+    _GD_FreeFrameWriter(W);
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  _GD_ClearError(D);
+
+  if (_GD_FlushFrameWriter(W))
+    GD_RETURN_ERROR(D);
+
+  for (prev = &D->writer; *prev; prev = &(*prev)->next)
+    if (*prev == W) {
+      *prev = W->next;
+      break;
+    }
+
+  _GD_FreeFrameWriter(W);
+
+  dreturn("%i", 0);
+  return 0;
+}
+/* vim: ts=2 sw=2 et tw=80
+*/
@@ -0,0 +1,137 @@
+/* gd_config.h - Generated by CMake */
+
+#ifndef GD_CONFIG_H
+#define GD_CONFIG_H
+
+/* Package information */
+#define PACKAGE_NAME "GetData"
+#define PACKAGE_VERSION "0.12.0"
+#define PACKAGE_STRING "GetData 0.12.0"
+#define PACKAGE_BUGREPORT "https://github.com/ketiltrout/getdata/issues"
+
+/* Headers */
+/* #undef HAVE_ASM_UNALIGNED_H */
+/* #undef HAVE_AVAILABILITY_H */
+#define HAVE_BYTESWAP_H 1
+#define HAVE_COMPLEX_H 1
+/* #undef HAVE_CRTDEFS_H */
+#define HAVE_CTYPE_H 1
+/* #undef HAVE_DIRECT_H */
+#define HAVE_DIRENT_H 1
+#define HAVE_ERRNO_H 1
+#define HAVE_FCNTL_H 1
+#define HAVE_FEATURES_H 1
+#define HAVE_FLOAT_H 1
+#define HAVE_INTTYPES_H 1
+/* #undef HAVE_IO_H */
+#define HAVE_LIBGEN_H 1
+/* #undef HAVE_LIBKERN_OSBYTEORDER_H */
+#define HAVE_LIMITS_H 1
+#define HAVE_MATH_H 1
+#define HAVE_MEMORY_H 1
+#define HAVE_STDDEF_H 1
+#define HAVE_STDINT_H 1
+#define HAVE_STDLIB_H 1
+#define HAVE_STRING_H 1
+#define HAVE_STRINGS_H 1
+/* #undef HAVE_SYS_ENDIAN_H */
+#define HAVE_SYS_FILE_H 1
+#define HAVE_SYS_MMAN_H 1
+#define HAVE_SYS_PARAM_H 1
+#define HAVE_SYS_STAT_H 1
+#define HAVE_SYS_SYSCALL_H 1
+#define HAVE_SYS_TYPES_H 1
+#define HAVE_TIME_H 1
+#define HAVE_UNISTD_H 1
+
+/* Encoding library headers */
+#define HAVE_BZLIB_H 1
+#define HAVE_ZLIB_H 1
+#define HAVE_LZMA_H 1
+/* #undef HAVE_FLAC_ALL_H */
+/* #undef HAVE_ZZIP_LIB_H */
+
+/* NumPy */
+/* #undef HAVE_NUMPY_ARRAYOBJECT_H */
+
+/* Regex support */
+/* #undef HAVE_PCRE_H */
+#define HAVE_REGEX_H 1
+#define HAVE_REGCOMP 1
+
+/* Functions */
+/* #undef HAVE_BASENAME */
+#define HAVE_CABS 1
+#define HAVE_DIRNAME 1
+#define HAVE_FCHMOD 1
+#define HAVE_FDOPENDIR 1
+#define HAVE_FSEEKO 1
+#define HAVE_FSEEKO64 1
+#define HAVE_FSTATAT 1
+#define HAVE_FSYNC 1
+#define HAVE_FTELLO 1
+#define HAVE_FTELLO64 1
+#define HAVE_FTRUNCATE 1
+#define HAVE_GETCWD 1
+#define HAVE_GMTIME 1
+#define HAVE_GMTIME_R 1
+#define HAVE_ISNAN 1
+#define HAVE_LSEEK64 1
+#define HAVE_LSTAT 1
+#define HAVE_MMAP 1
+#define HAVE_NAN 1
+#define HAVE_OPENAT 1
+#define HAVE_READDIR_R 1
+#define HAVE_READLINK 1
+#define HAVE_REGCOMP 1
+#define HAVE_RENAMEAT 1
+#define HAVE_SNPRINTF 1
+#define HAVE_STRERROR_R 1
+#define HAVE_STRTOLL 1
+#define HAVE_STRTOULL 1
+#define HAVE_SYMLINK 1
+#define HAVE_SYSCALL 1
+#define HAVE_UNLINKAT 1
+/* #undef STRERROR_R_CHAR_P */
+
+/* Libraries */
+/* #undef HAVE_LIBBZ2 */
+/* #undef HAVE_LIBZ */
+/* #undef HAVE_LIBLZMA */
+#define HAVE_LZMA_FILE_INFO_DECODER 1
+#define HAVE_LZMA_STREAM_ENCODER_MT 1
+/* #undef HAVE_LIBFLAC */
+/* #undef HAVE_LIBZZIP */
+
+/* External tools (for tests) */
+#define BZIP2 "/root/miniconda/bin/bzip2"
+/* #undef FLAC */
+#define GZIP "/usr/bin/gzip"
+#define UNZIP "/usr/bin/unzip"
+#define XZ "/root/miniconda/bin/xz"
+#define ZIP "/usr/bin/zip"
+
+/* Type sizes */
+#define SIZEOF_INT 4
+#define SIZEOF_UNSIGNED_INT 4
+#define SIZEOF_SIZE_T 8
+#define SIZEOF_VOID_P 8
+
+/* off64_t support */
+/* #undef HAVE_OFF64_T */
+#define HAVE_LSEEK64 1
+
+/* Version macros */
+#define GETDATA_MAJOR 0
+#define GETDATA_MINOR 12
+#define GETDATA_REVISION 0
+#define GETDATA_VERSION_SUFFIX ""
+
+/* Feature flags */
+#define STDC_HEADERS 1
+#define GD_RESTRICT_ARRAY_OK 1
+
+/* Platform flags */
+#define _POSIX_C_SOURCE 200809L
+
+#endif /* GD_CONFIG_H */
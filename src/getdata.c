@@ -224,6 +224,7 @@ static size_t _GD_DoRaw(DIRFILE *restrict D, gd_entry_t *restrict E, off64_t s0,
   ssize_t samples_read = 0;
   char *databuffer;
   size_t zero_pad = 0;
+  int direct;
 
   dtrace("%p, %p, %" PRId64 ", %" PRIuSIZE ", 0x%X, %p)", D, E, (int64_t)s0, ns,
       return_type, data_out);
@@ -233,10 +234,47 @@ static size_t _GD_DoRaw(DIRFILE *restrict D, gd_entry_t *restrict E, off64_t s0,
     return 0;
   }
 
-  databuffer = _GD_Malloc(D, ns * E->e->u.raw.size);
-  if (databuffer == NULL) {
-    dreturn("%i", 0);
-    return 0;
+  /* serve the read from the shared input cache, if it covers it */
+  if (E->e->u.raw.cache && s0 >= E->e->u.raw.cache_s0 &&
+      (uint64_t)(s0 - E->e->u.raw.cache_s0) <= E->e->u.raw.cache_n)
+  {
+    const size_t off = (size_t)(s0 - E->e->u.raw.cache_s0);
+    const size_t avail = E->e->u.raw.cache_n - off;
+
+    if (avail >= ns || E->e->u.raw.cache_eof) {
+      n_read = (avail < ns) ? avail : ns;
+      _GD_ConvertType(D, (char *)E->e->u.raw.cache + off * E->e->u.raw.size,
+          E->EN(raw,data_type), data_out, return_type, n_read);
+
+      /* the I/O pointer is moved when the cache is dropped */
+      E->e->u.raw.cache_pos = s0 + n_read;
+
+      dreturn("%" PRIuSIZE " (cached)", (D->error == GD_E_OK) ? n_read :
+          (size_t)0);
+      return (D->error == GD_E_OK) ? n_read : (size_t)0;
+    }
+
+    /* this read will leave the I/O pointer in the right place */
+    E->e->u.raw.cache_pos = -1;
+  }
+
+  /* If the caller wants the stored type, or a real type no narrower than it,
+   * the samples can be read straight into data_out and, if necessary, widened
+   * there, without a temporary buffer */
+  direct = (return_type == E->EN(raw,data_type) ||
+      (return_type != GD_NULL && !((return_type | E->EN(raw,data_type)) &
+                                   GD_COMPLEX) &&
+       GD_SIZE(return_type) >= E->e->u.raw.size));
+
+  if (direct) {
+    databuffer = (char *)data_out;
+    D->counter[GD_COUNTER_RAW_DIRECT]++;
+  } else {
+    databuffer = _GD_Malloc(D, ns * E->e->u.raw.size);
+    if (databuffer == NULL) {
+      dreturn("%i", 0);
+      return 0;
+    }
   }
 
   if (s0 < E->EN(raw,spf) * D->fragment[E->fragment_index].frame_offset)
@@ -256,7 +294,8 @@ static size_t _GD_DoRaw(DIRFILE *restrict D, gd_entry_t *restrict E, off64_t s0,
   if (ns > 0 || zero_pad)
     /* This will open the file if it's not open already */
     if (_GD_Seek(D, E, s0, GD_FILE_READ)) {
-      free(databuffer);
+      if (!direct)
+        free(databuffer);
       dreturn("%i", 0);
       return 0;
     }
@@ -268,7 +307,8 @@ static size_t _GD_DoRaw(DIRFILE *restrict D, gd_entry_t *restrict E, off64_t s0,
 
     if (samples_read == -1) {
       _GD_SetEncIOError(D, GD_E_IO_READ, E->e->u.raw.file + 0);
-      free(databuffer);
+      if (!direct)
+        free(databuffer);
       dreturn("%i", 0);
       return 0;
     }
@@ -282,313 +322,123 @@ static size_t _GD_DoRaw(DIRFILE *restrict D, gd_entry_t *restrict E, off64_t s0,
 
   n_read = samples_read + zeroed_samples;
 
-  _GD_ConvertType(D, databuffer, E->EN(raw,data_type), data_out, return_type,
-      n_read);
+  if (direct)
+    _GD_WidenInPlace(databuffer, E->EN(raw,data_type), return_type, n_read);
+  else {
+    _GD_ConvertType(D, databuffer, E->EN(raw,data_type), data_out,
+        return_type, n_read);
 
-  free(databuffer);
+    free(databuffer);
+  }
 
   dreturn("%" PRIuSIZE, (D->error == GD_E_OK) ? n_read : (size_t)0);
   return (D->error == GD_E_OK) ? n_read : (size_t)0;
 }
 
-/* Macros to reduce tangly code */
-#define POLYNOM5(t,npts) \
-  for (i = 0; i < npts; i++) ((t*)data)[i] = (t)( \
-      ((t*)data)[i] * ((t*)data)[i] * ((t*)data)[i] \
-      * ((t*)data)[i] * ((t*)data)[i] * a[5] \
-      + ((t*)data)[i] * ((t*)data)[i] * ((t*)data)[i] * ((t*)data)[i] * a[4] \
-      + ((t*)data)[i] * ((t*)data)[i] * ((t*)data)[i] * a[3] \
-      + ((t*)data)[i] * ((t*)data)[i] * a[2] \
-      + ((t*)data)[i] * a[1] + a[0] \
-      )
-
-#define POLYNOM4(t,npts) \
-  for (i = 0; i < npts; i++) ((t*)data)[i] = (t)( \
-      ((t*)data)[i] * ((t*)data)[i] * ((t*)data)[i] * ((t*)data)[i] * a[4] \
-      + ((t*)data)[i] * ((t*)data)[i] * ((t*)data)[i] * a[3] \
-      + ((t*)data)[i] * ((t*)data)[i] * a[2] \
-      + ((t*)data)[i] * a[1] + a[0] \
-      )
-
-#define POLYNOM3(t,npts) \
-  for (i = 0; i < npts; i++) ((t*)data)[i] = (t)( \
-      ((t*)data)[i] * ((t*)data)[i] * ((t*)data)[i] * a[3] \
-      + ((t*)data)[i] * ((t*)data)[i] * a[2] \
-      + ((t*)data)[i] * a[1] + a[0] \
-      )
-
-#define POLYNOM2(t,npts) \
-  for (i = 0; i < npts; i++) ((t*)data)[i] = (t)( \
-      ((t*)data)[i] * ((t*)data)[i] * a[2] \
-      + ((t*)data)[i] * a[1] + a[0] \
-      )
-
-#ifdef GD_NO_C99_API
-#define POLYNOMC(t) \
-  switch (n) { \
-    case 2: POLYNOMC2(t,npts); break; \
-    case 3: POLYNOMC3(t,npts); break; \
-    case 4: POLYNOMC4(t,npts); break; \
-    case 5: POLYNOMC5(t,npts); break; \
-    default: _GD_InternalError(D); \
-  }
-
-#define POLYNOMC5(t,npts) \
-  do { \
-    for (i = 0; i < npts; i++) { \
-      const double x = ((t*)data)[2 * i]; \
-      const double x2 = x * x; \
-      const double x3 = x2 * x; \
-      const double x4 = x3 * x; \
-      const double x5 = x4 * x; \
-      const double y = ((t*)data)[2 * i + 1]; \
-      const double y2 = y * y; \
-      const double y3 = y2 * y; \
-      const double y4 = y3 * y; \
-      const double y5 = y4 * y; \
-      ((t*)data)[2 * i] = (t)( \
-        a[5] * (x5 - 10 * x3 * y2 + 5 * x * y4) \
-        - a[4] * (x4 - 6 * x2 * y2 + y4) - a[3] * (x3 - 3 * x * y2) \
-        + a[2] * (x2 - y2) + a[1] * x + a[0] \
-        ); \
-      ((t*)data)[2 * i + 1] = (t)( \
-        a[5] * (5 * x4 * y - 10 * x3 * y2 + y5) \
-        + a[4] * (4 * x3 * y - 4 * x * y3) + a[3] * (3 * x2 * y - y3) \
-        + a[2] * 2 * x * y + a[1] * y \
-        ); \
-    } \
-  } while (0)
-
-#define POLYNOMC4(t,npts) \
-  do { \
-    for (i = 0; i < npts; i++) { \
-      const double x = ((t*)data)[2 * i]; \
-      const double x2 = x * x; \
-      const double x3 = x2 * x; \
-      const double x4 = x3 * x; \
-      const double y = ((t*)data)[2 * i + 1]; \
-      const double y2 = y * y; \
-      const double y3 = y2 * y; \
-      const double y4 = y3 * y; \
-      ((t*)data)[2 * i] = (t)( \
-        a[4] * (x4 - 6 * x2 * y2 + y4) + a[3] * (x3 - 3 * x * y2) \
-        + a[2] * (x2 - y2) + a[1] * x + a[0] \
-        ); \
-      ((t*)data)[2 * i + 1] = (t)( \
-        a[4] * (4 * x3 * y - 4 * x * y3) + a[3] * (3 * x2 * y - y3) \
-        + a[2] * 2 * x * y + a[1] * y \
-        ); \
-    } \
-  } while (0)
-
-#define POLYNOMC3(t,npts) \
+/* Macros to reduce tangly code.  Polynomials are evaluated by Horner's method:
+ * a[n] x**n + ... + a[1] x + a[0] = (...((a[n] x + a[n-1]) x + ...) x + a[0]
+ */
+#define POLYNOM(t) \
   do { \
     for (i = 0; i < npts; i++) { \
-      const double x = ((t*)data)[2 * i]; \
-      const double x2 = x * x; \
-      const double x3 = x2 * x; \
-      const double y = ((t*)data)[2 * i + 1]; \
-      const double y2 = y * y; \
-      const double y3 = y2 * y; \
-      ((t*)data)[2 * i] = (t)( \
-        a[3] * (x3 - 3 * x * y2) + a[2] * (x2 - y2) + a[1] * x + a[0] \
-        ); \
-      ((t*)data)[2 * i + 1] = (t)( \
-        a[3] * (3 * x2 * y - y3) + a[2] * 2 * x * y + a[1] * y \
-        ); \
+      const double x = (double)((t*)data)[i]; \
+      double y = a[n]; \
+      for (k = n; k-- > 0; ) \
+        y = y * x + a[k]; \
+      ((t*)data)[i] = (t)y; \
     } \
   } while (0)
 
-#define POLYNOMC2(t,npts) \
+/* complex data are stored as (real, imaginary) pairs, regardless of whether
+ * we have C99 complex types, and the arithmetic is done by hand.  The
+ * coefficients are complex (a[k] = ca[2k] + i ca[2k+1]), or, with ca = NULL,
+ * real */
+#define POLYNOMC(t) \
   do { \
     for (i = 0; i < npts; i++) { \
       const double x = ((t*)data)[2 * i]; \
-      const double x2 = x * x; \
       const double y = ((t*)data)[2 * i + 1]; \
-      const double y2 = y * y; \
-      ((t*)data)[2 * i] = (t)(a[2] * (x2 - y2) + a[1] * x + a[0]); \
-      ((t*)data)[2 * i + 1] = (t)(a[2] * 2 * x * y + a[1] * y); \
+      double zr, zi, tr; \
+      if (ca) { \
+        zr = ca[2 * n]; \
+        zi = ca[2 * n + 1]; \
+        for (k = n; k-- > 0; ) { \
+          tr = zr * x - zi * y + ca[2 * k]; \
+          zi = zr * y + zi * x + ca[2 * k + 1]; \
+          zr = tr; \
+        } \
+      } else { \
+        zr = a[n]; \
+        zi = 0; \
+        for (k = n; k-- > 0; ) { \
+          tr = zr * x - zi * y + a[k]; \
+          zi = zr * y + zi * x; \
+          zr = tr; \
+        } \
+      } \
+      ((t*)data)[2 * i] = (t)zr; \
+      ((t*)data)[2 * i + 1] = (t)zi; \
     } \
   } while (0)
-#else
-#define POLYNOMC(t) POLYNOM(_Complex t)
-#endif
-
-#define POLYNOM(t) \
-  switch (n) { \
-    case 2: POLYNOM2(t,npts); break; \
-    case 3: POLYNOM3(t,npts); break; \
-    case 4: POLYNOM4(t,npts); break; \
-    case 5: POLYNOM5(t,npts); break; \
-    default: _GD_InternalError(D); \
-  }
 
 /* _GD_PolynomData: Compute data = Sum(i=0..n; data**i * a[i]), for scalar a,
- * and integer 2 <= n < GD_MAX_POLYORD
+ * and integer 1 <= n < GD_MAX_POLYORD
  */
 static void _GD_PolynomData(DIRFILE *restrict D, void *restrict data,
     gd_type_t type, size_t npts, int n, const double *restrict a)
 {
   size_t i;
+  int k;
+  const double *ca = NULL;
 
   dtrace("%p, %p, 0x%X, %" PRIuSIZE ", %i, %p", D, data, type, npts, n, a);
 
-  if (n == 1) {
-    /* no need to duplicate this case */
-    _GD_LincomData(D, 1, data, type, NULL, NULL, a + 1, a, NULL, npts);
-  } else {
-    switch (type) {
-      case GD_NULL:                          break;
-      case GD_INT8:       POLYNOM(  int8_t); break;
-      case GD_UINT8:      POLYNOM( uint8_t); break;
-      case GD_INT16:      POLYNOM( int16_t); break;
-      case GD_UINT16:     POLYNOM(uint16_t); break;
-      case GD_INT32:      POLYNOM( int32_t); break;
-      case GD_UINT32:     POLYNOM(uint32_t); break;
-      case GD_INT64:      POLYNOM( int64_t); break;
-      case GD_UINT64:     POLYNOM(uint64_t); break;
-      case GD_FLOAT32:    POLYNOM(   float); break;
-      case GD_FLOAT64:    POLYNOM(  double); break;
-      case GD_COMPLEX64:  POLYNOMC(  float); break;
-      case GD_COMPLEX128: POLYNOMC( double); break;
-      default:         _GD_InternalError(D); break;
-    }
+  /* floating point data are vectorised */
+  if ((type == GD_FLOAT64 || type == GD_FLOAT32) &&
+      _GD_KernelPolynom(n, a, data, type, data, type, npts))
+  {
+    dreturnvoid();
+    return;
+  }
+
+  switch (type) {
+    case GD_NULL:                          break;
+    case GD_INT8:       POLYNOM(  int8_t); break;
+    case GD_UINT8:      POLYNOM( uint8_t); break;
+    case GD_INT16:      POLYNOM( int16_t); break;
+    case GD_UINT16:     POLYNOM(uint16_t); break;
+    case GD_INT32:      POLYNOM( int32_t); break;
+    case GD_UINT32:     POLYNOM(uint32_t); break;
+    case GD_INT64:      POLYNOM( int64_t); break;
+    case GD_UINT64:     POLYNOM(uint64_t); break;
+    case GD_FLOAT32:    POLYNOM(   float); break;
+    case GD_FLOAT64:    POLYNOM(  double); break;
+    case GD_COMPLEX64:  POLYNOMC(  float); break;
+    case GD_COMPLEX128: POLYNOMC( double); break;
+    default:         _GD_InternalError(D); break;
   }
 
   dreturnvoid();
 }
 
-#ifdef GD_NO_C99_API
-#undef POLYNOMC5
-#undef POLYNOMC4
-#undef POLYNOMC3
-#undef POLYNOMC2
-#undef POLYNOMC1
-
-#define POLYNOMC5(t,npts) \
-  do { \
-    for (i = 0; i < npts; i++) { \
-      const double x = ((t*)data)[2 * i]; \
-      const double x2 = x * x; \
-      const double x3 = x2 * x; \
-      const double x4 = x3 * x; \
-      const double x5 = x4 * x; \
-      const double y = ((t*)data)[2 * i + 1]; \
-      const double y2 = y * y; \
-      const double y3 = y2 * y; \
-      const double y4 = y3 * y; \
-      const double y5 = y4 * y; \
-      ((t*)data)[2 * i] = (t)( \
-        a[5][0] * (x5 - 10 * x3 * y2 + 5 * x * y4) - \
-        a[5][1] * (5 * x4 * y - 10 * x3 * y2 + y5) + \
-        a[4][0] * (x4 - 6 * x2 * y2 + y4) - \
-        a[4][1] * (4 * x3 * y - 4 * x * y3) + \
-        a[3][0] * (x3 - 3 * x * y2) - a[3][1] * (3 * x2 * y - y3) + \
-        a[2][0] * (x2 - y2) - a[2][1] * 2 * x * y + \
-        a[1][0] * x - a[1][1] * y + a[0][0] \
-        ); \
-      ((t*)data)[2 * i + 1] = (t)( \
-        a[5][1] * (x5 - 10 * x3 * y2 + 5 * x * y4) + \
-        a[5][0] * (5 * x4 * y - 10 * x3 * y2 + y5) + \
-        a[4][1] * (x4 - 6 * x2 * y2 + y4) + \
-        a[4][0] * (4 * x3 * y - 4 * x * y3) + \
-        a[3][1] * (x3 - 3 * x * y2) + a[3][0] * (3 * x2 * y - y3) + \
-        a[2][1] * (x2 - y2) + a[2][0] * 2 * x * y + \
-        a[1][1] * x + a[1][0] * y + a[0][1] \
-        ); \
-    } \
-  } while (0)
-
-#define POLYNOMC4(t,npts) \
-  do { \
-    for (i = 0; i < npts; i++) { \
-      const double x = ((t*)data)[2 * i]; \
-      const double x2 = x * x; \
-      const double x3 = x2 * x; \
-      const double x4 = x3 * x; \
-      const double y = ((t*)data)[2 * i + 1]; \
-      const double y2 = y * y; \
-      const double y3 = y2 * y; \
-      const double y4 = y3 * y; \
-      ((t*)data)[2 * i] = (t)( \
-        a[4][0] * (x4 - 6 * x2 * y2 + y4) - \
-        a[4][1] * (4 * x3 * y - 4 * x * y3) + \
-        a[3][0] * (x3 - 3 * x * y2) - a[3][1] * (3 * x2 * y - y3) + \
-        a[2][0] * (x2 - y2) - a[2][1] * 2 * x * y + \
-        a[1][0] * x - a[1][1] * y + a[0][0] \
-        ); \
-      ((t*)data)[2 * i + 1] = (t)( \
-        a[4][1] * (x4 - 6 * x2 * y2 + y4) + \
-        a[4][0] * (4 * x3 * y - 4 * x * y3) + \
-        a[3][1] * (x3 - 3 * x * y2) + a[3][0] * (3 * x2 * y - y3) + \
-        a[2][1] * (x2 - y2) + a[2][0] * 2 * x * y + \
-        a[1][1] * x + a[1][0] * y + a[0][1] \
-        ); \
-    } \
-  } while (0)
-
-#define POLYNOMC3(t,npts) \
-  do { \
-    for (i = 0; i < npts; i++) { \
-      const double x = ((t*)data)[2 * i]; \
-      const double x2 = x * x; \
-      const double x3 = x2 * x; \
-      const double y = ((t*)data)[2 * i + 1]; \
-      const double y2 = y * y; \
-      const double y3 = y2 * y; \
-      ((t*)data)[2 * i] = (t)( \
-        a[3][0] * (x3 - 3 * x * y2) - a[3][1] * (3 * x2 * y - y3) + \
-        a[2][0] * (x2 - y2) - a[2][1] * 2 * x * y + \
-        a[1][0] * x - a[1][1] * y + a[0][0] \
-        ); \
-      ((t*)data)[2 * i + 1] = (t)( \
-        a[3][1] * (x3 - 3 * x * y2) + a[3][0] * (3 * x2 * y - y3) + \
-        a[2][1] * (x2 - y2) + a[2][0] * 2 * x * y + \
-        a[1][1] * x + a[1][0] * y + a[0][1] \
-        ); \
-    } \
-  } while (0)
-
-#define POLYNOMC2(t,npts) \
-  do { \
-    for (i = 0; i < npts; i++) { \
-      const double x = ((t*)data)[2 * i]; \
-      const double x2 = x * x; \
-      const double y = ((t*)data)[2 * i + 1]; \
-      const double y2 = y * y; \
-      ((t*)data)[2 * i] = (t)( \
-        a[2][0] * (x2 - y2) - a[2][1] * 2 * x * y + \
-        a[1][0] * x - a[1][1] * y + a[0][0] \
-        ); \
-      ((t*)data)[2 * i + 1] = (t)( \
-        a[2][1] * (x2 - y2) + a[2][0] * 2 * x * y + \
-        a[1][1] * x + a[1][0] * y + a[0][1] \
-        ); \
-    } \
-  } while (0)
-#endif
-
-
 /* _GD_CPolynomData: Compute data = Sum(i=0..n; data**i * a[i]), for complex
- * scalar a, and integer 2 <= n < GD_MAX_POLYORD
+ * scalar a, and integer 1 <= n < GD_MAX_POLYORD
  */
 static void _GD_CPolynomData(DIRFILE *restrict D, void *restrict data,
     gd_type_t type, size_t npts, int n, GD_DCOMPLEXV(a))
 {
   size_t i;
+  int k;
+  /* either way, a is laid out as (real, imaginary) pairs */
+  const double *ca = (const double *)a;
 
   dtrace("%p, %p, 0x%X, %" PRIuSIZE ", %i, %p", D, data, type, npts, n, a);
 
-  if (n == 1) {
-    /* no need to duplicate this case */
-    _GD_CLincomData(D, 1, data, type, NULL, NULL, a + 1, a, NULL, npts);
-  } else {
-    switch (type) {
-      case GD_NULL:                          break;
-      case GD_COMPLEX64:  POLYNOMC(  float); break;
-      case GD_COMPLEX128: POLYNOMC( double); break;
-      default:         _GD_InternalError(D); break;
-    }
+  switch (type) {
+    case GD_NULL:                          break;
+    case GD_COMPLEX64:  POLYNOMC(  float); break;
+    case GD_COMPLEX128: POLYNOMC( double); break;
+    default:         _GD_InternalError(D); break;
   }
 
   dreturnvoid();
@@ -1229,6 +1079,31 @@ static size_t _GD_DoDivide(DIRFILE *restrict D, gd_entry_t *restrict E,
   return n_read;
 }
 
+/* _GD_BitWidth: The width, in bytes, at which bits can be extracted from E's
+ * input: that of the input's native type, if that is an integer type wide
+ * enough to contain all the bits of E, or else 8.  The type the input should
+ * be read as is stored in in_type.
+ */
+static int _GD_BitWidth(DIRFILE *restrict D, gd_entry_t *restrict E,
+    gd_type_t *restrict in_type)
+{
+  int size = 8;
+
+  dtrace("%p, %p, %p", D, E, in_type);
+
+  *in_type = _GD_NativeType(D, E->e->entry[0], E->e->repr[0]);
+
+  if (!D->error && !(*in_type & (GD_IEEE754 | GD_COMPLEX)) &&
+      E->EN(bit,bitnum) + E->EN(bit,numbits) <= 8 * (int)GD_SIZE(*in_type))
+  {
+    size = GD_SIZE(*in_type);
+  } else
+    *in_type = (E->field_type == GD_SBIT_ENTRY) ? GD_INT64 : GD_UINT64;
+
+  dreturn("%i", size);
+  return size;
+}
+
 /* _GD_DoBit:  Read from a bitfield.  Returns number of samples read.
  *             This is used by both BIT and SBIT (is_signed distinguishes)
  */
@@ -1237,46 +1112,55 @@ static size_t _GD_DoBit(DIRFILE *restrict D, gd_entry_t *restrict E,
     void *restrict data_out)
 {
   void *tmpbuf;
-  size_t i;
   size_t n_read;
-  const uint64_t mask = (E->EN(bit,numbits) == 64) ? 0xffffffffffffffffULL :
-    ((uint64_t)1 << E->EN(bit,numbits)) - 1;
+  int size;
+  gd_type_t in_type, bit_type;
 
   dtrace("%p, %p, %i, %" PRId64 ", %" PRIuSIZE ", 0x%X, %p", D, E, is_signed,
       (int64_t)first_samp, num_samp, return_type, data_out);
 
-  if (is_signed)
-    tmpbuf = _GD_Malloc(D, num_samp * sizeof(int64_t));
-  else
-    tmpbuf = _GD_Malloc(D, num_samp * sizeof(uint64_t));
-  if (tmpbuf == NULL) {
+  /* A narrow integer input is read as it is, and its bits extracted at that
+   * width, rather than widening every sample to 64 bits.  The extracted bits
+   * fit in an integer of the same width, of the signedness of the field */
+  size = _GD_BitWidth(D, E, &in_type);
+  if (D->error) {
     dreturn("%i", 0);
     return 0;
   }
+  bit_type = (gd_type_t)size | (is_signed ? GD_SIGNED : 0);
+
+  /* if it's wide enough, the caller's buffer is used as-is */
+  if (!(return_type & GD_COMPLEX) && GD_SIZE(return_type) >= (size_t)size)
+    tmpbuf = data_out;
+  else {
+    tmpbuf = _GD_Malloc(D, num_samp * size);
+    if (tmpbuf == NULL) {
+      dreturn("%i", 0);
+      return 0;
+    }
+  }
 
   n_read = _GD_DoField(D, E->e->entry[0], E->e->repr[0], first_samp, num_samp,
-      (is_signed) ? GD_INT64 : GD_UINT64, tmpbuf);
+      in_type, tmpbuf);
 
-  if (D->error != GD_E_OK) {
-    free(tmpbuf);
+  if (D->error) {
+    if (tmpbuf != data_out)
+      free(tmpbuf);
     dreturn("%i", 0);
     return 0;
   }
 
   /* extract bits */
-  if (is_signed) {
-    uint64_t sign = 0xFFFFFFFFFFFFFFFFLLU << (E->EN(bit,numbits) - 1);
-    for (i = 0; i < n_read; i++)
-      ((int64_t *)tmpbuf)[i] =
-        (((((uint64_t *)tmpbuf)[i] >> E->EN(bit,bitnum)) & mask) + sign) ^ sign;
-  } else
-    for (i = 0; i < n_read; i++)
-      ((uint64_t *)tmpbuf)[i] = (((uint64_t *)tmpbuf)[i] >> E->EN(bit,bitnum))
-        & mask;
+  _GD_KernelBits(tmpbuf, n_read, size, E->EN(bit,bitnum), E->EN(bit,numbits),
+      is_signed);
 
-  _GD_ConvertType(D, tmpbuf, (is_signed) ? GD_INT64 : GD_UINT64, data_out,
-      return_type, n_read);
-  free(tmpbuf);
+  if (tmpbuf == data_out) {
+    if (_GD_WidenInPlace(data_out, bit_type, return_type, n_read))
+      _GD_InternalError(D);
+  } else {
+    _GD_ConvertType(D, tmpbuf, bit_type, data_out, return_type, n_read);
+    free(tmpbuf);
+  }
 
   dreturn("%" PRIuSIZE, n_read);
   return n_read;
@@ -1331,7 +1215,8 @@ static size_t _GD_DoLinterp(DIRFILE *restrict D, gd_entry_t *restrict E,
   }
 
   _GD_LinterpData(D, data_out, return_type, E->e->u.linterp.complex_table,
-      data_in, n_read, E->e->u.linterp.lut, E->e->u.linterp.table_len);
+      data_in, n_read, E->e->u.linterp.lut, E->e->u.linterp.table_len,
+      &E->e->u.linterp.idx);
 
   free(data_in);
   dreturn("%" PRIuSIZE, n_read);
@@ -1345,13 +1230,32 @@ static size_t _GD_DoPolynom(DIRFILE *restrict D, gd_entry_t *restrict E,
     void *restrict data_out)
 {
   size_t n_read;
+  gd_type_t in_type = return_type;
 
   dtrace("%p, %p, %" PRId64 ", %" PRIuSIZE ", 0x%X, %p", D, E,
       (int64_t)first_samp, num_samp, return_type, data_out);
 
+  /* For a floating point result, a narrower real input is read as it is, and
+   * converted as part of the evaluation of the polynomial, rather than in a
+   * pass of its own.  Narrower types convert exactly, so the result is the
+   * same either way. */
+  if ((return_type == GD_FLOAT64 || return_type == GD_FLOAT32) &&
+      !(E->flags & GD_EN_COMPSCAL))
+  {
+    in_type = _GD_NativeType(D, E->e->entry[0], E->e->repr[0]);
+
+    if (D->error != GD_E_OK) {
+      dreturn("%i", 0);
+      return 0;
+    }
+
+    if (in_type & GD_COMPLEX || GD_SIZE(in_type) >= GD_SIZE(return_type))
+      in_type = return_type;
+  }
+
   /* read the input field */
   n_read = _GD_DoField(D, E->e->entry[0], E->e->repr[0], first_samp, num_samp,
-      return_type, data_out);
+      in_type, data_out);
 
   if (D->error != GD_E_OK) {
     dreturn("%i", 0);
@@ -1367,9 +1271,18 @@ static size_t _GD_DoPolynom(DIRFILE *restrict D, gd_entry_t *restrict E,
   if (E->flags & GD_EN_COMPSCAL)
     _GD_CPolynomData(D, data_out, return_type, n_read, E->EN(polynom,poly_ord),
         E->EN(polynom,ca));
-  else
+  else if (in_type == return_type)
     _GD_PolynomData(D, data_out, return_type, n_read, E->EN(polynom,poly_ord),
         E->EN(polynom,a));
+  else if (!_GD_KernelPolynom(E->EN(polynom,poly_ord), E->EN(polynom,a),
+        data_out, in_type, data_out, return_type, n_read))
+  {
+    if (_GD_WidenInPlace(data_out, in_type, return_type, n_read))
+      _GD_InternalError(D);
+    else
+      _GD_PolynomData(D, data_out, return_type, n_read,
+          E->EN(polynom,poly_ord), E->EN(polynom,a));
+  }
 
   dreturn("%" PRIuSIZE, n_read);
   return n_read;
@@ -1469,6 +1382,186 @@ static size_t _GD_DoWindow(DIRFILE *restrict D, gd_entry_t *restrict E,
   return n_read;
 }
 
+/* _GD_MplexIndex: return the count value index of an MPLEX, discarding it if
+ * the metadata or the data have changed since it was built.  Returns NULL if
+ * there isn't one and one can't be allocated, which isn't an error.
+ */
+static struct gd_mplex_idx_ *_GD_MplexIndex(const DIRFILE *restrict D,
+    gd_entry_t *restrict E)
+{
+  struct gd_mplex_idx_ *idx = E->e->u.mplex.idx;
+
+  dtrace("%p, %p", D, E);
+
+  if (idx == NULL) {
+    idx = E->e->u.mplex.idx = malloc(sizeof(*idx));
+    if (idx == NULL) {
+      dreturn("%p", NULL);
+      return NULL;
+    }
+    memset(idx, 0, sizeof(*idx));
+  } else if (idx->gen != D->gen || idx->data_gen != D->data_gen) {
+    idx->n_pos = idx->n_range = 0;
+  }
+
+  idx->gen = D->gen;
+  idx->data_gen = D->data_gen;
+
+  dreturn("%p (%" PRIuSIZE ", %" PRIuSIZE ")", idx, idx->n_pos, idx->n_range);
+  return idx;
+}
+
+/* the number of elements of the sorted list v of length n less than x */
+static size_t _GD_MplexBelow(const off64_t *v, size_t n, off64_t x)
+{
+  size_t lo = 0, hi = n;
+
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (v[mid] < x)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+/* the number of ranges in the sorted list v of length n whose start (k = 0) or
+ * end (k = 1) is less than x */
+static size_t _GD_MplexRangesBelow(const off64_t (*v)[2], size_t n, int k,
+    off64_t x)
+{
+  size_t lo = 0, hi = n;
+
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (v[mid][k] < x)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+/* _GD_MplexIndexAdd: add n samples of the count field, starting at s0, to the
+ * count value index.  On allocation failure, the index is just left as it
+ * was.
+ */
+static void _GD_MplexIndexAdd(struct gd_mplex_idx_ *idx, off64_t s0,
+    const int *buf, size_t n, int count_val)
+{
+  size_t i, m = 0, lo, hi, r0, r1;
+  off64_t a = s0, b = s0 + n;
+
+  dtrace("%p, %" PRId64 ", %p, %" PRIuSIZE ", %i", idx, (int64_t)s0, buf, n,
+      count_val);
+
+  if (n == 0) {
+    dreturn("%s", "");
+    return;
+  }
+
+  for (i = 0; i < n; ++i)
+    if (buf[i] == count_val)
+      m++;
+
+  /* the old positions in [a, b) are replaced by the new ones */
+  lo = _GD_MplexBelow(idx->pos, idx->n_pos, a);
+  hi = _GD_MplexBelow(idx->pos, idx->n_pos, b);
+
+  if (idx->n_pos - (hi - lo) + m > idx->pos_size) {
+    size_t size = idx->pos_size ? idx->pos_size : 64;
+    off64_t *ptr;
+
+    while (size < idx->n_pos - (hi - lo) + m)
+      size *= 2;
+
+    ptr = realloc(idx->pos, sizeof(*ptr) * size);
+    if (ptr == NULL) {
+      dreturn("%s", "");
+      return;
+    }
+    idx->pos = ptr;
+    idx->pos_size = size;
+  }
+
+  /* make sure the range can be recorded before changing anything */
+  if (idx->n_range == idx->range_size) {
+    size_t size = idx->range_size ? idx->range_size * 2 : 16;
+    off64_t (*ptr)[2] = realloc(idx->range, sizeof(*ptr) * size);
+    if (ptr == NULL) {
+      dreturn("%s", "");
+      return;
+    }
+    idx->range = ptr;
+    idx->range_size = size;
+  }
+
+  if (idx->n_pos > hi)
+    memmove(idx->pos + lo + m, idx->pos + hi,
+        sizeof(*idx->pos) * (idx->n_pos - hi));
+  idx->n_pos += m - (hi - lo);
+  for (i = 0; i < n; ++i)
+    if (buf[i] == count_val)
+      idx->pos[lo++] = s0 + i;
+
+  /* merge [a, b) with the ranges it overlaps or abuts */
+  r0 = _GD_MplexRangesBelow((const off64_t (*)[2])idx->range, idx->n_range, 1,
+      a);
+  for (r1 = r0; r1 < idx->n_range && idx->range[r1][0] <= b; ++r1) {
+    if (idx->range[r1][0] < a)
+      a = idx->range[r1][0];
+    if (idx->range[r1][1] > b)
+      b = idx->range[r1][1];
+  }
+
+  if (r1 == r0) {
+    memmove(idx->range + r0 + 1, idx->range + r0,
+        sizeof(*idx->range) * (idx->n_range - r0));
+    idx->n_range++;
+  } else {
+    memmove(idx->range + r0 + 1, idx->range + r1,
+        sizeof(*idx->range) * (idx->n_range - r1));
+    idx->n_range -= r1 - r0 - 1;
+  }
+  idx->range[r0][0] = a;
+  idx->range[r0][1] = b;
+
+  dreturn("(%" PRIuSIZE ", %" PRIuSIZE ")", idx->n_pos, idx->n_range);
+}
+
+/* _GD_MplexIndexFind: look in the count value index for the last count value
+ * before sample s of the count field.  If it's known, it's stored in *found.
+ * Otherwise, returns the sample before which the count field still needs to be
+ * searched, which is s, unless the samples just before s have already been
+ * searched.
+ */
+static off64_t _GD_MplexIndexFind(const struct gd_mplex_idx_ *idx, off64_t s,
+    off64_t *found)
+{
+  size_t r, p;
+
+  dtrace("%p, %" PRId64 ", %p", idx, (int64_t)s, found);
+
+  /* the last range starting before s */
+  r = _GD_MplexRangesBelow((const off64_t (*)[2])idx->range, idx->n_range, 0,
+      s);
+
+  if (r > 0 && idx->range[r - 1][1] >= s) {
+    /* [range start, s) has been searched */
+    p = _GD_MplexBelow(idx->pos, idx->n_pos, s);
+    if (p > 0 && idx->pos[p - 1] >= idx->range[r - 1][0])
+      *found = idx->pos[p - 1];
+    else
+      s = idx->range[r - 1][0];
+  }
+
+  dreturn("%" PRId64 " (%" PRId64 ")", (int64_t)s, (int64_t)*found);
+  return s;
+}
+
 /* _GD_DoMplex:  Read from an mplex.  Returns number of samples read.
 */
 static size_t _GD_DoMplex(DIRFILE *restrict D, gd_entry_t *restrict E,
@@ -1481,6 +1574,7 @@ static size_t _GD_DoMplex(DIRFILE *restrict D, gd_entry_t *restrict E,
   size_t n_read, n_read2, num_samp2;
   const size_t size = GD_SIZE(return_type);
   off64_t first_samp2;
+  struct gd_mplex_idx_ *idx;
 
   dtrace("%p, %p, %" PRId64 ", %" PRIuSIZE ", 0x%X, %p", D, E,
       (int64_t)first_samp, num_samp, return_type, data_out);
@@ -1543,15 +1637,24 @@ static size_t _GD_DoMplex(DIRFILE *restrict D, gd_entry_t *restrict E,
     return 0;
   }
 
+  /* record where the count value occurs */
+  idx = _GD_MplexIndex(D, E);
+  if (idx)
+    _GD_MplexIndexAdd(idx, first_samp2, tmpbuf, n_read2,
+        E->EN(mplex,count_val));
+
   /* Check whether we've saved the last sample */
   if (return_type == E->e->u.mplex.type && first_samp == E->e->u.mplex.sample)
     memcpy(start, E->e->u.mplex.d, size);
   /* Otherwise, check whether the caller was lucky/clever */
   else if (tmpbuf[0] != E->EN(mplex,count_val) && D->lookback) {
-    /* It wasn't -- do a look-back to find the start value.  On a, say, gzipped
-     * field this is expensive since it involves a rewind.  Hmm... */
+    /* It wasn't -- do a look-back to find the start value.  The part of the
+     * count field already read is looked up in the index; the rest has to be
+     * read backwards, which, on a, say, gzipped field, is expensive since it
+     * involves a rewind. */
     size_t lb_cycle = E->EN(mplex,period);
     off64_t chunk_start = first_samp2, lb_start, lb_sample = -1;
+    int moved2 = 0;
 
     /* if period is zero, use a period of GD_MPLEX_CYCLE or
      * 2 * count_val + 1, whichever is larger */
@@ -1569,9 +1672,18 @@ static size_t _GD_DoMplex(DIRFILE *restrict D, gd_entry_t *restrict E,
 
     /* stop if we're at the start of the lookback or we found the value */
     while (lb_sample == -1 && chunk_start > lb_start) {
-      /* the size of the next chunk */
-      size_t i, n_read3, chunk_size = chunk_start - lb_start;
+      size_t i, n_read3, chunk_size;
       int *tmpbuf2;
+
+      /* skip what's already been searched */
+      if (idx) {
+        chunk_start = _GD_MplexIndexFind(idx, chunk_start, &lb_sample);
+        if (lb_sample != -1 || chunk_start <= lb_start)
+          break;
+      }
+
+      /* the size of the next chunk */
+      chunk_size = chunk_start - lb_start;
       if (chunk_size > GD_BUFFER_SIZE)
         chunk_size = GD_BUFFER_SIZE;
 
@@ -1587,6 +1699,7 @@ static size_t _GD_DoMplex(DIRFILE *restrict D, gd_entry_t *restrict E,
 
       n_read3 = _GD_DoField(D, E->e->entry[1], E->e->repr[1], chunk_start,
           chunk_size, GD_INT_TYPE, tmpbuf2);
+      moved2 = 1;
 
       if (D->error) {
         free(tmpbuf2);
@@ -1595,6 +1708,10 @@ static size_t _GD_DoMplex(DIRFILE *restrict D, gd_entry_t *restrict E,
         return 0;
       }
 
+      if (idx)
+        _GD_MplexIndexAdd(idx, chunk_start, tmpbuf2, n_read3,
+            E->EN(mplex,count_val));
+
       /* find the sample */
       i = n_read3 - 1;
       do {
@@ -1606,6 +1723,10 @@ static size_t _GD_DoMplex(DIRFILE *restrict D, gd_entry_t *restrict E,
       free(tmpbuf2);
     }
 
+    /* the index may know of a value before the start of the lookback */
+    if (lb_sample < lb_start)
+      lb_sample = -1;
+
     /* read the value of the start, if found */
     if (lb_sample >= 0) {
       _GD_DoField(D, E->e->entry[0], E->e->repr[0], lb_sample * spf1 / spf2, 1,
@@ -1619,8 +1740,10 @@ static size_t _GD_DoMplex(DIRFILE *restrict D, gd_entry_t *restrict E,
     }
 
     /* now go and put the I/O pointers back where they belong, sigh */
-    _GD_Seek(D, E->e->entry[0], first_samp + n_read, GD_SEEK_SET);
-    _GD_Seek(D, E->e->entry[1], first_samp2 + n_read2, GD_SEEK_SET);
+    if (lb_sample >= 0)
+      _GD_Seek(D, E->e->entry[0], first_samp + n_read, GD_SEEK_SET);
+    if (moved2)
+      _GD_Seek(D, E->e->entry[1], first_samp2 + n_read2, GD_SEEK_SET);
   }
 
   if (n_read2 > 0 && n_read2 * spf1 < n_read * spf2)
@@ -1746,20 +1869,15 @@ static size_t _GD_DoIndir(DIRFILE *restrict D, const gd_entry_t *restrict E,
   return n_read;
 }
 
-/* _GD_DoField: Locate the field in the database and read it.
-*/
-size_t _GD_DoField(DIRFILE *restrict D, gd_entry_t *restrict E, int repr,
-    off64_t first_samp, size_t num_samp, gd_type_t return_type,
-    void *restrict data_out)
+/* _GD_Blockable: Returns non-zero if every node in the input tree of E can be
+ * evaluated block by block with results identical to a single-pass read.
+ * MPLEX keeps per-read look-back state, so trees containing one are excluded.
+ */
+static int _GD_Blockable(DIRFILE *restrict D, gd_entry_t *restrict E)
 {
-  size_t n_read = 0;
-  gd_type_t ntype;
-  void *true_data_out = data_out;
-  const gd_type_t true_return_type = return_type;
-  int out_of_place = 0;
+  int i, n = 0, ok = 1;
 
-  dtrace("%p, %p(%s), %i, %" PRId64 ", %" PRIuSIZE ", 0x%X, %p", D, E, E->field,
-      repr, (int64_t)first_samp, num_samp, return_type, data_out);
+  dtrace("%p, %p", D, E);
 
   if (++D->recurse_level >= GD_MAX_RECURSE_LEVEL) {
     _GD_SetError(D, GD_E_RECURSE_LEVEL, GD_E_RECURSE_CODE, NULL, 0, E->field);
@@ -1768,23 +1886,170 @@ size_t _GD_DoField(DIRFILE *restrict D, gd_entry_t *restrict E, int repr,
     return 0;
   }
 
-  if (!(E->flags & GD_EN_CALC)) {
-    _GD_CalculateEntry(D, E, 1);
-
-    if (D->error) {
-      D->recurse_level--;
-      dreturn("%i", 0);
-      return 0;
-    }
+  switch (E->field_type) {
+    case GD_RAW_ENTRY:
+    case GD_INDEX_ENTRY:
+    case GD_CONST_ENTRY:
+    case GD_CARRAY_ENTRY:
+      break;
+    case GD_LINCOM_ENTRY:
+      n = E->EN(lincom,n_fields);
+      break;
+    case GD_MULTIPLY_ENTRY:
+    case GD_DIVIDE_ENTRY:
+    case GD_WINDOW_ENTRY:
+    case GD_INDIR_ENTRY:
+      n = 2;
+      break;
+    case GD_LINTERP_ENTRY:
+    case GD_BIT_ENTRY:
+    case GD_SBIT_ENTRY:
+    case GD_PHASE_ENTRY:
+    case GD_POLYNOM_ENTRY:
+    case GD_RECIP_ENTRY:
+      n = 1;
+      break;
+    case GD_MPLEX_ENTRY:
+    case GD_SINDIR_ENTRY:
+    case GD_STRING_ENTRY:
+    case GD_SARRAY_ENTRY:
+    case GD_ALIAS_ENTRY:
+    case GD_NO_ENTRY:
+      ok = 0;
+      break;
   }
 
-  /* calculate the native type */
-  ntype = _GD_NativeType(D, E, GD_REPR_NONE);
+  if (n > 0 && _GD_FindInputs(D, E, 1))
+    ok = 0;
 
-  if (D->error) {
-    D->recurse_level--;
-    dreturn("%i", 0);
-    return 0;
+  for (i = 0; ok && i < n; ++i)
+    ok = _GD_Blockable(D, E->e->entry[i]);
+
+  D->recurse_level--;
+  dreturn("%i", ok);
+  return ok;
+}
+
+/* _GD_EvalPlan: Returns the number of samples per block to use when
+ * evaluating the derived field E, or zero if E should be read in a single
+ * pass.  Blocks are a whole number of frames long, so that the sample offset
+ * of every block maps exactly onto the inputs, whatever their SPF.  The
+ * result is cached in E->e until the dirfile metadata next changes.
+ */
+static size_t _GD_EvalPlan(DIRFILE *restrict D, gd_entry_t *restrict E)
+{
+  unsigned int spf;
+  size_t block = 0;
+
+  dtrace("%p, %p", D, E);
+
+  if (E->e->plan_gen == D->gen) {
+    dreturn("%" PRIuSIZE " (cached)", E->e->plan_block);
+    return E->e->plan_block;
+  }
+
+  if (E->field_type != GD_RAW_ENTRY && E->field_type != GD_INDEX_ENTRY &&
+      ~E->field_type & GD_SCALAR_ENTRY_BIT && _GD_Blockable(D, E))
+  {
+    spf = _GD_GetSPF(D, E);
+    if (D->error) {
+      dreturn("%i", 0);
+      return 0;
+    }
+
+    if (spf > 0)
+      block = ((GD_EVAL_BLOCK + spf - 1) / spf) * spf;
+  }
+
+  if (D->error) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  E->e->plan_gen = D->gen;
+  E->e->plan_block = block;
+
+  dreturn("%" PRIuSIZE, block);
+  return block;
+}
+
+/* _GD_DoFieldBlocked: Read num_samp samples of E in blocks of block samples.
+ * All the temporary buffers needed by the input tree are then only block
+ * samples long, and are reused while still in cache, instead of each node
+ * making a full-length pass over memory.  Returns number of samples read.
+ */
+static size_t _GD_DoFieldBlocked(DIRFILE *restrict D, gd_entry_t *restrict E,
+    int repr, off64_t first_samp, size_t num_samp, size_t block,
+    gd_type_t return_type, void *restrict data_out)
+{
+  size_t n, n_read = 0;
+  const size_t size = GD_SIZE(return_type);
+
+  dtrace("%p, %p, %i, %" PRId64 ", %" PRIuSIZE ", %" PRIuSIZE ", 0x%X, %p", D,
+      E, repr, (int64_t)first_samp, num_samp, block, return_type, data_out);
+
+  while (n_read < num_samp) {
+    const size_t want = (num_samp - n_read > block) ? block :
+      num_samp - n_read;
+
+    n = _GD_DoField(D, E, repr, first_samp + n_read, want, return_type,
+        (data_out == NULL) ? NULL : (char *)data_out + size * n_read);
+
+    if (D->error) {
+      dreturn("%i", 0);
+      return 0;
+    }
+
+    n_read += n;
+
+    /* short read: we've hit the end of an input */
+    if (n < want)
+      break;
+  }
+
+  dreturn("%" PRIuSIZE, n_read);
+  return n_read;
+}
+
+/* _GD_DoField: Locate the field in the database and read it.
+*/
+size_t _GD_DoField(DIRFILE *restrict D, gd_entry_t *restrict E, int repr,
+    off64_t first_samp, size_t num_samp, gd_type_t return_type,
+    void *restrict data_out)
+{
+  size_t n_read = 0;
+  gd_type_t ntype;
+  void *true_data_out = data_out;
+  const gd_type_t true_return_type = return_type;
+  int out_of_place = 0;
+
+  dtrace("%p, %p(%s), %i, %" PRId64 ", %" PRIuSIZE ", 0x%X, %p", D, E, E->field,
+      repr, (int64_t)first_samp, num_samp, return_type, data_out);
+
+  if (++D->recurse_level >= GD_MAX_RECURSE_LEVEL) {
+    _GD_SetError(D, GD_E_RECURSE_LEVEL, GD_E_RECURSE_CODE, NULL, 0, E->field);
+    D->recurse_level--;
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  if (!(E->flags & GD_EN_CALC)) {
+    _GD_CalculateEntry(D, E, 1);
+
+    if (D->error) {
+      D->recurse_level--;
+      dreturn("%i", 0);
+      return 0;
+    }
+  }
+
+  /* calculate the native type */
+  ntype = _GD_NativeType(D, E, GD_REPR_NONE);
+
+  if (D->error) {
+    D->recurse_level--;
+    dreturn("%i", 0);
+    return 0;
   }
 
   if (first_samp == GD_HERE) {
@@ -1803,10 +2068,30 @@ size_t _GD_DoField(DIRFILE *restrict D, gd_entry_t *restrict E, int repr,
     num_samp = GD_TRANSACTION_MAX(ntype);
   if (first_samp > (int64_t)(GD_INT64_MAX - num_samp)) {
     _GD_SetError(D, GD_E_RANGE, GD_E_OUT_OF_RANGE, NULL, 0, NULL);
+    D->recurse_level--;
     dreturn("%i", 0);
     return 0;
   }
 
+  /* break up large top-level reads of derived fields into blocks */
+  if (D->recurse_level == 1 && num_samp > GD_EVAL_BLOCK) {
+    size_t block = _GD_EvalPlan(D, E);
+
+    if (D->error) {
+      D->recurse_level--;
+      dreturn("%i", 0);
+      return 0;
+    }
+
+    if (block > 0 && num_samp > block) {
+      n_read = _GD_DoFieldBlocked(D, E, repr, first_samp, num_samp, block,
+          return_type, data_out);
+      D->recurse_level--;
+      dreturn("%" PRIuSIZE, n_read);
+      return n_read;
+    }
+  }
+
   /* short circuit for purely real native types */
   if (~ntype & GD_COMPLEX) {
     if (repr == GD_REPR_IMAG) {
@@ -1971,6 +2256,120 @@ static size_t _GD_DoSindir(DIRFILE *D, gd_entry_t *E, off64_t first_samp,
   return n_read;
 }
 
+/* _GD_SampleRange: Convert the frame/sample range requested of E into a range
+ * of samples.  On entry *first_samp and *num_samp hold the caller's sample
+ * counts; on return they hold the sample range of E.  Returns non-zero on
+ * error.
+ */
+static int _GD_SampleRange(DIRFILE *restrict D, gd_entry_t *restrict E,
+    off64_t first_frame, off64_t *restrict first_samp, size_t num_frames,
+    size_t *restrict num_samp)
+{
+  unsigned int spf;
+
+  dtrace("%p, %p, %" PRId64 ", %p, %" PRIuSIZE ", %p", D, E,
+      (int64_t)first_frame, first_samp, num_frames, num_samp);
+
+  if (first_frame == GD_HERE || *first_samp == GD_HERE) {
+    *first_samp = GD_HERE;
+    first_frame = 0;
+  }
+
+  if (first_frame || num_frames) {
+    /* get the samples per frame */
+    spf = _GD_GetSPF(D, E);
+
+    if (D->error) {
+      dreturn("%i", 1);
+      return 1;
+    }
+
+    /* don't overflow */
+    if (*first_samp > GD_INT64_MAX - spf * first_frame) {
+      _GD_SetError(D, GD_E_RANGE, GD_E_OUT_OF_RANGE, NULL, 0, NULL);
+      dreturn("%i", 1);
+      return 1;
+    }
+    *first_samp += spf * first_frame;
+
+    if (*num_samp > GD_SIZE_T_MAX - spf * num_frames)
+      *num_samp = GD_SIZE_T_MAX;
+    else
+      *num_samp += spf * num_frames;
+  }
+
+  if (*first_samp < 0 && (*first_samp != GD_HERE || first_frame != 0)) {
+    _GD_SetError(D, GD_E_RANGE, GD_E_OUT_OF_RANGE, NULL, 0, NULL);
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  dreturn("%i (%" PRId64 ", %" PRIuSIZE ")", 0, (int64_t)*first_samp,
+      *num_samp);
+  return 0;
+}
+
+/* _GD_GetData: read the sample range [first_samp, first_samp + num_samp) of a
+ * vector field; the part of gd_getdata64 which follows the field lookup */
+static size_t _GD_GetData(DIRFILE *restrict D, gd_entry_t *restrict E,
+    int repr, off64_t first_samp, size_t num_samp, gd_type_t return_type,
+    void *restrict data_out)
+{
+  size_t n_read = 0;
+
+  dtrace("%p, %p, %i, %" PRId64 ", %" PRIuSIZE ", 0x%X, %p", D, E, repr,
+      (int64_t)first_samp, num_samp, return_type, data_out);
+
+  if (E->field_type == GD_SINDIR_ENTRY)
+    n_read = _GD_DoSindir(D, E, first_samp, num_samp, return_type,
+        data_out);
+  else {
+    if (return_type != GD_NULL &&
+        _GD_BadType(GD_DIRFILE_STANDARDS_VERSION, return_type))
+    {
+      _GD_SetError(D, GD_E_BAD_TYPE, 0, NULL, return_type, NULL);
+    } else
+      n_read = _GD_DoField(D, E, repr, first_samp, num_samp, return_type,
+          data_out);
+  }
+
+  dreturn("%" PRIuSIZE, n_read);
+  return n_read;
+}
+
+/* the part of gd_getdata64 after the field code, which is used in error
+ * messages, has been resolved */
+static size_t _GD_GetDataE(DIRFILE *restrict D, const char *field_code,
+    gd_entry_t *restrict entry, int repr, off64_t first_frame,
+    off64_t first_samp, size_t num_frames, size_t num_samp,
+    gd_type_t return_type, void *data_out)
+{
+  size_t n_read;
+
+  dtrace("%p, \"%s\", %p, 0x%X, %" PRId64 ", %" PRId64 ", %" PRIuSIZE ", %"
+      PRIuSIZE ", 0x%X, %p", D, field_code, entry, repr, (int64_t)first_frame,
+      (int64_t)first_samp, num_frames, num_samp, return_type, data_out);
+
+  if (entry->field_type & GD_SCALAR_ENTRY_BIT) {
+    _GD_SetError(D, GD_E_DIMENSION, GD_E_DIM_CALLER, NULL, 0, field_code);
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  if (_GD_SampleRange(D, entry, first_frame, &first_samp, num_frames,
+        &num_samp))
+  {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  n_read = _GD_GetData(D, entry, repr, first_samp, num_samp, return_type,
+      data_out);
+
+  dreturn("%" PRIuSIZE, n_read);
+  return n_read;
+}
+
 /* this function is little more than a public boilerplate for _GD_DoField */
 size_t gd_getdata64(DIRFILE* D, const char *field_code, off64_t first_frame,
     off64_t first_samp, size_t num_frames, size_t num_samp,
@@ -1979,7 +2378,6 @@ size_t gd_getdata64(DIRFILE* D, const char *field_code, off64_t first_frame,
   size_t n_read = 0;
   gd_entry_t* entry;
   int repr;
-  unsigned int spf;
 
   dtrace("%p, \"%s\", %" PRId64 ", %" PRId64 ", %" PRIuSIZE ", %" PRIuSIZE
       ", 0x%X, %p", D, field_code, (int64_t)first_frame, (int64_t)first_samp,
@@ -1994,61 +2392,510 @@ size_t gd_getdata64(DIRFILE* D, const char *field_code, off64_t first_frame,
     return 0;
   }
 
-  if (entry->field_type & GD_SCALAR_ENTRY_BIT) {
-    _GD_SetError(D, GD_E_DIMENSION, GD_E_DIM_CALLER, NULL, 0, field_code);
+  n_read = _GD_GetDataE(D, field_code, entry, repr, first_frame, first_samp,
+      num_frames, num_samp, return_type, data_out);
+
+  dreturn("%" PRIuSIZE, n_read);
+  return n_read;
+}
+
+/* Resolve a field code once, for repeated reads with gd_getdata_handle */
+gd_field_handle_t gd_field_handle(DIRFILE *D, const char *field_code)
+{
+  gd_entry_t *E;
+  struct gd_handle_ *ptr;
+  int i, repr;
+
+  dtrace("%p, \"%s\"", D, field_code);
+
+  GD_RETURN_ERR_IF_INVALID(D);
+
+  E = _GD_FindFieldAndRepr(D, field_code, &repr, NULL, 1);
+
+  if (D->error)
+    GD_RETURN_ERROR(D);
+
+  /* reuse an existing handle */
+  if (E->e->handled)
+    for (i = 0; i < D->n_handle; ++i)
+      if (D->handle[i].E == E && D->handle[i].repr == repr) {
+        dreturn("%i", i);
+        return i;
+      }
+
+  if (D->n_handle == D->handle_size) {
+    ptr = _GD_Realloc(D, D->handle, sizeof(*ptr) * (D->handle_size + 64));
+    if (ptr == NULL)
+      GD_RETURN_ERROR(D);
+    D->handle = ptr;
+    D->handle_size += 64;
+  }
+
+  D->handle[D->n_handle].E = E;
+  D->handle[D->n_handle].repr = repr;
+  E->e->handled = 1;
+
+  dreturn("%i", D->n_handle);
+  return D->n_handle++;
+}
+
+/* gd_getdata64, for a field code resolved by gd_field_handle */
+size_t gd_getdata_handle64(DIRFILE *D, gd_field_handle_t h,
+    off64_t first_frame, off64_t first_samp, size_t num_frames,
+    size_t num_samp, gd_type_t return_type, void *data_out)
+{
+  size_t n_read;
+
+  dtrace("%p, %i, %" PRId64 ", %" PRId64 ", %" PRIuSIZE ", %" PRIuSIZE
+      ", 0x%X, %p", D, h, (int64_t)first_frame, (int64_t)first_samp,
+      num_frames, num_samp, return_type, data_out);
+
+  GD_RETURN_IF_INVALID(D, "%i", 0);
+
+  if (h < 0 || h >= D->n_handle || D->handle[h].E == NULL) {
+    _GD_SetError(D, GD_E_ARGUMENT, GD_E_ARG_HANDLE, NULL, h, NULL);
     dreturn("%i", 0);
     return 0;
   }
 
-  if (first_frame == GD_HERE || first_samp == GD_HERE) {
-    first_samp = GD_HERE;
-    first_frame = 0;
+  n_read = _GD_GetDataE(D, D->handle[h].E->field, D->handle[h].E,
+      D->handle[h].repr, first_frame, first_samp, num_frames, num_samp,
+      return_type, data_out);
+
+  dreturn("%" PRIuSIZE, n_read);
+  return n_read;
+}
+
+/* The RAW fields needed by a gd_getdata_multi call */
+struct gd_multi_raw_ {
+  gd_entry_t *E;
+  off64_t s0, s1; /* the union of the sample ranges read: [s0, s1) */
+  int refs; /* number of reads of this field */
+};
+
+struct gd_multi_ {
+  struct gd_multi_raw_ *raw;
+  size_t n, size;
+};
+
+/* The fields requested by a gd_getdata_multi call */
+struct gd_multi_field_ {
+  gd_entry_t *E;
+  int repr;
+  off64_t s0;
+  size_t ns;
+  gd_type_t in_type; /* the type of the input of a grouped BIT field */
+  ssize_t group; /* the first field of this field's BIT group, or -1 */
+};
+
+/* _GD_MultiPlan: Walk the input tree of E, which is going to be read over the
+ * samples [s0, s0 + ns), tallying the reads of every RAW field in it, using
+ * the same sample arithmetic as the _GD_Do... functions.  An under-estimate
+ * only results in a cache miss, never a wrong answer.  Returns non-zero on
+ * error.
+ */
+static int _GD_MultiPlan(DIRFILE *restrict D, gd_entry_t *restrict E,
+    off64_t s0, size_t ns, struct gd_multi_ *restrict m)
+{
+  int i, n = 0;
+  size_t j;
+  unsigned int spf0, spf;
+
+  dtrace("%p, %p, %" PRId64 ", %" PRIuSIZE ", %p", D, E, (int64_t)s0, ns, m);
+
+  if (++D->recurse_level >= GD_MAX_RECURSE_LEVEL) {
+    _GD_SetError(D, GD_E_RECURSE_LEVEL, GD_E_RECURSE_CODE, NULL, 0, E->field);
+    D->recurse_level--;
+    dreturn("%i", 1);
+    return 1;
   }
 
-  if (first_frame || num_frames) {
-    /* get the samples per frame */
-    spf = _GD_GetSPF(D, entry);
+  if (!(E->flags & GD_EN_CALC)) {
+    _GD_CalculateEntry(D, E, 1);
 
     if (D->error) {
-      dreturn("%i", 0);
-      return 0;
+      D->recurse_level--;
+      dreturn("%i", 1);
+      return 1;
     }
+  }
 
-    /* don't overflow */
-    if (first_samp > GD_INT64_MAX - spf * first_frame) {
-      _GD_SetError(D, GD_E_RANGE, GD_E_OUT_OF_RANGE, NULL, 0, NULL);
-      dreturn("%i", 0);
-      return 0;
+  /* nothing to do */
+  if (s0 < 0 || ns == 0 || E->field_type & GD_SCALAR_ENTRY_BIT) {
+    D->recurse_level--;
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  /* keep the arithmetic below sane */
+  if (ns > GD_TRANSACTION_MAX(GD_COMPLEX128))
+    ns = GD_TRANSACTION_MAX(GD_COMPLEX128);
+  if (s0 > (int64_t)(GD_INT64_MAX - ns)) {
+    D->recurse_level--;
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  switch (E->field_type) {
+    case GD_RAW_ENTRY:
+      for (j = 0; j < m->n; ++j)
+        if (m->raw[j].E == E)
+          break;
+
+      if (j == m->n) {
+        if (m->n == m->size) {
+          struct gd_multi_raw_ *ptr = _GD_Realloc(D, m->raw,
+              sizeof(*ptr) * (m->size ? 2 * m->size : 16));
+          if (ptr == NULL) {
+            D->recurse_level--;
+            dreturn("%i", 1);
+            return 1;
+          }
+          m->raw = ptr;
+          m->size = m->size ? 2 * m->size : 16;
+        }
+        m->raw[j].E = E;
+        m->raw[j].s0 = s0;
+        m->raw[j].s1 = s0 + ns;
+        m->raw[j].refs = 0;
+        m->n++;
+      }
+
+      if (m->raw[j].s0 > s0)
+        m->raw[j].s0 = s0;
+      if (m->raw[j].s1 < s0 + (off64_t)ns)
+        m->raw[j].s1 = s0 + ns;
+      m->raw[j].refs++;
+      break;
+    case GD_LINCOM_ENTRY:
+      n = E->EN(lincom,n_fields);
+      break;
+    case GD_MULTIPLY_ENTRY:
+    case GD_DIVIDE_ENTRY:
+    case GD_WINDOW_ENTRY:
+    case GD_MPLEX_ENTRY:
+    case GD_INDIR_ENTRY:
+      n = 2;
+      break;
+    case GD_LINTERP_ENTRY:
+    case GD_BIT_ENTRY:
+    case GD_SBIT_ENTRY:
+    case GD_POLYNOM_ENTRY:
+    case GD_RECIP_ENTRY:
+    case GD_SINDIR_ENTRY:
+      n = 1;
+      break;
+    case GD_PHASE_ENTRY:
+      if (_GD_FindInputs(D, E, 1) == 0)
+        _GD_MultiPlan(D, E->e->entry[0], s0 + E->EN(phase,shift), ns, m);
+      break;
+    default:
+      break;
+  }
+
+  if (n > 0 && _GD_FindInputs(D, E, 1) == 0) {
+    spf0 = _GD_GetSPF(D, E->e->entry[0]);
+
+    for (i = 0; !D->error && i < n; ++i) {
+      if (E->e->entry[i]->field_type & GD_SCALAR_ENTRY_BIT)
+        continue;
+
+      if (i == 0)
+        _GD_MultiPlan(D, E->e->entry[0], s0, ns, m);
+      else {
+        spf = _GD_GetSPF(D, E->e->entry[i]);
+        if (!D->error && spf0 > 0)
+          _GD_MultiPlan(D, E->e->entry[i], s0 * spf / spf0,
+              (size_t)ceil((double)ns * spf / spf0), m);
+      }
     }
-    first_samp += spf * first_frame;
+  }
 
-    if (num_samp > GD_SIZE_T_MAX - spf * num_frames)
-      num_samp = GD_SIZE_T_MAX;
-    else
-      num_samp += spf * num_frames;
+  D->recurse_level--;
+  dreturn("%i", D->error ? 1 : 0);
+  return D->error ? 1 : 0;
+}
+
+/* _GD_MultiPrefetch: Read every RAW field which appears more than once in the
+ * plan, over the union of the ranges needed, into its shared input cache.
+ * This is purely an optimisation: a field which can't be cached is simply read
+ * as usual.
+ */
+static void _GD_MultiPrefetch(DIRFILE *restrict D, struct gd_multi_ *restrict m)
+{
+  size_t j, ns, n;
+  void *buf;
+  gd_entry_t *E;
+
+  dtrace("%p, %p", D, m);
+
+  for (j = 0; j < m->n; ++j) {
+    if (m->raw[j].refs < 2)
+      continue;
+
+    E = m->raw[j].E;
+    ns = (size_t)(m->raw[j].s1 - m->raw[j].s0);
+    if (ns > GD_TRANSACTION_MAX(E->EN(raw,data_type)))
+      continue;
+
+    buf = malloc(ns * E->e->u.raw.size);
+    if (buf == NULL)
+      continue;
+
+    n = _GD_DoRaw(D, E, m->raw[j].s0, ns, E->EN(raw,data_type), buf);
+
+    if (D->error) {
+      free(buf);
+      break;
+    }
+
+    E->e->u.raw.cache = buf;
+    E->e->u.raw.cache_s0 = m->raw[j].s0;
+    E->e->u.raw.cache_n = n;
+    E->e->u.raw.cache_eof = (n < ns);
+    E->e->u.raw.cache_pos = -1;
   }
 
-  if (first_samp < 0 && (first_samp != GD_HERE || first_frame != 0)) {
-    _GD_SetError(D, GD_E_RANGE, GD_E_OUT_OF_RANGE, NULL, 0, NULL);
+  dreturnvoid();
+}
+
+/* _GD_MultiBitInput: Can the BIT or SBIT field E be extracted from the same
+ * pass over its input as other bitfields of that input?  That's the case if
+ * the input is of an integer type wide enough to hold all of E's bits.  If so,
+ * returns non-zero, and stores the input type in in_type.
+ */
+static int _GD_MultiBitInput(DIRFILE *restrict D, gd_entry_t *restrict E,
+    int repr, gd_type_t return_type, gd_type_t *restrict in_type)
+{
+  dtrace("%p, %p, %i, 0x%X, %p", D, E, repr, return_type, in_type);
+
+  if ((E->field_type != GD_BIT_ENTRY && E->field_type != GD_SBIT_ENTRY) ||
+      (repr != GD_REPR_NONE && repr != GD_REPR_REAL) ||
+      (return_type != GD_NULL &&
+       _GD_BadType(GD_DIRFILE_STANDARDS_VERSION, return_type)))
+  {
     dreturn("%i", 0);
     return 0;
   }
 
-  if (entry->field_type == GD_SINDIR_ENTRY)
-    n_read = _GD_DoSindir(D, entry, first_samp, num_samp, return_type,
-        data_out);
-  else {
-    if (return_type != GD_NULL &&
-        _GD_BadType(GD_DIRFILE_STANDARDS_VERSION, return_type))
+  if (!(E->flags & GD_EN_CALC))
+    _GD_CalculateEntry(D, E, 1);
+
+  if (D->error || _GD_FindInputs(D, E, 1)) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  *in_type = _GD_NativeType(D, E->e->entry[0], E->e->repr[0]);
+
+  if (D->error || *in_type & (GD_IEEE754 | GD_COMPLEX) ||
+      E->EN(bit,bitnum) + E->EN(bit,numbits) > 8 * (int)GD_SIZE(*in_type))
+  {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  dreturn("%i", 1);
+  return 1;
+}
+
+/* _GD_MultiBits: Read all the BIT and SBIT fields of group g, which share an
+ * input and sample range, in a single pass over that input.  The input is
+ * read a block at a time, and every bitfield is extracted from the block
+ * while it's still in cache.
+ */
+static void _GD_MultiBits(DIRFILE *restrict D,
+    const struct gd_multi_field_ *restrict f, size_t n_fields, size_t g,
+    const gd_type_t *return_types, void **data_out, size_t *n_read)
+{
+  gd_entry_t *in = f[g].E->e->entry[0];
+  const int in_repr = f[g].E->e->repr[0];
+  const gd_type_t in_type = f[g].in_type;
+  const int size = GD_SIZE(in_type);
+  size_t i, n, want, done;
+  char *buf, *tmp;
+
+  dtrace("%p, %p, %" PRIuSIZE ", %" PRIuSIZE ", %p, %p, %p", D, f, n_fields, g,
+      return_types, data_out, n_read);
+
+  buf = _GD_Malloc(D, 2 * GD_EVAL_BLOCK * size);
+  if (buf == NULL) {
+    dreturnvoid();
+    return;
+  }
+  tmp = buf + GD_EVAL_BLOCK * size;
+
+  for (done = 0; done < f[g].ns; done += n) {
+    want = f[g].ns - done;
+    if (want > GD_EVAL_BLOCK)
+      want = GD_EVAL_BLOCK;
+
+    n = _GD_DoField(D, in, in_repr, f[g].s0 + done, want, in_type, buf);
+    if (D->error)
+      break;
+
+    for (i = g; i < n_fields; ++i) {
+      const gd_entry_t *E = f[i].E;
+      const int is_signed = (E->field_type == GD_SBIT_ENTRY);
+
+      if (f[i].group != (ssize_t)g)
+        continue;
+
+      memcpy(tmp, buf, n * size);
+      _GD_KernelBits(tmp, n, size, E->EN(bit,bitnum), E->EN(bit,numbits),
+          is_signed);
+      _GD_ConvertType(D, tmp, (gd_type_t)size | (is_signed ? GD_SIGNED : 0),
+          (char *)data_out[i] + done * GD_SIZE(return_types[i]),
+          return_types[i], n);
+      if (n_read)
+        n_read[i] += n;
+    }
+
+    if (n < want)
+      break;
+  }
+
+  free(buf);
+  dreturnvoid();
+}
+
+/* read several fields over the same frame range, reading shared inputs once */
+int gd_getdata_multi64(DIRFILE *D, size_t n_fields, const char **field_codes,
+    off64_t first_frame, off64_t first_samp, size_t num_frames,
+    size_t num_samp, const gd_type_t *return_types, void **data_out,
+    size_t *n_read)
+{
+  size_t i, j;
+  struct gd_multi_ m;
+  struct gd_multi_field_ *f;
+
+  dtrace("%p, %" PRIuSIZE ", %p, %" PRId64 ", %" PRId64 ", %" PRIuSIZE ", %"
+      PRIuSIZE ", %p, %p, %p", D, n_fields, field_codes, (int64_t)first_frame,
+      (int64_t)first_samp, num_frames, num_samp, return_types, data_out,
+      n_read);
+
+  GD_RETURN_ERR_IF_INVALID(D);
+
+  if (n_read)
+    memset(n_read, 0, sizeof(*n_read) * n_fields);
+
+  if (n_fields == 0) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  f = _GD_Malloc(D, sizeof(*f) * n_fields);
+  if (f == NULL)
+    GD_RETURN_ERROR(D);
+
+  /* look up all the fields first */
+  for (i = 0; i < n_fields; ++i) {
+    f[i].E = _GD_FindFieldAndRepr(D, field_codes[i], &f[i].repr, NULL, 1);
+
+    if (D->error)
+      break;
+
+    if (f[i].E->field_type & GD_SCALAR_ENTRY_BIT) {
+      _GD_SetError(D, GD_E_DIMENSION, GD_E_DIM_CALLER, NULL, 0,
+          field_codes[i]);
+      break;
+    }
+
+    f[i].s0 = first_samp;
+    f[i].ns = num_samp;
+    f[i].group = -1;
+    if (_GD_SampleRange(D, f[i].E, first_frame, &f[i].s0, num_frames,
+          &f[i].ns))
     {
-      _GD_SetError(D, GD_E_BAD_TYPE, 0, NULL, return_type, NULL);
-    } else
-      n_read = _GD_DoField(D, entry, repr, first_samp, num_samp, return_type,
-          data_out);
+      break;
+    }
   }
 
-  dreturn("%" PRIuSIZE, n_read);
-  return n_read;
+  /* group the bitfields which can be extracted from a single pass over the
+   * same input */
+  if (!D->error && first_samp != GD_HERE && first_frame != GD_HERE)
+    for (i = 0; i < n_fields; ++i) {
+      if (!_GD_MultiBitInput(D, f[i].E, f[i].repr, return_types[i],
+            &f[i].in_type))
+      {
+        if (D->error)
+          break;
+        continue;
+      }
+
+      for (j = 0; j < i; ++j)
+        if (f[j].group == (ssize_t)j && f[j].E->e->entry[0] ==
+            f[i].E->e->entry[0] && f[j].E->e->repr[0] == f[i].E->e->repr[0]
+            && f[j].s0 == f[i].s0 && f[j].ns == f[i].ns)
+        {
+          break;
+        }
+
+      f[i].group = j;
+    }
+
+  if (D->error) {
+    free(f);
+    GD_RETURN_ERROR(D);
+  }
+
+  /* find the RAW fields read more than once and fetch them up front.  Reads
+   * relative to the I/O pointer start in a different place for every field,
+   * so there's nothing to share in that case */
+  memset(&m, 0, sizeof(m));
+  if (first_samp != GD_HERE && first_frame != GD_HERE) {
+    for (i = 0; i < n_fields; ++i) {
+      if (f[i].group == (ssize_t)i) {
+        /* the input of a BIT group is read once for the whole group */
+        if (_GD_MultiPlan(D, f[i].E->e->entry[0], f[i].s0, f[i].ns, &m))
+          break;
+      } else if (f[i].group < 0 &&
+          _GD_MultiPlan(D, f[i].E, f[i].s0, f[i].ns, &m))
+      {
+        break;
+      }
+    }
+
+    if (!D->error)
+      _GD_MultiPrefetch(D, &m);
+  }
+
+  for (i = 0; !D->error && i < n_fields; ++i) {
+    if (f[i].group == (ssize_t)i)
+      _GD_MultiBits(D, f, n_fields, i, return_types, data_out, n_read);
+    else if (f[i].group < 0) {
+      j = _GD_GetData(D, f[i].E, f[i].repr, f[i].s0, f[i].ns,
+          return_types[i], data_out[i]);
+
+      if (n_read)
+        n_read[i] = j;
+    }
+
+    if (D->error)
+      break;
+  }
+
+  /* nothing is reported for the failed field and those after it, even if they
+   * were read as part of a BIT group */
+  if (D->error && n_read)
+    memset(n_read + i, 0, sizeof(*n_read) * (n_fields - i));
+
+  /* drop the caches, leaving the I/O pointer of each field where it would be
+   * if its last read hadn't used the cache */
+  for (j = 0; j < m.n; ++j) {
+    gd_entry_t *E = m.raw[j].E;
+
+    if (E->e->u.raw.cache && E->e->u.raw.cache_pos >= 0 && !D->error)
+      _GD_Seek(D, E, E->e->u.raw.cache_pos, GD_FILE_READ);
+
+    free(E->e->u.raw.cache);
+    E->e->u.raw.cache = NULL;
+  }
+
+  free(m.raw);
+  free(f);
+
+  GD_RETURN_ERROR(D);
 }
 
 #if !(defined _FILE_OFFSET_BITS && _FILE_OFFSET_BITS == 64)
@@ -2060,6 +2907,22 @@ size_t gd_getdata(DIRFILE* D, const char *field_code, off_t first_frame,
   return gd_getdata64(D, field_code, first_frame, first_samp, num_frames,
       num_samp, return_type, data_out);
 }
+
+size_t gd_getdata_handle(DIRFILE *D, gd_field_handle_t h, off_t first_frame,
+    off_t first_samp, size_t num_frames, size_t num_samp,
+    gd_type_t return_type, void *data_out)
+{
+  return gd_getdata_handle64(D, h, first_frame, first_samp, num_frames,
+      num_samp, return_type, data_out);
+}
+
+int gd_getdata_multi(DIRFILE *D, size_t n_fields, const char **field_codes,
+    off_t first_frame, off_t first_samp, size_t num_frames, size_t num_samp,
+    const gd_type_t *return_types, void **data_out, size_t *n_read)
+{
+  return gd_getdata_multi64(D, n_fields, field_codes, first_frame, first_samp,
+      num_frames, num_samp, return_types, data_out, n_read);
+}
 #endif
 /* vim: ts=2 sw=2 et tw=80
 */
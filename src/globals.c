@@ -45,6 +45,9 @@ const char *gd_reference(DIRFILE* D, const char* field_code) gd_nothrow
   
   /* if no field specified, return only the field name */
   if (field_code == NULL) {
+    if (D->reference_field == NULL)
+      _GD_ParseLazyRef(D);
+
     if (D->reference_field == NULL) {
       dreturn("%p", NULL);
       return NULL;
@@ -96,13 +99,14 @@ const char *gd_reference(DIRFILE* D, const char* field_code) gd_nothrow
   D->fragment[0].ref_name = ptr;
   D->fragment[0].modified = 1;
   D->flags &= ~GD_HAVE_VERSION;
+  D->gen++;
 
   dreturn("\"%s\"", D->reference_field->field);
   return D->reference_field->field;
 }
 
 /* the mask of allowed flags */
-#define GD_FLAG_MASK (GD_VERBOSE | GD_PRETTY_PRINT)
+#define GD_FLAG_MASK (GD_VERBOSE | GD_PRETTY_PRINT | GD_MMAP)
 unsigned long gd_flags(DIRFILE *D, unsigned long set, unsigned long reset)
   gd_nothrow
 {
@@ -191,99 +195,110 @@ void gd_alloc_funcs(void *(*malloc_func)(size_t),
   dreturnvoid();
 }
 
-/* Find all the currently open RAWs, and close old ones until we end
- * up with not more than new_limit of them */
-static int _GD_FindOpenFields(DIRFILE *D, long new_limit)
+/* The open RAW fields are kept, when gd_open_limit() is in effect, in a
+ * doubly linked list threaded through their private entries, ordered from the
+ * most recently used (D->lru_head) to the least (D->lru_tail). */
+#define GD_LRU_LINKED(D,E) ((E)->e->u.raw.lru_prev || (D)->lru_head == (E))
+
+static void _GD_LRUUnlink(DIRFILE *restrict D, const gd_entry_t *restrict E)
 {
-  unsigned int i;
-  long j;
-  time_t atime;
+  gd_entry_t *const prev = E->e->u.raw.lru_prev;
+  gd_entry_t *const next = E->e->u.raw.lru_next;
 
-  dtrace("%p, %li", D, new_limit);
+  if (prev)
+    prev->e->u.raw.lru_next = next;
+  else
+    D->lru_head = next;
 
-  D->open_raws = D->open_fds = 0;
-  D->opened_sorted = 1;
+  if (next)
+    next->e->u.raw.lru_prev = prev;
+  else
+    D->lru_tail = prev;
 
-  /* Run through everything, looking for open raw entries */
-  for (i = 0; i < D->n_entries; ++i) {
-    if (D->entry[i]->field_type == GD_RAW_ENTRY) {
-      dwatch("%s", D->entry[i]->field);
-      dwatch("%li", (long)D->entry[i]->e->u.raw.atime);
-    }
+  E->e->u.raw.lru_prev = E->e->u.raw.lru_next = NULL;
+}
 
-    if (D->entry[i]->field_type == GD_RAW_ENTRY &&
-        D->entry[i]->e->u.raw.atime > 0)
-    {
-      atime = D->entry[i]->e->u.raw.atime;
-
-      if (D->open_fds + D->entry[i]->e->u.raw.fd_count > new_limit) {
-        /* At the limit: close the oldest file we've found if the one
-         * we just found is newer, otherwise close this field */
-        if (D->opened[D->open_raws]->e->u.raw.atime < atime) {
-          /* FiniRawIO decrements open_raws on success */
-          if (_GD_FiniRawIO(D, D->opened[D->open_raws],
-              D->opened[D->open_raws]->fragment_index, GD_FINIRAW_KEEP))
-          {
-            dreturn("%i", -1);
-            return -1;
-          }
-        } else {
-          /* Close this file and continue */ 
-          if (_GD_FiniRawIO(D, D->entry[i], D->entry[i]->fragment_index,
-              GD_FINIRAW_KEEP))
-          {
-            dreturn("%i", -1);
-            return -1;
-          }
-          continue;
-        }
-      }
+static void _GD_LRULink(DIRFILE *restrict D, gd_entry_t *restrict E)
+{
+  E->e->u.raw.lru_prev = NULL;
+  E->e->u.raw.lru_next = D->lru_head;
+  if (D->lru_head)
+    D->lru_head->e->u.raw.lru_prev = E;
+  else
+    D->lru_tail = E;
+  D->lru_head = E;
+}
 
-      /* Find where the new entry should go in the opened list */
-      for (j = 0; j < D->open_raws && atime < D->opened[j]->e->u.raw.atime;
-          ++j)
-      {
-        /* Nothing to do here: just counting j */
-      }
+/* Add a newly opened RAW field to the front of the open list */
+void _GD_LRUPush(DIRFILE *restrict D, gd_entry_t *restrict E)
+{
+  dtrace("%p, %p", D, E);
+
+  E->e->u.raw.atime = ++D->access_count;
 
-      /* Insert sort */
-      memmove(D->opened + j + 1, D->opened + j,
-          sizeof(D->opened[0]) * (D->open_raws - j));
-      D->opened[j] = D->entry[i];
+  if (D->open_limit > 0) {
+    if (GD_LRU_LINKED(D, E))
+      _GD_LRUUnlink(D, E);
+    else {
       D->open_raws++;
-      D->open_fds += D->entry[i]->e->u.raw.fd_count;
-      dwatch("%li", D->open_fds);
+      D->open_fds += E->e->u.raw.fd_count;
     }
+    _GD_LRULink(D, E);
   }
 
-  dreturn("%i", 0);
-  return 0;
+  dreturnvoid();
 }
 
-/* This is (b - a) because we want the larger atime sorted first */
-static int openedcmp(const void *a, const void *b)
+/* Remove a RAW field which is being closed from the open list */
+void _GD_LRURemove(DIRFILE *restrict D, const gd_entry_t *restrict E)
 {
-  return (int)((*((gd_entry_t**)b))->e->u.raw.atime
-      - (*((gd_entry_t**)a))->e->u.raw.atime);
+  dtrace("%p, %p", D, E);
+
+  E->e->u.raw.atime = 0;
+
+  if (D->open_limit > 0 && GD_LRU_LINKED(D, E)) {
+    _GD_LRUUnlink(D, E);
+    D->open_raws--;
+    D->open_fds -= E->e->u.raw.fd_count;
+  }
+
+  dreturnvoid();
 }
 
-/* Close open RAWs until were have only limit of them open */
-static int _GD_CloseOpenFields(DIRFILE *D, long limit)
+/* Mark an open RAW field as the most recently used */
+void _GD_LRUTouch(DIRFILE *restrict D, gd_entry_t *restrict E)
 {
-  dtrace("%p, %li", D, limit);
+  dtrace("%p, %p", D, E);
+
+  E->e->u.raw.atime = ++D->access_count;
 
-  /* qsort the opened list */
-  if (!D->opened_sorted) {
-    qsort(D->opened, D->open_raws, sizeof(D->opened[0]), openedcmp);
-    D->opened_sorted = 1;
+  if (D->lru_head != E && GD_LRU_LINKED(D, E)) {
+    _GD_LRUUnlink(D, E);
+    _GD_LRULink(D, E);
   }
 
-  /* FiniRawIO updates the opened list, so we just have to close
-   * the last open field over and over again until we're below
-   * the limit */
-  while (D->open_fds > limit) {
-    if (_GD_FiniRawIO(D, D->opened[D->open_raws - 1],
-          D->opened[D->open_raws - 1]->fragment_index, GD_FINIRAW_KEEP))
+  dreturnvoid();
+}
+
+/* Sort the larger (more recent) atime first */
+static int _GD_AtimeCmp(const void *a, const void *b)
+{
+  const uint64_t ta = (*((gd_entry_t* const*)a))->e->u.raw.atime;
+  const uint64_t tb = (*((gd_entry_t* const*)b))->e->u.raw.atime;
+
+  return (ta < tb) ? 1 : (ta > tb) ? -1 : 0;
+}
+
+/* Close open RAWs until we have only limit descriptors open.  The least
+ * recently used is always at the tail of the list, and FiniRawIO removes
+ * it from there */
+static int _GD_CloseOpenFields(DIRFILE *D, long limit)
+{
+  dtrace("%p, %li", D, limit);
+
+  while (D->open_fds > limit && D->lru_tail) {
+    if (_GD_FiniRawIO(D, D->lru_tail, D->lru_tail->fragment_index,
+          GD_FINIRAW_KEEP))
     {
       dreturn("%i", -1);
       return -1;
@@ -294,6 +309,66 @@ static int _GD_CloseOpenFields(DIRFILE *D, long limit)
   return 0;
 }
 
+/* Find all the currently open RAWs, put them in the open list by order of
+ * last use, and close old ones until we end up with not more than new_limit
+ * of them */
+static int _GD_FindOpenFields(DIRFILE *D, long new_limit)
+{
+  unsigned int i, n = 0;
+  gd_entry_t **list;
+
+  dtrace("%p, %li", D, new_limit);
+
+  D->open_raws = D->open_fds = 0;
+  D->lru_head = D->lru_tail = NULL;
+
+  /* Run through everything, looking for open raw entries */
+  list = _GD_Malloc(D, sizeof(*list) * (D->n_entries + 1));
+  if (list == NULL) {
+    dreturn("%i", -1);
+    return -1;
+  }
+
+  for (i = 0; i < D->n_entries; ++i)
+    if (D->entry[i]->field_type == GD_RAW_ENTRY &&
+        D->entry[i]->e->u.raw.atime > 0)
+    {
+      list[n++] = D->entry[i];
+    }
+
+  /* newest first; link them up oldest first */
+  qsort(list, n, sizeof(*list), _GD_AtimeCmp);
+  D->open_limit = new_limit;
+  for (i = n; i > 0; --i) {
+    list[i - 1]->e->u.raw.lru_prev = list[i - 1]->e->u.raw.lru_next = NULL;
+    _GD_LRULink(D, list[i - 1]);
+    D->open_raws++;
+    D->open_fds += list[i - 1]->e->u.raw.fd_count;
+  }
+  free(list);
+
+  i = _GD_CloseOpenFields(D, new_limit);
+
+  dreturn("%i", i);
+  return i;
+}
+
+/* Forget the open list */
+static void _GD_ClearOpenFields(DIRFILE *D)
+{
+  gd_entry_t *E, *next;
+
+  dtrace("%p", D);
+
+  for (E = D->lru_head; E; E = next) {
+    next = E->e->u.raw.lru_next;
+    E->e->u.raw.lru_prev = E->e->u.raw.lru_next = NULL;
+  }
+  D->lru_head = D->lru_tail = NULL;
+
+  dreturnvoid();
+}
+
 /* Close the oldest open fields until we have at least n free descriptors */
 int _GD_AutoClose(DIRFILE *D, int n)
 {
@@ -336,37 +411,44 @@ long gd_open_limit(DIRFILE *D, long new_limit)
     new_limit = 2;
 
   if (new_limit >= 0 && new_limit != D->open_limit) { /* New limit */
-    if (new_limit == 0) { /* Caller removes limiting */
-      free(D->opened);
-      D->opened = NULL;
-    } else if (D->open_limit == 0) { /* Caller initiates limiting */
-      D->opened = _GD_Malloc(D, sizeof(D->opened[0]) * new_limit);
-      if (D->error)
-        GD_RETURN_ERROR(D);
-
+    if (new_limit == 0) /* Caller removes limiting */
+      _GD_ClearOpenFields(D);
+    else if (D->open_limit == 0) { /* Caller initiates limiting */
       if (_GD_FindOpenFields(D, new_limit)) {
-        free(D->opened);
-        D->opened = NULL;
+        _GD_ClearOpenFields(D);
+        D->open_limit = 0;
         GD_RETURN_ERROR(D);
       }
+    } else if (new_limit < D->open_fds && _GD_CloseOpenFields(D, new_limit))
+      /* Caller lowers the limit: close RAWs until we're under it */
+      GD_RETURN_ERROR(D);
 
-      D->open_limit = new_limit;
-    } else { /* Caller updates the limit */
-      void *ptr;
-
-      /* First close RAWs until we're under the new limit */
-      if (new_limit < D->open_fds && _GD_CloseOpenFields(D, new_limit))
-        GD_RETURN_ERROR(D);
-
-      /* Now realloc */
-      ptr = _GD_Realloc(D, D->opened, sizeof(D->opened[0]) * new_limit);
-      if (D->error)
-        GD_RETURN_ERROR(D);
-      D->opened = ptr;
-    }
     D->open_limit = new_limit;
   }
 
   dreturn("%li", D->open_limit);
   return D->open_limit;
 }
+
+/* Report one of the statistics counters */
+gd_int64_t gd_counter(DIRFILE *D, int counter) gd_nothrow
+{
+  dtrace("%p, %i", D, counter);
+
+  _GD_ClearError(D);
+
+  if (counter < 0 || counter >= GD_N_COUNTERS) {
+    _GD_SetError(D, GD_E_ARGUMENT, GD_E_ARG_COUNTER, NULL, counter, NULL);
+    GD_RETURN_ERROR(D);
+  }
+
+  /* catch up with the write-behind worker, if there is one */
+  if (D->wb && (counter == GD_COUNTER_INDEX_SEEK ||
+        counter == GD_COUNTER_WB_DEPTH))
+  {
+    _GD_WBCounters(D);
+  }
+
+  dreturn("%" PRIu64, D->counter[counter]);
+  return (gd_int64_t)D->counter[counter];
+}
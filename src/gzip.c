@@ -26,30 +26,621 @@
 
 #ifdef HAVE_GZSEEK64
 #define gd_gzseek gzseek64
-#else
-#define gd_gzseek gzseek
-#endif
-
-#ifdef HAVE_GZTELL64
 #define gd_gztell gztell64
 #else
+#define gd_gzseek gzseek
 #define gd_gztell gztell
 #endif
 
-/* The gzip encoding scheme uses edata as a gzFile object.  If a file is
- * open, idata >= 0 otherwise idata = -1.  Writes occur out-of-place. */
+/* The gzip encoding scheme uses edata as a struct gd_gzdata_.  If a file is
+ * open, idata >= 0 otherwise idata = -1.  Writes occur out-of-place.
+ *
+ * When writing, we simply use a gzFile.  When reading, we do the inflating
+ * ourselves, so that we can keep an index of access points into the
+ * compressed stream, in the manner of zlib's examples/zran.c.  An access point
+ * records what's needed to restart inflation at a deflate block boundary: the
+ * compressed offset, the number of bits of the previous byte still to be
+ * used, and the GD_GZ_WINSIZE bytes of uncompressed data which precede it
+ * (which we keep deflated).  Points are added roughly every GD_GZ_SPAN bytes of
+ * uncompressed data, the first time the stream is inflated past them, and the
+ * index is saved in a sidecar (see sidecar.c) when the data file is closed.
+ * A seek then never has to inflate more than GD_GZ_SPAN bytes or so, once the
+ * index covers the target.
+ *
+ * Every file we write ends with an empty "size member", whose header records
+ * the uncompressed size of the whole file in an extra field.  This is where
+ * _GD_GzipSize looks first, since the trailer of the last member only knows
+ * the size of that member.  Writing at the end of the data appends a new gzip
+ * member to the file (see _GD_AppendRawIO), followed by a new size member, but
+ * only if the size of the data is known exactly, from the index or a size
+ * member: otherwise, it's left to an ordinary out-of-place write.  Reading a
+ * file of many members is no different from reading one.
+ */
+#define GD_GZ_CHUNK      16384
+#define GD_GZ_WINSIZE    32768
+#define GD_GZ_SPAN       (1 << 22)
+
+/* the sidecar magic number, including a format version */
+#define GD_GZ_IDX_MAGIC "GDGZIX01"
+
+/* The size member: a gzip header with FLG.FEXTRA set, and an extra field
+ * holding a single "GD" subfield of eight bytes, which are the size,
+ * little-endian; then an empty deflate stream, and a trailer of zeroes */
+#define GD_GZ_SZ_LEN 34
+#define GD_GZ_SZ_OFFSET 16
+static const unsigned char _GD_GzipSizeHead[GD_GZ_SZ_OFFSET] = {
+  0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 255, 12, 0, 'G', 'D', 8, 0
+};
+static const unsigned char _GD_GzipSizeTail[10] = { 3, 0, 0, 0, 0, 0, 0, 0,
+  0, 0 };
+
+struct gd_gzpoint_ {
+  off64_t out; /* uncompressed offset */
+  off64_t in; /* offset of the first whole compressed byte */
+  int bits; /* number of bits of the byte before that still to be used */
+  uLong wlen; /* length of window */
+  Bytef *window; /* the preceding GD_GZ_WINSIZE bytes of output, deflated */
+};
+
+struct gd_gzdata_ {
+  gzFile gz; /* only used when writing */
+  off64_t base; /* uncompressed bytes before the member being written */
+
+  /* inflation state */
+  int dirfd;
+  z_stream strm;
+  int raw; /* inflating a raw deflate stream, after restoring a point */
+  int skip; /* bytes of gzip trailer still to skip, in raw mode */
+  int member; /* at the start of a gzip member */
+  int in_eof; /* the last read of the file returned nothing */
+  int eof;
+  int zerr; /* the last zlib error */
+  off64_t in; /* compressed offset of the end of in_buf */
+  off64_t out; /* uncompressed offset */
+  Bytef in_buf[GD_GZ_CHUNK];
+  Bytef win[GD_GZ_WINSIZE]; /* output buffer; always the most recent output */
+
+  /* the index */
+  struct gd_gzpoint_ *point;
+  size_t n_point, size_point;
+  off64_t indexed; /* uncompressed bytes already scanned for access points */
+  off64_t total; /* uncompressed size, if known, or -1 */
+  int dirty;
+  struct gd_stamp_ stamp; /* of the data file */
+};
+
+static void _GD_GzipFreeIndex(struct gd_gzdata_ *gzd)
+{
+  size_t i;
+
+  dtrace("%p", gzd);
+
+  for (i = 0; i < gzd->n_point; ++i)
+    free(gzd->point[i].window);
+  free(gzd->point);
+
+  gzd->point = NULL;
+  gzd->n_point = gzd->size_point = 0;
+  gzd->indexed = 0;
+  gzd->total = -1;
+
+  dreturnvoid();
+}
 
-int _GD_GzipOpen(int fd, struct gd_raw_file_* file,
-    gd_type_t data_type gd_unused_, int swap gd_unused_, unsigned int mode)
+/* _GD_GzipLoadIndex: read the sidecar of the data file name, if there is one
+ * and it matches the stamp in gzd.  If points is zero, only the uncompressed
+ * size is read.
+ */
+static void _GD_GzipLoadIndex(const DIRFILE *D, int dirfd, const char *name,
+    struct gd_gzdata_ *gzd, int points)
 {
-  const char *gzmode = "w";
-  dtrace("%i, %p, <unused>, <unused>, 0x%X", fd, file, mode);
+  int64_t total, indexed;
+  uint64_t n, i;
+  int fd, bad = 0;
+
+  dtrace("%p, %i, \"%s\", %p, %i", D, dirfd, name, gzd, points);
+
+  fd = _GD_OpenSidecar(D, dirfd, name, GD_GZ_IDX_MAGIC, &gzd->stamp);
+  if (fd < 0) {
+    dreturnvoid();
+    return;
+  }
+
+  if (_GD_SidecarRead(fd, &total, 8) || _GD_SidecarRead(fd, &indexed, 8) ||
+      _GD_SidecarRead(fd, &n, 8) ||
+      _GD_SidecarBadCount(n, sizeof(*gzd->point), &gzd->stamp))
+  {
+    close(fd);
+    dreturnvoid();
+    return;
+  }
+
+  gzd->total = total;
+
+  if (points && n > 0) {
+    gzd->point = malloc(sizeof(*gzd->point) * n);
+    if (gzd->point == NULL)
+      bad = 1;
+    gzd->size_point = n;
+
+    for (i = 0; !bad && i < n; ++i) {
+      struct gd_gzpoint_ *p = gzd->point + i;
+      int64_t out, in;
+      int32_t bits;
+      uint32_t wlen;
+
+      if (_GD_SidecarRead(fd, &out, 8) || _GD_SidecarRead(fd, &in, 8) ||
+          _GD_SidecarRead(fd, &bits, 4) || _GD_SidecarRead(fd, &wlen, 4) ||
+          bits < 0 || bits > 7 || wlen > compressBound(GD_GZ_WINSIZE) ||
+          (i > 0 && out <= p[-1].out))
+      {
+        bad = 1;
+        break;
+      }
+
+      p->window = malloc(wlen);
+      if (p->window == NULL) {
+        bad = 1;
+        break;
+      }
+      gzd->n_point++;
+
+      p->out = out;
+      p->in = in;
+      p->bits = bits;
+      p->wlen = wlen;
+      if (_GD_SidecarRead(fd, p->window, wlen))
+        bad = 1;
+    }
+
+    if (bad)
+      _GD_GzipFreeIndex(gzd);
+    else
+      gzd->indexed = indexed;
+  }
+
+  close(fd);
+
+  dreturnvoid();
+}
+
+/* _GD_GzipSaveIndex: write the sidecar, if it's worth having */
+static void _GD_GzipSaveIndex(struct gd_raw_file_ *file,
+    struct gd_gzdata_ *gzd)
+{
+  char *tmp;
+  struct gd_stamp_ stamp;
+  const int64_t total = gzd->total, indexed = gzd->indexed;
+  const uint64_t n = gzd->n_point;
+  size_t i;
+  int fd, bad;
+
+  dtrace("%p, %p", file, gzd);
+
+  /* don't bother if seeking is cheap anyway, or if the file has changed */
+  if (gzd->n_point == 0 || _GD_FileStamp(file->idata, &stamp) ||
+      memcmp(&stamp, &gzd->stamp, sizeof(stamp)))
+  {
+    dreturnvoid();
+    return;
+  }
+
+  fd = _GD_CreateSidecar(file->D, gzd->dirfd, file->name, GD_GZ_IDX_MAGIC,
+      &stamp, &tmp);
+  if (fd < 0) {
+    dreturnvoid();
+    return;
+  }
+
+  bad = _GD_SidecarWrite(fd, &total, 8) || _GD_SidecarWrite(fd, &indexed, 8) ||
+    _GD_SidecarWrite(fd, &n, 8);
+
+  for (i = 0; !bad && i < gzd->n_point; ++i) {
+    const int64_t out = gzd->point[i].out, in = gzd->point[i].in;
+    const int32_t bits = gzd->point[i].bits;
+    const uint32_t wlen = (uint32_t)gzd->point[i].wlen;
+
+    bad = _GD_SidecarWrite(fd, &out, 8) || _GD_SidecarWrite(fd, &in, 8) ||
+      _GD_SidecarWrite(fd, &bits, 4) || _GD_SidecarWrite(fd, &wlen, 4) ||
+      _GD_SidecarWrite(fd, gzd->point[i].window, wlen);
+  }
+
+  if (!_GD_FinishSidecar(file->D, gzd->dirfd, file->name, fd, tmp, bad))
+    gzd->dirty = 0;
+
+  dreturnvoid();
+}
+
+/* _GD_GzipTailSize: find the uncompressed size of the gzip file fd from its
+ * end: either the size member, if there is one, or, unless exact is non-zero,
+ * the ISIZE field of the trailer of the last member, which is right only if
+ * that's the only member, and its size is less than 4 GiB.  Returns non-zero on
+ * error, or if an exact size was wanted, but there's no size member.
+ */
+static int _GD_GzipTailSize(int fd, off64_t *size, int exact)
+{
+  unsigned char buf[GD_GZ_SZ_LEN];
+  const unsigned char *isize = buf + GD_GZ_SZ_LEN - 4;
+  uint64_t s = 0;
+  off64_t len;
+  int i;
+
+  dtrace("%i, %p, %i", fd, size, exact);
+
+  len = lseek64(fd, 0, SEEK_END);
+  if (len < 4) {
+    if (len >= 0)
+      errno = EINVAL;
+    dreturn("%i", 1);
+    return 1;
+  } else if (len > GD_GZ_SZ_LEN)
+    len = GD_GZ_SZ_LEN;
+
+  if (lseek64(fd, -len, SEEK_END) == -1 ||
+      read(fd, buf + GD_GZ_SZ_LEN - len, (size_t)len) < len)
+  {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  /* both are stored little-endian */
+  if (len == GD_GZ_SZ_LEN && memcmp(buf, _GD_GzipSizeHead, GD_GZ_SZ_OFFSET) == 0
+      && memcmp(buf + GD_GZ_SZ_OFFSET + 8, _GD_GzipSizeTail,
+        sizeof(_GD_GzipSizeTail)) == 0)
+  {
+    for (i = 7; i >= 0; --i)
+      s = (s << 8) | buf[GD_GZ_SZ_OFFSET + i];
+  } else if (exact) {
+    errno = EINVAL;
+    dreturn("%i", 1);
+    return 1;
+  } else
+    s = (uint64_t)isize[0] | ((uint64_t)isize[1] << 8) |
+      ((uint64_t)isize[2] << 16) | ((uint64_t)isize[3] << 24);
+
+  *size = (off64_t)s;
+
+  dreturn("%i (%" PRIu64 ")", 0, s);
+  return 0;
+}
+
+/* _GD_GzipFinishWrite: after writing a new data file, or appending a member
+ * to one, append the size member, and bring the index, if there is one, up to
+ * date: the access points in the data before the new member are still good.
+ * Returns non-zero on error.
+ */
+static int _GD_GzipFinishWrite(struct gd_raw_file_ *file,
+    struct gd_gzdata_ *gzd, off64_t total)
+{
+  unsigned char buf[GD_GZ_SZ_LEN];
+  uint64_t s = (uint64_t)total;
+  int i, fd;
+
+  dtrace("%p, %p, %" PRId64, file, gzd, (int64_t)total);
+
+  memcpy(buf, _GD_GzipSizeHead, GD_GZ_SZ_OFFSET);
+  for (i = 0; i < 8; ++i, s >>= 8)
+    buf[GD_GZ_SZ_OFFSET + i] = (unsigned char)(s & 0xFF);
+  memcpy(buf + GD_GZ_SZ_OFFSET + 8, _GD_GzipSizeTail,
+      sizeof(_GD_GzipSizeTail));
+
+  fd = gd_OpenAt(file->D, gzd->dirfd, file->name,
+      O_RDWR | O_APPEND | O_BINARY, 0666);
+  if (fd < 0) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  if (write(fd, buf, GD_GZ_SZ_LEN) != GD_GZ_SZ_LEN) {
+    close(fd);
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  if (gzd->n_point > 0 && _GD_FileStamp(fd, &gzd->stamp) == 0) {
+    gzd->total = total;
+    file->idata = fd;
+    _GD_GzipSaveIndex(file, gzd);
+  }
+
+  if (close(fd)) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  dreturn("%i", 0);
+  return 0;
+}
+
+/* _GD_GzipAddPoint: record an access point at the current position, which
+ * must be a deflate block boundary */
+static void _GD_GzipAddPoint(struct gd_gzdata_ *gzd)
+{
+  struct gd_gzpoint_ *p;
+  Bytef *window;
+  uLongf wlen;
+  const size_t pos = gzd->strm.next_out - gzd->win;
+
+  dtrace("%p", gzd);
+
+  if (gzd->n_point == gzd->size_point) {
+    size_t size = gzd->size_point ? 2 * gzd->size_point : 16;
+    p = realloc(gzd->point, sizeof(*p) * size);
+    if (p == NULL) {
+      dreturnvoid();
+      return;
+    }
+    gzd->point = p;
+    gzd->size_point = size;
+  }
+
+  /* unwrap the window: the oldest data start at the current output position */
+  window = malloc(GD_GZ_WINSIZE);
+  if (window == NULL) {
+    dreturnvoid();
+    return;
+  }
+  memcpy(window, gzd->win + pos, GD_GZ_WINSIZE - pos);
+  memcpy(window + GD_GZ_WINSIZE - pos, gzd->win, pos);
+
+  p = gzd->point + gzd->n_point;
+  wlen = compressBound(GD_GZ_WINSIZE);
+  p->window = malloc(wlen);
+  if (p->window == NULL || compress2(p->window, &wlen, window, GD_GZ_WINSIZE,
+        Z_BEST_SPEED) != Z_OK)
+  {
+    free(p->window);
+    free(window);
+    dreturnvoid();
+    return;
+  }
+  free(window);
+
+  p->out = gzd->out;
+  p->in = gzd->in - gzd->strm.avail_in;
+  p->bits = gzd->strm.data_type & 7;
+  p->wlen = wlen;
+  gzd->n_point++;
+  gzd->dirty = 1;
+
+  dreturn("(%" PRId64 ", %" PRId64 ", %i)", (int64_t)p->out, (int64_t)p->in,
+      p->bits);
+}
+
+/* _GD_GzipRestart: go back to the start of the file */
+static int _GD_GzipRestart(struct gd_raw_file_ *file, struct gd_gzdata_ *gzd)
+{
+  dtrace("%p, %p", file, gzd);
+
+  if (lseek64(file->idata, 0, SEEK_SET) == -1) {
+    gzd->zerr = Z_ERRNO;
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  gzd->zerr = inflateReset2(&gzd->strm, 15 + 32);
+  if (gzd->zerr != Z_OK) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  gzd->strm.avail_in = 0;
+  gzd->strm.next_out = gzd->win;
+  gzd->strm.avail_out = GD_GZ_WINSIZE;
+  gzd->in = gzd->out = 0;
+  gzd->raw = gzd->skip = gzd->in_eof = gzd->eof = 0;
+  gzd->member = 1;
+
+  dreturn("%i", 0);
+  return 0;
+}
+
+/* _GD_GzipRestore: restart inflation from the access point p */
+static int _GD_GzipRestore(struct gd_raw_file_ *file, struct gd_gzdata_ *gzd,
+    const struct gd_gzpoint_ *p)
+{
+  uLongf wlen = GD_GZ_WINSIZE;
+  unsigned char c;
+
+  dtrace("%p, %p, %p", file, gzd, p);
+
+  gzd->in = p->in - (p->bits ? 1 : 0);
+  if (lseek64(file->idata, gzd->in, SEEK_SET) == -1) {
+    gzd->zerr = Z_ERRNO;
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  gzd->zerr = inflateReset2(&gzd->strm, -15);
+  if (gzd->zerr != Z_OK) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  gzd->strm.avail_in = 0;
+
+  if (p->bits) {
+    if (read(file->idata, &c, 1) != 1) {
+      gzd->zerr = Z_ERRNO;
+      dreturn("%i", 1);
+      return 1;
+    }
+    gzd->in++;
+    inflatePrime(&gzd->strm, p->bits, c >> (8 - p->bits));
+  }
+
+  gzd->zerr = uncompress(gzd->win, &wlen, p->window, p->wlen);
+  if (gzd->zerr != Z_OK || wlen != GD_GZ_WINSIZE) {
+    if (gzd->zerr == Z_OK)
+      gzd->zerr = Z_DATA_ERROR;
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  gzd->zerr = inflateSetDictionary(&gzd->strm, gzd->win, GD_GZ_WINSIZE);
+  if (gzd->zerr != Z_OK) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  gzd->strm.next_out = gzd->win;
+  gzd->strm.avail_out = GD_GZ_WINSIZE;
+  gzd->out = p->out;
+  gzd->raw = 1;
+  gzd->skip = gzd->member = gzd->in_eof = gzd->eof = 0;
+  _GD_CountIndexSeek(file);
+
+  dreturn("%i", 0);
+  return 0;
+}
+
+/* _GD_GzipInflate: inflate up to len bytes into ptr, or discard them if ptr
+ * is NULL, adding access points as we go.  Returns the number of bytes
+ * produced, which is short only at the end of the data, or -1 on error.
+ */
+static ssize_t _GD_GzipInflate(struct gd_raw_file_ *file,
+    struct gd_gzdata_ *gzd, Bytef *ptr, size_t len)
+{
+  size_t done = 0;
+  z_stream *strm = &gzd->strm;
+
+  dtrace("%p, %p, %p, %" PRIuSIZE, file, gzd, ptr, len);
+
+  while (done < len && !gzd->eof) {
+    Bytef *from;
+    uInt rest = 0, avail_in;
+    size_t k;
+    int ret, building;
+
+    if (strm->avail_in == 0 && !gzd->in_eof) {
+      ssize_t n = read(file->idata, gzd->in_buf, GD_GZ_CHUNK);
+      if (n < 0) {
+        gzd->zerr = Z_ERRNO;
+        dreturn("%i", -1);
+        return -1;
+      }
+      strm->next_in = gzd->in_buf;
+      strm->avail_in = (uInt)n;
+      gzd->in += n;
+      gzd->in_eof = (n == 0);
+    }
+
+    /* skip the trailer of a member after raw inflation, then look for another
+     * member */
+    if (gzd->skip) {
+      if (strm->avail_in == 0) {
+        gzd->eof = 1;
+        break;
+      }
+      k = (strm->avail_in < (uInt)gzd->skip) ? (size_t)strm->avail_in :
+        (size_t)gzd->skip;
+      strm->next_in += k;
+      strm->avail_in -= (uInt)k;
+      gzd->skip -= (int)k;
+      if (gzd->skip == 0) {
+        gzd->zerr = inflateReset2(strm, 15 + 32);
+        if (gzd->zerr != Z_OK) {
+          dreturn("%i", -1);
+          return -1;
+        }
+        gzd->raw = 0;
+        gzd->member = 1;
+      }
+      continue;
+    }
+
+    /* the end of the last member */
+    if (gzd->member && strm->avail_in == 0) {
+      gzd->eof = 1;
+      break;
+    }
+
+    if (strm->avail_out == 0) {
+      strm->next_out = gzd->win;
+      strm->avail_out = GD_GZ_WINSIZE;
+    }
+
+    /* don't produce more than we've been asked for */
+    if (strm->avail_out > len - done) {
+      rest = strm->avail_out - (uInt)(len - done);
+      strm->avail_out -= rest;
+    }
+
+    /* after an append, the total may be known before the index is complete */
+    building = (gzd->out >= gzd->indexed);
+    from = strm->next_out;
+    avail_in = strm->avail_in;
+
+    ret = inflate(strm, building ? Z_BLOCK : Z_NO_FLUSH);
+
+    strm->avail_out += rest;
+    k = strm->next_out - from;
+    if (k > 0) {
+      if (ptr)
+        memcpy(ptr + done, from, k);
+      done += k;
+      gzd->out += k;
+    }
+
+    if (building && gzd->out > gzd->indexed)
+      gzd->indexed = gzd->out;
+
+    if (ret == Z_OK || ret == Z_STREAM_END || ret == Z_BUF_ERROR)
+      if (k > 0 || strm->avail_in < avail_in)
+        gzd->member = 0;
+
+    if (ret == Z_OK) {
+      if (building && strm->data_type & 128 && !(strm->data_type & 64) &&
+          gzd->out - ((gzd->n_point > 0) ? gzd->point[gzd->n_point - 1].out :
+            0) >= GD_GZ_SPAN)
+      {
+        _GD_GzipAddPoint(gzd);
+      }
+    } else if (ret == Z_STREAM_END) {
+      if (gzd->raw)
+        gzd->skip = 8;
+      else {
+        inflateReset(strm);
+        gzd->member = 1;
+      }
+    } else if (ret == Z_BUF_ERROR) {
+      /* no progress possible: the file is truncated */
+      if (strm->avail_in == 0 && gzd->in_eof)
+        gzd->eof = 1;
+    } else if (gzd->member && ret == Z_DATA_ERROR) {
+      /* trailing garbage after the last member: ignore it, as gzip does */
+      gzd->eof = 1;
+    } else {
+      gzd->zerr = ret;
+      dreturn("%i", -1);
+      return -1;
+    }
+  }
+
+  /* now we know how long it is */
+  if (gzd->eof && gzd->total < 0) {
+    gzd->total = gzd->indexed = gzd->out;
+    gzd->dirty = 1;
+  }
+
+  dreturn("%" PRIuSIZE, done);
+  return (ssize_t)done;
+}
+
+int _GD_GzipOpen(int fd, struct gd_raw_file_* file, gd_type_t data_type,
+    int swap gd_unused_, unsigned int mode)
+{
+  struct gd_gzdata_ *gzd;
+
+  dtrace("%i, %p, 0x%X, <unused>, 0x%X", fd, file, data_type, mode);
 
   if (mode & GD_FILE_READ) {
     file->idata = gd_OpenAt(file->D, fd, file->name, O_RDONLY | O_BINARY, 0666);
-    gzmode = "r";
   } else if (mode & GD_FILE_TEMP) {
     file->idata = _GD_MakeTempFile(file->D, fd, file->name);
+  } else if (mode & GD_FILE_APPEND) {
+    file->idata = gd_OpenAt(file->D, fd, file->name,
+        O_RDWR | O_APPEND | O_BINARY, 0666);
   } else { /* internal error */
     dreturn("%i", 1);
     errno = EINVAL; /* I guess ... ? */
@@ -61,28 +652,82 @@ int _GD_GzipOpen(int fd, struct gd_raw_file_* file,
     return 1;
   }
 
-  file->edata = gzdopen(file->idata, gzmode);
-
-  if (file->edata == NULL) {
+  gzd = calloc(1, sizeof(*gzd));
+  if (gzd == NULL) {
     close(file->idata);
     errno = ENOMEM;
     file->idata = -1;
     dreturn("%i", 1);
     return 1;
   }
+  gzd->dirfd = fd;
+  gzd->total = -1;
 
+  if (mode & GD_FILE_READ) {
+    if (inflateInit2(&gzd->strm, 15 + 32) != Z_OK) {
+      free(gzd);
+      close(file->idata);
+      errno = ENOMEM;
+      file->idata = -1;
+      dreturn("%i", 1);
+      return 1;
+    }
+
+    gzd->strm.next_out = gzd->win;
+    gzd->strm.avail_out = GD_GZ_WINSIZE;
+    gzd->member = 1;
+
+    if (_GD_FileStamp(file->idata, &gzd->stamp) == 0)
+      _GD_GzipLoadIndex(file->D, fd, file->name, gzd, 1);
+  } else {
+    if (mode & GD_FILE_APPEND) {
+      /* find out exactly how much data there is already; if we can't, we
+       * can't append.  The index, if there is one, is kept for
+       * _GD_GzipFinishWrite to update */
+      if (_GD_FileStamp(file->idata, &gzd->stamp) == 0)
+        _GD_GzipLoadIndex(file->D, fd, file->name, gzd, 1);
+
+      if (gzd->total >= 0)
+        gzd->base = gzd->total;
+      else if (_GD_GzipTailSize(file->idata, &gzd->base, 1)) {
+        _GD_GzipFreeIndex(gzd);
+        free(gzd);
+        close(file->idata);
+        file->idata = -1;
+        dreturn("%i", 1);
+        return 1;
+      }
+    }
+
+    gzd->gz = gzdopen(file->idata, (mode & GD_FILE_APPEND) ? "a" : "w");
+
+    if (gzd->gz == NULL) {
+      _GD_GzipFreeIndex(gzd);
+      free(gzd);
+      close(file->idata);
+      errno = ENOMEM;
+      file->idata = -1;
+      dreturn("%i", 1);
+      return 1;
+    }
+  }
+
+  file->edata = gzd;
   file->mode = mode;
-  file->pos = 0;
+  file->pos = gzd->base / GD_SIZE(data_type);
   dreturn("%i", 0);
   return 0;
 }
 
 off64_t _GD_GzipSeek(struct gd_raw_file_* file, off64_t offset,
-    gd_type_t data_type, unsigned int mode)
+    gd_type_t data_type, unsigned int mode gd_unused_)
 {
+  struct gd_gzdata_ *gzd = (struct gd_gzdata_ *)file->edata;
+  const struct gd_gzpoint_ *p = NULL;
   off64_t n = 0;
+  size_t lo, hi;
 
-  dtrace("%p, %" PRId64 ", 0x%X, 0x%X", file, (int64_t)offset, data_type, mode);
+  dtrace("%p, %" PRId64 ", 0x%X, <unused>", file, (int64_t)offset, data_type);
 
   if (file->pos == offset) {
     dreturn("%" PRId64, (int64_t)offset);
@@ -91,17 +736,48 @@ off64_t _GD_GzipSeek(struct gd_raw_file_* file, off64_t offset,
 
   offset *= GD_SIZE(data_type);
 
-  n = gd_gzseek((gzFile)file->edata, offset, SEEK_SET);
+  if (gzd->gz) {
+    /* the gzFile only knows about the member it's writing */
+    n = gd_gzseek(gzd->gz, offset - gzd->base, SEEK_SET);
 
-  if (n == -1) {
-    /* some implementations of gzseek return error on attempts to seek past the
-     * EOF in read mode, and set the position to the EOF. */
-    if (mode != GD_FILE_WRITE && gzeof((gzFile)file->edata))
-      n = gd_gztell((gzFile)file->edata);
-    else {
+    if (n == -1) {
       dreturn("%i", -1);
       return -1;
     }
+    n += gzd->base;
+  } else {
+    /* find the last access point at or before offset */
+    for (lo = 0, hi = gzd->n_point; lo < hi; ) {
+      size_t mid = (lo + hi) / 2;
+      if (gzd->point[mid].out <= offset)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    if (lo > 0)
+      p = gzd->point + lo - 1;
+
+    /* go back, or skip ahead, if we can't get there from here more cheaply */
+    if (offset < gzd->out || (p && p->out > gzd->out)) {
+      if (p ? _GD_GzipRestore(file, gzd, p) : _GD_GzipRestart(file, gzd)) {
+        dreturn("%i", -1);
+        return -1;
+      }
+    }
+
+    /* inflate the rest of the way.  If we hit the end of the data, we stop
+     * there */
+    while (gzd->out < offset && !gzd->eof) {
+      const off64_t want = offset - gzd->out;
+      if (_GD_GzipInflate(file, gzd, NULL, (want > GD_SSIZE_T_MAX) ?
+            GD_SSIZE_T_MAX : (size_t)want) < 0)
+      {
+        dreturn("%i", -1);
+        return -1;
+      }
+    }
+
+    n = gzd->out;
   }
 
   n /= GD_SIZE(data_type);
@@ -115,22 +791,18 @@ ssize_t _GD_GzipRead(struct gd_raw_file_ *file, void *ptr, gd_type_t data_type,
     size_t nmemb)
 {
   ssize_t n;
-  int errnum;
 
   dtrace("%p, %p, 0x%X, %" PRIuSIZE, file, ptr, data_type, nmemb);
 
-  n = gzread((gzFile)file->edata, ptr, GD_SIZE(data_type) * nmemb);
+  n = _GD_GzipInflate(file, (struct gd_gzdata_ *)file->edata, (Bytef *)ptr,
+      GD_SIZE(data_type) * nmemb);
 
   if (n >= 0) {
     n /= GD_SIZE(data_type);
     file->pos += n;
-  } else {
-    gzerror((gzFile)file->edata, &errnum);
-    if (errnum < 0)
-      n = -1;
   }
 
-  dreturn("%" PRIuSIZE, n);
+  dreturn("%" PRIdSIZE, n);
   return n;
 }
 
@@ -139,16 +811,17 @@ ssize_t _GD_GzipWrite(struct gd_raw_file_ *file, const void *ptr,
 {
   ssize_t n;
   int errnum;
+  gzFile gz = ((struct gd_gzdata_ *)file->edata)->gz;
 
   dtrace("%p, %p, 0x%X, %" PRIuSIZE, file, ptr, data_type, nmemb);
 
-  n = gzwrite((gzFile)file->edata, ptr, GD_SIZE(data_type) * nmemb);
+  n = gzwrite(gz, ptr, GD_SIZE(data_type) * nmemb);
 
   if (n > 0) {
     n /= GD_SIZE(data_type);
     file->pos += n;
   } else {
-    gzerror((gzFile)file->edata, &errnum);
+    gzerror(gz, &errnum);
     if (errnum < 0)
       n = -1;
   }
@@ -160,28 +833,52 @@ ssize_t _GD_GzipWrite(struct gd_raw_file_ *file, const void *ptr,
 int _GD_GzipClose(struct gd_raw_file_ *file)
 {
   int ret;
+  struct gd_gzdata_ *gzd = (struct gd_gzdata_ *)file->edata;
 
   dtrace("%p", file);
 
-  ret = gzclose((gzFile)file->edata);
-  if (ret) {
-    dreturn("%i", ret);
-    return ret;
+  if (gzd->gz) {
+    const off64_t written = gd_gztell(gzd->gz);
+
+    ret = gzclose(gzd->gz);
+    if (ret) {
+      dreturn("%i", ret);
+      return ret;
+    }
+
+    ret = _GD_GzipFinishWrite(file, gzd, gzd->base + written);
+    _GD_GzipFreeIndex(gzd);
+  } else {
+    /* when a file is read for an out-of-place write, it's about to be
+     * replaced, so there's no point saving its index */
+    if (gzd->dirty && !(file->mode & GD_FILE_WRITE))
+      _GD_GzipSaveIndex(file, gzd);
+
+    ret = close(file->idata);
+    if (ret) {
+      dreturn("%i", ret);
+      return ret;
+    }
+
+    inflateEnd(&gzd->strm);
+    _GD_GzipFreeIndex(gzd);
   }
 
+  free(gzd);
   file->idata = -1;
   file->edata = NULL;
   file->mode = 0;
 
-  dreturn("%i", 0);
-  return 0;
+  dreturn("%i", ret);
+  return ret;
 }
 
 off64_t _GD_GzipSize(int dirfd, struct gd_raw_file_ *file, gd_type_t data_type,
     int swap gd_unused_)
 {
   int fd;
-  uint32_t size = 0;
+  off64_t size;
+  struct gd_gzdata_ gzd;
 
   dtrace("%i, %p, 0x%X, <unused>", dirfd, file, data_type);
 
@@ -191,27 +888,31 @@ off64_t _GD_GzipSize(int dirfd, struct gd_raw_file_ *file, gd_type_t data_type,
     return -1;
   }
 
-  /* seek to the end */
-  if (lseek64(fd, -4, SEEK_END) == -1) {
-    dreturn("%i", -1);
-    return -1;
+  /* the index knows the size exactly, if it's complete; the ISIZE field of the
+   * trailer only knows the size of the last member, modulo 2**32 */
+  gzd.total = -1;
+  gzd.point = NULL;
+  gzd.n_point = 0;
+  if (_GD_FileStamp(fd, &gzd.stamp) == 0)
+    _GD_GzipLoadIndex(file->D, dirfd, file->name, &gzd, 0);
+
+  if (gzd.total >= 0) {
+    close(fd);
+    dreturn("%" PRId64 " (indexed)", (int64_t)(gzd.total / GD_SIZE(data_type)));
+    return gzd.total / GD_SIZE(data_type);
   }
-  if (read(fd, &size, 4) < 4) {
+
+  if (_GD_GzipTailSize(fd, &size, 0)) {
+    close(fd);
     dreturn("%i", -1);
     return -1;
   }
 
-  /* the checksum size is stored little endian */
-#ifdef WORDS_BIGENDIAN
-  size = (size << 24) | ((size << 8) & 0x00ff0000)
-    | (size >> 24) | ((size >> 8) & 0x0000ff00);
-#endif
-
   close(fd);
 
   size /= GD_SIZE(data_type);
 
-  dreturn("%" PRIu32, size);
+  dreturn("%" PRId64, (int64_t)size);
   return size;
 }
 
@@ -220,11 +921,18 @@ int _GD_GzipStrerr(const struct gd_raw_file_ *file, char *buf, size_t buflen)
   int r = 0;
   int gzerrnum = 0;
   const char *gzerr = NULL;
+  const struct gd_gzdata_ *gzd = (const struct gd_gzdata_ *)file->edata;
 
   dtrace("%p, %p, %" PRIuSIZE, file, buf, buflen);
 
-  if (file->edata)
-    gzerr = gzerror((gzFile)file->edata, &gzerrnum);
+  if (gzd) {
+    if (gzd->gz)
+      gzerr = gzerror(gzd->gz, &gzerrnum);
+    else if (gzd->zerr != Z_OK && gzd->zerr != Z_ERRNO) {
+      gzerrnum = gzd->zerr;
+      gzerr = gzd->strm.msg ? gzd->strm.msg : zError(gzd->zerr);
+    }
+  }
 
   if (gzerrnum == Z_ERRNO || gzerr == NULL)
     r = gd_StrError(errno, buf, buflen);
@@ -202,6 +202,7 @@ int _GD_Include(DIRFILE *D, struct parser_state *p, const char *ename,
   FILE* new_fp = NULL;
   time_t mtime = 0;
   struct stat statbuf;
+  struct gd_stamp_ stamp;
 
   dtrace("%p, %p, \"%s\", %p, %i, \"%s\", \"%s\", %i", D, p, ename, ref_name,
       parent, pxin, sxin, immediate);
@@ -305,6 +306,11 @@ int _GD_Include(DIRFILE *D, struct parser_state *p, const char *ename,
   if (fstat(i, &statbuf) == 0)
     mtime = statbuf.st_mtime;
 
+  /* and its stamp, if we're going to save a snapshot */
+  stamp.size = -1;
+  if (p->flags & GD_SNAPSHOT && _GD_FileStamp(i, &stamp))
+    stamp.size = -1;
+
   /* If we got here, we managed to open the included file; parse it */
   ptr = _GD_Realloc(D, D->fragment, (++D->n_fragment) * sizeof(D->fragment[0]));
   if (ptr == NULL) {
@@ -341,6 +347,8 @@ int _GD_Include(DIRFILE *D, struct parser_state *p, const char *ename,
   D->fragment[me].nsl = nsl;
   D->fragment[me].mtime = mtime;
   D->fragment[me].vers = (p->pedantic) ? 1ULL << p->standards : 0;
+  D->fragment[me].lazy = 0;
+  D->fragment[me].stamp = stamp;
 
   /* compute the (relative) subdirectory name */
   if (sname[0] == '.' && sname[1] == '\0') {
@@ -370,7 +378,20 @@ int _GD_Include(DIRFILE *D, struct parser_state *p, const char *ename,
     goto include_error;
   }
 
-  *ref_name = _GD_ParseFragment(new_fp, D, p, me, immediate);
+  /* With GD_LAZY_INCLUDE, just register the fragment: it's parsed by
+   * _GD_ParseLazy when needed.  This is only possible when nothing in the
+   * fragment can affect the parsing of the rest of its parent (ie. no /VERSION
+   * leak; see below). */
+  if (!immediate && p->flags & GD_LAZY_INCLUDE && oldp.pedantic &&
+      oldp.standards >= 9)
+  {
+    D->fragment[me].lazy = 1;
+    D->fragment[me].lazy_standards = p->standards;
+    D->fragment[me].lazy_flags = p->flags;
+    D->n_lazy++;
+    *ref_name = NULL;
+  } else
+    *ref_name = _GD_ParseFragment(new_fp, D, p, me, immediate);
 
   fclose(new_fp);
 
@@ -411,6 +432,196 @@ include_error:
   return -1;
 }
 
+/* Parse a fragment registered by _GD_Include with GD_LAZY_INCLUDE.  The new
+ * entries are appended as a bulk addition (see _GD_InsertSort), since our
+ * caller may be in the middle of a walk through the entry list. */
+static void _GD_ParseLazyFragment(DIRFILE *D, int me)
+{
+  int i, fd;
+  FILE *fp;
+  char *ref_name;
+  gd_entry_t *E, *old_ref = D->reference_field;
+  const int add_batch = D->add_batch;
+  struct parser_state p = { NULL, 0, 0, GD_PEDANTIC, NULL, 0, 0 };
+
+  dtrace("%p, %i", D, me);
+
+  /* Whatever happens, we only try this once */
+  D->fragment[me].lazy = 0;
+  D->n_lazy--;
+
+  fd = gd_OpenAt(D, D->fragment[me].dirfd, D->fragment[me].bname,
+      O_RDONLY | O_BINARY, 0666);
+  if (fd < 0) {
+    _GD_SetError(D, GD_E_IO, GD_E_IO_INCL,
+        D->fragment[D->fragment[me].parent].cname, 0, D->fragment[me].cname);
+    dreturnvoid();
+    return;
+  }
+
+  fp = fdopen(fd, "rb");
+  if (fp == NULL) {
+    close(fd);
+    _GD_SetError(D, GD_E_IO, GD_E_IO_INCL,
+        D->fragment[D->fragment[me].parent].cname, 0, D->fragment[me].cname);
+    dreturnvoid();
+    return;
+  }
+
+  /* Reconstruct the parser state at the /INCLUDE.  The current namespace is
+   * always reset by an /INCLUDE in Standards Version 9 and later */
+  p.standards = D->fragment[me].lazy_standards;
+  p.flags = D->fragment[me].lazy_flags;
+
+  D->add_batch = 1;
+  ref_name = _GD_ParseFragment(fp, D, &p, me, 0);
+  D->add_batch = add_batch;
+
+  fclose(fp);
+  free(p.ns);
+
+  if (p.standards != D->fragment[me].lazy_standards)
+    D->flags |= GD_MULTISTANDARD;
+
+  /* propagate the versions to the ancestors; when parsed eagerly, this
+   * happens one level at a time in _GD_ParseDirective */
+  for (i = D->fragment[me].parent; i != -1; i = D->fragment[i].parent)
+    D->fragment[i].vers |= D->fragment[me].vers;
+
+  /* A /REFERENCE directive is only honoured if we didn't already have a
+   * reference field */
+  if (ref_name && !D->error && old_ref == NULL && ~p.flags & GD_IGNORE_REFS) {
+    E = _GD_FindField(D, ref_name, strlen(ref_name), D->entry, D->n_entries,
+        1, NULL);
+    if (E && E->field_type == GD_RAW_ENTRY)
+      D->reference_field = E;
+  }
+  free(ref_name);
+
+  D->fl.value_list_validity = 0;
+  D->fl.entry_list_validity = 0;
+  D->flags &= ~GD_HAVE_VERSION;
+  D->gen++;
+
+  dreturnvoid();
+}
+
+/* Returns non-zero if the code may be defined in fragment i, based on its
+ * affixes; also true of any fragment it includes */
+static int _GD_LazyMatch(const DIRFILE *D, int i, const char *code,
+    size_t len)
+{
+  const struct gd_fragment_t *F = D->fragment + i;
+  size_t j;
+
+  if (code[0] == '.' && len > 1) {
+    code++;
+    len--;
+  }
+
+  if (F->ns && (len <= F->nsl || code[F->nsl] != '.' ||
+        memcmp(code, F->ns, F->nsl)))
+  {
+    return 0;
+  }
+
+  if (F->px) {
+    for (j = 0; j + F->pxl <= len; ++j)
+      if (memcmp(code + j, F->px, F->pxl) == 0)
+        break;
+    if (j + F->pxl > len)
+      return 0;
+  }
+
+  if (F->sx) {
+    for (j = 0; j + F->sxl <= len; ++j)
+      if (memcmp(code + j, F->sx, F->sxl) == 0)
+        break;
+    if (j + F->sxl > len)
+      return 0;
+  }
+
+  return 1;
+}
+
+/* Parse the fragments which were registered, but not parsed, by
+ * _GD_Include because of GD_LAZY_INCLUDE.  If code is non-NULL, only those
+ * which might define it are parsed; otherwise, all of them are.  Fragments
+ * included by the ones parsed here are handled in the same way.  Returns the
+ * number of fragments parsed. */
+int _GD_ParseLazy(DIRFILE *restrict D, const char *restrict code, size_t len)
+{
+  int i, n = 0;
+
+  dtrace("%p, \"%s\", %" PRIuSIZE, D, code, len);
+
+  for (i = 0; D->n_lazy > 0 && i < D->n_fragment && !D->error; ++i)
+    if (D->fragment[i].lazy && (code == NULL ||
+          _GD_LazyMatch(D, i, code, len)))
+    {
+      _GD_ParseLazyFragment(D, i);
+      n++;
+    }
+
+  if (n && !D->error)
+    _GD_UpdateAliases(D, 0);
+
+  dreturn("%i", n);
+  return n;
+}
+
+/* A metadata write needs the whole dirfile: if it's writable, parse
+ * everything deferred by GD_LAZY_INCLUDE.  Returns non-zero on error. */
+int _GD_ParseLazyForWrite(DIRFILE *D)
+{
+  dtrace("%p", D);
+
+  if (D->n_lazy > 0 && (D->flags & GD_ACCMODE) == GD_RDWR)
+    _GD_ParseLazy(D, NULL, 0);
+
+  dreturn("%i", D->error);
+  return D->error;
+}
+
+/* Make sure fragment index, if it exists, has been parsed */
+void _GD_ParseLazyIndex(DIRFILE *D, int index)
+{
+  dtrace("%p, %i", D, index);
+
+  if (index >= D->n_fragment)
+    _GD_ParseLazy(D, NULL, 0);
+  else if (index >= 0 && D->fragment[index].lazy && !D->error) {
+    _GD_ParseLazyFragment(D, index);
+    if (!D->error)
+      _GD_UpdateAliases(D, 0);
+  }
+
+  dreturnvoid();
+}
+
+/* Parse fragments registered by GD_LAZY_INCLUDE, in order, until we find a
+ * reference field */
+void _GD_ParseLazyRef(DIRFILE *D)
+{
+  int i, n = 0;
+
+  dtrace("%p", D);
+
+  for (i = 0; D->n_lazy > 0 && D->reference_field == NULL &&
+      i < D->n_fragment && !D->error; ++i)
+  {
+    if (D->fragment[i].lazy) {
+      _GD_ParseLazyFragment(D, i);
+      n++;
+    }
+  }
+
+  if (n && !D->error)
+    _GD_UpdateAliases(D, 0);
+
+  dreturnvoid();
+}
+
 static int _GD_IncludeAffix(DIRFILE* D, const char *funcname, const char* file,
     int fragment_index, const char *px, const char *sx, unsigned long flags)
 {
@@ -432,6 +643,8 @@ static int _GD_IncludeAffix(DIRFILE* D, const char *funcname, const char* file,
 
   if ((D->flags & GD_ACCMODE) == GD_RDONLY) 
     GD_SET_RETURN_ERROR(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
+  else if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
   else if (fragment_index < 0 || fragment_index >= D->n_fragment) 
     GD_SET_RETURN_ERROR(D, GD_E_BAD_INDEX, 0, NULL, fragment_index, NULL);
   else if (D->fragment[fragment_index].protection & GD_PROTECT_FORMAT)
@@ -535,6 +748,7 @@ static int _GD_IncludeAffix(DIRFILE* D, const char *funcname, const char* file,
   /* Successful include.  Mark the parent as dirty */
   D->fragment[fragment_index].modified = 1;
   D->flags &= ~GD_HAVE_VERSION;
+  D->gen++;
 
   /* If ref_name is non-NULL, the included fragment contained a REFERENCE
    * directive.  If ref_name is NULL but D->fragment[new_fragment].ref_name is
@@ -637,6 +851,8 @@ int gd_uninclude(DIRFILE* D, int fragment_index, int del)
 
   if ((D->flags & GD_ACCMODE) == GD_RDONLY) 
     GD_SET_RETURN_ERROR(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
   if (fragment_index <= 0 || fragment_index >= D->n_fragment)
     GD_SET_RETURN_ERROR(D, GD_E_BAD_INDEX, 0, NULL, fragment_index, NULL);
 
@@ -694,6 +910,7 @@ int gd_uninclude(DIRFILE* D, int fragment_index, int del)
   /* Flag the parent as modified */
   D->fragment[parent].modified = 1;
   D->flags &= ~GD_HAVE_VERSION;
+  D->gen++;
 
   /* delete the fragments -- again, don't bother resizing D->fragment */
   for (j = 0; j < nf; ++j) {
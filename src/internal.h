@@ -356,6 +356,18 @@ double cimag(double _Complex z);
 /* the default mplex cycle length */
 #define GD_MPLEX_CYCLE 10
 
+/* the target number of samples per block when a derived field is evaluated
+ * block by block.  With a handful of complex-valued temporaries per node in
+ * the input tree, this keeps the working set inside a typical L2 cache */
+#define GD_EVAL_BLOCK 4096
+
+/* the number of samples whose LUT segments are found before they are
+ * interpolated together */
+#define GD_LINTERP_BLOCK 256
+
+/* the number of gd_counter() counters */
+#define GD_N_COUNTERS (GD_COUNTER_SNAPSHOT + 1)
+
 #ifdef _MSC_VER
 # define gd_static_inline_ static
 #else
@@ -869,6 +881,9 @@ ssize_t getdelim(char**, size_t*, int, FILE*);
 #define GD_E_FIELD_STR         5
 
 #define GD_E_SUPPORT_REGEX     1
+#define GD_E_SUPPORT_THREADS   2
+
+#define GD_E_CALLBACK_ABORT    1
 
 #define GD_E_ENTRY_TYPE      1
 #define GD_E_ENTRY_METARAW   2
@@ -922,6 +937,8 @@ ssize_t getdelim(char**, size_t*, int, FILE*);
 #define GD_E_ARG_BAD_VERS       6
 #define GD_E_ARG_REGEX          7
 #define GD_E_ARG_PCRE           8
+#define GD_E_ARG_COUNTER        9
+#define GD_E_ARG_HANDLE         10
 
 #define GD_E_LONG_FLUSH         1
 
@@ -934,6 +951,7 @@ ssize_t getdelim(char**, size_t*, int, FILE*);
 #define GD_FILE_RDWR  ( GD_FILE_READ | GD_FILE_WRITE )
 #define GD_FILE_TEMP  0x4
 #define GD_FILE_TOUCH 0x8
+#define GD_FILE_APPEND 0x10 /* write a new member at the end of the file */
 
 /* lists -- all the entry types plus alias, scalar, vector, all */
 #define GD_N_ENTRY_LISTS (GD_N_ENTYPES + 4)
@@ -999,8 +1017,21 @@ struct gd_raw_file_ {
   DIRFILE *D;
   unsigned int mode;
   off64_t pos;
+  int wb; /* non-zero while the write-behind worker is using the file */
+  unsigned int wb_seeks; /* index seeks made by the write-behind worker */
 };
 
+/* Count an index seek on file f.  The write-behind worker mustn't touch the
+ * DIRFILE, so its seeks are counted in the file, and added to the DIRFILE's
+ * counter later by the caller's thread */
+#define _GD_CountIndexSeek(f) \
+  do { \
+    if ((f)->wb) \
+      (f)->wb_seeks++; \
+    else \
+      (f)->D->counter[GD_COUNTER_INDEX_SEEK]++; \
+  } while (0)
+
 /* linterp table datum */
 struct gd_lut_ {
   double x;
@@ -1010,6 +1041,17 @@ struct gd_lut_ {
   } y;
 };
 
+/* LINTERP lookup index.  The table's abscissa range is split into n_bucket
+ * equal buckets; every x in bucket b lies in a segment between start[b] - 1
+ * and start[b + 1] - 1, which is usually one or two segments.  For real
+ * tables, the segments are also kept as separate x, y and slope arrays */
+struct gd_lutidx_ {
+  double x0, scale; /* the bucket of x is (x - x0) * scale */
+  size_t n_bucket;
+  size_t *start; /* n_bucket + 1 entries */
+  double *sx, *sy, *slope; /* n - 1 entries each; NULL for complex tables */
+};
+
 /* field lists */
 struct gd_flist_ {
   const char **entry_list[GD_N_ENTRY_LISTS];
@@ -1023,6 +1065,42 @@ struct gd_flist_ {
 };
 
 /* Unified entry struct */
+/* the count value index of an MPLEX: the samples of the count field, in the
+ * ranges of it which have been read, which hold the count value; valid while
+ * gen and data_gen equal D->gen and D->data_gen (see _GD_MplexIndex) */
+struct gd_mplex_idx_ {
+  unsigned long gen, data_gen;
+  off64_t *pos; /* sorted */
+  size_t n_pos, pos_size;
+  off64_t (*range)[2]; /* sorted, disjoint, half-open ranges */
+  size_t n_range, range_size;
+};
+
+/* a field handle */
+struct gd_handle_ {
+  gd_entry_t *E; /* NULL if the field has been deleted */
+  int repr;
+};
+
+/* a frame writer; see gd_frame_writer_open() */
+struct gd_frame_writer_ {
+  DIRFILE *D; /* NULL once the dirfile has been closed */
+  size_t n_fields;
+  struct gd_fw_field_ {
+    char *field_code;
+    gd_type_t type;
+    off64_t s0; /* the sample number of the first buffered frame */
+    unsigned int spf;
+    size_t frame_size; /* bytes per frame */
+    char *buffer;
+    size_t n_done; /* samples already written by an unfinished flush */
+  } *field;
+  int here; /* non-zero if writing at the I/O pointer */
+  size_t n_frames; /* frames buffered */
+  size_t buffer_frames; /* capacity of the buffers, in frames */
+  struct gd_frame_writer_ *next; /* the dirfile's list of writers */
+};
+
 struct gd_private_entry_ {
   size_t len; /* strlen(E->field) */
 
@@ -1041,13 +1119,29 @@ struct gd_private_entry_ {
   const char **alias_list;
   struct gd_flist_ fl;
 
+  /* blocked evaluation plan for derived fields; valid when plan_gen equals
+   * D->gen (see _GD_EvalPlan) */
+  unsigned long plan_gen;
+  size_t plan_block; /* samples per block, or zero for single-pass */
+
+  int handled; /* non-zero if a field handle refers to this entry */
+
   union {
     struct { /* RAW */
       char* filebase;
       size_t size; /* Data type size */
-      time_t atime; /* Access time, with second resolution */
+      uint64_t atime; /* Access count when last used; zero if closed */
       int fd_count; /* Number of open files */
+      /* the open file LRU list; see _GD_LRUTouch */
+      gd_entry_t *lru_prev, *lru_next;
+      int wb_pending; /* queued writes; see gd_write_behind */
       struct gd_raw_file_ file[2]; /* encoding framework data */
+      /* shared input cache; only non-NULL during gd_getdata_multi */
+      void *cache; /* native-type samples, endianness corrected */
+      off64_t cache_s0; /* first sample in the cache */
+      size_t cache_n; /* number of samples in the cache */
+      int cache_eof; /* the cache ends at the end of the field */
+      off64_t cache_pos; /* where the last read, if from the cache, ended */
     } raw;
     struct { /* LINTERP */
       char *table_file;
@@ -1056,6 +1150,9 @@ struct gd_private_entry_ {
       int complex_table;
       int table_monotonic;
       struct gd_lut_ *lut;
+      struct gd_lutidx_ idx;
+      void *map; /* if non-NULL, lut and idx are in this cache mapping */
+      size_t map_len;
     } linterp;
     struct { /* CONST */
       void *d;
@@ -1066,6 +1163,7 @@ struct gd_private_entry_ {
       gd_type_t type;
       off64_t sample;
       char d[16];
+      struct gd_mplex_idx_ *idx;
     } mplex;
     char *string; /* STRING */
     off64_t index_pos; /* INDEX */
@@ -1122,6 +1220,8 @@ typedef int (*gd_ef_strerr_t)(const struct gd_raw_file_*, char *, size_t);
 #define GD_EF_SWAP 0x2 /* in-framework byte-sex metadata correction occurs */
 #define GD_EF_OOP  0x4 /* writes occur out-of-place */
 #define GD_EF_EDAT 0x8 /* The /ENCODING datum is used */
+#define GD_EF_APPEND 0x10 /* OOP writes at EOF can be done in GD_FILE_APPEND
+                             mode */
 
 /* Just so we're clear on the difference between GD_EF_ECOR and GD_EF_SWAP:
  *
@@ -1177,6 +1277,14 @@ struct parser_state {
 #define GD_PVERS_GE(p, v) (!(p).pedantic || (p).standards >= (v))
 #define GD_PVERS_LT(p, v) (!(p).pedantic || (p).standards < (v))
 
+/* the stamp of a file, which tells whether a sidecar of it is current; see
+ * sidecar.c */
+struct gd_stamp_ {
+  int64_t size;
+  int64_t mtime;
+  unsigned char tail[8]; /* the last eight bytes of the file */
+};
+
 /* Format file fragment metadata */
 struct gd_fragment_t {
   char* cname; /* Canonical name (full path) */
@@ -1201,6 +1309,15 @@ struct gd_fragment_t {
   size_t pxl; /* strlen(px) */
   char *sx; /* suffix */
   size_t sxl; /* strlen(sx) */
+
+  /* deferred parsing; see _GD_ParseLazy */
+  int lazy; /* non-zero if registered, but not yet parsed */
+  int lazy_standards; /* the parser state at the /INCLUDE */
+  unsigned long lazy_flags;
+
+  /* the stamp of the file when it was parsed, for GD_SNAPSHOT; size is -1 if
+   * there's none; see _GD_SaveSnapshot */
+  struct gd_stamp_ stamp;
 };
 
 /* directory metadata */
@@ -1241,6 +1358,11 @@ struct gd_dirfile_ {
 
   /* global data */
   unsigned long int flags;
+  unsigned long int gen; /* metadata generation; bumped on every change */
+  unsigned long int data_gen; /* data generation; bumped on every write */
+
+  /* statistics counters; see gd_counter() */
+  uint64_t counter[GD_N_COUNTERS];
 
   char *error_prefix;
   unsigned long int open_flags; /* the original flags (used in gd_desynced) */
@@ -1251,8 +1373,8 @@ struct gd_dirfile_ {
 
   /* for TMOF avoidance */
   long open_limit, open_fds, open_raws;
-  int opened_sorted;
-  gd_entry_t **opened;
+  uint64_t access_count;
+  gd_entry_t *lru_head, *lru_tail; /* most and least recently used */
 
   /* for the public tokeniser */
   char *tok_base;
@@ -1264,6 +1386,33 @@ struct gd_dirfile_ {
   /* field array */
   gd_entry_t** entry;
 
+  /* hash of the field array, by field code; see _GD_FindField */
+  gd_entry_t **hash;
+  unsigned int hash_size; /* a power of two, or zero if not built */
+
+  /* field handles; see gd_field_handle() */
+  struct gd_handle_ *handle;
+  int n_handle, handle_size;
+
+  /* bulk addition; see gd_add_begin() */
+  int add_batch; /* non-zero between gd_add_begin() and gd_add_commit() */
+  int unsorted; /* non-zero if entries have been appended out of order */
+
+  /* the number of fragments awaiting a lazy parse; see GD_LAZY_INCLUDE */
+  int n_lazy;
+
+  /* open frame writers; see gd_frame_writer_open() */
+  struct gd_frame_writer_ *writer;
+
+  /* the write-behind queue; see gd_write_behind() */
+  struct gd_wb_ *wb;
+
+  /* data conversion; see gd_move_threads() and gd_move_callback() */
+  int move_threads;
+  uint64_t move_rate;
+  gd_move_callback_t move_callback;
+  void *move_extra;
+
   /* the reference field */
   gd_entry_t* reference_field;
 
@@ -1299,9 +1448,15 @@ extern void (*_GD_CFree)(void*);
  */
 #ifdef USE_MODULES
 /* Alias the internal symbols to the external ones */
+#define _GD_CreateSidecar gd_CreateSidecar
+#define _GD_FileStamp gd_FileStamp
+#define _GD_FinishSidecar gd_FinishSidecar
 #define _GD_MakeFullPathOnly gd_MakeFullPathOnly
 #define _GD_MakeTempFile gd_MakeTempFile
+#define _GD_MoveSidecar gd_MoveSidecar
+#define _GD_OpenSidecar gd_OpenSidecar
 #define _GD_StrError gd_StrError
+#define _GD_UnlinkSidecar gd_UnlinkSidecar
 
 #ifdef __cplusplus
 extern "C" {
@@ -1314,6 +1469,18 @@ extern "C" {
 #define gd_MakeTempFile _GD_MakeTempFile
 #endif
 
+/* sidecar index files; see sidecar.c */
+#define GD_SIDECAR_SUFFIX ".gdidx"
+
+#define _GD_SidecarRead(fd,buf,len) (read(fd,buf,len) != (ssize_t)(len))
+#define _GD_SidecarWrite(fd,buf,len) (write(fd,buf,len) != (ssize_t)(len))
+
+/* Non-zero if a count of n records of len bytes each, read from a sidecar,
+ * can't be right: each record indexes at least one byte of the data file,
+ * whose stamp is s, and they all have to fit in memory */
+#define _GD_SidecarBadCount(n,len,s) \
+  ((n) > (uint64_t)(s)->size || (n) > GD_SIZE_T_MAX / (len))
+
 #if !defined HAVE_STRERROR_R || defined STRERROR_R_CHAR_P
 int _GD_StrError(int errnum, char *buf, size_t buflen);
 #else
@@ -1326,6 +1493,14 @@ int _GD_StrError(int errnum, char *buf, size_t buflen);
 
 char *_GD_MakeFullPathOnly(const DIRFILE *D, int dirfd, const char *name);
 int _GD_MakeTempFile(const DIRFILE*, int, char*);
+int _GD_CreateSidecar(const DIRFILE*, int, const char*, const char*,
+    const struct gd_stamp_*, char**);
+int _GD_FileStamp(int, struct gd_stamp_*);
+int _GD_FinishSidecar(const DIRFILE*, int, const char*, int, char*, int);
+void _GD_MoveSidecar(const DIRFILE*, int, const char*, int, const char*);
+int _GD_OpenSidecar(const DIRFILE*, int, const char*, const char*,
+    const struct gd_stamp_*);
+void _GD_UnlinkSidecar(const DIRFILE*, int, const char*);
 
 #ifdef USE_MODULES
 #ifdef __cplusplus
@@ -1336,6 +1511,7 @@ int _GD_MakeTempFile(const DIRFILE*, int, char*);
 
 /* forward declarations */
 void *_GD_Alloc(DIRFILE*, gd_type_t, size_t) __attribute_malloc__;
+int _GD_AppendRawIO(DIRFILE*, gd_entry_t*, off64_t);
 int _GD_AutoClose(DIRFILE*, int);
 
 #define _GD_BadWindop(op) \
@@ -1372,6 +1548,7 @@ int _GD_ContainsFragment(const int *, int, int);
 void _GD_ConvertType(DIRFILE *restrict, const void *restrict, gd_type_t,
     void *restrict, gd_type_t, size_t) gd_nothrow;
 gd_type_t _GD_ConstType(DIRFILE *D, gd_type_t type);
+void _GD_DetachFrameWriters(DIRFILE *D);
 const char *_GD_DirName(const DIRFILE *D, int dirfd);
 size_t _GD_DoField(DIRFILE *restrict, gd_entry_t *restrict, int, off64_t,
     size_t, gd_type_t, void *restrict);
@@ -1381,7 +1558,7 @@ off64_t _GD_DoSeek(DIRFILE *restrict, gd_entry_t *restrict,
     const struct encoding_t *restrict, off64_t, unsigned int mode);
 int _GD_EntryCmp(const void*, const void*);
 gd_entry_t *_GD_FindEntry(DIRFILE *restrict, const char *restrict);
-gd_entry_t *_GD_FindField(const DIRFILE *restrict, const char *restrict,
+gd_entry_t *_GD_FindField(DIRFILE *restrict, const char *restrict,
     size_t, gd_entry_t *const *, unsigned int, int, unsigned int *restrict);
 gd_entry_t *_GD_FindFieldAndRepr(DIRFILE *restrict, const char *restrict,
     int *restrict, unsigned int *restrict, int);
@@ -1391,10 +1568,15 @@ void _GD_FixEndianness(void*, size_t, gd_type_t, unsigned, unsigned);
 int _GD_FileSwapBytes(const DIRFILE *restrict, const gd_entry_t *restrict);
 int _GD_FiniRawIO(DIRFILE*, const gd_entry_t*, int, int);
 void _GD_Flush(DIRFILE *restrict, gd_entry_t *restrict, int, int);
+int _GD_FlushFrameWriters(DIRFILE *D);
 void _GD_FlushMeta(DIRFILE* D, int fragment, int force);
 void _GD_FreeE(DIRFILE *restrict, gd_entry_t *restrict, int);
 void _GD_FreeF(DIRFILE *restrict, int, int);
 void _GD_FreeFL(struct gd_flist_ *);
+void _GD_FreeLut(struct gd_private_entry_ *);
+void _GD_HashClear(DIRFILE *);
+void _GD_HashDelete(DIRFILE *restrict, const gd_entry_t *restrict);
+void _GD_FreeLutIndex(struct gd_lutidx_ *);
 off64_t _GD_GetEOF(DIRFILE *restrict, gd_entry_t *restrict,
     const char *restrict, int *restrict);
 off64_t _GD_GetIOPos(DIRFILE *restrict, gd_entry_t *restrict, off64_t);
@@ -1417,19 +1599,49 @@ void _GD_InsertSort(DIRFILE *restrict, gd_entry_t *restrict, int u) gd_nothrow;
   _GD_SetError(D, GD_E_INTERNAL_ERROR, 0, __FILE__, __LINE__, NULL)
 
 int _GD_InvalidEntype(gd_entype_t t);
+
+/* kernel levels; see kernel.c */
+#define GD_KERNEL_BEST   -1
+#define GD_KERNEL_SCALAR  0
+#define GD_KERNEL_SSE2    1
+#define GD_KERNEL_AVX2    2
+#define GD_KERNEL_NEON    3
+#define GD_N_KERNELS      4
+void _GD_KernelBits(void*, size_t, int, int, int, int);
+int _GD_KernelConvert(const void*, gd_type_t, void*, gd_type_t, size_t);
+int _GD_KernelInit(int);
+void _GD_KernelLinterp(double*, const double*, const int32_t*, size_t,
+    const double*, const double*, const double*);
+void _GD_KernelLincom(int, double *restrict, const double *restrict,
+    const double *restrict, const double *restrict, const double *restrict,
+    size_t);
+const char *_GD_KernelName(int);
+int _GD_KernelPolynom(int, const double*, const void*, gd_type_t, void*,
+    gd_type_t, size_t);
+void _GD_KernelSwap(void*, size_t, int);
+
 gd_type_t _GD_LegacyType(char c);
 void _GD_LincomData(DIRFILE *restrict, int n, void *restrict,
     gd_type_t return_type, const double *restrict, const double *restrict,
     const double *restrict, const double *restrict,
     const unsigned int *restrict, size_t);
 void _GD_LinterpData(DIRFILE *restrict, void*, gd_type_t, int,
-    const double*, size_t, const struct gd_lut_ *restrict, size_t);
+    const double*, size_t, const struct gd_lut_ *restrict, size_t,
+    const struct gd_lutidx_ *restrict);
 int _GD_ListEntry(const gd_entry_t*, int, int, int, int, int, gd_entype_t);
+int _GD_LoadSnapshot(DIRFILE *restrict, struct parser_state *restrict);
+void _GD_LRUPush(DIRFILE *restrict, gd_entry_t *restrict);
+void _GD_LRURemove(DIRFILE *restrict, const gd_entry_t *restrict);
+void _GD_LRUTouch(DIRFILE *restrict, gd_entry_t *restrict);
+int _GD_LutIndex(DIRFILE *restrict, const struct gd_lut_ *restrict, size_t,
+    int, struct gd_lutidx_ *restrict);
 char *_GD_MakeFullPath(DIRFILE *restrict, int, const char *restrict, int);
 void *_GD_Malloc(DIRFILE *D, size_t size) __attribute_malloc__;
 int _GD_MissingFramework(int encoding, unsigned int funcs);
 int _GD_MogrifyFile(DIRFILE *restrict, gd_entry_t *restrict, unsigned long int,
     unsigned long int, off64_t, int, int, char *restrict);
+unsigned int _GD_MogrifyFields(DIRFILE *restrict, gd_entry_t **restrict,
+    unsigned int, unsigned long int, unsigned long int, off64_t);
 gd_type_t _GD_NativeType(DIRFILE *restrict, gd_entry_t *restrict, int);
 char *_GD_NormaliseNamespace(DIRFILE *restrict, const char *restrict,
     size_t *restrict) __attribute_malloc__;
@@ -1438,12 +1650,18 @@ gd_entry_t *_GD_ParseFieldSpec(DIRFILE *restrict,
     const gd_entry_t *restrict, int, int, int, char **, const char *);
 char *_GD_ParseFragment(FILE *restrict, DIRFILE*, struct parser_state *restrict,
     int, int);
+int _GD_ParseLazy(DIRFILE *restrict, const char *restrict, size_t);
+int _GD_ParseLazyForWrite(DIRFILE*);
+void _GD_ParseLazyIndex(DIRFILE*, int);
+void _GD_ParseLazyRef(DIRFILE*);
 void _GD_PerformRename(DIRFILE *restrict, struct gd_rename_data_ *restrict);
 struct gd_rename_data_ *_GD_PrepareRename(DIRFILE *restrict, char *restrict,
     size_t, gd_entry_t *restrict, int, unsigned);
 int _GD_ReadLinterpFile(DIRFILE *restrict, gd_entry_t *restrict);
 void *_GD_Realloc(DIRFILE *restrict, void *restrict, size_t size);
 void _GD_ReleaseDir(DIRFILE *D, int dirfd);
+void _GD_ReverseLut(struct gd_lut_ *, size_t);
+void _GD_SaveSnapshot(DIRFILE*);
 int _GD_SlashDot(const char*, size_t, unsigned, const char**, const char**);
 int _GD_Seek(DIRFILE *restrict, gd_entry_t *restrict, off64_t offset,
     unsigned int mode);
@@ -1455,6 +1673,7 @@ int _GD_SetTablePath(DIRFILE *restrict, const gd_entry_t *restrict,
 void _GD_SimpleParserInit(DIRFILE *restrict D, const char *restrict name,
     struct parser_state *restrict p);
 int _GD_ShutdownDirfile(DIRFILE*, int, int);
+void _GD_SortEntries(DIRFILE*) gd_nothrow;
 int _GD_StrCmpNull(const char *restrict, const char *restrict);
 char *_GD_Strdup(DIRFILE *restrict, const char *restrict);
 char *_GD_StripCode(DIRFILE *restrict, int, const char *restrict, unsigned)
@@ -1469,10 +1688,28 @@ void _GD_UpdateAliases(DIRFILE*, int);
 char *_GD_UpdateCode(DIRFILE *restrict, int, const char *restrict, int,
     const char *restrict, size_t, const char *restrict, size_t,
     const char *restrict, size_t) __attribute_malloc__;
+void _GD_UpdateVersion(DIRFILE *restrict, const gd_entry_t *restrict);
 int _GD_ValidateField(const char*, size_t, int, int, unsigned);
+int _GD_WidenInPlace(void *, gd_type_t, gd_type_t, size_t) gd_nothrow;
 ssize_t _GD_WriteOut(const gd_entry_t*, const struct encoding_t*, const void*,
     gd_type_t, size_t, int);
 
+/* write-behind; these do nothing unless gd_write_behind() is in effect */
+#ifdef USE_PTHREAD
+void _GD_WBCounters(DIRFILE *D);
+int _GD_WBDrain(DIRFILE *D);
+int _GD_WBQueue(DIRFILE *restrict, gd_entry_t *restrict, off64_t, size_t,
+    gd_type_t, const void *restrict);
+void _GD_WBStop(DIRFILE *D);
+void _GD_WBWait(DIRFILE *restrict, const gd_entry_t *restrict);
+#else
+#define _GD_WBCounters(D)
+#define _GD_WBDrain(D) ((D)->error)
+#define _GD_WBQueue(D,E,s0,ns,t,p) (_GD_InternalError(D), (D)->error)
+#define _GD_WBStop(D)
+#define _GD_WBWait(D,E)
+#endif
+
 /* generic I/O methods */
 int _GD_GenericMove(int, struct gd_raw_file_ *restrict, int, char *restrict);
 int _GD_GenericName(DIRFILE *restrict, const char *restrict,
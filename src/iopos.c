@@ -41,6 +41,18 @@ off64_t _GD_GetIOPos(DIRFILE *D, gd_entry_t *E, off64_t index_pos)
 
   switch (E->field_type) {
     case GD_RAW_ENTRY:
+      _GD_WBWait(D, E);
+
+      /* An append has no read-side file, but the write side knows where it
+       * is */
+      if (E->e->u.raw.file[1].idata >= 0 &&
+          (E->e->u.raw.file[1].mode & GD_FILE_APPEND))
+      {
+        pos = E->e->u.raw.file[1].pos + E->EN(raw,spf) *
+          D->fragment[E->fragment_index].frame_offset;
+        break;
+      }
+
       /* We must open the file to know its starting offset */
       if (E->e->u.raw.file[0].idata < 0)
         if (_GD_InitRawIO(D, E, NULL, -1, NULL, 0, GD_FILE_READ,
@@ -154,6 +166,8 @@ off64_t _GD_DoSeek(DIRFILE *D, gd_entry_t *E, const struct encoding_t *enc,
 
   dtrace("%p, %p, %p, %" PRId64 ", 0x%X", D, E, enc, (int64_t)offset, mode);
 
+  _GD_WBWait(D, E);
+
   /* Yet another overflow check */
   if (GD_SIZE(E->EN(raw,data_type)) > 0 &&
       offset > GD_INT64_MAX / GD_SIZE(E->EN(raw,data_type)))
@@ -162,6 +176,10 @@ off64_t _GD_DoSeek(DIRFILE *D, gd_entry_t *E, const struct encoding_t *enc,
   }
 
   if (oop_write) {
+    /* at the end of the data, we may be able to append instead */
+    if (mode == GD_FILE_WRITE && _GD_AppendRawIO(D, E, offset))
+      GD_RETURN_ERROR(D);
+
     /* in this case we need to close and then re-open the file */
     if (offset < E->e->u.raw.file[1].pos) {
       if (_GD_FiniRawIO(D, E, E->fragment_index, GD_FINIRAW_KEEP))
@@ -250,9 +268,8 @@ off64_t _GD_DoSeek(DIRFILE *D, gd_entry_t *E, const struct encoding_t *enc,
     GD_RETURN_ERROR(D);
   }
 
-  /* Update atime */
-  E->e->u.raw.atime = time(NULL);
-  D->opened_sorted = 0;
+  /* Move to the front of the open list */
+  _GD_LRUTouch(D, E);
 
   dreturn("%" PRId64, (int64_t)pos);
   return pos;
@@ -0,0 +1,1166 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+#include "internal.h"
+
+/* Vectorised versions of the inner loops which dominate the CPU time of
+ * reads: byte swapping (_GD_FixEndianness), type conversion (_GD_ConvertType
+ * and _GD_WidenInPlace), LINCOM and POLYNOM evaluation (_GD_LincomData and
+ * _GD_PolynomData) and bit extraction (_GD_DoBit).
+ *
+ * Every kernel has a portable scalar version.  On x86, when compiled with GCC
+ * or Clang, there are also SSE2 and AVX2 versions, one of which is chosen at
+ * run time according to what the CPU supports; on AArch64, there are NEON
+ * versions.  The vector versions give bit-for-bit the same results as the
+ * scalar ones: in particular, they never fuse a multiplication and an
+ * addition.
+ *
+ * POLYNOMs are evaluated by Horner's method, a chunk of samples at a time,
+ * converting each chunk of input to double precision only as it's needed.
+ *
+ * The bit extraction kernels work on integers of any width, so a narrow input
+ * needn't be widened before its bits are extracted.
+ *
+ * The conversion kernels handle only the common conversions to floating
+ * point; the rest are left to _GD_ConvertType.  They work from the end of the
+ * buffers to the start, so they may convert in place when the output type is
+ * no narrower than the input type.
+ */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GD_KERNEL_X86
+#include <immintrin.h>
+#define GD_TARGET_SSE2 __attribute__((target("sse2")))
+#define GD_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define GD_KERNEL_ARM
+#include <arm_neon.h>
+#endif
+
+typedef void (*gd_kswap_t)(void *, size_t);
+typedef int (*gd_kconvert_t)(const void *, gd_type_t, void *, gd_type_t,
+    size_t);
+typedef void (*gd_klincom_t)(int, double *restrict, const double *restrict,
+    const double *restrict, const double *restrict, const double *restrict,
+    size_t);
+typedef void (*gd_khorner_t)(double *, size_t, int, const double *);
+typedef void (*gd_kbits_t)(void *, size_t, int, int, int, int);
+typedef void (*gd_klinterp_t)(double *, const double *, const int32_t *,
+    size_t, const double *, const double *, const double *);
+
+/* the mask and sign bit used by the bit extraction kernels */
+#define GD_BITS_MASK(numbits) (((numbits) == 64) ? ~(uint64_t)0 : \
+    ((uint64_t)1 << (numbits)) - 1)
+#define GD_BITS_SIGN(numbits) (~(uint64_t)0 << ((numbits) - 1))
+
+/* SCALAR */
+
+static void _GD_Swap16Scalar(void *buf, size_t n)
+{
+  uint16_t *p = (uint16_t *)buf;
+  size_t i;
+
+  for (i = 0; i < n; ++i)
+    p[i] = gd_swap16(p[i]);
+}
+
+static void _GD_Swap32Scalar(void *buf, size_t n)
+{
+  uint32_t *p = (uint32_t *)buf;
+  size_t i;
+
+  for (i = 0; i < n; ++i)
+    p[i] = gd_swap32(p[i]);
+}
+
+static void _GD_Swap64Scalar(void *buf, size_t n)
+{
+  uint64_t *p = (uint64_t *)buf;
+  size_t i;
+
+  for (i = 0; i < n; ++i)
+    p[i] = gd_swap64(p[i]);
+}
+
+/* the scalar conversion kernel converts nothing: _GD_ConvertType does that */
+static int _GD_ConvertScalar(const void *in gd_unused_,
+    gd_type_t in_type gd_unused_, void *out gd_unused_,
+    gd_type_t out_type gd_unused_, size_t n gd_unused_)
+{
+  return 0;
+}
+
+/* the same arithmetic, in the same order, as the LINCOM macros in common.c */
+static void _GD_LincomScalar(int n, double *restrict d1,
+    const double *restrict d2, const double *restrict d3,
+    const double *restrict m, const double *restrict b, size_t len)
+{
+  size_t i;
+
+  switch (n) {
+    case 1:
+      for (i = 0; i < len; ++i)
+        d1[i] = d1[i] * m[0] + b[0];
+      break;
+    case 2:
+      for (i = 0; i < len; ++i)
+        d1[i] = d1[i] * m[0] + (d2[i] * m[1] + b[0] + b[1]);
+      break;
+    case 3:
+      for (i = 0; i < len; ++i)
+        d1[i] = d1[i] * m[0] + (d2[i] * m[1] + d3[i] * m[2] + b[0] + b[1] +
+            b[2]);
+      break;
+  }
+}
+
+/* evaluate the polynomial of order n with coefficients a at each of the len
+ * points in x, by Horner's method */
+static void _GD_HornerScalar(double *x, size_t len, int n, const double *a)
+{
+  size_t i;
+  int k;
+
+  for (i = 0; i < len; ++i) {
+    double y = a[n];
+    for (k = n; k-- > 0; )
+      y = y * x[i] + a[k];
+    x[i] = y;
+  }
+}
+
+/* interpolate each of the n points in x on its segment, seg, of a LUT.  The
+ * buffers may be the same */
+static void _GD_LinterpScalar(double *out, const double *x,
+    const int32_t *seg, size_t n, const double *sx, const double *sy,
+    const double *slope)
+{
+  size_t i;
+
+  for (i = 0; i < n; ++i) {
+    const int32_t k = seg[i];
+    out[i] = sy[k] + slope[k] * (x[i] - sx[k]);
+  }
+}
+
+/* extract bits from the n values of type t in buf */
+#define BITS_SCALAR(t) do { \
+  const t mask = (t)GD_BITS_MASK(numbits); \
+  t *p = (t *)buf; \
+  if (is_signed) { \
+    const t sign = (t)GD_BITS_SIGN(numbits); \
+    for (i = 0; i < n; ++i) \
+      p[i] = (t)((((t)(p[i] >> bitnum) & mask) + sign) ^ sign); \
+  } else \
+    for (i = 0; i < n; ++i) \
+      p[i] = (t)(p[i] >> bitnum) & mask; \
+} while (0)
+
+static void _GD_BitsScalar(void *buf, size_t n, int size, int bitnum,
+    int numbits, int is_signed)
+{
+  size_t i;
+
+  switch (size) {
+    case 1:
+      BITS_SCALAR(uint8_t);
+      break;
+    case 2:
+      BITS_SCALAR(uint16_t);
+      break;
+    case 4:
+      BITS_SCALAR(uint32_t);
+      break;
+    case 8:
+      BITS_SCALAR(uint64_t);
+      break;
+  }
+}
+
+/* the rest of a conversion, from element n - 1 down to element 0, used to
+ * finish off what the vector loops leave */
+#define CONVERT_TAIL(ot,it) do { \
+  while (n-- > 0) \
+    ((ot *)out)[n] = (ot)((const it *)in)[n]; \
+} while (0)
+
+/* the offset of the start of the rest of a LINCOM, or NULL */
+#define LINCOM_REST(d,i) ((d) ? (d) + (i) : NULL)
+
+#ifdef GD_KERNEL_X86
+/* SSE2 */
+
+/* swap the bytes of the 16-bit words in v */
+#define SWAP16_SSE2(v) _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8))
+
+GD_TARGET_SSE2 static void _GD_Swap16SSE2(void *buf, size_t n)
+{
+  uint16_t *p = (uint16_t *)buf;
+  size_t i;
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    __m128i v = _mm_loadu_si128((__m128i *)(p + i));
+    _mm_storeu_si128((__m128i *)(p + i), SWAP16_SSE2(v));
+  }
+  _GD_Swap16Scalar(p + i, n - i);
+}
+
+GD_TARGET_SSE2 static void _GD_Swap32SSE2(void *buf, size_t n)
+{
+  uint32_t *p = (uint32_t *)buf;
+  size_t i;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128((__m128i *)(p + i));
+    /* swap the words, then the bytes in the words */
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    _mm_storeu_si128((__m128i *)(p + i), SWAP16_SSE2(v));
+  }
+  _GD_Swap32Scalar(p + i, n - i);
+}
+
+GD_TARGET_SSE2 static void _GD_Swap64SSE2(void *buf, size_t n)
+{
+  uint64_t *p = (uint64_t *)buf;
+  size_t i;
+
+  for (i = 0; i + 2 <= n; i += 2) {
+    __m128i v = _mm_loadu_si128((__m128i *)(p + i));
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    _mm_storeu_si128((__m128i *)(p + i), SWAP16_SSE2(v));
+  }
+  _GD_Swap64Scalar(p + i, n - i);
+}
+
+/* convert the four 32-bit integers in v to doubles, and store them at o */
+#define CVT_EPI32_PD_SSE2(o,v) do { \
+  _mm_storeu_pd(o, _mm_cvtepi32_pd(v)); \
+  _mm_storeu_pd((o) + 2, _mm_cvtepi32_pd(_mm_srli_si128(v, 8))); \
+} while (0)
+
+GD_TARGET_SSE2 static int _GD_ConvertSSE2(const void *in, gd_type_t in_type,
+    void *out, gd_type_t out_type, size_t n)
+{
+  const __m128i zero = _mm_setzero_si128();
+
+  if (out_type == GD_FLOAT64) {
+    double *o = (double *)out;
+    switch (in_type) {
+      case GD_INT8:
+      case GD_UINT8:
+        for (; n >= 4; n -= 4) {
+          int32_t w;
+          __m128i v;
+          memcpy(&w, (const int8_t *)in + n - 4, 4);
+          v = _mm_cvtsi32_si128(w);
+          if (in_type == GD_INT8) {
+            v = _mm_unpacklo_epi8(v, v);
+            v = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 24);
+          } else
+            v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero);
+          CVT_EPI32_PD_SSE2(o + n - 4, v);
+        }
+        if (in_type == GD_INT8)
+          CONVERT_TAIL(double, int8_t);
+        else
+          CONVERT_TAIL(double, uint8_t);
+        return 1;
+      case GD_INT16:
+      case GD_UINT16:
+        for (; n >= 4; n -= 4) {
+          __m128i v = _mm_loadl_epi64((const __m128i *)((const int16_t *)in +
+                n - 4));
+          if (in_type == GD_INT16)
+            v = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+          else
+            v = _mm_unpacklo_epi16(v, zero);
+          CVT_EPI32_PD_SSE2(o + n - 4, v);
+        }
+        if (in_type == GD_INT16)
+          CONVERT_TAIL(double, int16_t);
+        else
+          CONVERT_TAIL(double, uint16_t);
+        return 1;
+      case GD_INT32:
+        for (; n >= 4; n -= 4) {
+          __m128i v = _mm_loadu_si128((const __m128i *)((const int32_t *)in +
+                n - 4));
+          CVT_EPI32_PD_SSE2(o + n - 4, v);
+        }
+        CONVERT_TAIL(double, int32_t);
+        return 1;
+      case GD_UINT32:
+        {
+          /* flip the top bit, convert as signed, and add it back */
+          const __m128i top = _mm_set1_epi32((int)0x80000000);
+          const __m128d off = _mm_set1_pd(2147483648.);
+          for (; n >= 4; n -= 4) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)
+                  ((const uint32_t *)in + n - 4)), top);
+            _mm_storeu_pd(o + n - 4, _mm_add_pd(_mm_cvtepi32_pd(v), off));
+            _mm_storeu_pd(o + n - 2, _mm_add_pd(_mm_cvtepi32_pd(
+                    _mm_srli_si128(v, 8)), off));
+          }
+        }
+        CONVERT_TAIL(double, uint32_t);
+        return 1;
+      case GD_FLOAT32:
+        for (; n >= 4; n -= 4) {
+          __m128 v = _mm_loadu_ps((const float *)in + n - 4);
+          _mm_storeu_pd(o + n - 4, _mm_cvtps_pd(v));
+          _mm_storeu_pd(o + n - 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+        }
+        CONVERT_TAIL(double, float);
+        return 1;
+      default:
+        return 0;
+    }
+  } else if (out_type == GD_FLOAT32) {
+    float *o = (float *)out;
+    switch (in_type) {
+      case GD_INT16:
+      case GD_UINT16:
+        for (; n >= 4; n -= 4) {
+          __m128i v = _mm_loadl_epi64((const __m128i *)((const int16_t *)in +
+                n - 4));
+          if (in_type == GD_INT16)
+            v = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+          else
+            v = _mm_unpacklo_epi16(v, zero);
+          _mm_storeu_ps(o + n - 4, _mm_cvtepi32_ps(v));
+        }
+        if (in_type == GD_INT16)
+          CONVERT_TAIL(float, int16_t);
+        else
+          CONVERT_TAIL(float, uint16_t);
+        return 1;
+      case GD_INT32:
+        for (; n >= 4; n -= 4)
+          _mm_storeu_ps(o + n - 4, _mm_cvtepi32_ps(_mm_loadu_si128(
+                  (const __m128i *)((const int32_t *)in + n - 4))));
+        CONVERT_TAIL(float, int32_t);
+        return 1;
+      case GD_FLOAT64:
+        for (; n >= 4; n -= 4) {
+          const double *i = (const double *)in + n - 4;
+          _mm_storeu_ps(o + n - 4, _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(i)),
+                _mm_cvtpd_ps(_mm_loadu_pd(i + 2))));
+        }
+        CONVERT_TAIL(float, double);
+        return 1;
+      default:
+        return 0;
+    }
+  }
+
+  return 0;
+}
+
+GD_TARGET_SSE2 static void _GD_LincomSSE2(int n, double *restrict d1,
+    const double *restrict d2, const double *restrict d3,
+    const double *restrict m, const double *restrict b, size_t len)
+{
+  const __m128d m0 = _mm_set1_pd(m[0]), b0 = _mm_set1_pd(b[0]);
+  size_t i = 0;
+
+  if (n == 1) {
+    for (; i + 2 <= len; i += 2)
+      _mm_storeu_pd(d1 + i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(d1 + i), m0),
+            b0));
+  } else if (n == 2) {
+    const __m128d m1 = _mm_set1_pd(m[1]), b1 = _mm_set1_pd(b[1]);
+    for (; i + 2 <= len; i += 2) {
+      __m128d t = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_loadu_pd(d2 + i), m1),
+            b0), b1);
+      _mm_storeu_pd(d1 + i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(d1 + i), m0),
+            t));
+    }
+  } else if (n == 3) {
+    const __m128d m1 = _mm_set1_pd(m[1]), b1 = _mm_set1_pd(b[1]);
+    const __m128d m2 = _mm_set1_pd(m[2]), b2 = _mm_set1_pd(b[2]);
+    for (; i + 2 <= len; i += 2) {
+      __m128d t = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(d2 + i), m1),
+          _mm_mul_pd(_mm_loadu_pd(d3 + i), m2));
+      t = _mm_add_pd(_mm_add_pd(_mm_add_pd(t, b0), b1), b2);
+      _mm_storeu_pd(d1 + i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(d1 + i), m0),
+            t));
+    }
+  }
+
+  _GD_LincomScalar(n, d1 + i, LINCOM_REST(d2, i), LINCOM_REST(d3, i), m, b,
+      len - i);
+}
+
+GD_TARGET_SSE2 static void _GD_HornerSSE2(double *x, size_t len, int n,
+    const double *a)
+{
+  __m128d c[GD_MAX_POLYORD + 1];
+  size_t i;
+  int k;
+
+  for (k = 0; k <= n; ++k)
+    c[k] = _mm_set1_pd(a[k]);
+
+  for (i = 0; i + 2 <= len; i += 2) {
+    const __m128d v = _mm_loadu_pd(x + i);
+    __m128d y = c[n];
+    for (k = n; k-- > 0; )
+      y = _mm_add_pd(_mm_mul_pd(y, v), c[k]);
+    _mm_storeu_pd(x + i, y);
+  }
+  _GD_HornerScalar(x + i, len - i, n, a);
+}
+
+/* extract bits from the values of size bytes in buf with the given vector
+ * instructions; there's no 8-bit shift, but a 16-bit one does just as well,
+ * since the mask removes the bits shifted in from the neighbouring byte */
+#define BITS_VECTOR(vt,k,load,store,srl,and,add,xor,set1) do { \
+  const vt mask = set1(GD_BITS_MASK(numbits)); \
+  const vt sign = set1(GD_BITS_SIGN(numbits)); \
+  for (i = 0; i + k <= n; i += k) { \
+    vt v = and(srl(load((vt *)(p + i * size)), shift), mask); \
+    if (is_signed) \
+      v = xor(add(v, sign), sign); \
+    store((vt *)(p + i * size), v); \
+  } \
+} while (0)
+
+#define SET1_EPI8_SSE2(x) _mm_set1_epi8((char)(x))
+#define SET1_EPI16_SSE2(x) _mm_set1_epi16((short)(x))
+#define SET1_EPI32_SSE2(x) _mm_set1_epi32((int)(x))
+#define SET1_EPI64_SSE2(x) _mm_set1_epi64x((int64_t)(x))
+
+GD_TARGET_SSE2 static void _GD_BitsSSE2(void *buf, size_t n, int size,
+    int bitnum, int numbits, int is_signed)
+{
+  const __m128i shift = _mm_cvtsi32_si128(bitnum);
+  char *p = (char *)buf;
+  size_t i = 0;
+
+  switch (size) {
+    case 1:
+      BITS_VECTOR(__m128i, 16, _mm_loadu_si128, _mm_storeu_si128,
+          _mm_srl_epi16, _mm_and_si128, _mm_add_epi8, _mm_xor_si128,
+          SET1_EPI8_SSE2);
+      break;
+    case 2:
+      BITS_VECTOR(__m128i, 8, _mm_loadu_si128, _mm_storeu_si128,
+          _mm_srl_epi16, _mm_and_si128, _mm_add_epi16, _mm_xor_si128,
+          SET1_EPI16_SSE2);
+      break;
+    case 4:
+      BITS_VECTOR(__m128i, 4, _mm_loadu_si128, _mm_storeu_si128,
+          _mm_srl_epi32, _mm_and_si128, _mm_add_epi32, _mm_xor_si128,
+          SET1_EPI32_SSE2);
+      break;
+    case 8:
+      BITS_VECTOR(__m128i, 2, _mm_loadu_si128, _mm_storeu_si128,
+          _mm_srl_epi64, _mm_and_si128, _mm_add_epi64, _mm_xor_si128,
+          SET1_EPI64_SSE2);
+      break;
+  }
+  _GD_BitsScalar(p + i * size, n - i, size, bitnum, numbits, is_signed);
+}
+
+/* AVX2 */
+
+/* byte shuffles for _mm256_shuffle_epi8, which works on each 128-bit lane */
+#define SWAP_MASK_AVX2(a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p) \
+  _mm256_setr_epi8(a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p, \
+      a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p)
+
+#define SWAP_AVX2(name,t,mask,scalar) \
+GD_TARGET_AVX2 static void name(void *buf, size_t n) \
+{ \
+  const __m256i s = mask; \
+  const size_t k = 32 / sizeof(t); \
+  t *p = (t *)buf; \
+  size_t i; \
+ \
+  for (i = 0; i + k <= n; i += k) \
+    _mm256_storeu_si256((__m256i *)(p + i), _mm256_shuffle_epi8( \
+          _mm256_loadu_si256((__m256i *)(p + i)), s)); \
+  scalar(p + i, n - i); \
+}
+
+SWAP_AVX2(_GD_Swap16AVX2, uint16_t, SWAP_MASK_AVX2(1, 0, 3, 2, 5, 4, 7, 6, 9,
+      8, 11, 10, 13, 12, 15, 14), _GD_Swap16Scalar)
+SWAP_AVX2(_GD_Swap32AVX2, uint32_t, SWAP_MASK_AVX2(3, 2, 1, 0, 7, 6, 5, 4, 11,
+      10, 9, 8, 15, 14, 13, 12), _GD_Swap32Scalar)
+SWAP_AVX2(_GD_Swap64AVX2, uint64_t, SWAP_MASK_AVX2(7, 6, 5, 4, 3, 2, 1, 0, 15,
+      14, 13, 12, 11, 10, 9, 8), _GD_Swap64Scalar)
+
+/* load four bytes at p into the bottom of a vector */
+GD_TARGET_AVX2 static __m128i _GD_Load4AVX2(const void *p)
+{
+  int32_t w;
+  memcpy(&w, p, 4);
+  return _mm_cvtsi32_si128(w);
+}
+
+GD_TARGET_AVX2 static int _GD_ConvertAVX2(const void *in, gd_type_t in_type,
+    void *out, gd_type_t out_type, size_t n)
+{
+  if (out_type == GD_FLOAT64) {
+    double *o = (double *)out;
+    switch (in_type) {
+      case GD_INT8:
+        for (; n >= 4; n -= 4)
+          _mm256_storeu_pd(o + n - 4, _mm256_cvtepi32_pd(_mm_cvtepi8_epi32(
+                  _GD_Load4AVX2((const int8_t *)in + n - 4))));
+        CONVERT_TAIL(double, int8_t);
+        return 1;
+      case GD_UINT8:
+        for (; n >= 4; n -= 4)
+          _mm256_storeu_pd(o + n - 4, _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(
+                  _GD_Load4AVX2((const uint8_t *)in + n - 4))));
+        CONVERT_TAIL(double, uint8_t);
+        return 1;
+      case GD_INT16:
+        for (; n >= 4; n -= 4)
+          _mm256_storeu_pd(o + n - 4, _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(
+                  _mm_loadl_epi64((const __m128i *)((const int16_t *)in + n -
+                      4)))));
+        CONVERT_TAIL(double, int16_t);
+        return 1;
+      case GD_UINT16:
+        for (; n >= 4; n -= 4)
+          _mm256_storeu_pd(o + n - 4, _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(
+                  _mm_loadl_epi64((const __m128i *)((const uint16_t *)in + n -
+                      4)))));
+        CONVERT_TAIL(double, uint16_t);
+        return 1;
+      case GD_INT32:
+        for (; n >= 4; n -= 4)
+          _mm256_storeu_pd(o + n - 4, _mm256_cvtepi32_pd(_mm_loadu_si128(
+                  (const __m128i *)((const int32_t *)in + n - 4))));
+        CONVERT_TAIL(double, int32_t);
+        return 1;
+      case GD_UINT32:
+        {
+          const __m128i top = _mm_set1_epi32((int)0x80000000);
+          const __m256d off = _mm256_set1_pd(2147483648.);
+          for (; n >= 4; n -= 4)
+            _mm256_storeu_pd(o + n - 4, _mm256_add_pd(_mm256_cvtepi32_pd(
+                    _mm_xor_si128(_mm_loadu_si128((const __m128i *)
+                        ((const uint32_t *)in + n - 4)), top)), off));
+        }
+        CONVERT_TAIL(double, uint32_t);
+        return 1;
+      case GD_FLOAT32:
+        for (; n >= 4; n -= 4)
+          _mm256_storeu_pd(o + n - 4, _mm256_cvtps_pd(_mm_loadu_ps(
+                  (const float *)in + n - 4)));
+        CONVERT_TAIL(double, float);
+        return 1;
+      default:
+        return 0;
+    }
+  } else if (out_type == GD_FLOAT32) {
+    float *o = (float *)out;
+    switch (in_type) {
+      case GD_INT16:
+        for (; n >= 8; n -= 8)
+          _mm256_storeu_ps(o + n - 8, _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(
+                  _mm_loadu_si128((const __m128i *)((const int16_t *)in + n -
+                      8)))));
+        CONVERT_TAIL(float, int16_t);
+        return 1;
+      case GD_UINT16:
+        for (; n >= 8; n -= 8)
+          _mm256_storeu_ps(o + n - 8, _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(
+                  _mm_loadu_si128((const __m128i *)((const uint16_t *)in + n -
+                      8)))));
+        CONVERT_TAIL(float, uint16_t);
+        return 1;
+      case GD_INT32:
+        for (; n >= 8; n -= 8)
+          _mm256_storeu_ps(o + n - 8, _mm256_cvtepi32_ps(_mm256_loadu_si256(
+                  (const __m256i *)((const int32_t *)in + n - 8))));
+        CONVERT_TAIL(float, int32_t);
+        return 1;
+      case GD_FLOAT64:
+        for (; n >= 4; n -= 4)
+          _mm_storeu_ps(o + n - 4, _mm256_cvtpd_ps(_mm256_loadu_pd(
+                  (const double *)in + n - 4)));
+        CONVERT_TAIL(float, double);
+        return 1;
+      default:
+        return 0;
+    }
+  }
+
+  return 0;
+}
+
+GD_TARGET_AVX2 static void _GD_LincomAVX2(int n, double *restrict d1,
+    const double *restrict d2, const double *restrict d3,
+    const double *restrict m, const double *restrict b, size_t len)
+{
+  const __m256d m0 = _mm256_set1_pd(m[0]), b0 = _mm256_set1_pd(b[0]);
+  size_t i = 0;
+
+  if (n == 1) {
+    for (; i + 4 <= len; i += 4)
+      _mm256_storeu_pd(d1 + i, _mm256_add_pd(_mm256_mul_pd(
+              _mm256_loadu_pd(d1 + i), m0), b0));
+  } else if (n == 2) {
+    const __m256d m1 = _mm256_set1_pd(m[1]), b1 = _mm256_set1_pd(b[1]);
+    for (; i + 4 <= len; i += 4) {
+      __m256d t = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(
+              _mm256_loadu_pd(d2 + i), m1), b0), b1);
+      _mm256_storeu_pd(d1 + i, _mm256_add_pd(_mm256_mul_pd(
+              _mm256_loadu_pd(d1 + i), m0), t));
+    }
+  } else if (n == 3) {
+    const __m256d m1 = _mm256_set1_pd(m[1]), b1 = _mm256_set1_pd(b[1]);
+    const __m256d m2 = _mm256_set1_pd(m[2]), b2 = _mm256_set1_pd(b[2]);
+    for (; i + 4 <= len; i += 4) {
+      __m256d t = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(d2 + i), m1),
+          _mm256_mul_pd(_mm256_loadu_pd(d3 + i), m2));
+      t = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(t, b0), b1), b2);
+      _mm256_storeu_pd(d1 + i, _mm256_add_pd(_mm256_mul_pd(
+              _mm256_loadu_pd(d1 + i), m0), t));
+    }
+  }
+
+  _GD_LincomScalar(n, d1 + i, LINCOM_REST(d2, i), LINCOM_REST(d3, i), m, b,
+      len - i);
+}
+
+GD_TARGET_AVX2 static void _GD_HornerAVX2(double *x, size_t len, int n,
+    const double *a)
+{
+  __m256d c[GD_MAX_POLYORD + 1];
+  size_t i;
+  int k;
+
+  for (k = 0; k <= n; ++k)
+    c[k] = _mm256_set1_pd(a[k]);
+
+  /* four independent chains at a time, to hide the latency of each step */
+  for (i = 0; i + 16 <= len; i += 16) {
+    const __m256d v0 = _mm256_loadu_pd(x + i);
+    const __m256d v1 = _mm256_loadu_pd(x + i + 4);
+    const __m256d v2 = _mm256_loadu_pd(x + i + 8);
+    const __m256d v3 = _mm256_loadu_pd(x + i + 12);
+    __m256d y0 = c[n], y1 = c[n], y2 = c[n], y3 = c[n];
+    for (k = n; k-- > 0; ) {
+      y0 = _mm256_add_pd(_mm256_mul_pd(y0, v0), c[k]);
+      y1 = _mm256_add_pd(_mm256_mul_pd(y1, v1), c[k]);
+      y2 = _mm256_add_pd(_mm256_mul_pd(y2, v2), c[k]);
+      y3 = _mm256_add_pd(_mm256_mul_pd(y3, v3), c[k]);
+    }
+    _mm256_storeu_pd(x + i, y0);
+    _mm256_storeu_pd(x + i + 4, y1);
+    _mm256_storeu_pd(x + i + 8, y2);
+    _mm256_storeu_pd(x + i + 12, y3);
+  }
+  for (; i + 4 <= len; i += 4) {
+    const __m256d v = _mm256_loadu_pd(x + i);
+    __m256d y = c[n];
+    for (k = n; k-- > 0; )
+      y = _mm256_add_pd(_mm256_mul_pd(y, v), c[k]);
+    _mm256_storeu_pd(x + i, y);
+  }
+  _GD_HornerScalar(x + i, len - i, n, a);
+}
+
+GD_TARGET_AVX2 static void _GD_LinterpAVX2(double *out, const double *x,
+    const int32_t *seg, size_t n, const double *sx, const double *sy,
+    const double *slope)
+{
+  size_t i;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    const __m128i k = _mm_loadu_si128((const __m128i *)(seg + i));
+    const __m256d x0 = _mm256_i32gather_pd(sx, k, 8);
+    const __m256d y0 = _mm256_i32gather_pd(sy, k, 8);
+    const __m256d s = _mm256_i32gather_pd(slope, k, 8);
+    _mm256_storeu_pd(out + i, _mm256_add_pd(y0,
+          _mm256_mul_pd(s, _mm256_sub_pd(_mm256_loadu_pd(x + i), x0))));
+  }
+  _GD_LinterpScalar(out + i, x + i, seg + i, n - i, sx, sy, slope);
+}
+
+#define SET1_EPI8_AVX2(x) _mm256_set1_epi8((char)(x))
+#define SET1_EPI16_AVX2(x) _mm256_set1_epi16((short)(x))
+#define SET1_EPI32_AVX2(x) _mm256_set1_epi32((int)(x))
+#define SET1_EPI64_AVX2(x) _mm256_set1_epi64x((int64_t)(x))
+
+GD_TARGET_AVX2 static void _GD_BitsAVX2(void *buf, size_t n, int size,
+    int bitnum, int numbits, int is_signed)
+{
+  const __m128i shift = _mm_cvtsi32_si128(bitnum);
+  char *p = (char *)buf;
+  size_t i = 0;
+
+  switch (size) {
+    case 1:
+      BITS_VECTOR(__m256i, 32, _mm256_loadu_si256, _mm256_storeu_si256,
+          _mm256_srl_epi16, _mm256_and_si256, _mm256_add_epi8,
+          _mm256_xor_si256, SET1_EPI8_AVX2);
+      break;
+    case 2:
+      BITS_VECTOR(__m256i, 16, _mm256_loadu_si256, _mm256_storeu_si256,
+          _mm256_srl_epi16, _mm256_and_si256, _mm256_add_epi16,
+          _mm256_xor_si256, SET1_EPI16_AVX2);
+      break;
+    case 4:
+      BITS_VECTOR(__m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256,
+          _mm256_srl_epi32, _mm256_and_si256, _mm256_add_epi32,
+          _mm256_xor_si256, SET1_EPI32_AVX2);
+      break;
+    case 8:
+      BITS_VECTOR(__m256i, 4, _mm256_loadu_si256, _mm256_storeu_si256,
+          _mm256_srl_epi64, _mm256_and_si256, _mm256_add_epi64,
+          _mm256_xor_si256, SET1_EPI64_AVX2);
+      break;
+  }
+  _GD_BitsScalar(p + i * size, n - i, size, bitnum, numbits, is_signed);
+}
+#endif
+
+#ifdef GD_KERNEL_ARM
+/* NEON */
+
+#define SWAP_NEON(name,t,rev,scalar) \
+static void name(void *buf, size_t n) \
+{ \
+  const size_t k = 16 / sizeof(t); \
+  t *p = (t *)buf; \
+  size_t i; \
+ \
+  for (i = 0; i + k <= n; i += k) \
+    vst1q_u8((uint8_t *)(p + i), rev(vld1q_u8((const uint8_t *)(p + i)))); \
+  scalar(p + i, n - i); \
+}
+
+SWAP_NEON(_GD_Swap16NEON, uint16_t, vrev16q_u8, _GD_Swap16Scalar)
+SWAP_NEON(_GD_Swap32NEON, uint32_t, vrev32q_u8, _GD_Swap32Scalar)
+SWAP_NEON(_GD_Swap64NEON, uint64_t, vrev64q_u8, _GD_Swap64Scalar)
+
+/* convert the four 32-bit integers in v to doubles, and store them at o */
+#define CVT_S32_F64_NEON(o,v) do { \
+  vst1q_f64(o, vcvtq_f64_s64(vmovl_s32(vget_low_s32(v)))); \
+  vst1q_f64((o) + 2, vcvtq_f64_s64(vmovl_s32(vget_high_s32(v)))); \
+} while (0)
+#define CVT_U32_F64_NEON(o,v) do { \
+  vst1q_f64(o, vcvtq_f64_u64(vmovl_u32(vget_low_u32(v)))); \
+  vst1q_f64((o) + 2, vcvtq_f64_u64(vmovl_u32(vget_high_u32(v)))); \
+} while (0)
+
+static int _GD_ConvertNEON(const void *in, gd_type_t in_type, void *out,
+    gd_type_t out_type, size_t n)
+{
+  if (out_type == GD_FLOAT64) {
+    double *o = (double *)out;
+    switch (in_type) {
+      case GD_INT16:
+        for (; n >= 4; n -= 4)
+          CVT_S32_F64_NEON(o + n - 4, vmovl_s16(vld1_s16((const int16_t *)in +
+                  n - 4)));
+        CONVERT_TAIL(double, int16_t);
+        return 1;
+      case GD_UINT16:
+        for (; n >= 4; n -= 4)
+          CVT_U32_F64_NEON(o + n - 4, vmovl_u16(vld1_u16((const uint16_t *)in
+                  + n - 4)));
+        CONVERT_TAIL(double, uint16_t);
+        return 1;
+      case GD_INT32:
+        for (; n >= 4; n -= 4)
+          CVT_S32_F64_NEON(o + n - 4, vld1q_s32((const int32_t *)in + n - 4));
+        CONVERT_TAIL(double, int32_t);
+        return 1;
+      case GD_UINT32:
+        for (; n >= 4; n -= 4)
+          CVT_U32_F64_NEON(o + n - 4, vld1q_u32((const uint32_t *)in + n - 4));
+        CONVERT_TAIL(double, uint32_t);
+        return 1;
+      case GD_FLOAT32:
+        for (; n >= 4; n -= 4) {
+          const float32x4_t v = vld1q_f32((const float *)in + n - 4);
+          vst1q_f64(o + n - 4, vcvt_f64_f32(vget_low_f32(v)));
+          vst1q_f64(o + n - 2, vcvt_f64_f32(vget_high_f32(v)));
+        }
+        CONVERT_TAIL(double, float);
+        return 1;
+      default:
+        return 0;
+    }
+  } else if (out_type == GD_FLOAT32 && in_type == GD_FLOAT64) {
+    float *o = (float *)out;
+    for (; n >= 4; n -= 4) {
+      const double *i = (const double *)in + n - 4;
+      vst1q_f32(o + n - 4, vcombine_f32(vcvt_f32_f64(vld1q_f64(i)),
+            vcvt_f32_f64(vld1q_f64(i + 2))));
+    }
+    CONVERT_TAIL(float, double);
+    return 1;
+  }
+
+  return 0;
+}
+
+static void _GD_LincomNEON(int n, double *restrict d1,
+    const double *restrict d2, const double *restrict d3,
+    const double *restrict m, const double *restrict b, size_t len)
+{
+  const float64x2_t m0 = vdupq_n_f64(m[0]), b0 = vdupq_n_f64(b[0]);
+  size_t i = 0;
+
+  /* vmulq/vaddq, not vfmaq: no fused multiply-add */
+  if (n == 1) {
+    for (; i + 2 <= len; i += 2)
+      vst1q_f64(d1 + i, vaddq_f64(vmulq_f64(vld1q_f64(d1 + i), m0), b0));
+  } else if (n == 2) {
+    const float64x2_t m1 = vdupq_n_f64(m[1]), b1 = vdupq_n_f64(b[1]);
+    for (; i + 2 <= len; i += 2) {
+      float64x2_t t = vaddq_f64(vaddq_f64(vmulq_f64(vld1q_f64(d2 + i), m1),
+            b0), b1);
+      vst1q_f64(d1 + i, vaddq_f64(vmulq_f64(vld1q_f64(d1 + i), m0), t));
+    }
+  } else if (n == 3) {
+    const float64x2_t m1 = vdupq_n_f64(m[1]), b1 = vdupq_n_f64(b[1]);
+    const float64x2_t m2 = vdupq_n_f64(m[2]), b2 = vdupq_n_f64(b[2]);
+    for (; i + 2 <= len; i += 2) {
+      float64x2_t t = vaddq_f64(vmulq_f64(vld1q_f64(d2 + i), m1),
+          vmulq_f64(vld1q_f64(d3 + i), m2));
+      t = vaddq_f64(vaddq_f64(vaddq_f64(t, b0), b1), b2);
+      vst1q_f64(d1 + i, vaddq_f64(vmulq_f64(vld1q_f64(d1 + i), m0), t));
+    }
+  }
+
+  _GD_LincomScalar(n, d1 + i, LINCOM_REST(d2, i), LINCOM_REST(d3, i), m, b,
+      len - i);
+}
+
+static void _GD_HornerNEON(double *x, size_t len, int n, const double *a)
+{
+  float64x2_t c[GD_MAX_POLYORD + 1];
+  size_t i;
+  int k;
+
+  for (k = 0; k <= n; ++k)
+    c[k] = vdupq_n_f64(a[k]);
+
+  for (i = 0; i + 2 <= len; i += 2) {
+    const float64x2_t v = vld1q_f64(x + i);
+    float64x2_t y = c[n];
+    for (k = n; k-- > 0; )
+      y = vaddq_f64(vmulq_f64(y, v), c[k]);
+    vst1q_f64(x + i, y);
+  }
+  _GD_HornerScalar(x + i, len - i, n, a);
+}
+
+/* extract bits from the values of size bytes in buf; a shift left by a
+ * negative amount is a shift right */
+#define BITS_NEON(vt,t,k,sfx,ssfx) do { \
+  const vt mask = vdupq_n_##sfx((t)GD_BITS_MASK(numbits)); \
+  const vt sign = vdupq_n_##sfx((t)GD_BITS_SIGN(numbits)); \
+  for (i = 0; i + k <= n; i += k) { \
+    vt v = vandq_##sfx(vshlq_##sfx(vld1q_##sfx((t *)p + i), \
+          vdupq_n_##ssfx(-bitnum)), mask); \
+    if (is_signed) \
+      v = veorq_##sfx(vaddq_##sfx(v, sign), sign); \
+    vst1q_##sfx((t *)p + i, v); \
+  } \
+} while (0)
+
+static void _GD_BitsNEON(void *buf, size_t n, int size, int bitnum,
+    int numbits, int is_signed)
+{
+  char *p = (char *)buf;
+  size_t i = 0;
+
+  switch (size) {
+    case 1:
+      BITS_NEON(uint8x16_t, uint8_t, 16, u8, s8);
+      break;
+    case 2:
+      BITS_NEON(uint16x8_t, uint16_t, 8, u16, s16);
+      break;
+    case 4:
+      BITS_NEON(uint32x4_t, uint32_t, 4, u32, s32);
+      break;
+    case 8:
+      BITS_NEON(uint64x2_t, uint64_t, 2, u64, s64);
+      break;
+  }
+  _GD_BitsScalar(p + i * size, n - i, size, bitnum, numbits, is_signed);
+}
+#endif
+
+/* DISPATCH */
+
+static struct {
+  int level; /* negative until _GD_KernelInit is first called */
+  gd_kswap_t swap16, swap32, swap64;
+  gd_kconvert_t convert;
+  gd_klincom_t lincom;
+  gd_khorner_t horner;
+  gd_kbits_t bits;
+  gd_klinterp_t linterp;
+} _GD_Kernel = { -1, _GD_Swap16Scalar, _GD_Swap32Scalar, _GD_Swap64Scalar,
+  _GD_ConvertScalar, _GD_LincomScalar, _GD_HornerScalar, _GD_BitsScalar,
+  _GD_LinterpScalar };
+
+/* Is the kernel level supported here? */
+static int _GD_KernelAvailable(int level)
+{
+  switch (level) {
+    case GD_KERNEL_SCALAR:
+      return 1;
+#ifdef GD_KERNEL_X86
+    case GD_KERNEL_SSE2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse2");
+    case GD_KERNEL_AVX2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+#endif
+#ifdef GD_KERNEL_ARM
+    case GD_KERNEL_NEON:
+      return 1;
+#endif
+  }
+
+  return 0;
+}
+
+/* Select the kernels of the given level, or, if that's GD_KERNEL_BEST, the
+ * best available ones.  An unavailable level selects the scalar kernels.
+ * Returns the level selected.
+ */
+int _GD_KernelInit(int level)
+{
+  dtrace("%i", level);
+
+  if (level == GD_KERNEL_BEST) {
+    if (_GD_KernelAvailable(GD_KERNEL_AVX2))
+      level = GD_KERNEL_AVX2;
+    else if (_GD_KernelAvailable(GD_KERNEL_SSE2))
+      level = GD_KERNEL_SSE2;
+    else if (_GD_KernelAvailable(GD_KERNEL_NEON))
+      level = GD_KERNEL_NEON;
+    else
+      level = GD_KERNEL_SCALAR;
+  } else if (!_GD_KernelAvailable(level))
+    level = GD_KERNEL_SCALAR;
+
+  switch (level) {
+#ifdef GD_KERNEL_X86
+    case GD_KERNEL_SSE2:
+      _GD_Kernel.swap16 = _GD_Swap16SSE2;
+      _GD_Kernel.swap32 = _GD_Swap32SSE2;
+      _GD_Kernel.swap64 = _GD_Swap64SSE2;
+      _GD_Kernel.convert = _GD_ConvertSSE2;
+      _GD_Kernel.lincom = _GD_LincomSSE2;
+      _GD_Kernel.horner = _GD_HornerSSE2;
+      _GD_Kernel.bits = _GD_BitsSSE2;
+      _GD_Kernel.linterp = _GD_LinterpScalar; /* no gathers */
+      break;
+    case GD_KERNEL_AVX2:
+      _GD_Kernel.swap16 = _GD_Swap16AVX2;
+      _GD_Kernel.swap32 = _GD_Swap32AVX2;
+      _GD_Kernel.swap64 = _GD_Swap64AVX2;
+      _GD_Kernel.convert = _GD_ConvertAVX2;
+      _GD_Kernel.lincom = _GD_LincomAVX2;
+      _GD_Kernel.horner = _GD_HornerAVX2;
+      _GD_Kernel.bits = _GD_BitsAVX2;
+      _GD_Kernel.linterp = _GD_LinterpAVX2;
+      break;
+#endif
+#ifdef GD_KERNEL_ARM
+    case GD_KERNEL_NEON:
+      _GD_Kernel.swap16 = _GD_Swap16NEON;
+      _GD_Kernel.swap32 = _GD_Swap32NEON;
+      _GD_Kernel.swap64 = _GD_Swap64NEON;
+      _GD_Kernel.convert = _GD_ConvertNEON;
+      _GD_Kernel.lincom = _GD_LincomNEON;
+      _GD_Kernel.horner = _GD_HornerNEON;
+      _GD_Kernel.bits = _GD_BitsNEON;
+      _GD_Kernel.linterp = _GD_LinterpScalar; /* no gathers */
+      break;
+#endif
+    default:
+      _GD_Kernel.swap16 = _GD_Swap16Scalar;
+      _GD_Kernel.swap32 = _GD_Swap32Scalar;
+      _GD_Kernel.swap64 = _GD_Swap64Scalar;
+      _GD_Kernel.convert = _GD_ConvertScalar;
+      _GD_Kernel.lincom = _GD_LincomScalar;
+      _GD_Kernel.horner = _GD_HornerScalar;
+      _GD_Kernel.bits = _GD_BitsScalar;
+      _GD_Kernel.linterp = _GD_LinterpScalar;
+      break;
+  }
+  _GD_Kernel.level = level;
+
+  dreturn("%i", level);
+  return level;
+}
+
+/* The name of a kernel level, or NULL */
+const char *_GD_KernelName(int level)
+{
+  static const char *const name[GD_N_KERNELS] = { "scalar", "sse2", "avx2",
+    "neon" };
+
+  if (level < 0 || level >= GD_N_KERNELS)
+    return NULL;
+
+  return name[level];
+}
+
+/* the number of samples converted at a time by the fused kernels */
+#define GD_KERNEL_CHUNK 512
+
+#define GD_KERNEL_READY() do { \
+  if (_GD_Kernel.level < 0) \
+    _GD_KernelInit(GD_KERNEL_BEST); \
+} while (0)
+
+/* Swap the byte order of the n elements of size bytes in buf */
+void _GD_KernelSwap(void *buf, size_t n, int size)
+{
+  GD_KERNEL_READY();
+
+  switch (size) {
+    case 2:
+      (*_GD_Kernel.swap16)(buf, n);
+      break;
+    case 4:
+      (*_GD_Kernel.swap32)(buf, n);
+      break;
+    case 8:
+      (*_GD_Kernel.swap64)(buf, n);
+      break;
+  }
+}
+
+/* Convert n samples from in_type to out_type.  The buffers may be the same, if
+ * out_type is no narrower than in_type.  Returns zero, having done nothing,
+ * if there's no kernel for the conversion.
+ */
+int _GD_KernelConvert(const void *in, gd_type_t in_type, void *out,
+    gd_type_t out_type, size_t n)
+{
+  GD_KERNEL_READY();
+
+  return (*_GD_Kernel.convert)(in, in_type, out, out_type, n);
+}
+
+/* Compute the real-valued LINCOM of n inputs of the same length, replacing
+ * the first, d1, with the result */
+void _GD_KernelLincom(int n, double *restrict d1, const double *restrict d2,
+    const double *restrict d3, const double *restrict m,
+    const double *restrict b, size_t len)
+{
+  GD_KERNEL_READY();
+
+  (*_GD_Kernel.lincom)(n, d1, d2, d3, m, b, len);
+}
+
+/* Interpolate the n points in x on a real LUT, given the segment each lies
+ * in, seg, and the LUT's segments, as stored in its gd_lutidx_, storing the
+ * results in out, which may be x */
+void _GD_KernelLinterp(double *out, const double *x, const int32_t *seg,
+    size_t n, const double *sx, const double *sy, const double *slope)
+{
+  GD_KERNEL_READY();
+
+  (*_GD_Kernel.linterp)(out, x, seg, n, sx, sy, slope);
+}
+
+/* Evaluate the real polynomial of order n with coefficients a at the npts
+ * points in, of type in_type, storing the results in out, of type out_type,
+ * which may be GD_FLOAT32 or GD_FLOAT64.  This fuses the conversion of the
+ * input with the evaluation: a narrow input is never stored as double
+ * precision in full.  The buffers may be the same, if out_type is no narrower
+ * than in_type.  Returns zero, having done nothing, if there's no kernel for
+ * the conversions.
+ */
+int _GD_KernelPolynom(int n, const double *a, const void *in,
+    gd_type_t in_type, void *out, gd_type_t out_type, size_t npts)
+{
+  double x[GD_KERNEL_CHUNK];
+  const size_t is = GD_SIZE(in_type), os = GD_SIZE(out_type);
+  size_t m;
+
+  GD_KERNEL_READY();
+
+  /* a zero-length conversion reports whether it's possible */
+  if (n < 1 || n > GD_MAX_POLYORD ||
+      (out_type != GD_FLOAT64 && out_type != GD_FLOAT32) ||
+      (in_type != GD_FLOAT64 &&
+       !(*_GD_Kernel.convert)(in, in_type, x, GD_FLOAT64, 0)) ||
+      (out_type != GD_FLOAT64 &&
+       !(*_GD_Kernel.convert)(x, GD_FLOAT64, out, out_type, 0)))
+  {
+    return 0;
+  }
+
+  /* no conversion needed */
+  if (in_type == GD_FLOAT64 && out_type == GD_FLOAT64) {
+    if (in != out)
+      memmove(out, in, npts * sizeof(double));
+    (*_GD_Kernel.horner)((double *)out, npts, n, a);
+    return 1;
+  }
+
+  /* chunks are done from the end, like conversions, so that in may be out */
+  for (; npts > 0; npts -= m) {
+    const char *i;
+    double *o;
+
+    m = (npts > GD_KERNEL_CHUNK) ? GD_KERNEL_CHUNK : npts;
+    i = (const char *)in + (npts - m) * is;
+
+    /* double precision output is evaluated where it lands */
+    o = (out_type == GD_FLOAT64) ? (double *)out + npts - m : x;
+
+    if (in_type == GD_FLOAT64)
+      memcpy(o, i, m * sizeof(double));
+    else
+      (*_GD_Kernel.convert)(i, in_type, o, GD_FLOAT64, m);
+
+    (*_GD_Kernel.horner)(o, m, n, a);
+
+    if (o == x)
+      (*_GD_Kernel.convert)(x, GD_FLOAT64, (char *)out + (npts - m) * os,
+          out_type, m);
+  }
+
+  return 1;
+}
+
+/* Extract numbits bits starting at bitnum from each of the n integers of size
+ * bytes in buf, sign-extending them, if is_signed, to the full size */
+void _GD_KernelBits(void *buf, size_t n, int size, int bitnum, int numbits,
+    int is_signed)
+{
+  GD_KERNEL_READY();
+
+  (*_GD_Kernel.bits)(buf, n, size, bitnum, numbits, is_signed);
+}
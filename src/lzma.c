@@ -32,12 +32,31 @@
 #define GD_LZMA_DATA_IN 32752
 #define GD_LZMA_LOOKBACK 4096
 
+/* When we can, we write .xz files in blocks of this many bytes of
+ * uncompressed data, compressed in parallel by up to GD_LZMA_MAX_THREADS
+ * threads.  Each block can be decompressed on its own, which is what makes
+ * seeking cheap. */
+#define GD_LZMA_BLOCK_SIZE (1 << 22)
+#define GD_LZMA_MAX_THREADS 8
+
+#ifdef HAVE_LZMA_FILE_INFO_DECODER
+#define GD_LZMA_INDEX
+#endif
+
 struct gd_lzmadata {
   lzma_stream xz;
   FILE* stream;
   int stream_end;
   int input_eof;
   int offset; /* Offset into the output buffer */
+  uint64_t base; /* when appending: the size of the data already there */
+#ifdef GD_LZMA_INDEX
+  lzma_index *index; /* the .xz index, once we've read it */
+  int index_state; /* 0 = not read yet; 1 = read; -1 = unavailable */
+  int in_block; /* decoding the block iter points to with a block decoder */
+  lzma_index_iter iter;
+  lzma_block block; /* the block decoder keeps a pointer to this */
+#endif
   uint8_t data_in[GD_LZMA_DATA_IN];
   uint8_t data_out[GD_LZMA_DATA_OUT];
 };
@@ -55,7 +74,184 @@ struct gd_lzmadata {
 #define LZEOF(p) ((p).stream_end || (p).input_eof)
 
 /* The lzma encoding scheme uses edata as a gd_lzmadata pointer.  If a file is
- * open, idata = 0 otherwise idata = -1. */
+ * open, idata = 0 otherwise idata = -1.
+ *
+ * An .xz file ends with an index of the blocks it contains.  When liblzma can
+ * read it for us, seeks which leave the output buffer start decoding at the
+ * block containing the target, using a block decoder, which then moves on
+ * from block to block, instead of decoding everything before the target.  The
+ * index also gives the uncompressed size of the file directly.
+ *
+ * A write which starts at the end of the data is done by appending a new
+ * stream to the file (GD_FILE_APPEND).  The decoders are told to expect
+ * concatenated streams, and the file's index covers them all. */
+
+#ifdef GD_LZMA_INDEX
+/* Read the index of the .xz file stream.  Returns NULL if it can't be read,
+ * which isn't necessarily an error: legacy .lzma files have no index. */
+static lzma_index *_GD_LzmaReadIndex(FILE *stream)
+{
+  lzma_stream xz = LZMA_STREAM_INIT;
+  lzma_index *index = NULL;
+  uint8_t buf[GD_LZMA_DATA_IN];
+  gd_stat64_t statbuf;
+  lzma_ret e = LZMA_OK;
+
+  dtrace("%p", stream);
+
+  if (gd_fstat64(fileno(stream), &statbuf) ||
+      lzma_file_info_decoder(&xz, &index, UINT64_MAX, statbuf.st_size)
+      != LZMA_OK)
+  {
+    dreturn("%p", NULL);
+    return NULL;
+  }
+
+  if (fseeko64(stream, 0, SEEK_SET)) {
+    lzma_end(&xz);
+    dreturn("%p", NULL);
+    return NULL;
+  }
+
+  for (;;) {
+    if (xz.avail_in == 0) {
+      xz.next_in = buf;
+      xz.avail_in = fread(buf, 1, GD_LZMA_DATA_IN, stream);
+      if (xz.avail_in == 0 && ferror(stream))
+        break;
+    }
+
+    e = lzma_code(&xz, (xz.avail_in == 0) ? LZMA_FINISH : LZMA_RUN);
+
+    if (e == LZMA_SEEK_NEEDED) {
+      /* the decoder wants something else */
+      if (fseeko64(stream, xz.seek_pos, SEEK_SET))
+        break;
+      xz.avail_in = 0;
+    } else if (e != LZMA_OK)
+      break;
+  }
+  lzma_end(&xz);
+
+  /* on success, the decoder gives us the index at the end */
+  if (e != LZMA_STREAM_END) {
+    if (index)
+      lzma_index_end(index, NULL);
+    index = NULL;
+  }
+
+  dreturn("%p", index);
+  return index;
+}
+
+/* Start a block decoder on the block lzd->iter points to.  The output buffer
+ * is left alone.  Returns non-zero on error. */
+static int _GD_LzmaStartBlock(struct gd_lzmadata *lzd, int *errnum)
+{
+  lzma_filter filters[LZMA_FILTERS_MAX + 1];
+  lzma_block *block = &lzd->block;
+  const uint64_t total_out = lzd->xz.total_out;
+  lzma_ret e;
+  int i;
+
+  dtrace("%p, %p", lzd, errnum);
+
+  if (fseeko64(lzd->stream, lzd->iter.block.compressed_file_offset, SEEK_SET)
+      || fread(lzd->data_in, 1, 1, lzd->stream) != 1)
+  {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  memset(block, 0, sizeof(*block));
+  block->version = 0;
+  block->check = lzd->iter.stream.flags->check;
+  block->filters = filters;
+  block->header_size = lzma_block_header_size_decode(lzd->data_in[0]);
+
+  if (lzd->data_in[0] == 0) {
+    /* an index, not a block: the index is wrong */
+    *errnum = LZMA_DATA_ERROR;
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  if (fread(lzd->data_in + 1, 1, block->header_size - 1, lzd->stream) !=
+      block->header_size - 1)
+  {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  e = lzma_block_header_decode(block, NULL, lzd->data_in);
+  if (e == LZMA_OK) {
+    e = lzma_block_compressed_size(block, lzd->iter.block.unpadded_size);
+    if (e == LZMA_OK)
+      e = lzma_block_decoder(&lzd->xz, block);
+
+    /* the decoder has what it needs from these by now */
+    for (i = 0; filters[i].id != LZMA_VLI_UNKNOWN; ++i)
+      free(filters[i].options);
+    block->filters = NULL;
+  }
+
+  if (e != LZMA_OK) {
+    *errnum = e;
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  lzd->xz.next_in = lzd->data_in;
+  lzd->xz.avail_in = 0;
+  lzd->xz.total_out = total_out;
+  lzd->input_eof = lzd->stream_end = 0;
+  lzd->in_block = 1;
+
+  dreturn("%i", 0);
+  return 0;
+}
+#endif
+
+#ifdef HAVE_LZMA_STREAM_ENCODER_MT
+/* Set up a multithreaded encoder, which writes blocks of GD_LZMA_BLOCK_SIZE
+ * bytes.  There's no point in a dictionary bigger than a block. */
+static lzma_ret _GD_LzmaEncoder(lzma_stream *xz)
+{
+  lzma_options_lzma opt;
+  lzma_filter filters[2];
+  lzma_mt mt;
+  lzma_ret e;
+
+  dtrace("%p", xz);
+
+  if (lzma_lzma_preset(&opt, 9)) {
+    dreturn("%i", LZMA_OPTIONS_ERROR);
+    return LZMA_OPTIONS_ERROR;
+  }
+
+  if (opt.dict_size > GD_LZMA_BLOCK_SIZE)
+    opt.dict_size = GD_LZMA_BLOCK_SIZE;
+
+  filters[0].id = LZMA_FILTER_LZMA2;
+  filters[0].options = &opt;
+  filters[1].id = LZMA_VLI_UNKNOWN;
+
+  memset(&mt, 0, sizeof(mt));
+  mt.threads = lzma_cputhreads();
+  if (mt.threads < 1)
+    mt.threads = 1;
+  else if (mt.threads > GD_LZMA_MAX_THREADS)
+    mt.threads = GD_LZMA_MAX_THREADS;
+  mt.block_size = GD_LZMA_BLOCK_SIZE;
+  mt.filters = filters;
+  mt.check = LZMA_CHECK_CRC64;
+
+  e = lzma_stream_encoder_mt(xz, &mt);
+
+  dreturn("%i", e);
+  return e;
+}
+#endif
 
 static struct gd_lzmadata *_GD_LzmaDoOpen(int dirfd, struct gd_raw_file_* file,
     unsigned int mode)
@@ -71,6 +267,10 @@ static struct gd_lzmadata *_GD_LzmaDoOpen(int dirfd, struct gd_raw_file_* file,
 
   if (mode & GD_FILE_READ) {
     fd = gd_OpenAt(file->D, dirfd, file->name, O_RDONLY | O_BINARY, 0666);
+  } else if (mode & GD_FILE_APPEND) {
+    fd = gd_OpenAt(file->D, dirfd, file->name, O_WRONLY | O_APPEND | O_BINARY,
+        0666);
+    fdmode = "ab";
   } else if (mode & GD_FILE_TEMP) {
     fd = _GD_MakeTempFile(file->D, dirfd, file->name);
     fdmode = "wb";
@@ -105,9 +305,13 @@ static struct gd_lzmadata *_GD_LzmaDoOpen(int dirfd, struct gd_raw_file_* file,
   lzd->xz.next_out = lzd->data_out;
   lzd->xz.avail_out = GD_LZMA_DATA_OUT;
   if (mode & GD_FILE_READ)
-    e = lzma_auto_decoder(&lzd->xz, UINT64_MAX, 0);
+    e = lzma_auto_decoder(&lzd->xz, UINT64_MAX, LZMA_CONCATENATED);
   else {
+#ifdef HAVE_LZMA_STREAM_ENCODER_MT
+    e = _GD_LzmaEncoder(&lzd->xz);
+#else
     e = lzma_easy_encoder(&lzd->xz, 9, LZMA_CHECK_CRC64);
+#endif
     memset(lzd->data_in, 0, GD_LZMA_DATA_IN);
   }
 
@@ -123,10 +327,21 @@ static struct gd_lzmadata *_GD_LzmaDoOpen(int dirfd, struct gd_raw_file_* file,
   return lzd;
 }
 
-int _GD_LzmaOpen(int dirfd, struct gd_raw_file_* file,
-    gd_type_t data_type gd_unused_, int swap gd_unused_, unsigned int mode)
+int _GD_LzmaOpen(int dirfd, struct gd_raw_file_* file, gd_type_t data_type,
+    int swap, unsigned int mode)
 {
-  dtrace("%i, %p, <unused>, <unused>, 0x%X", dirfd, file, mode);
+  off64_t n = 0;
+
+  dtrace("%i, %p, 0x%X, %i, 0x%X", dirfd, file, data_type, swap, mode);
+
+  /* new data goes after the old */
+  if (mode & GD_FILE_APPEND) {
+    n = _GD_LzmaSize(dirfd, file, data_type, swap);
+    if (n < 0) {
+      dreturn("%i", 1);
+      return 1;
+    }
+  }
 
   file->edata = _GD_LzmaDoOpen(dirfd, file, mode);
 
@@ -135,8 +350,9 @@ int _GD_LzmaOpen(int dirfd, struct gd_raw_file_* file,
     return 1;
   }
 
+  ((struct gd_lzmadata *)file->edata)->base = n * GD_SIZE(data_type);
   file->mode = mode;
-  file->pos = 0;
+  file->pos = n;
   file->idata = 0;
   dreturn("%i", 0);
   return 0;
@@ -192,6 +408,18 @@ static int _GD_LzmaReady(struct gd_lzmadata *lzd, size_t nreq, int size,
 
     ready = READY(*lzd);
     if (e == LZMA_STREAM_END) {
+#ifdef GD_LZMA_INDEX
+      /* on to the next block, if there is one */
+      if (lzd->in_block && !lzma_index_iter_next(&lzd->iter,
+            LZMA_INDEX_ITER_NONEMPTY_BLOCK))
+      {
+        if (_GD_LzmaStartBlock(lzd, errnum)) {
+          dreturn("%i", -1);
+          return -1;
+        }
+        continue;
+      }
+#endif
       lzd->stream_end = 1;
       break;
     }
@@ -310,6 +538,49 @@ off64_t _GD_LzmaSeek(struct gd_raw_file_* file, off64_t count,
       return file->pos;
     }
 
+#ifdef GD_LZMA_INDEX
+    /* read the index, if we haven't tried yet.  This moves the file
+     * position, which we have to restore */
+    if (lzd->index_state == 0) {
+      const off64_t here = ftello64(lzd->stream);
+
+      lzd->index = _GD_LzmaReadIndex(lzd->stream);
+      lzd->index_state = lzd->index ? 1 : -1;
+      clearerr(lzd->stream);
+
+      if (fseeko64(lzd->stream, here, SEEK_SET)) {
+        dreturn("%i", -1);
+        return -1;
+      }
+    }
+
+    /* skip to the block holding the target, if we're going backwards, or if
+     * it's after the one we're in.  Past the end, we find the last block, and
+     * run off the end of that */
+    if (lzd->index_state == 1) {
+      const lzma_vli total = lzma_index_uncompressed_size(lzd->index);
+      lzma_index_iter iter;
+
+      lzma_index_iter_init(&iter, lzd->index);
+      if (total > 0 && !lzma_index_iter_locate(&iter,
+            (byte_count < total) ? byte_count : total - 1) &&
+          (BASE(*lzd) > byte_count ||
+           iter.block.uncompressed_file_offset > lzd->xz.total_out))
+      {
+        lzd->iter = iter;
+        if (_GD_LzmaStartBlock(lzd, &file->error)) {
+          dreturn("%i", -1);
+          return -1;
+        }
+        lzd->xz.next_out = lzd->data_out;
+        lzd->xz.avail_out = GD_LZMA_DATA_OUT;
+        lzd->xz.total_out = iter.block.uncompressed_file_offset;
+        lzd->offset = 0;
+        _GD_CountIndexSeek(file);
+      }
+    }
+#endif
+
     if (BASE(*lzd) > byte_count) {
       /* a backwards seek -- rewind to the beginning */
       lzd->xz.avail_in = 0;
@@ -317,7 +588,7 @@ off64_t _GD_LzmaSeek(struct gd_raw_file_* file, off64_t count,
       lzd->xz.total_in = lzd->xz.total_out = 0;
       lzd->xz.next_in = lzd->data_in;
       lzd->xz.next_out = lzd->data_out;
-      e = lzma_auto_decoder(&lzd->xz, UINT64_MAX, 0);
+      e = lzma_auto_decoder(&lzd->xz, UINT64_MAX, LZMA_CONCATENATED);
       if (e != LZMA_OK) {
         file->error = e;
         file->idata = -1;
@@ -329,6 +600,9 @@ off64_t _GD_LzmaSeek(struct gd_raw_file_* file, off64_t count,
       }
       rewind(lzd->stream);
       lzd->input_eof = lzd->stream_end = 0;
+#ifdef GD_LZMA_INDEX
+      lzd->in_block = 0;
+#endif
     }
 
     /* seek forward the slow way */
@@ -356,8 +630,8 @@ off64_t _GD_LzmaSeek(struct gd_raw_file_* file, off64_t count,
     }
   } else {
     /* we only get here when we need to pad */
-    while (lzd->xz.total_in < byte_count) {
-      int n = byte_count - lzd->xz.total_in;
+    while (lzd->base + lzd->xz.total_in < byte_count) {
+      int n = byte_count - (lzd->base + lzd->xz.total_in);
       if (n > GD_LZMA_DATA_IN)
         n = GD_LZMA_DATA_IN;
 
@@ -452,6 +726,10 @@ int _GD_LzmaClose(struct gd_raw_file_ *file)
 
   /* shutdown */
   lzma_end(&lzd->xz);
+#ifdef GD_LZMA_INDEX
+  if (lzd->index)
+    lzma_index_end(lzd->index, NULL);
+#endif
   if (fclose(lzd->stream)) {
     dreturn("%i", 1);
     return 1;
@@ -498,6 +776,24 @@ off64_t _GD_LzmaSize(int dirfd, struct gd_raw_file_ *file, gd_type_t data_type,
     return -1;
   }
 
+#ifdef GD_LZMA_INDEX
+  /* the index knows */
+  lzd->index = _GD_LzmaReadIndex(lzd->stream);
+  if (lzd->index) {
+    n = lzma_index_uncompressed_size(lzd->index) / size;
+
+    lzma_index_end(lzd->index, NULL);
+    lzma_end(&lzd->xz);
+    fclose(lzd->stream);
+    free(lzd);
+
+    dreturn("%" PRId64 " (indexed)", (int64_t)n);
+    return n;
+  }
+  clearerr(lzd->stream);
+  rewind(lzd->stream);
+#endif
+
   /* read until EOF */
   while (!LZEOF(*lzd)) {
     if (_GD_LzmaReady(lzd, GD_LZMA_DATA_OUT, size, &file->error) < 0) {
@@ -314,6 +314,8 @@ static int _GD_Change(DIRFILE *D, const char *field_code, const gd_entry_t *N,
 
   if ((D->flags & GD_ACCMODE) != GD_RDWR)
     _GD_SetError(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
+  else if (_GD_ParseLazyForWrite(D))
+    ; /* Error already set */
   else if ((E = _GD_FindEntry(D, field_code)) == NULL)
     ; /* Error already set */
   else if (D->fragment[E->fragment_index].protection & GD_PROTECT_FORMAT)
@@ -328,6 +330,9 @@ static int _GD_Change(DIRFILE *D, const char *field_code, const gd_entry_t *N,
   early = E->flags & GD_EN_EARLY ? 1 : 0;
   calc = E->flags & GD_EN_CALC ? 1 : 0;
 
+  if (E->field_type == GD_RAW_ENTRY)
+    _GD_WBWait(D, E);
+
   memcpy(&Qe, E->e, sizeof(struct gd_private_entry_));
   memcpy(&Q, E, sizeof(gd_entry_t));
 
@@ -603,6 +608,9 @@ static int _GD_Change(DIRFILE *D, const char *field_code, const gd_entry_t *N,
         Q.EN(linterp,table) = _GD_Strdup(D, N->EN(linterp,table));
         Qe.u.linterp.table_file = NULL;
         Qe.u.linterp.table_len = -1; /* not read yet */
+        Qe.u.linterp.lut = NULL;
+        memset(&Qe.u.linterp.idx, 0, sizeof(Qe.u.linterp.idx));
+        Qe.u.linterp.map = NULL;
 
         if (Q.EN(linterp,table) == NULL)
           break;
@@ -625,6 +633,11 @@ static int _GD_Change(DIRFILE *D, const char *field_code, const gd_entry_t *N,
                 NULL);
             break;
           }
+
+          /* and its cache */
+          _GD_MoveSidecar(D, E->e->u.linterp.table_dirfd,
+              E->e->u.linterp.table_file, Qe.u.linterp.table_dirfd,
+              Qe.u.linterp.table_file);
         }
 
         modified = 1;
@@ -632,7 +645,7 @@ static int _GD_Change(DIRFILE *D, const char *field_code, const gd_entry_t *N,
         free(E->e->u.linterp.table_file);
         if (E->e->u.linterp.table_dirfd > 0)
           _GD_ReleaseDir(D, E->e->u.linterp.table_dirfd);
-        free(E->e->u.linterp.lut);
+        _GD_FreeLut(E->e);
       }
 
       break;
@@ -1067,11 +1080,21 @@ static int _GD_Change(DIRFILE *D, const char *field_code, const gd_entry_t *N,
     if (E->field_type == GD_LINTERP_ENTRY && flags)
       _GD_ReleaseDir(D, Qe.u.linterp.table_dirfd);
 
+    /* opening and closing the data file above may have moved this entry in
+     * the open list */
+    if (E->field_type == GD_RAW_ENTRY) {
+      Qe.u.raw.atime = E->e->u.raw.atime;
+      Qe.u.raw.fd_count = E->e->u.raw.fd_count;
+      Qe.u.raw.lru_prev = E->e->u.raw.lru_prev;
+      Qe.u.raw.lru_next = E->e->u.raw.lru_next;
+    }
+
     memcpy(E->e, &Qe, sizeof(struct gd_private_entry_));
     Q.e = E->e;
     memcpy(E, &Q, sizeof(gd_entry_t));
     D->fragment[E->fragment_index].modified = 1;
     D->flags &= ~GD_HAVE_VERSION;
+    D->gen++;
   }
 
   dreturn("%i", 0);
@@ -1661,6 +1684,9 @@ static int _GD_AlterSpec(DIRFILE* D, const char* line, const char* parent,
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
   if ((D->flags & GD_ACCMODE) == GD_RDONLY)
     GD_SET_RETURN_ERROR(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
 
@@ -20,21 +20,74 @@
  */
 #include "internal.h"
 
-int _GD_MogrifyFile(DIRFILE* D, gd_entry_t* E, unsigned long encoding,
-    unsigned long byte_sex, off64_t offset, int finalise, int new_fragment,
-    char* new_filebase)
+#ifdef USE_PTHREAD
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#endif
+
+#if defined HAVE_SYS_SYSCALL_H && defined HAVE_SYSCALL
+#include <sys/syscall.h>
+#ifdef SYS_copy_file_range
+#define USE_COPY_FILE_RANGE
+#endif
+#endif
+
+/* the most copy_file_range() is asked to copy at once; this is also how often
+ * a kernel copy checks for cancellation and the rate limit */
+#define GD_COPY_CHUNK 0x1000000 /* 16 MiB */
+
+/* A RAW field being rewritten by _GD_MogrifyFile or _GD_MogrifyFields.  Only
+ * _GD_MogrifyStart and _GD_MogrifyEnd touch the DIRFILE; _GD_MogrifyCopy,
+ * which does the real work, only touches this and the field's raw files, so it
+ * can run in a worker thread. */
+struct gd_mogrify_ {
+  gd_entry_t *E;
+  const struct encoding_t *enc_in, *enc_out;
+  int subencoding, new_fragment;
+  unsigned in_sex, out_sex;
+  char *new_filebase;
+  void *buffer;
+  uint64_t bytes; /* bytes copied */
+
+  /* non-zero if the data can be copied verbatim between unencoded files, in
+   * which case we try to get the kernel to do it; and how much it did */
+  int offload;
+  uint64_t offloaded;
+
+  /* set by _GD_MogrifyCopy on failure: the I/O suberror, the raw file it
+   * happened to, and errno; or -1 if the copy was cancelled */
+  int suberror, which, errnum;
+};
+
+/* Shared state for copies: cancellation, and the rate limit.  If pooled is
+ * non-zero, several copies share this, and it's protected by the lock */
+struct gd_mogrify_ctl_ {
+#ifdef USE_PTHREAD
+  pthread_mutex_t lock;
+  struct timespec t0;
+#endif
+  int pooled, cancel;
+  uint64_t max_rate, bytes;
+};
+
+/* Check the conversion, and open the input and output files.  Returns -1 on
+ * error, 0 if there's nothing to do, or 1 if m is ready to copy. */
+static int _GD_MogrifyStart(DIRFILE *D, struct gd_mogrify_ *m, gd_entry_t *E,
+    unsigned long encoding, unsigned long byte_sex, off64_t offset,
+    int new_fragment, char *new_filebase)
 {
   const struct encoding_t* enc_in;
   const struct encoding_t* enc_out;
-  const size_t ns = GD_BUFFER_SIZE / E->e->u.raw.size;
-  ssize_t nread, nwrote;
   int subencoding = GD_ENC_UNKNOWN;
   int i, ef_swap;
   int arm_fix = 0, endian_fix = 0;
-  void *buffer;
 
-  dtrace("%p, %p, %lu, %lu, %" PRId64 ", %i, %i, %p", D, E, encoding, byte_sex,
-      (int64_t)offset, finalise, new_fragment, new_filebase);
+  dtrace("%p, %p, %p, %lu, %lu, %" PRId64 ", %i, %p", D, m, E, encoding,
+      byte_sex, (int64_t)offset, new_fragment, new_filebase);
+
+  memset(m, 0, sizeof(*m));
+  m->E = E;
 
   if (new_fragment == -1)
     new_fragment = E->fragment_index;
@@ -194,19 +247,180 @@ int _GD_MogrifyFile(DIRFILE* D, gd_entry_t* E, unsigned long encoding,
     return -1;
   }
 
-  if ((buffer = _GD_Malloc(D, GD_BUFFER_SIZE)) == NULL) {
+  if ((m->buffer = _GD_Malloc(D, GD_BUFFER_SIZE)) == NULL) {
     free(new_filebase);
     dreturn("%i", -1);
     return -1;
   }
 
-  /* Now copy the old file to the new file */
+  m->enc_in = enc_in;
+  m->enc_out = enc_out;
+  m->subencoding = subencoding;
+  m->new_fragment = new_fragment;
+  m->new_filebase = new_filebase;
+  m->in_sex = D->fragment[E->fragment_index].byte_sex;
+  m->out_sex = byte_sex;
+  m->offload = (enc_in->scheme == GD_UNENCODED &&
+      enc_out->scheme == GD_UNENCODED && !endian_fix && !arm_fix);
+
+  dreturn("%i", 1);
+  return 1;
+}
+
+/* Account for n more bytes copied, and wait, if necessary, to keep the total
+ * copy rate under the limit.  Returns non-zero if the copy should stop. */
+static int _GD_MogrifyThrottle(struct gd_mogrify_ctl_ *ctl, size_t n)
+{
+  int cancel;
+#ifdef USE_PTHREAD
+  struct timespec now;
+  double due = 0;
+#endif
+
+  dtrace("%p, %" PRIuSIZE, ctl, n);
+
+  if (!ctl->pooled) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+#ifdef USE_PTHREAD
+  /* the time, since the start, by which the copies should have done this
+   * much */
+  pthread_mutex_lock(&ctl->lock);
+  cancel = ctl->cancel;
+  ctl->bytes += n;
+  if (ctl->max_rate > 0)
+    due = (double)ctl->bytes / ctl->max_rate;
+  pthread_mutex_unlock(&ctl->lock);
+
+  if (due > 0 && !cancel) {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    due -= (now.tv_sec - ctl->t0.tv_sec) +
+      (now.tv_nsec - ctl->t0.tv_nsec) * 1e-9;
+    if (due > 0) {
+      struct timespec nap;
+      nap.tv_sec = (time_t)due;
+      nap.tv_nsec = (long)((due - nap.tv_sec) * 1e9);
+      nanosleep(&nap, NULL);
+    }
+  }
+#else
+  cancel = ctl->cancel;
+#endif
+
+  dreturn("%i", cancel);
+  return cancel;
+}
+
+#ifdef USE_COPY_FILE_RANGE
+/* Copy as much as possible of the old file to the new one with
+ * copy_file_range(), which keeps the data in the kernel, and, on filesystems
+ * which support it, shares the blocks between the files rather than copying
+ * them.  Returns non-zero if the copy is finished (or failed); otherwise,
+ * the kernel can't do it, and the caller should copy whatever's left itself.
+ * This mustn't touch the DIRFILE. */
+static int _GD_MogrifyOffload(struct gd_mogrify_ *m,
+    struct gd_mogrify_ctl_ *ctl)
+{
+  struct gd_raw_file_ *file = m->E->e->u.raw.file;
+  const size_t size = m->E->e->u.raw.size;
+  int64_t in_off = (int64_t)file[0].pos * size;
+  int64_t out_off = (int64_t)file[1].pos * size;
+  int64_t end;
+  ssize_t n = 0;
+  size_t len;
+  gd_stat64_t statbuf;
+  int done = 1;
+
+  dtrace("%p, %p", m, ctl);
+
+  if (gd_fstat64(file[0].idata, &statbuf)) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  /* like the read/write loop, ignore a partial sample at the end */
+  end = statbuf.st_size - statbuf.st_size % size;
+
+  while (in_off < end) {
+    if (_GD_MogrifyThrottle(ctl, n)) {
+      m->suberror = -1;
+      break;
+    }
+
+    len = (end - in_off > GD_COPY_CHUNK) ? GD_COPY_CHUNK :
+      (size_t)(end - in_off);
+    n = (ssize_t)syscall(SYS_copy_file_range, file[0].idata, &in_off,
+        file[1].idata, &out_off, len, 0U);
+
+    if (n < 0) {
+      /* these just mean the kernel can't do this copy */
+      if (errno == ENOSYS || errno == EXDEV || errno == EINVAL ||
+          errno == EOPNOTSUPP || errno == EBADF)
+      {
+        done = 0;
+      } else {
+        m->suberror = GD_E_IO_WRITE;
+        m->which = 1;
+        m->errnum = errno;
+      }
+      break;
+    } else if (n == 0) /* the file got shorter */
+      break;
+
+    m->bytes += n;
+    m->offloaded += n;
+  }
+
+  /* copy_file_range() doesn't move the file offsets; if we're falling back on
+   * the read/write loop, it needs them to be where we stopped */
+  file[0].pos = in_off / size;
+  file[1].pos = out_off / size;
+  if (!done && (lseek64(file[0].idata, file[0].pos * size, SEEK_SET) < 0 ||
+        lseek64(file[1].idata, file[1].pos * size, SEEK_SET) < 0))
+  {
+    m->suberror = GD_E_IO_WRITE;
+    m->which = 1;
+    m->errnum = errno;
+    done = 1;
+  }
+
+  dreturn("%i", done);
+  return done;
+}
+#endif
+
+/* Copy the old file to the new one.  This mustn't touch the DIRFILE. */
+static void _GD_MogrifyCopy(struct gd_mogrify_ *m, struct gd_mogrify_ctl_ *ctl)
+{
+  gd_entry_t *E = m->E;
+  const size_t ns = GD_BUFFER_SIZE / E->e->u.raw.size;
+  ssize_t nread = 0, nwrote;
+
+  dtrace("%p, %p", m, ctl);
+
+#ifdef USE_COPY_FILE_RANGE
+  if (m->offload && _GD_MogrifyOffload(m, ctl)) {
+    dreturnvoid();
+    return;
+  }
+#endif
+
   for (;;) {
-    nread = (*enc_in->read)(E->e->u.raw.file, buffer, E->EN(raw,data_type),
-        ns);
+    if (_GD_MogrifyThrottle(ctl, nread * E->e->u.raw.size)) {
+      m->suberror = -1;
+      break;
+    }
+
+    errno = 0;
+    nread = (*m->enc_in->read)(E->e->u.raw.file, m->buffer,
+        E->EN(raw,data_type), ns);
 
     if (nread < 0) {
-      _GD_SetEncIOError(D, GD_E_IO_READ, E->e->u.raw.file + 0);
+      m->suberror = GD_E_IO_READ;
+      m->which = 0;
+      m->errnum = errno;
       break;
     }
 
@@ -214,19 +428,47 @@ int _GD_MogrifyFile(DIRFILE* D, gd_entry_t* E, unsigned long encoding,
       break;
 
     /* swap endianness, if required */
-    _GD_FixEndianness(buffer, nread, E->EN(raw,data_type),
-        D->fragment[E->fragment_index].byte_sex, byte_sex);
+    _GD_FixEndianness(m->buffer, nread, E->EN(raw,data_type), m->in_sex,
+        m->out_sex);
 
-    nwrote = _GD_WriteOut(E, enc_out, buffer, E->EN(raw,data_type), nread, 1);
+    errno = 0;
+    nwrote = _GD_WriteOut(E, m->enc_out, m->buffer, E->EN(raw,data_type),
+        nread, 1);
 
     if (nwrote < nread) {
-      _GD_SetEncIOError(D, GD_E_IO_WRITE, E->e->u.raw.file + 1);
+      m->suberror = GD_E_IO_WRITE;
+      m->which = 1;
+      m->errnum = errno;
       break;
     }
+
+    m->bytes += nread * E->e->u.raw.size;
   }
 
-  free(buffer);
+  dreturnvoid();
+}
+
+/* Report the copy's error, if any, and finish up: if finalise is non-zero,
+ * replace the old file with the new one, or delete the new one on error;
+ * otherwise just close both.  Returns non-zero on error. */
+static int _GD_MogrifyEnd(DIRFILE *D, struct gd_mogrify_ *m, int finalise)
+{
+  gd_entry_t *E = m->E;
+  const int subencoding = m->subencoding;
+  const int new_fragment = m->new_fragment;
+  char *new_filebase = m->new_filebase;
+
+  dtrace("%p, %p, %i", D, m, finalise);
+
+  free(m->buffer);
+  m->buffer = NULL;
 
+  D->counter[GD_COUNTER_COPY_OFFLOAD] += m->offloaded;
+
+  if (m->suberror > 0 && !D->error) {
+    errno = m->errnum;
+    _GD_SetEncIOError(D, m->suberror, E->e->u.raw.file + m->which);
+  }
 
   if (finalise) {
     /* Finalise the conversion: on error delete the temporary file, otherwise
@@ -236,7 +478,9 @@ int _GD_MogrifyFile(DIRFILE* D, gd_entry_t* E, unsigned long encoding,
        * file can stay open) */
       _GD_FiniRawIO(D, E, new_fragment, GD_FINIRAW_CLOTEMP
           | GD_FINIRAW_DISCARD);
+      free(new_filebase);
     } else {
+      const struct encoding_t *enc_in = m->enc_in;
       struct gd_raw_file_ temp;
       memcpy(&temp, E->e->u.raw.file, sizeof(temp));
 
@@ -252,11 +496,13 @@ int _GD_MogrifyFile(DIRFILE* D, gd_entry_t* E, unsigned long encoding,
       {
         E->e->u.raw.file[0].name = temp.name;
         E->e->u.raw.file[0].subenc = temp.subenc;
+        free(new_filebase);
       } else if (_GD_FiniRawIO(D, E, new_fragment, GD_FINIRAW_KEEP |
             GD_FINIRAW_CLOTEMP))
       {
         E->e->u.raw.file[0].name = temp.name;
         E->e->u.raw.file[0].subenc = temp.subenc;
+        free(new_filebase);
       } else if ((subencoding != temp.subenc || strcmp(E->e->u.raw.filebase,
               new_filebase) || D->fragment[new_fragment].dirfd !=
             D->fragment[E->fragment_index].dirfd) && (*enc_in->unlink)(
@@ -265,6 +511,7 @@ int _GD_MogrifyFile(DIRFILE* D, gd_entry_t* E, unsigned long encoding,
         _GD_SetError(D, GD_E_IO, GD_E_IO_UNLINK, temp.name, 0, NULL);
         E->e->u.raw.file[0].name = temp.name;
         E->e->u.raw.file[0].subenc = temp.subenc;
+        free(new_filebase);
       } else {
         free(temp.name);
         free(E->e->u.raw.filebase);
@@ -279,13 +526,269 @@ int _GD_MogrifyFile(DIRFILE* D, gd_entry_t* E, unsigned long encoding,
     _GD_FiniRawIO(D, E, new_fragment, GD_FINIRAW_DEFER | GD_FINIRAW_CLOTEMP);
   }
 
-  if (D->error) {
-    dreturn("%i", -1);
-    return -1;
+  dreturn("%i", D->error ? -1 : 0);
+  return D->error ? -1 : 0;
+}
+
+int _GD_MogrifyFile(DIRFILE* D, gd_entry_t* E, unsigned long encoding,
+    unsigned long byte_sex, off64_t offset, int finalise, int new_fragment,
+    char* new_filebase)
+{
+  struct gd_mogrify_ m;
+  struct gd_mogrify_ctl_ ctl;
+  int r;
+
+  dtrace("%p, %p, %lu, %lu, %" PRId64 ", %i, %i, %p", D, E, encoding, byte_sex,
+      (int64_t)offset, finalise, new_fragment, new_filebase);
+
+  r = _GD_MogrifyStart(D, &m, E, encoding, byte_sex, offset, new_fragment,
+      new_filebase);
+
+  if (r <= 0) {
+    dreturn("%i", r);
+    return r;
   }
 
-  dreturn("%i", 0);
-  return 0;
+  memset(&ctl, 0, sizeof(ctl));
+  _GD_MogrifyCopy(&m, &ctl);
+
+  r = _GD_MogrifyEnd(D, &m, finalise);
+
+  dreturn("%i", r);
+  return r;
+}
+
+/* Tell the caller how things are going, after a field is finished.  Returns
+ * non-zero if they want us to stop. */
+static int _GD_MogrifyProgress(DIRFILE *D, const gd_entry_t *E,
+    unsigned int n_done, unsigned int n, uint64_t bytes)
+{
+  gd_move_data_t pdata;
+  int r;
+
+  dtrace("%p, %p, %u, %u, %" PRIu64, D, E, n_done, n, bytes);
+
+  if (D->move_callback == NULL) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  pdata.dirfile = D;
+  pdata.field_code = E->field;
+  pdata.fragment_index = E->fragment_index;
+  pdata.n_done = n_done;
+  pdata.n_fields = n;
+  pdata.bytes = bytes;
+
+  r = (*D->move_callback)(&pdata, D->move_extra);
+  if (r != GD_MOVE_CONTINUE)
+    _GD_SetError(D, GD_E_CALLBACK, GD_E_CALLBACK_ABORT, NULL, r, NULL);
+
+  dreturn("%i", r);
+  return r;
+}
+
+#ifdef USE_PTHREAD
+/* The worker pool for _GD_MogrifyFields.  The caller's thread starts and ends
+ * the fields; the workers only copy them. */
+struct gd_mogrify_pool_ {
+  struct gd_mogrify_ctl_ ctl;
+  pthread_cond_t work; /* signalled when a field is ready, or on stop */
+  pthread_cond_t done; /* signalled when a copy is finished */
+  struct gd_mogrify_ *m;
+  int *copied; /* non-zero once a field needs ending */
+  unsigned int *ready; /* the fields ready to copy, in order */
+  unsigned int n_ready, next; /* the next one is the next to copy */
+  int stop;
+};
+
+static void *_GD_MogrifyWorker(void *arg)
+{
+  struct gd_mogrify_pool_ *pool = (struct gd_mogrify_pool_ *)arg;
+  unsigned int i;
+
+  pthread_mutex_lock(&pool->ctl.lock);
+  for (;;) {
+    while (pool->next == pool->n_ready && !pool->stop)
+      pthread_cond_wait(&pool->work, &pool->ctl.lock);
+
+    if (pool->next == pool->n_ready)
+      break;
+
+    i = pool->ready[pool->next++];
+    pthread_mutex_unlock(&pool->ctl.lock);
+
+    _GD_MogrifyCopy(pool->m + i, &pool->ctl);
+
+    pthread_mutex_lock(&pool->ctl.lock);
+    pool->copied[i] = 1;
+    pthread_cond_signal(&pool->done);
+  }
+  pthread_mutex_unlock(&pool->ctl.lock);
+
+  return NULL;
+}
+#endif
+
+/* Rewrite the data files of the n RAW fields in the list E, which all belong
+ * to the same fragment, as _GD_MogrifyFile does without finalising.  With
+ * gd_move_threads() in effect, several fields are copied at once by worker
+ * threads.  Returns the number of fields started; if D->error is set, the
+ * caller needs to discard all of those. */
+unsigned int _GD_MogrifyFields(DIRFILE *D, gd_entry_t **E, unsigned int n,
+    unsigned long encoding, unsigned long byte_sex, off64_t offset)
+{
+  unsigned int i, n_done = 0;
+  uint64_t bytes = 0;
+#ifdef USE_PTHREAD
+  struct gd_mogrify_pool_ pool;
+  pthread_t *thread;
+  unsigned int n_started = 0, n_thread, n_live;
+  int r;
+#else
+  struct gd_mogrify_ m;
+  struct gd_mogrify_ctl_ ctl;
+#endif
+
+  dtrace("%p, %p, %u, %lu, %lu, %" PRId64, D, E, n, encoding, byte_sex,
+      (int64_t)offset);
+
+#ifdef USE_PTHREAD
+  n_thread = (D->move_threads > 1) ? (unsigned int)D->move_threads : 0;
+  if (n_thread > n)
+    n_thread = n;
+
+  memset(&pool, 0, sizeof(pool));
+  pool.ctl.pooled = 1;
+  pool.ctl.max_rate = D->move_rate;
+  clock_gettime(CLOCK_MONOTONIC, &pool.ctl.t0);
+
+  pool.m = _GD_Malloc(D, sizeof(*pool.m) * n);
+  pool.copied = _GD_Malloc(D, sizeof(*pool.copied) * n);
+  pool.ready = _GD_Malloc(D, sizeof(*pool.ready) * n);
+  thread = _GD_Malloc(D, sizeof(*thread) * (n_thread + 1));
+  if (pool.m == NULL || pool.copied == NULL || pool.ready == NULL ||
+      thread == NULL)
+  {
+    free(pool.m);
+    free(pool.copied);
+    free(pool.ready);
+    free(thread);
+    dreturn("%i", 0);
+    return 0;
+  }
+  memset(pool.copied, 0, sizeof(*pool.copied) * n);
+
+  pthread_mutex_init(&pool.ctl.lock, NULL);
+  pthread_cond_init(&pool.work, NULL);
+  pthread_cond_init(&pool.done, NULL);
+
+  /* if we can't start any workers, we do the copying ourselves */
+  for (n_live = 0; n_live < n_thread; ++n_live)
+    if (pthread_create(thread + n_live, NULL, _GD_MogrifyWorker, &pool))
+      break;
+
+  for (;;) {
+    /* keep every worker busy, or, without any, start the next field.  Fields
+     * being copied are taken off the open list, so opening files for others
+     * doesn't close theirs. */
+    while (!D->error && n_started < n &&
+        n_started - n_done < (n_live ? n_live : 1))
+    {
+      i = n_started++;
+      r = _GD_MogrifyStart(D, pool.m + i, E[i], encoding, byte_sex, offset, -1,
+          NULL);
+
+      pthread_mutex_lock(&pool.ctl.lock);
+      if (r > 0) {
+        _GD_LRURemove(D, E[i]);
+        pool.ready[pool.n_ready++] = i;
+        pthread_cond_signal(&pool.work);
+      } else
+        pool.copied[i] = 1; /* nothing to copy */
+      pthread_mutex_unlock(&pool.ctl.lock);
+    }
+
+    if (n_done == n_started)
+      break;
+
+    if (n_live == 0 && pool.next < pool.n_ready) {
+      i = pool.ready[pool.next++];
+      _GD_MogrifyCopy(pool.m + i, &pool.ctl);
+      pool.copied[i] = 1;
+    }
+
+    /* wait for a copy to finish, and end it */
+    pthread_mutex_lock(&pool.ctl.lock);
+    for (;;) {
+      for (i = 0; i < n_started; ++i)
+        if (pool.copied[i] == 1)
+          break;
+      if (i < n_started)
+        break;
+      pthread_cond_wait(&pool.done, &pool.ctl.lock);
+    }
+    pool.copied[i] = 2;
+    pthread_mutex_unlock(&pool.ctl.lock);
+
+    n_done++;
+    if (!D->error && (pool.m[i].buffer == NULL ||
+          _GD_MogrifyEnd(D, pool.m + i, 0) == 0))
+    {
+      bytes += pool.m[i].bytes;
+      _GD_MogrifyProgress(D, E[i], n_done, n, bytes);
+    } else if (pool.m[i].buffer)
+      _GD_MogrifyEnd(D, pool.m + i, 0);
+
+    /* after an error, don't bother finishing the others */
+    if (D->error) {
+      pthread_mutex_lock(&pool.ctl.lock);
+      pool.ctl.cancel = 1;
+      pthread_mutex_unlock(&pool.ctl.lock);
+    }
+  }
+
+  /* shut down the workers */
+  pthread_mutex_lock(&pool.ctl.lock);
+  pool.stop = 1;
+  pthread_cond_broadcast(&pool.work);
+  pthread_mutex_unlock(&pool.ctl.lock);
+
+  for (i = 0; i < n_live; ++i)
+    pthread_join(thread[i], NULL);
+
+  pthread_cond_destroy(&pool.done);
+  pthread_cond_destroy(&pool.work);
+  pthread_mutex_destroy(&pool.ctl.lock);
+  free(thread);
+  free(pool.ready);
+  free(pool.copied);
+  free(pool.m);
+
+  dreturn("%u", n_started);
+  return n_started;
+#else
+  memset(&ctl, 0, sizeof(ctl));
+
+  for (i = 0; i < n; ++i) {
+    int r = _GD_MogrifyStart(D, &m, E[i], encoding, byte_sex, offset, -1,
+        NULL);
+    if (r < 0)
+      break;
+    else if (r > 0) {
+      _GD_MogrifyCopy(&m, &ctl);
+      if (_GD_MogrifyEnd(D, &m, 0))
+        break;
+      bytes += m.bytes;
+    }
+
+    if (_GD_MogrifyProgress(D, E[i], ++n_done, n, bytes))
+      break;
+  }
+
+  dreturn("%u", (i < n) ? i + 1 : n);
+  return (i < n) ? i + 1 : n;
+#endif
 }
 
 int _GD_StrCmpNull(const char *s1, const char *s2)
@@ -393,6 +896,7 @@ static int _GD_Move(DIRFILE *D, gd_entry_t *E, int new_fragment, unsigned flags)
   D->fragment[E->fragment_index].modified = 1;
   D->fragment[new_fragment].modified = 1;
   D->flags &= ~GD_HAVE_VERSION;
+  D->gen++;
 
   /* update metadata */
   E->fragment_index = new_fragment;
@@ -403,8 +907,10 @@ static int _GD_Move(DIRFILE *D, gd_entry_t *E, int new_fragment, unsigned flags)
     _GD_PerformRename(D, rdat);
 
   /* resort */
-  if (new_code)
+  if (new_code) {
     qsort(D->entry, D->n_entries, sizeof(gd_entry_t*), _GD_EntryCmp);
+    _GD_HashClear(D);
+  }
 
   dreturn("%i", 0);
   return 0;
@@ -420,6 +926,9 @@ int gd_move(DIRFILE *D, const char *field_code, int new_fragment,
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
   E = _GD_FindField(D, field_code, strlen(field_code), D->entry, D->n_entries,
       0, NULL);
 
@@ -444,3 +953,33 @@ int gd_move(DIRFILE *D, const char *field_code, int new_fragment,
   dreturn("%i", ret);
   return ret;
 }
+
+void gd_move_callback(DIRFILE *D, gd_move_callback_t callback, void *extra)
+  gd_nothrow
+{
+  dtrace("%p, %p, %p", D, callback, extra);
+
+  D->move_callback = callback;
+  D->move_extra = extra;
+
+  dreturnvoid();
+}
+
+int gd_move_threads(DIRFILE *D, int n_threads, uint64_t max_rate)
+{
+  dtrace("%p, %i, %" PRIu64, D, n_threads, max_rate);
+
+  GD_RETURN_ERR_IF_INVALID(D);
+
+#ifdef USE_PTHREAD
+  D->move_threads = (n_threads > 1) ? n_threads : 1;
+  D->move_rate = max_rate;
+#else
+  if (n_threads > 1 || max_rate > 0)
+    GD_SET_RETURN_ERROR(D, GD_E_UNSUPPORTED, GD_E_SUPPORT_THREADS, NULL, 0,
+        NULL);
+#endif
+
+  dreturn("%i", 0);
+  return 0;
+}
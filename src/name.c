@@ -1008,6 +1008,7 @@ void _GD_PerformRename(DIRFILE *restrict D,
 
   /* re-sort the entry list */
   qsort(D->entry, D->n_entries, sizeof(gd_entry_t*), _GD_EntryCmp);
+  _GD_HashClear(D);
 
   /* Invalidate field lists */
   rdat->fl->value_list_validity = 0;
@@ -1265,6 +1266,7 @@ static int _GD_Rename(DIRFILE *D, gd_entry_t *E, const char *new_name,
   _GD_PerformRename(D, rdat);
 
   D->flags &= ~GD_HAVE_VERSION;
+  D->gen++;
 
   dreturn("%i", 0);
   return 0;
@@ -1284,6 +1286,9 @@ int gd_rename(DIRFILE *D, const char *old_code, const char *new_name,
   if ((D->flags & GD_ACCMODE) == GD_RDONLY)
     GD_SET_RETURN_ERROR(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
 
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
   E = _GD_FindField(D, old_code, strlen(old_code), D->entry, D->n_entries, 0,
       NULL);
 
@@ -54,6 +54,11 @@ static unsigned int _GD_NEntries(DIRFILE *D, struct gd_private_entry_ *p,
         n++;
       }
   } else {
+    if (_GD_ParseLazy(D, NULL, 0) && D->error) {
+      dreturn("%u", 0);
+      return 0;
+    }
+
     for (u = 0; u < D->n_entries; ++u)
       if (_GD_ListEntry(D->entry[u], 0, hidden, noalias, special,
             GD_ALL_FRAGMENTS, ctype))
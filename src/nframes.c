@@ -31,8 +31,9 @@ off64_t gd_nframes64(DIRFILE* D)
   GD_RETURN_ERR_IF_INVALID(D);
 
   if (D->reference_field == NULL) {
-    dreturn("%i", 0);
-    return 0;
+    _GD_ParseLazyRef(D);
+    if (D->reference_field == NULL)
+      GD_RETURN_ERROR(D);
   }
 
   if (!_GD_Supports(D, D->reference_field, GD_EF_NAME | GD_EF_SIZE))
@@ -403,6 +403,7 @@ static DIRFILE *_GD_Open(DIRFILE *D, int dirfd, const char *filedir,
   int dirfd_error = 0;
   time_t mtime = 0;
   struct parser_state p;
+  int save = (flags & GD_SNAPSHOT) != 0;
 
 #ifdef GD_NO_DIR_OPEN
   gd_stat64_t statbuf;
@@ -462,6 +463,7 @@ static DIRFILE *_GD_Open(DIRFILE *D, int dirfd, const char *filedir,
   D->sehandler_extra = extra;
   D->standards = GD_DIRFILE_STANDARDS_VERSION;
   D->lookback = GD_DEFAULT_LOOKBACK;
+  D->gen = 1;
 
   if (dirfile == NULL) {
     _GD_SetError2(D, GD_E_IO, 0, filedir, 0, NULL, dirfd_error);
@@ -573,6 +575,8 @@ static DIRFILE *_GD_Open(DIRFILE *D, int dirfd, const char *filedir,
     0;
   D->fragment[0].px = D->fragment[0].sx = D->fragment[0].ns = NULL;
   D->fragment[0].pxl = D->fragment[0].sxl = D->fragment[0].nsl = 0;
+  D->fragment[0].lazy = 0;
+  D->fragment[0].stamp.size = -1;
 
   /* parser proto-state */
   p.line = 0;
@@ -583,8 +587,15 @@ static DIRFILE *_GD_Open(DIRFILE *D, int dirfd, const char *filedir,
   p.ns = NULL;
   p.nsl = 0;
 
-  /* Parser invocation */
-  ref_name = _GD_ParseFragment(fp, D, &p, 0, 1);
+  /* Parser invocation, unless there's a current snapshot of its results */
+  if (flags & GD_SNAPSHOT && _GD_FileStamp(fileno(fp), &D->fragment[0].stamp))
+    D->fragment[0].stamp.size = -1;
+
+  if (flags & GD_SNAPSHOT && _GD_LoadSnapshot(D, &p) == 0) {
+    ref_name = NULL;
+    save = 0;
+  } else
+    ref_name = _GD_ParseFragment(fp, D, &p, 0, 1);
   fclose(fp);
   free(p.ns);
 
@@ -615,6 +626,9 @@ static DIRFILE *_GD_Open(DIRFILE *D, int dirfd, const char *filedir,
     free(ref_name);
   }
 
+  if (save && D->error == GD_E_OK)
+    _GD_SaveSnapshot(D);
+
   /* Success! Clear invalid bit */
   if (D->error == GD_E_OK)
     D->flags &= ~GD_INVALID;
@@ -2304,7 +2304,8 @@ static int _GD_ParseDirective(DIRFILE *D, struct parser_state *restrict p,
 
         p->flags = D->fragment[me].encoding | D->fragment[me].byte_sex |
           (p->flags & (GD_PEDANTIC | GD_PERMISSIVE | GD_FORCE_ENDIAN |
-                       GD_FORCE_ENCODING | GD_IGNORE_DUPS | GD_IGNORE_REFS));
+                       GD_FORCE_ENCODING | GD_IGNORE_DUPS | GD_IGNORE_REFS |
+                       GD_LAZY_INCLUDE | GD_SNAPSHOT));
 
         frag = _GD_Include(D, p, in_cols[1], &new_ref, me,
             (n_cols > 2) ? in_cols[2] : NULL, (n_cols > 3) ? in_cols[3] : NULL,
@@ -2481,6 +2482,7 @@ char *_GD_ParseFragment(FILE *restrict fp, DIRFILE *D, struct parser_state *p,
   int saved_suberror = 0;
   int saved_line = 0;
   char* saved_token = NULL;
+  const int add_batch = D->add_batch;
 
   dtrace("%p, %p, %p, %i, %i", fp, D, p, me, resolve);
 
@@ -2488,6 +2490,9 @@ char *_GD_ParseFragment(FILE *restrict fp, DIRFILE *D, struct parser_state *p,
   p->line = 0;
   p->file = D->fragment[me].cname;
 
+  /* add the fragment's entries as a bulk addition, sorted once at the end */
+  D->add_batch = 1;
+
   /* start parsing */
   while (rescan || (instring = _GD_GetLine(fp, &n, &p->line))) {
     rescan = 0;
@@ -2603,6 +2608,10 @@ char *_GD_ParseFragment(FILE *restrict fp, DIRFILE *D, struct parser_state *p,
       D->fragment[me].ref_name = _GD_Strdup(D, first_raw->field);
   }
 
+  D->add_batch = add_batch;
+  if (!add_batch)
+    _GD_SortEntries(D);
+
   /* resolve aliases, if requested */
   if (resolve && !D->error)
     _GD_UpdateAliases(D, 0);
@@ -26,6 +26,8 @@ int gd_protection(DIRFILE* D, int fragment_index) gd_nothrow
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  _GD_ParseLazyIndex(D, fragment_index);
+
   if (fragment_index < 0 || fragment_index >= D->n_fragment)
     GD_SET_RETURN_ERROR(D, GD_E_BAD_INDEX, 0, NULL, fragment_index, NULL);
 
@@ -42,6 +44,9 @@ int gd_alter_protection(DIRFILE *D, int protection_level, int fragment_index)
 
   GD_RETURN_ERR_IF_INVALID(D);
 
+  if (_GD_ParseLazyForWrite(D))
+    GD_RETURN_ERROR(D);
+
   if ((D->flags & GD_ACCMODE) != GD_RDWR)
     GD_SET_RETURN_ERROR(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
 
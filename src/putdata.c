@@ -27,6 +27,8 @@ static size_t _GD_DoRawOut(DIRFILE *restrict D, gd_entry_t *restrict E,
 {
   ssize_t n_wrote;
   void *databuffer;
+  const void *out;
+  int ecor, async, arm_fix = 0;
 
   /* check protection */
   if (D->fragment[E->fragment_index].protection & GD_PROTECT_DATA) {
@@ -47,55 +49,87 @@ static size_t _GD_DoRawOut(DIRFILE *restrict D, gd_entry_t *restrict E,
 
   s0 -= D->fragment[E->fragment_index].frame_offset * E->EN(raw,spf);
 
-  if (!_GD_Supports(D, E, GD_EF_OPEN | GD_EF_SEEK | GD_EF_WRITE)) {
+  /* With write-behind, once the file is open for writing, the write is just
+   * queued.  Out-of-place encodings, which may need to reopen the file, are
+   * always written synchronously. */
+  async = (D->wb && E->e->u.raw.file[0].idata >= 0 &&
+      (E->e->u.raw.file[0].mode & GD_FILE_WRITE) &&
+      !(_GD_ef[E->e->u.raw.file[0].subenc].flags & GD_EF_OOP));
+
+  if (!async && !_GD_Supports(D, E, GD_EF_OPEN | GD_EF_SEEK | GD_EF_WRITE)) {
     dreturn("%i", 0);
     return 0;
   }
 
-  databuffer = _GD_Alloc(D, E->EN(raw,data_type), ns);
+  ecor = _GD_ef[E->e->u.raw.file[0].subenc].flags & GD_EF_ECOR;
 
-  if (databuffer == NULL) {
-    dreturn("%i", 0);
-    return 0;
-  }
+  /* If the data are already of the stored type and byte order, they can be
+   * written as they are, without a temporary buffer */
+  if (data_type == E->EN(raw,data_type) && (!ecor ||
+        (!_GD_CheckByteSex(data_type, 0,
+                           D->fragment[E->fragment_index].byte_sex, 1,
+                           &arm_fix) && !arm_fix)))
+  {
+    databuffer = NULL;
+    out = data_in;
+  } else {
+    databuffer = _GD_Alloc(D, E->EN(raw,data_type), ns);
 
-  _GD_ConvertType(D, data_in, data_type, databuffer, E->EN(raw,data_type), ns);
+    if (databuffer == NULL) {
+      dreturn("%i", 0);
+      return 0;
+    }
 
-  if (D->error) { /* bad input type */
-    free(databuffer);
-    dreturn("%i", 0);
-    return 0;
-  }
+    _GD_ConvertType(D, data_in, data_type, databuffer, E->EN(raw,data_type),
+        ns);
+
+    if (D->error) { /* bad input type */
+      free(databuffer);
+      dreturn("%i", 0);
+      return 0;
+    }
+
+    /* fix endianness, if necessary */
+    if (ecor)
+      _GD_FixEndianness(databuffer, ns, E->EN(raw,data_type), 0,
+          D->fragment[E->fragment_index].byte_sex);
 
-  /* fix endianness, if necessary */
-  if (_GD_ef[E->e->u.raw.file[0].subenc].flags & GD_EF_ECOR)
-    _GD_FixEndianness(databuffer, ns, E->EN(raw,data_type), 0,
-        D->fragment[E->fragment_index].byte_sex);
+    out = databuffer;
+  }
 
   /* write data to file. */
-  if (_GD_InitRawIO(D, E, NULL, -1, NULL, 0, GD_FILE_WRITE,
-        _GD_FileSwapBytes(D, E)))
-  {
-    free(databuffer);
-    dreturn("%i", 0);
-    return 0;
+  if (!async) {
+    if (_GD_InitRawIO(D, E, NULL, -1, NULL, 0, GD_FILE_WRITE,
+          _GD_FileSwapBytes(D, E)))
+    {
+      free(databuffer);
+      dreturn("%i", 0);
+      return 0;
+    }
+
+    async = (D->wb &&
+        !(_GD_ef[E->e->u.raw.file[0].subenc].flags & GD_EF_OOP));
   }
 
-  if (_GD_DoSeek(D, E, _GD_ef + E->e->u.raw.file[0].subenc, s0, GD_FILE_WRITE)
-      < 0)
+  if (async) {
+    n_wrote = _GD_WBQueue(D, E, s0, ns, E->EN(raw,data_type), out) ? 0 : ns;
+    _GD_LRUTouch(D, E);
+  } else if (_GD_DoSeek(D, E, _GD_ef + E->e->u.raw.file[0].subenc, s0,
+        GD_FILE_WRITE) < 0)
   {
     free(databuffer);
     dreturn("%i", 0);
     return 0;
-  }
-
-  n_wrote = _GD_WriteOut(E, _GD_ef + E->e->u.raw.file[0].subenc, databuffer,
-      E->EN(raw,data_type), ns, 0);
+  } else {
+    n_wrote = _GD_WriteOut(E, _GD_ef + E->e->u.raw.file[0].subenc, out,
+        E->EN(raw,data_type), ns, 0);
 
-  if (n_wrote < 0) {
-    _GD_SetEncIOError(D, GD_E_IO_WRITE, E->e->u.raw.file + 0);
-    n_wrote = 0;
+    if (n_wrote < 0) {
+      _GD_SetEncIOError(D, GD_E_IO_WRITE, E->e->u.raw.file + 0);
+      n_wrote = 0;
+    }
   }
+  D->data_gen++;
 
   free(databuffer);
 
@@ -111,6 +145,7 @@ static size_t _GD_DoLinterpOut(DIRFILE *restrict D, gd_entry_t *restrict E,
   int dir = -1, i;
   double *tmpbuf;
   struct gd_lut_ *tmp_lut;
+  struct gd_lutidx_ tmp_idx;
 
   dtrace("%p, %p, %" PRId64 ", %" PRIuSIZE ", 0x%X, %p", D, E,
       (int64_t)first_samp, num_samp, data_type, data_in);
@@ -185,8 +220,15 @@ static size_t _GD_DoLinterpOut(DIRFILE *restrict D, gd_entry_t *restrict E,
     tmp_lut[i].y.r = E->e->u.linterp.lut[i].x;
   }
 
-  _GD_LinterpData(D, tmpbuf, GD_FLOAT64, 0, tmpbuf, num_samp, tmp_lut,
-      E->e->u.linterp.table_len);
+  /* a decreasing function has a decreasing inverse: sort it */
+  if (tmp_lut[0].x > tmp_lut[E->e->u.linterp.table_len - 1].x)
+    _GD_ReverseLut(tmp_lut, E->e->u.linterp.table_len);
+
+  if (_GD_LutIndex(D, tmp_lut, E->e->u.linterp.table_len, 0, &tmp_idx) == 0) {
+    _GD_LinterpData(D, tmpbuf, GD_FLOAT64, 0, tmpbuf, num_samp, tmp_lut,
+        E->e->u.linterp.table_len, &tmp_idx);
+    _GD_FreeLutIndex(&tmp_idx);
+  }
 
   free(tmp_lut);
   if (D->error != GD_E_OK) {
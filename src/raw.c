@@ -20,6 +20,92 @@
  */
 #include "internal.h"
 
+#if defined HAVE_SYS_MMAN_H && defined HAVE_MMAP
+#include <sys/mman.h>
+#define USE_MMAP
+#endif
+
+#ifdef USE_MMAP
+/* The mapping of a RAW file opened read-only in a dirfile opened with GD_MMAP.
+ * It is kept in the file's edata, which is otherwise unused by this scheme */
+struct gd_rawmap_ {
+  char *base;
+  size_t len;
+};
+
+/* _GD_RawMap: map the file again, if its size has changed since it was last
+ * mapped.  Returns non-zero on error.
+ */
+static int _GD_RawMap(struct gd_raw_file_ *file)
+{
+  struct gd_rawmap_ *m = (struct gd_rawmap_ *)file->edata;
+  gd_stat64_t statbuf;
+  void *base;
+
+  dtrace("%p", file);
+
+  if (gd_fstat64(file->idata, &statbuf)) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  if ((uint64_t)statbuf.st_size == m->len) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  if ((uint64_t)statbuf.st_size > GD_SIZE_T_MAX) {
+    errno = EFBIG;
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  if (m->len > 0)
+    munmap(m->base, m->len);
+  m->base = NULL;
+  m->len = 0;
+
+  /* can't map an empty file */
+  if (statbuf.st_size == 0) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  base = mmap(NULL, (size_t)statbuf.st_size, PROT_READ, MAP_SHARED,
+      file->idata, 0);
+
+  if (base == MAP_FAILED) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  m->base = (char *)base;
+  m->len = (size_t)statbuf.st_size;
+
+  dreturn("%i", 0);
+  return 0;
+}
+
+/* _GD_RawUnmap: drop the mapping, if any */
+static void _GD_RawUnmap(struct gd_raw_file_ *file)
+{
+  struct gd_rawmap_ *m = (struct gd_rawmap_ *)file->edata;
+
+  dtrace("%p", file);
+
+  if (m) {
+    if (m->len > 0)
+      munmap(m->base, m->len);
+    free(m);
+    file->edata = NULL;
+  }
+
+  dreturnvoid();
+}
+#else
+#define _GD_RawUnmap(f)
+#endif
+
 int _GD_RawOpen(int fd, struct gd_raw_file_* file,
     gd_type_t data_type gd_unused_, int swap gd_unused_, unsigned int mode)
 {
@@ -29,12 +115,25 @@ int _GD_RawOpen(int fd, struct gd_raw_file_* file,
     if (file->mode & mode) {
       dreturn("%i", 0);
       return 0;
-    } else if (file->idata >= 0)
+    } else if (file->idata >= 0) {
+      _GD_RawUnmap(file);
       close(file->idata);
+    }
 
     file->idata = gd_OpenAt(file->D, fd, file->name, ((mode & GD_FILE_WRITE) ?
           (O_RDWR | O_CREAT) : O_RDONLY) | O_BINARY, 0666);
 
+#ifdef USE_MMAP
+    /* map read-only files, if asked to.  If that fails, we just fall back on
+     * read() */
+    if (file->idata >= 0 && !(mode & GD_FILE_WRITE) &&
+        file->D->flags & GD_MMAP)
+    {
+      file->edata = calloc(1, sizeof(struct gd_rawmap_));
+      if (file->edata && _GD_RawMap(file))
+        _GD_RawUnmap(file);
+    }
+#endif
   } else {
     file->idata = _GD_MakeTempFile(file->D, fd, file->name);
   }
@@ -64,6 +163,13 @@ off64_t _GD_RawSeek(struct gd_raw_file_* file, off64_t count,
     return count;
   }
 
+  /* a mapped file doesn't use the file offset */
+  if (file->edata) {
+    file->pos = count;
+    dreturn("%" PRId64 " (mapped)", (int64_t)count);
+    return count;
+  }
+
   pos = lseek64(file->idata, count * GD_SIZE(data_type), SEEK_SET);
 
   /* If we've landed in the middle of a sample, we have to back up */
@@ -89,6 +195,35 @@ ssize_t _GD_RawRead(struct gd_raw_file_ *restrict file, void *restrict ptr,
 
   dtrace("%p, %p, 0x%X, %" PRIuSIZE, file, ptr, data_type, nmemb);
 
+#ifdef USE_MMAP
+  if (file->edata) {
+    const struct gd_rawmap_ *m = (const struct gd_rawmap_ *)file->edata;
+    const uint64_t start = (uint64_t)file->pos * GD_SIZE(data_type);
+    size_t avail;
+
+    /* the file may have grown since we mapped it.  It mustn't shrink: reading
+     * a page of the mapping past the end of the file would raise SIGBUS */
+    if (start + (uint64_t)nmemb * GD_SIZE(data_type) > m->len &&
+        _GD_RawMap(file))
+    {
+      dreturn("%i", -1);
+      return -1;
+    }
+
+    avail = (start < m->len) ? (m->len - start) / GD_SIZE(data_type) : 0;
+    nread = (avail < nmemb) ? avail : nmemb;
+
+    if (nread > 0)
+      memcpy(ptr, m->base + start, nread * GD_SIZE(data_type));
+
+    file->pos += nread;
+    file->D->counter[GD_COUNTER_RAW_MMAP]++;
+
+    dreturn("%" PRIdSIZE " (mapped)", nread);
+    return nread;
+  }
+#endif
+
   nread = read(file->idata, ptr, nmemb * GD_SIZE(data_type));
 
   if (nread >= 0) {
@@ -136,6 +271,7 @@ int _GD_RawClose(struct gd_raw_file_ *file)
 
   dtrace("%p", file);
 
+  _GD_RawUnmap(file);
   ret = close(file->idata);
   if (!ret) {
     file->idata = -1;
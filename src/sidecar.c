@@ -0,0 +1,252 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+#include "internal.h"
+
+/* Sidecar files hold indices which encodings build to speed up access to
+ * their data files.  They're caches: they may be deleted at any time, and
+ * failure to read or write one is never an error.  They're only written
+ * when the dirfile is open for writing.
+ *
+ * A sidecar is named after its data file, with GD_SIDECAR_SUFFIX appended.
+ * It starts with an eight-byte magic number, which identifies the encoding
+ * and the format version, followed by the stamp of the data file which it
+ * indexes: the data file's size, modification time and last eight bytes.
+ * A sidecar whose stamp doesn't match the data file is ignored.  The rest of
+ * the file belongs to the encoding.  Everything is stored in native
+ * byte order.
+ */
+
+/* the name of the sidecar of the data file name, or NULL on error */
+static char *_GD_SidecarName(const char *name)
+{
+  char *sidecar;
+
+  dtrace("\"%s\"", name);
+
+  sidecar = malloc(strlen(name) + sizeof(GD_SIDECAR_SUFFIX));
+  if (sidecar)
+    sprintf(sidecar, "%s%s", name, GD_SIDECAR_SUFFIX);
+
+  dreturn("\"%s\"", sidecar);
+  return sidecar;
+}
+
+/* Fill in the stamp of the open data file fd.  The file offset is left at
+ * the start of the file.  Returns non-zero on error.
+ */
+int _GD_FileStamp(int fd, struct gd_stamp_ *stamp)
+{
+  gd_stat64_t statbuf;
+
+  dtrace("%i, %p", fd, stamp);
+
+  memset(stamp, 0, sizeof(*stamp));
+
+  if (gd_fstat64(fd, &statbuf)) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  stamp->size = statbuf.st_size;
+  stamp->mtime = statbuf.st_mtime;
+
+  if (stamp->size >= 8 && (lseek64(fd, -8, SEEK_END) == -1 ||
+        read(fd, stamp->tail, 8) != 8))
+  {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  if (lseek64(fd, 0, SEEK_SET) == -1) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  dreturn("%i", 0);
+  return 0;
+}
+
+/* Open the sidecar of the data file name for reading, and check its header.
+ * Returns a descriptor positioned after the header, or -1 if there's no
+ * usable sidecar.
+ */
+int _GD_OpenSidecar(const DIRFILE *D gd_unused_d, int dirfd,
+    const char *name, const char *magic, const struct gd_stamp_ *stamp)
+{
+  char *sidecar;
+  char buf[8];
+  struct gd_stamp_ s;
+  int fd;
+
+  dtrace("%p, %i, \"%s\", \"%.8s\", %p", D, dirfd, name, magic, stamp);
+
+  sidecar = _GD_SidecarName(name);
+  if (sidecar == NULL) {
+    dreturn("%i", -1);
+    return -1;
+  }
+
+  fd = gd_OpenAt(D, dirfd, sidecar, O_RDONLY | O_BINARY, 0666);
+  free(sidecar);
+
+  if (fd < 0) {
+    dreturn("%i", -1);
+    return -1;
+  }
+
+  memset(&s, 0, sizeof(s));
+  if (_GD_SidecarRead(fd, buf, 8) || memcmp(buf, magic, 8) ||
+      _GD_SidecarRead(fd, &s.size, sizeof(s.size)) ||
+      _GD_SidecarRead(fd, &s.mtime, sizeof(s.mtime)) ||
+      _GD_SidecarRead(fd, s.tail, sizeof(s.tail)) ||
+      memcmp(&s, stamp, sizeof(s)))
+  {
+    close(fd);
+    fd = -1;
+  }
+
+  dreturn("%i", fd);
+  return fd;
+}
+
+/* Start writing a sidecar for the data file name, whose stamp is given.  The
+ * sidecar is written to a temporary file, whose name is returned in *tmp,
+ * and which _GD_FinishSidecar moves into place.  Returns a descriptor
+ * positioned after the header, or -1 on error, or if the dirfile is
+ * read-only.
+ */
+int _GD_CreateSidecar(const DIRFILE *D, int dirfd, const char *name,
+    const char *magic, const struct gd_stamp_ *stamp, char **tmp)
+{
+  int fd;
+
+  dtrace("%p, %i, \"%s\", \"%.8s\", %p, %p", D, dirfd, name, magic, stamp,
+      tmp);
+
+  if ((D->flags & GD_ACCMODE) != GD_RDWR) {
+    *tmp = NULL;
+    dreturn("%i", -1);
+    return -1;
+  }
+
+  *tmp = malloc(strlen(name) + sizeof(GD_SIDECAR_SUFFIX) + 7);
+  if (*tmp == NULL) {
+    dreturn("%i", -1);
+    return -1;
+  }
+  sprintf(*tmp, "%s%s_XXXXXX", name, GD_SIDECAR_SUFFIX);
+
+  fd = _GD_MakeTempFile(D, dirfd, *tmp);
+  if (fd < 0) {
+    free(*tmp);
+    *tmp = NULL;
+    dreturn("%i", -1);
+    return -1;
+  }
+
+  if (_GD_SidecarWrite(fd, magic, 8) ||
+      _GD_SidecarWrite(fd, &stamp->size, sizeof(stamp->size)) ||
+      _GD_SidecarWrite(fd, &stamp->mtime, sizeof(stamp->mtime)) ||
+      _GD_SidecarWrite(fd, stamp->tail, sizeof(stamp->tail)))
+  {
+    _GD_FinishSidecar(D, dirfd, name, fd, *tmp, 1);
+    *tmp = NULL;
+    fd = -1;
+  }
+
+  dreturn("%i", fd);
+  return fd;
+}
+
+/* Close a sidecar started by _GD_CreateSidecar and, unless bad is non-zero,
+ * move it into place; otherwise, it's discarded.  Frees tmp.  Returns non-zero
+ * if the sidecar wasn't written.
+ */
+int _GD_FinishSidecar(const DIRFILE *D gd_unused_d, int dirfd,
+    const char *name, int fd, char *tmp, int bad)
+{
+  char *sidecar = NULL;
+
+  dtrace("%p, %i, \"%s\", %i, \"%s\", %i", D, dirfd, name, fd, tmp, bad);
+
+  if (close(fd))
+    bad = 1;
+
+  if (!bad)
+    bad = (sidecar = _GD_SidecarName(name)) == NULL;
+
+  if (bad || gd_RenameAt(D, dirfd, tmp, dirfd, sidecar)) {
+    gd_UnlinkAt(D, dirfd, tmp, 0);
+    bad = 1;
+  }
+
+  free(sidecar);
+  free(tmp);
+
+  dreturn("%i", bad);
+  return bad;
+}
+
+/* Delete the sidecar of the data file name, if any */
+void _GD_UnlinkSidecar(const DIRFILE *D gd_unused_d, int dirfd,
+    const char *name)
+{
+  char *sidecar;
+
+  dtrace("%p, %i, \"%s\"", D, dirfd, name);
+
+  sidecar = _GD_SidecarName(name);
+  if (sidecar) {
+    gd_UnlinkAt(D, dirfd, sidecar, 0);
+    free(sidecar);
+  }
+
+  dreturnvoid();
+}
+
+/* Move the sidecar of the data file old_name along with it.  If it can't be
+ * moved, it's deleted. */
+void _GD_MoveSidecar(const DIRFILE *D gd_unused_d, int olddirfd,
+    const char *old_name, int newdirfd, const char *new_name)
+{
+  char *old_sidecar, *new_sidecar;
+
+  dtrace("%p, %i, \"%s\", %i, \"%s\"", D, olddirfd, old_name, newdirfd,
+      new_name);
+
+  old_sidecar = _GD_SidecarName(old_name);
+  if (old_sidecar == NULL) {
+    dreturnvoid();
+    return;
+  }
+
+  new_sidecar = _GD_SidecarName(new_name);
+  if (new_sidecar == NULL ||
+      gd_RenameAt(D, olddirfd, old_sidecar, newdirfd, new_sidecar))
+  {
+    gd_UnlinkAt(D, olddirfd, old_sidecar, 0);
+  }
+
+  free(new_sidecar);
+  free(old_sidecar);
+
+  dreturnvoid();
+}
@@ -58,6 +58,11 @@ struct gd_siedata {
   int have_l; /* a flag to indicate that l is initialised */
   int bof;    /* this is the first record */
   int header; /* non-zero if we have a header */
+
+  int dirfd; /* the directory containing the file */
+  int indexed; /* 1 if end is loaded; -1 if it can't be */
+  int64_t *end; /* the record index: the ending sample of every record */
+  size_t n_end; /* the number of records in the index */
 };
 
 /* Header size in bytes */
@@ -114,7 +119,7 @@ static int _GD_SampIndDiscardHeader(FILE *stream)
 static int _GD_SampIndDoOpen(int fdin, struct gd_raw_file_ *file,
     struct gd_siedata *f, int swap, unsigned int mode)
 {
-  int fd;
+  int fd, header = 0;
   FILE *stream;
 
   dtrace("%i, %p, %i, 0x%X", fdin, file, swap, mode);
@@ -139,19 +144,20 @@ static int _GD_SampIndDoOpen(int fdin, struct gd_raw_file_ *file,
   }
 
   if (!(mode & GD_FILE_WRITE)) {
-    f->header = _GD_SampIndDiscardHeader(stream);
-    if (f->header < 0) {
+    header = _GD_SampIndDiscardHeader(stream);
+    if (header < 0) {
       fclose(stream);
       dreturn("%i", -1);
       return -1;
     }
-  } else
-    f->header = 0;
+  }
 
   memset(f, 0, sizeof(struct gd_siedata));
   f->r = f->s = f->p = f->d[0] = -1;
   f->fp = stream;
   f->swap = swap;
+  f->header = header;
+  f->dirfd = fdin;
 
   dreturn("%i", fd);
   return fd;
@@ -230,6 +236,185 @@ static int _GD_Advance(struct gd_siedata *f, size_t size)
   return 0;
 }
 
+/* The record index.  For files which aren't open for writing, seeks which
+ * need to move to another record look up the target record in a list of the
+ * ending sample of every record, rather than reading all the records before
+ * it.  The index is built the first time it's needed, and saved in a sidecar,
+ * which holds, in native byte order: the header flag, the record size, the
+ * number of records, and then the ending sample of each record.
+ */
+#define GD_SIE_IDX_MAGIC "GDSIIX01"
+
+/* number of records read at once when building the index */
+#define GD_SIE_CHUNK 4096
+
+/* read the index from the sidecar; returns non-zero if there isn't a usable
+ * one */
+static int _GD_SampIndLoadIndex(struct gd_raw_file_ *file,
+    struct gd_siedata *f, size_t size, int64_t n, const struct gd_stamp_ *stamp)
+{
+  int64_t v[3];
+  int fd, bad;
+
+  dtrace("%p, %p, %" PRIuSIZE ", %" PRId64 ", %p", file, f, size, n, stamp);
+
+  fd = _GD_OpenSidecar(file->D, f->dirfd, file->name, GD_SIE_IDX_MAGIC, stamp);
+  if (fd < 0) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  bad = _GD_SidecarRead(fd, v, sizeof(v)) || v[0] != f->header ||
+    v[1] != (int64_t)size || v[2] != n;
+
+  if (!bad && n > 0) {
+    f->end = malloc(sizeof(int64_t) * n);
+    bad = f->end == NULL || _GD_SidecarRead(fd, f->end, sizeof(int64_t) * n);
+  }
+  close(fd);
+
+  if (bad) {
+    free(f->end);
+    f->end = NULL;
+  } else
+    f->n_end = n;
+
+  dreturn("%i", bad);
+  return bad;
+}
+
+/* read the ending sample of all n records in the file; returns non-zero on
+ * error */
+static int _GD_SampIndBuildIndex(struct gd_siedata *f, size_t size, int64_t n)
+{
+  char *buf;
+  int64_t i = 0;
+  size_t j, nr;
+
+  dtrace("%p, %" PRIuSIZE ", %" PRId64, f, size, n);
+
+  if (n == 0) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  f->end = malloc(sizeof(int64_t) * n);
+  buf = malloc(size * GD_SIE_CHUNK);
+  if (f->end == NULL || buf == NULL ||
+      fseeko64(f->fp, f->header ? HEADSIZE : 0, SEEK_SET))
+  {
+    free(buf);
+    free(f->end);
+    f->end = NULL;
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  while (i < n) {
+    nr = fread(buf, size, GD_SIE_CHUNK, f->fp);
+    for (j = 0; j < nr && i < n; ++j, ++i)
+      f->end[i] = FIXSEX(f->swap,
+          gd_get_unaligned64((const int64_t*)(buf + j * size)));
+    if (nr < GD_SIE_CHUNK)
+      break;
+  }
+  free(buf);
+
+  if (i < n) {
+    free(f->end);
+    f->end = NULL;
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  f->n_end = n;
+  dreturn("%i", 0);
+  return 0;
+}
+
+/* make sure the record index is available: load it from the sidecar, or build
+ * it and try to save it.  Returns non-zero if it isn't available. */
+static int _GD_SampIndGetIndex(struct gd_raw_file_ *file,
+    struct gd_siedata *f, size_t size)
+{
+  struct gd_stamp_ stamp;
+  int64_t n, head = f->header ? HEADSIZE : 0;
+  char *tmp;
+  int sfd;
+
+  dtrace("%p, %p, %" PRIuSIZE, file, f, size);
+
+  if (f->indexed) {
+    dreturn("%i", f->indexed < 0);
+    return f->indexed < 0;
+  }
+
+  /* this moves the file offset, but we're about to reposition the stream
+   * anyways */
+  f->indexed = -1;
+  if (fflush(f->fp) || _GD_FileStamp(fileno(f->fp), &stamp)) {
+    dreturn("%i", 1);
+    return 1;
+  }
+  n = (stamp.size > head) ? (stamp.size - head) / (int64_t)size : 0;
+
+  if (_GD_SampIndLoadIndex(file, f, size, n, &stamp)) {
+    if (_GD_SampIndBuildIndex(f, size, n)) {
+      dreturn("%i", 1);
+      return 1;
+    }
+
+    sfd = _GD_CreateSidecar(file->D, f->dirfd, file->name, GD_SIE_IDX_MAGIC,
+        &stamp, &tmp);
+    if (sfd >= 0) {
+      const int64_t v[3] = { f->header, (int64_t)size, n };
+      int bad = _GD_SidecarWrite(sfd, v, sizeof(v));
+      if (!bad && n > 0)
+        bad = _GD_SidecarWrite(sfd, f->end, sizeof(int64_t) * n);
+      _GD_FinishSidecar(file->D, f->dirfd, file->name, sfd, tmp, bad);
+    }
+  }
+
+  f->indexed = 1;
+  dreturn("%i (%" PRIuSIZE ")", 0, f->n_end);
+  return 0;
+}
+
+/* position the stream on record k, as if we had advanced to it; returns
+ * non-zero on error */
+static int _GD_SampIndGoto(struct gd_siedata *f, size_t size, size_t k)
+{
+  const off64_t head = f->header ? HEADSIZE : 0;
+
+  dtrace("%p, %" PRIuSIZE ", %" PRIuSIZE, f, size, k);
+
+  if (k == 0) {
+    if (fseeko64(f->fp, head, SEEK_SET) || fread(f->d, size, 1, f->fp) < 1) {
+      dreturn("%i", 1);
+      return 1;
+    }
+    f->p = 0;
+    f->have_l = 0;
+    f->bof = 1;
+  } else {
+    if (fseeko64(f->fp, head + (off64_t)(k - 1) * size, SEEK_SET) ||
+        fread(f->l, size, 1, f->fp) < 1 || fread(f->d, size, 1, f->fp) < 1)
+    {
+      dreturn("%i", 1);
+      return 1;
+    }
+    f->p = f->end[k - 1] + 1;
+    f->have_l = 1;
+    f->bof = 0;
+  }
+
+  f->r = k;
+  f->s = FIXSEX(f->swap, f->d[0]);
+
+  dreturn("%i", 0);
+  return 0;
+}
+
 off64_t _GD_SampIndSeek(struct gd_raw_file_ *file, off64_t sample,
     gd_type_t data_type, unsigned int mode)
 {
@@ -245,7 +430,29 @@ off64_t _GD_SampIndSeek(struct gd_raw_file_ *file, off64_t sample,
     return sample;
   }
 
-  if (sample < f->p) {
+  /* use the index to find the record, unless the target is in this record,
+   * or we're just starting at the beginning */
+  if (!(mode & GD_FILE_WRITE) && !(file->mode & GD_FILE_WRITE) &&
+      (sample < f->p || (sample > f->s && sample > 0)) &&
+      _GD_SampIndGetIndex(file, f, size) == 0 && f->n_end > 0)
+  {
+    /* binary search for the first record ending at or after sample; if
+     * there's none, we go to the last record, and advance off the end below */
+    size_t lo = 0, hi = f->n_end - 1;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (f->end[mid] < sample)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    if (_GD_SampIndGoto(f, size, lo)) {
+      dreturn("%i", -1);
+      return -1;
+    }
+    _GD_CountIndexSeek(file);
+  } else if (sample < f->p) {
     /* seek backwards -- reading a file backwards doesn't necessarily work
      * that well.  So, let's just rewind to the beginning and try again. */
     rewind(f->fp);
@@ -709,6 +916,7 @@ int _GD_SampIndClose(struct gd_raw_file_* file)
   if (ret != EOF) {
     file->mode = 0;
     file->idata = -1;
+    free(f->end);
     free(file->edata);
     file->edata = NULL;
     dreturn("%i", 0);
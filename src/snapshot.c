@@ -0,0 +1,1054 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+#include "internal.h"
+
+#if defined HAVE_SYS_MMAN_H && defined HAVE_MMAP
+#include <sys/mman.h>
+#define USE_MMAP
+#endif
+
+/* A snapshot is a binary copy of the metadata parsed from the format
+ * specification, which gd_open() saves when given GD_SNAPSHOT, and loads,
+ * instead of parsing the format specification, the next time.  It's a sidecar
+ * of the root format file (see sidecar.c), so it's ignored once that file
+ * changes.  It also records the stamp of every other fragment, and it's
+ * ignored if any of those change.
+ *
+ * The sidecar header is followed by:
+ *
+ *   int64_t  layout, checksum, length of the body
+ *
+ * and then the body, which is a sequence of items, each padded to a multiple
+ * of eight bytes: integers (an int64_t), strings (an int64_t length, including
+ * the terminating NUL, or zero for NULL, followed by the characters) and raw
+ * data.  The body holds:
+ *
+ *   - the library version, the parse-affecting open flags, the Standards
+ *     Version and the GD_PEDANTIC and GD_MULTISTANDARD dirfile flags;
+ *   - the number of fragments, and, for each, its names, encoding data,
+ *     reference field, namespace and affixes, parent, encoding, byte sex,
+ *     protection, frame offset, versions, and stamp;
+ *   - the number of entries and the index of the reference field, and then
+ *     each entry, in the order of the field list: its type, and, except for
+ *     INDEX, its field code, fragment index, flags, meta field data, input
+ *     fields, scalars, a copy of the type-specific part of the gd_entry_t, and
+ *     the private data the parser produced (RAW file base, LINTERP table path,
+ *     CONST and CARRAY values, SARRAY and STRING strings).
+ *
+ * A meta field records the index of its parent, which always comes first in
+ * the field list, and its position in the parent's list of meta fields;
+ * a parent records the length of that list.  layout records the sizes of the
+ * structures copied; the checksum, over the body, catches damage.  Everything
+ * is stored in native byte order.
+ *
+ * Nothing read is trusted: counts and indices are bounded, and each entry must
+ * be one the parser could have made.  If anything's amiss, the snapshot is
+ * ignored and the format specification parsed as usual.
+ */
+#define GD_SNAP_MAGIC "GDSNAP01"
+#define GD_SNAP_LAYOUT ((int64_t)sizeof(gd_entry_t) | \
+    ((int64_t)GD_SNAP_U_SIZE << 16) | \
+    ((int64_t)GD_DIRFILE_STANDARDS_VERSION << 32))
+#define GD_SNAP_HEADER (32 + 24) /* sidecar header + our header */
+
+/* the type-specific part of a gd_entry_t: the union before e */
+#define GD_SNAP_U offsetof(gd_entry_t, EN(raw,spf))
+#define GD_SNAP_U_SIZE (offsetof(gd_entry_t, e) - GD_SNAP_U)
+
+/* open flags which affect the parser */
+#define GD_SNAP_FLAGS (GD_FORCE_ENDIAN | GD_BIG_ENDIAN | GD_LITTLE_ENDIAN | \
+    GD_PEDANTIC | GD_FORCE_ENCODING | GD_IGNORE_DUPS | GD_IGNORE_REFS | \
+    GD_ARM_FLAG | GD_PERMISSIVE | GD_ENCODING)
+
+#ifdef USE_MMAP
+/* a 64-bit FNV-1a hash of the words of the body; since each step is a
+ * bijection, any single damaged word changes it */
+static uint64_t _GD_SnapSum(const char *buf, size_t len)
+{
+  uint64_t h = 14695981039346656037ULL, w;
+  size_t i;
+
+  dtrace("%p, %" PRIuSIZE, buf, len);
+
+  for (i = 0; i + 8 <= len; i += 8) {
+    memcpy(&w, buf + i, 8);
+    h = (h ^ w) * 1099511628211ULL;
+  }
+
+  dreturn("0x%" PRIX64, h);
+  return h;
+}
+
+/* the body of a snapshot being written */
+struct gd_snapw_ {
+  char *buf;
+  size_t len, size;
+  int bad; /* non-zero if an allocation failed */
+};
+
+static void _GD_SnapPutData(struct gd_snapw_ *w, const void *data, size_t len)
+{
+  const size_t padded = (len + 7) & ~(size_t)7;
+
+  dtrace("%p, %p, %" PRIuSIZE, w, data, len);
+
+  if (!w->bad && w->len + padded > w->size) {
+    size_t size = w->size ? 2 * w->size : 4096;
+    char *ptr;
+
+    while (size < w->len + padded)
+      size *= 2;
+
+    ptr = realloc(w->buf, size);
+    if (ptr == NULL)
+      w->bad = 1;
+    else {
+      w->buf = ptr;
+      w->size = size;
+    }
+  }
+
+  if (!w->bad) {
+    memcpy(w->buf + w->len, data, len);
+    memset(w->buf + w->len + len, 0, padded - len);
+    w->len += padded;
+  }
+
+  dreturnvoid();
+}
+
+static void _GD_SnapPutInt(struct gd_snapw_ *w, int64_t i)
+{
+  dtrace("%p, %" PRId64, w, i);
+
+  _GD_SnapPutData(w, &i, sizeof(i));
+
+  dreturnvoid();
+}
+
+static void _GD_SnapPutStr(struct gd_snapw_ *w, const char *s)
+{
+  dtrace("%p, \"%s\"", w, s);
+
+  if (s == NULL)
+    _GD_SnapPutInt(w, 0);
+  else {
+    _GD_SnapPutInt(w, (int64_t)strlen(s) + 1);
+    _GD_SnapPutData(w, s, strlen(s) + 1);
+  }
+
+  dreturnvoid();
+}
+
+/* the body of a snapshot being read.  Running off the end, or finding
+ * anything inconsistent, sets bad, after which everything read is garbage */
+struct gd_snapr_ {
+  const char *pos, *end;
+  int bad;
+};
+
+/* a pointer to len bytes of raw data, or NULL */
+static const char *_GD_SnapData(struct gd_snapr_ *r, size_t len)
+{
+  const char *data = NULL;
+
+  dtrace("%p, %" PRIuSIZE, r, len);
+
+  /* the body is a whole number of words */
+  if (r->bad || len > (size_t)(r->end - r->pos))
+    r->bad = 1;
+  else {
+    data = r->pos;
+    r->pos += (len + 7) & ~(size_t)7;
+  }
+
+  dreturn("%p", data);
+  return data;
+}
+
+static int64_t _GD_SnapInt(struct gd_snapr_ *r)
+{
+  int64_t i = 0;
+  const char *data;
+
+  dtrace("%p", r);
+
+  data = _GD_SnapData(r, sizeof(i));
+  if (data)
+    memcpy(&i, data, sizeof(i));
+
+  dreturn("%" PRId64, i);
+  return i;
+}
+
+/* Read an integer which must lie in [min, max] */
+static int64_t _GD_SnapRange(struct gd_snapr_ *r, int64_t min, int64_t max)
+{
+  int64_t i;
+
+  dtrace("%p, %" PRId64 ", %" PRId64, r, min, max);
+
+  i = _GD_SnapInt(r);
+  if (i < min || i > max) {
+    r->bad = 1;
+    i = min;
+  }
+
+  dreturn("%" PRId64, i);
+  return i;
+}
+
+/* A pointer to a string in the snapshot, or NULL */
+static const char *_GD_SnapStr(struct gd_snapr_ *r)
+{
+  const char *s = NULL;
+  int64_t n;
+
+  dtrace("%p", r);
+
+  n = _GD_SnapInt(r);
+  if (n < 0 || (uint64_t)n > (uint64_t)(r->end - r->pos))
+    r->bad = 1;
+  else if (n > 0) {
+    s = _GD_SnapData(r, (size_t)n);
+    if (s && s[n - 1] != '\0') {
+      r->bad = 1;
+      s = NULL;
+    }
+  }
+
+  dreturn("\"%s\"", s);
+  return s;
+}
+
+/* A newly malloc'd copy of a string in the snapshot, or NULL */
+static char *_GD_SnapDup(struct gd_snapr_ *r)
+{
+  const char *s;
+  char *copy = NULL;
+
+  dtrace("%p", r);
+
+  s = _GD_SnapStr(r);
+  if (s) {
+    copy = strdup(s);
+    if (copy == NULL)
+      r->bad = 1;
+  }
+
+  dreturn("\"%s\"", copy);
+  return copy;
+}
+
+static void _GD_SnapPutStamp(struct gd_snapw_ *w, const struct gd_stamp_ *s)
+{
+  dtrace("%p, %p", w, s);
+
+  _GD_SnapPutInt(w, s->size);
+  _GD_SnapPutInt(w, s->mtime);
+  _GD_SnapPutData(w, s->tail, sizeof(s->tail));
+
+  dreturnvoid();
+}
+
+static void _GD_SnapStamp(struct gd_snapr_ *r, struct gd_stamp_ *s)
+{
+  const char *tail;
+
+  dtrace("%p, %p", r, s);
+
+  memset(s, 0, sizeof(*s));
+  s->size = _GD_SnapInt(r);
+  s->mtime = _GD_SnapInt(r);
+  tail = _GD_SnapData(r, sizeof(s->tail));
+  if (tail)
+    memcpy(s->tail, tail, sizeof(s->tail));
+
+  dreturnvoid();
+}
+
+/* Write the entry E, at position u in the field list, whose meta fields'
+ * positions in their parents' lists are in meta_pos */
+static void _GD_SnapPutEntry(DIRFILE *restrict D, struct gd_snapw_ *restrict w,
+    const gd_entry_t *restrict E, const int *restrict meta_pos)
+{
+  const struct gd_private_entry_ *e = E->e;
+  gd_entry_t copy;
+  unsigned int u;
+  size_t n;
+  int i;
+
+  dtrace("%p, %p, %p, %p", D, w, E, meta_pos);
+
+  _GD_SnapPutInt(w, E->field_type);
+  if (E->field_type == GD_INDEX_ENTRY) {
+    dreturnvoid();
+    return;
+  }
+
+  _GD_SnapPutStr(w, E->field);
+  _GD_SnapPutInt(w, E->fragment_index);
+  _GD_SnapPutInt(w, E->flags);
+
+  _GD_SnapPutInt(w, e->n_meta);
+  if (e->n_meta == -1) {
+    _GD_FindField(D, e->p.parent->field, e->p.parent->e->len, D->entry,
+        D->n_entries, 0, &u);
+    _GD_SnapPutInt(w, u);
+    _GD_FindField(D, E->field, e->len, D->entry, D->n_entries, 0, &u);
+    _GD_SnapPutInt(w, meta_pos[u]);
+  }
+
+  for (i = 0; i < GD_MAX_LINCOM; ++i)
+    _GD_SnapPutStr(w, E->in_fields[i]);
+  for (i = 0; i <= GD_MAX_POLYORD; ++i) {
+    _GD_SnapPutStr(w, E->scalar[i]);
+    _GD_SnapPutInt(w, E->scalar_ind[i]);
+  }
+
+  /* the type-specific part, without the LINTERP table path */
+  copy = *E;
+  if (E->field_type == GD_LINTERP_ENTRY)
+    copy.EN(linterp,table) = NULL;
+  _GD_SnapPutData(w, (const char *)&copy + GD_SNAP_U, GD_SNAP_U_SIZE);
+
+  switch (E->field_type) {
+    case GD_RAW_ENTRY:
+      _GD_SnapPutStr(w, e->u.raw.filebase);
+      break;
+    case GD_LINTERP_ENTRY:
+      _GD_SnapPutStr(w, E->EN(linterp,table));
+      break;
+    case GD_CONST_ENTRY:
+      _GD_SnapPutData(w, e->u.scalar.d,
+          GD_SIZE(_GD_ConstType(D, E->EN(scalar,const_type))));
+      break;
+    case GD_CARRAY_ENTRY:
+      _GD_SnapPutData(w, e->u.scalar.d,
+          GD_SIZE(_GD_ConstType(D, E->EN(scalar,const_type))) *
+          E->EN(scalar,array_len));
+      break;
+    case GD_SARRAY_ENTRY:
+      for (n = 0; n < E->EN(scalar,array_len); ++n)
+        _GD_SnapPutStr(w, ((char **)e->u.scalar.d)[n]);
+      break;
+    case GD_STRING_ENTRY:
+      _GD_SnapPutStr(w, e->u.string);
+      break;
+    default:
+      break;
+  }
+
+  dreturnvoid();
+}
+
+/* Check that the public part of an entry read from a snapshot is something the
+ * parser could have made, since the rest of the library relies on it: the
+ * right number of input fields and scalar field codes for its type, and sane
+ * parameters.  Returns non-zero if it isn't. */
+static int _GD_SnapBadEntry(const gd_entry_t *E)
+{
+  int i, n_in = 0, n_scalar = 0, bad = 0;
+
+  dtrace("%p", E);
+
+  switch (E->field_type) {
+    case GD_RAW_ENTRY:
+      n_scalar = 1;
+      bad = (E->scalar[0] == NULL && E->EN(raw,spf) == 0);
+      break;
+    case GD_LINCOM_ENTRY:
+      n_in = E->EN(lincom,n_fields);
+      n_scalar = 2 * GD_MAX_LINCOM;
+      bad = (n_in < 1 || n_in > GD_MAX_LINCOM);
+      break;
+    case GD_LINTERP_ENTRY:
+    case GD_ALIAS_ENTRY:
+      n_in = 1;
+      break;
+    case GD_PHASE_ENTRY:
+    case GD_RECIP_ENTRY:
+      n_in = n_scalar = 1;
+      break;
+    case GD_POLYNOM_ENTRY:
+      n_in = 1;
+      bad = (E->EN(polynom,poly_ord) < 1 ||
+          E->EN(polynom,poly_ord) > GD_MAX_POLYORD);
+      if (!bad)
+        n_scalar = E->EN(polynom,poly_ord) + 1;
+      break;
+    case GD_BIT_ENTRY:
+    case GD_SBIT_ENTRY:
+      n_in = 1;
+      n_scalar = 2;
+      bad = (E->scalar[1] == NULL && E->EN(bit,numbits) < 1) ||
+        (E->scalar[0] == NULL && E->EN(bit,bitnum) < 0) ||
+        (E->scalar[0] == NULL && E->scalar[1] == NULL &&
+         E->EN(bit,bitnum) + E->EN(bit,numbits) - 1 > 63);
+      break;
+    case GD_MULTIPLY_ENTRY:
+    case GD_DIVIDE_ENTRY:
+    case GD_INDIR_ENTRY:
+    case GD_SINDIR_ENTRY:
+      n_in = 2;
+      break;
+    case GD_WINDOW_ENTRY:
+      n_in = 2;
+      n_scalar = 1;
+      bad = _GD_BadWindop(E->EN(window,windop));
+      break;
+    case GD_MPLEX_ENTRY:
+      n_in = n_scalar = 2;
+      bad = (E->scalar[1] == NULL && E->EN(mplex,period) < 0);
+      break;
+    default:
+      break;
+  }
+
+  for (i = 0; i < GD_MAX_LINCOM; ++i)
+    if ((i < n_in) != (E->in_fields[i] != NULL))
+      bad = 1;
+
+  /* and scalar field codes are resolved when first needed, unless there are
+   * none */
+  for (i = 0; i <= GD_MAX_POLYORD; ++i)
+    if (E->scalar[i] && (i >= n_scalar || E->flags & GD_EN_CALC ||
+          (E->field_type == GD_LINCOM_ENTRY && i % GD_MAX_LINCOM >= n_in)))
+    {
+      bad = 1;
+    }
+
+  if (E->flags & ~(GD_EN_COMPSCAL | GD_EN_CALC | GD_EN_HIDDEN | GD_EN_EARLY))
+    bad = 1;
+
+  dreturn("%i", bad);
+  return bad;
+}
+
+/* Read an entry of the given type, the k-th of the n in the list being
+ * rebuilt, for a dirfile with n_fragment fragments.  Returns NULL if the
+ * snapshot is bad. */
+static gd_entry_t *_GD_SnapEntry(DIRFILE *restrict D, struct gd_snapr_ *r,
+    gd_entype_t type, gd_entry_t **restrict list, unsigned int k,
+    unsigned int n_entries, int n_fragment)
+{
+  gd_entry_t *E, *P;
+  const char *data;
+  size_t n, size;
+  int i;
+
+  dtrace("%p, %p, 0x%X, %p, %u, %u, %i", D, r, type, list, k, n_entries,
+      n_fragment);
+
+  switch (type) {
+    case GD_RAW_ENTRY:
+    case GD_LINCOM_ENTRY:
+    case GD_LINTERP_ENTRY:
+    case GD_BIT_ENTRY:
+    case GD_MULTIPLY_ENTRY:
+    case GD_PHASE_ENTRY:
+    case GD_POLYNOM_ENTRY:
+    case GD_SBIT_ENTRY:
+    case GD_DIVIDE_ENTRY:
+    case GD_RECIP_ENTRY:
+    case GD_WINDOW_ENTRY:
+    case GD_MPLEX_ENTRY:
+    case GD_INDIR_ENTRY:
+    case GD_SINDIR_ENTRY:
+    case GD_CONST_ENTRY:
+    case GD_CARRAY_ENTRY:
+    case GD_STRING_ENTRY:
+    case GD_SARRAY_ENTRY:
+    case GD_ALIAS_ENTRY:
+      break;
+    default:
+      r->bad = 1;
+      dreturn("%p", NULL);
+      return NULL;
+  }
+
+  E = malloc(sizeof(*E));
+  if (E == NULL) {
+    r->bad = 1;
+    dreturn("%p", NULL);
+    return NULL;
+  }
+  memset(E, 0, sizeof(*E));
+
+  E->e = malloc(sizeof(*E->e));
+  if (E->e == NULL) {
+    free(E);
+    r->bad = 1;
+    dreturn("%p", NULL);
+    return NULL;
+  }
+  memset(E->e, 0, sizeof(*E->e));
+
+  /* this is enough for _GD_FreeE */
+  E->field_type = type;
+
+  E->field = _GD_SnapDup(r);
+  E->fragment_index = (int)_GD_SnapRange(r, 0, n_fragment - 1);
+  E->flags = (unsigned)_GD_SnapRange(r, 0, UINT_MAX);
+  if (E->field == NULL)
+    r->bad = 1;
+  else
+    E->e->len = strlen(E->field);
+
+  /* the meta field data.  A parent comes before its meta fields. */
+  E->e->n_meta = (int)_GD_SnapRange(r, -1, (int64_t)n_entries - k - 1);
+  if (E->e->n_meta == -1) {
+    E->e->n_meta = 0; /* until we have a parent */
+    P = list[_GD_SnapRange(r, 0, (int64_t)k - 1)];
+    i = (int)_GD_SnapRange(r, 0, INT_MAX);
+    if (!r->bad && P->e->n_meta > i && P->e->p.meta_entry[i] == NULL) {
+      E->e->n_meta = -1;
+      E->e->p.parent = P;
+      P->e->p.meta_entry[i] = E;
+    } else
+      r->bad = 1;
+  } else if (E->e->n_meta > 0 && !r->bad) {
+    E->e->p.meta_entry = calloc(E->e->n_meta, sizeof(gd_entry_t *));
+    if (E->e->p.meta_entry == NULL) {
+      E->e->n_meta = 0;
+      r->bad = 1;
+    }
+  }
+
+  for (i = 0; i < GD_MAX_LINCOM; ++i)
+    E->in_fields[i] = _GD_SnapDup(r);
+  for (i = 0; i <= GD_MAX_POLYORD; ++i) {
+    E->scalar[i] = _GD_SnapDup(r);
+    E->scalar_ind[i] = (int)_GD_SnapRange(r, INT_MIN, INT_MAX);
+  }
+
+  data = _GD_SnapData(r, GD_SNAP_U_SIZE);
+  if (data)
+    memcpy((char *)E + GD_SNAP_U, data, GD_SNAP_U_SIZE);
+
+  if (!r->bad && _GD_SnapBadEntry(E))
+    r->bad = 1;
+
+  /* now the private data, as the parser leaves it */
+  switch (type) {
+    case GD_RAW_ENTRY:
+      E->e->u.raw.file[0].idata = E->e->u.raw.file[1].idata = -1;
+      E->e->u.raw.file[0].subenc = GD_ENC_UNKNOWN;
+      E->e->u.raw.size = GD_SIZE(E->EN(raw,data_type));
+      E->e->u.raw.filebase = _GD_SnapDup(r);
+      if (E->e->u.raw.filebase == NULL || E->e->u.raw.size == 0)
+        r->bad = 1;
+      break;
+    case GD_LINTERP_ENTRY:
+      E->EN(linterp,table) = _GD_SnapDup(r);
+      E->e->u.linterp.table_len = -1;
+      break;
+    case GD_CONST_ENTRY:
+    case GD_CARRAY_ENTRY:
+      if (_GD_BadType(GD_DIRFILE_STANDARDS_VERSION,
+            E->EN(scalar,const_type)))
+      {
+        r->bad = 1;
+        break;
+      }
+      size = GD_SIZE(_GD_ConstType(D, E->EN(scalar,const_type)));
+      n = (type == GD_CONST_ENTRY) ? 1 : E->EN(scalar,array_len);
+      if (n == 0 || n > (size_t)(r->end - r->pos) / size) {
+        r->bad = 1;
+        break;
+      }
+      data = _GD_SnapData(r, n * size);
+      E->e->u.scalar.d = malloc(n * size);
+      if (data == NULL || E->e->u.scalar.d == NULL)
+        r->bad = 1;
+      else
+        memcpy(E->e->u.scalar.d, data, n * size);
+      break;
+    case GD_SARRAY_ENTRY:
+      /* _GD_FreeE frees array_len strings */
+      n = E->EN(scalar,array_len);
+      E->EN(scalar,array_len) = 0;
+      if (n == 0 || n > (size_t)(r->end - r->pos) / 8) {
+        r->bad = 1;
+        break;
+      }
+      E->e->u.scalar.d = calloc(n, sizeof(char *));
+      if (E->e->u.scalar.d == NULL) {
+        r->bad = 1;
+        break;
+      }
+      E->EN(scalar,array_len) = n;
+      for (size = 0; size < n; ++size)
+        if ((((char **)E->e->u.scalar.d)[size] = _GD_SnapDup(r)) == NULL)
+          r->bad = 1;
+      break;
+    case GD_STRING_ENTRY:
+      E->e->u.string = _GD_SnapDup(r);
+      if (E->e->u.string == NULL)
+        r->bad = 1;
+      break;
+    default:
+      break;
+  }
+
+  if (r->bad) {
+    /* unhook it from its parent, if necessary */
+    if (E->e->n_meta == -1)
+      for (i = 0; i < E->e->p.parent->e->n_meta; ++i)
+        if (E->e->p.parent->e->p.meta_entry[i] == E)
+          E->e->p.parent->e->p.meta_entry[i] = NULL;
+
+    /* _GD_FreeE only frees the codes its type uses */
+    for (i = 0; i < GD_MAX_LINCOM; ++i) {
+      free(E->in_fields[i]);
+      E->in_fields[i] = NULL;
+    }
+    for (i = 0; i <= GD_MAX_POLYORD; ++i) {
+      free(E->scalar[i]);
+      E->scalar[i] = NULL;
+    }
+    _GD_FreeE(D, E, 1);
+    E = NULL;
+  }
+
+  dreturn("%p", E);
+  return E;
+}
+
+/* Check the stamp of fragment f against the one in the snapshot.  Returns
+ * non-zero if it's changed. */
+static int _GD_SnapCheck(DIRFILE *restrict D gd_unused_d,
+    const struct gd_fragment_t *f, const struct gd_stamp_ *restrict stamp)
+{
+  struct gd_stamp_ now;
+  int fd, changed = 1;
+
+  dtrace("%p, %p, %p", D, f, stamp);
+
+  fd = gd_OpenAt(D, f->dirfd, f->bname, O_RDONLY | O_BINARY, 0666);
+  if (fd >= 0) {
+    changed = _GD_FileStamp(fd, &now) || memcmp(&now, stamp, sizeof(now));
+    close(fd);
+  }
+
+  dreturn("%i", changed);
+  return changed;
+}
+
+/* Free the metadata of fragments [first, n) */
+static void _GD_SnapFreeFragments(DIRFILE *restrict D,
+    struct gd_fragment_t *restrict f, int first, int n)
+{
+  int i;
+
+  dtrace("%p, %p, %i, %i", D, f, first, n);
+
+  for (i = first; i < n; ++i) {
+    free(f[i].cname);
+    free(f[i].bname);
+    free(f[i].sname);
+    free(f[i].ename);
+    free(f[i].enc_data);
+    free(f[i].ref_name);
+    free(f[i].ns);
+    free(f[i].px);
+    free(f[i].sx);
+    if (f[i].dirfd >= 0)
+      _GD_ReleaseDir(D, f[i].dirfd);
+  }
+
+  dreturnvoid();
+}
+
+/* Rebuild the fragment list from the snapshot.  Returns NULL if it's bad. */
+static struct gd_fragment_t *_GD_SnapFragments(DIRFILE *restrict D,
+    struct gd_snapr_ *restrict r, int n)
+{
+  struct gd_fragment_t *f;
+  struct gd_stamp_ stamp;
+  const char *cname;
+  int i;
+
+  dtrace("%p, %p, %i", D, r, n);
+
+  f = calloc(n, sizeof(*f));
+  if (f == NULL) {
+    dreturn("%p", NULL);
+    return NULL;
+  }
+
+  for (i = 0; i < n && !r->bad; ++i) {
+    if (i == 0) {
+      /* the root fragment, which gd_open() has already set up, has to be the
+       * same file: the snapshot may have been copied along with the dirfile */
+      cname = _GD_SnapStr(r);
+      if (cname == NULL || strcmp(cname, D->fragment[0].cname)) {
+        r->bad = 1;
+        break;
+      }
+      _GD_SnapStr(r);
+      _GD_SnapStr(r);
+      _GD_SnapStr(r);
+      f[0].cname = _GD_Strdup(D, D->fragment[0].cname);
+      f[0].bname = _GD_Strdup(D, D->fragment[0].bname);
+      f[0].dirfd = -1;
+    } else {
+      f[i].cname = _GD_SnapDup(r);
+      f[i].bname = _GD_SnapDup(r);
+      f[i].sname = _GD_SnapDup(r);
+      f[i].ename = _GD_SnapDup(r);
+      f[i].dirfd = -1;
+    }
+    f[i].enc_data = _GD_SnapDup(r);
+    f[i].ref_name = _GD_SnapDup(r);
+    f[i].ns = _GD_SnapDup(r);
+    f[i].px = _GD_SnapDup(r);
+    f[i].sx = _GD_SnapDup(r);
+    f[i].nsl = f[i].ns ? strlen(f[i].ns) : 0;
+    f[i].pxl = f[i].px ? strlen(f[i].px) : 0;
+    f[i].sxl = f[i].sx ? strlen(f[i].sx) : 0;
+
+    f[i].parent = (int)_GD_SnapRange(r, -1, i - 1);
+    f[i].encoding = (unsigned long)_GD_SnapInt(r);
+    f[i].byte_sex = (unsigned long)_GD_SnapInt(r);
+    f[i].protection = (int)_GD_SnapRange(r, 0, GD_PROTECT_ALL);
+    f[i].frame_offset = _GD_SnapInt(r);
+    f[i].vers = (uint32_t)_GD_SnapInt(r);
+    _GD_SnapStamp(r, &stamp);
+
+    if (r->bad || D->error || (i == 0) != (f[i].parent == -1) ||
+        f[i].cname == NULL || f[i].bname == NULL)
+    {
+      r->bad = 1;
+      break;
+    }
+
+    if (i == 0) {
+      /* its stamp is the snapshot's */
+      f[0].dirfd = D->fragment[0].dirfd;
+      D->dir[0].rc++;
+      f[0].mtime = D->fragment[0].mtime;
+      f[0].stamp = D->fragment[0].stamp;
+    } else {
+      /* the others have to be unchanged */
+      f[i].dirfd = _GD_GrabDir(D, f[f[i].parent].dirfd, f[i].cname, 1);
+      if (f[i].dirfd < 0 || _GD_SnapCheck(D, f + i, &stamp)) {
+        r->bad = 1;
+        break;
+      }
+      f[i].mtime = (time_t)stamp.mtime;
+      f[i].stamp = stamp;
+    }
+  }
+
+  if (r->bad) {
+    _GD_SnapFreeFragments(D, f, 0, (i < n) ? i + 1 : n);
+    free(f);
+    f = NULL;
+  }
+
+  dreturn("%p", f);
+  return f;
+}
+#endif
+
+/* _GD_LoadSnapshot: replace the parser with the snapshot of its results, if
+ * there's a current one.  D has just its root fragment, whose stamp has been
+ * taken, and the INDEX entry.  On success, p holds the Standards Version and
+ * pedantry of the parse, and D the rest.  Returns non-zero if there's no
+ * usable snapshot, leaving D untouched.
+ */
+int _GD_LoadSnapshot(DIRFILE *restrict D, struct parser_state *restrict p)
+{
+#ifdef USE_MMAP
+  struct gd_fragment_t *f = NULL;
+  gd_entry_t **list = NULL;
+  struct gd_snapr_ r;
+  gd_stat64_t statbuf;
+  int64_t h[3], standards, dflags, ref;
+  const char *version;
+  unsigned int k, n = 0;
+  int i, fd, n_fragment = 0, have_index = 0;
+  size_t len = 0;
+  char *map;
+
+  dtrace("%p, %p", D, p);
+
+  if (D->fragment[0].stamp.size < 0) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  fd = _GD_OpenSidecar(D, D->fragment[0].dirfd, D->fragment[0].bname,
+      GD_SNAP_MAGIC, &D->fragment[0].stamp);
+  if (fd < 0) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  if (_GD_SidecarRead(fd, h, sizeof(h)) || h[0] != GD_SNAP_LAYOUT ||
+      h[2] <= 0 || h[2] % 8 || gd_fstat64(fd, &statbuf) ||
+      statbuf.st_size != GD_SNAP_HEADER + h[2] ||
+      (uint64_t)statbuf.st_size > GD_SIZE_T_MAX)
+  {
+    close(fd);
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  len = (size_t)statbuf.st_size;
+  map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (map == MAP_FAILED) {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  r.pos = map + GD_SNAP_HEADER;
+  r.end = map + len;
+  r.bad = (_GD_SnapSum(r.pos, (size_t)h[2]) != (uint64_t)h[1]);
+
+  /* the library which wrote it, and how it was opened */
+  version = _GD_SnapStr(&r);
+  if (version == NULL || strcmp(version, GD_GETDATA_VERSION) ||
+      _GD_SnapInt(&r) != (int64_t)(D->open_flags & GD_SNAP_FLAGS))
+  {
+    r.bad = 1;
+  }
+  standards = _GD_SnapRange(&r, 0, INT_MAX);
+  dflags = _GD_SnapRange(&r, 0, GD_PEDANTIC | GD_MULTISTANDARD);
+
+  /* the fragments; each takes a word, at least */
+  n_fragment = (int)_GD_SnapRange(&r, 1, ((r.end - r.pos) / 8 < INT_MAX) ?
+      (r.end - r.pos) / 8 : INT_MAX);
+  if (!r.bad)
+    f = _GD_SnapFragments(D, &r, n_fragment);
+
+  /* the entries, likewise */
+  if (f) {
+    n = (unsigned int)_GD_SnapRange(&r, 1, ((r.end - r.pos) / 8 < UINT_MAX) ?
+        (r.end - r.pos) / 8 : UINT_MAX);
+    ref = _GD_SnapRange(&r, -1, (int64_t)n - 1);
+    if (!r.bad) {
+      list = calloc(n, sizeof(gd_entry_t *));
+      if (list == NULL)
+        r.bad = 1;
+    }
+  }
+
+  for (k = 0; list && k < n && !r.bad; ++k) {
+    gd_entype_t type = (gd_entype_t)_GD_SnapRange(&r, INT_MIN, INT_MAX);
+
+    if (r.bad)
+      break;
+    else if (type == GD_INDEX_ENTRY) {
+      if (have_index++)
+        r.bad = 1;
+      list[k] = D->entry[0];
+    } else if ((list[k] = _GD_SnapEntry(D, &r, type, list, k, n,
+            n_fragment)) == NULL)
+    {
+      break;
+    }
+
+    /* the list has to be sorted, with no duplicates */
+    if (k > 0 && _GD_EntryCmp(list + k - 1, list + k) >= 0)
+      r.bad = 1;
+  }
+
+  if (list && !r.bad) {
+    if (!have_index || r.pos != r.end ||
+        (ref >= 0 && list[ref]->field_type != GD_RAW_ENTRY))
+    {
+      r.bad = 1;
+    }
+
+    /* every meta field's parent has to have found it */
+    for (k = 0; k < n && !r.bad; ++k)
+      if (list[k]->e->n_meta > 0)
+        for (i = 0; i < list[k]->e->n_meta; ++i)
+          if (list[k]->e->p.meta_entry[i] == NULL)
+            r.bad = 1;
+  }
+
+  munmap(map, len);
+
+  if (r.bad || list == NULL) {
+    if (list)
+      for (k = 0; k < n; ++k)
+        if (list[k] && list[k] != D->entry[0])
+          _GD_FreeE(D, list[k], 1);
+    free(list);
+
+    if (f) {
+      _GD_SnapFreeFragments(D, f, 0, n_fragment);
+      free(f);
+    }
+
+    /* the only errors are failed allocations, which aren't reported, since
+     * the parser will have a go next */
+    _GD_ClearError(D);
+
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  /* Success; install everything */
+  _GD_SnapFreeFragments(D, D->fragment, 0, D->n_fragment);
+  free(D->fragment);
+  D->fragment = f;
+  D->n_fragment = n_fragment;
+
+  _GD_HashClear(D);
+  free(D->entry);
+  D->entry = list;
+  D->n_entries = n;
+
+  if (ref >= 0)
+    D->reference_field = list[ref];
+  p->standards = (int)standards;
+  p->pedantic = (dflags & GD_PEDANTIC) ? GD_PEDANTIC : 0;
+  if (dflags & GD_MULTISTANDARD)
+    D->flags |= GD_MULTISTANDARD;
+
+  _GD_UpdateAliases(D, 0);
+  D->counter[GD_COUNTER_SNAPSHOT]++;
+
+  dreturn("%i", 0);
+  return 0;
+#else
+  return 1;
+#endif
+}
+
+/* _GD_SaveSnapshot: save a snapshot of the metadata gd_open() has just
+ * parsed, for the next time.  Nothing's saved if the parser reported anything,
+ * since loading the snapshot wouldn't, or hasn't finished, or the stamp of a
+ * fragment is missing.
+ */
+void _GD_SaveSnapshot(DIRFILE *D)
+{
+#ifdef USE_MMAP
+  struct gd_snapw_ w;
+  int64_t h[3];
+  int *meta_pos;
+  unsigned int k, u;
+  int i, fd, bad;
+  char *tmp;
+
+  dtrace("%p", D);
+
+  if (D->n_error || D->n_lazy) {
+    dreturnvoid();
+    return;
+  }
+
+  for (i = 0; i < D->n_fragment; ++i)
+    if (D->fragment[i].stamp.size < 0) {
+      dreturnvoid();
+      return;
+    }
+
+  /* the position of each meta field in its parent's list */
+  meta_pos = malloc(sizeof(int) * D->n_entries);
+  if (meta_pos == NULL) {
+    dreturnvoid();
+    return;
+  }
+
+  for (k = 0; k < D->n_entries; ++k)
+    for (i = 0; i < D->entry[k]->e->n_meta; ++i) {
+      const gd_entry_t *M = D->entry[k]->e->p.meta_entry[i];
+      _GD_FindField(D, M->field, M->e->len, D->entry, D->n_entries, 0, &u);
+      meta_pos[u] = i;
+    }
+
+  memset(&w, 0, sizeof(w));
+
+  _GD_SnapPutStr(&w, GD_GETDATA_VERSION);
+  _GD_SnapPutInt(&w, (int64_t)(D->open_flags & GD_SNAP_FLAGS));
+  _GD_SnapPutInt(&w, D->standards);
+  _GD_SnapPutInt(&w, (int64_t)(D->flags & (GD_PEDANTIC | GD_MULTISTANDARD)));
+
+  _GD_SnapPutInt(&w, D->n_fragment);
+  for (i = 0; i < D->n_fragment; ++i) {
+    const struct gd_fragment_t *f = D->fragment + i;
+
+    _GD_SnapPutStr(&w, f->cname);
+    _GD_SnapPutStr(&w, f->bname);
+    _GD_SnapPutStr(&w, f->sname);
+    _GD_SnapPutStr(&w, f->ename);
+    _GD_SnapPutStr(&w, (const char *)f->enc_data);
+    _GD_SnapPutStr(&w, f->ref_name);
+    _GD_SnapPutStr(&w, f->ns);
+    _GD_SnapPutStr(&w, f->px);
+    _GD_SnapPutStr(&w, f->sx);
+    _GD_SnapPutInt(&w, f->parent);
+    _GD_SnapPutInt(&w, (int64_t)f->encoding);
+    _GD_SnapPutInt(&w, (int64_t)f->byte_sex);
+    _GD_SnapPutInt(&w, f->protection);
+    _GD_SnapPutInt(&w, f->frame_offset);
+    _GD_SnapPutInt(&w, f->vers);
+    _GD_SnapPutStamp(&w, &f->stamp);
+  }
+
+  /* the reference field */
+  u = 0;
+  if (D->reference_field)
+    _GD_FindField(D, D->reference_field->field, D->reference_field->e->len,
+        D->entry, D->n_entries, 0, &u);
+
+  _GD_SnapPutInt(&w, D->n_entries);
+  _GD_SnapPutInt(&w, D->reference_field ? (int64_t)u : -1);
+  for (k = 0; k < D->n_entries; ++k)
+    _GD_SnapPutEntry(D, &w, D->entry[k], meta_pos);
+
+  free(meta_pos);
+
+  if (w.bad) {
+    free(w.buf);
+    dreturnvoid();
+    return;
+  }
+
+  fd = _GD_CreateSidecar(D, D->fragment[0].dirfd, D->fragment[0].bname,
+      GD_SNAP_MAGIC, &D->fragment[0].stamp, &tmp);
+  if (fd < 0) {
+    free(w.buf);
+    dreturnvoid();
+    return;
+  }
+
+  h[0] = GD_SNAP_LAYOUT;
+  h[1] = (int64_t)_GD_SnapSum(w.buf, w.len);
+  h[2] = (int64_t)w.len;
+
+  bad = _GD_SidecarWrite(fd, h, sizeof(h)) || _GD_SidecarWrite(fd, w.buf,
+      w.len);
+  free(w.buf);
+
+  _GD_FinishSidecar(D, D->fragment[0].dirfd, D->fragment[0].bname, fd, tmp,
+      bad);
+
+  dreturnvoid();
+#endif
+}
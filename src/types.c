@@ -70,6 +70,10 @@ gd_nothrow
   if (out_type == GD_NULL) /* null return type: don't return data */
     return;
 
+  /* the common conversions to floating point are vectorised */
+  if (_GD_KernelConvert(data_in, in_type, data_out, out_type, n))
+    return;
+
   switch (in_type) {
     case GD_INT8:
       switch (out_type) {
@@ -684,5 +688,82 @@ gd_nothrow
   }
 }
 
+/* _GD_WidenInPlace: convert n samples of the real type in_type stored at the
+ * start of buf into the real type out_type, which must be at least as wide, in
+ * the same buffer.  Working backwards, no sample is overwritten before it has
+ * been read.  Each sample is copied out into a local before its replacement is
+ * copied in, so the buffer is never accessed through two types at once.
+ * Returns non-zero if the conversion isn't one we can do.
+ */
+#define WIDEN_TO(ot,it) \
+  do { \
+    it in_; \
+    ot out_; \
+    for (i = n; i-- > 0; ) { \
+      memcpy(&in_, (char *)buf + i * sizeof(it), sizeof(it)); \
+      out_ = (ot)in_; \
+      memcpy((char *)buf + i * sizeof(ot), &out_, sizeof(ot)); \
+    } \
+  } while (0)
+
+#define WIDEN(it) \
+  switch (out_type) { \
+    case GD_INT8:    WIDEN_TO(int8_t,it);   break; \
+    case GD_UINT8:   WIDEN_TO(uint8_t,it);  break; \
+    case GD_INT16:   WIDEN_TO(int16_t,it);  break; \
+    case GD_UINT16:  WIDEN_TO(uint16_t,it); break; \
+    case GD_INT32:   WIDEN_TO(int32_t,it);  break; \
+    case GD_UINT32:  WIDEN_TO(uint32_t,it); break; \
+    case GD_INT64:   WIDEN_TO(int64_t,it);  break; \
+    case GD_UINT64:  WIDEN_TO(uint64_t,it); break; \
+    case GD_FLOAT32: WIDEN_TO(float,it);    break; \
+    case GD_FLOAT64: WIDEN_TO(double,it);   break; \
+    default: return 1; \
+  }
+
+int _GD_WidenInPlace(void *buf, gd_type_t in_type, gd_type_t out_type,
+    size_t n) gd_nothrow
+{
+  size_t i;
+
+  dtrace("%p, 0x%X, 0x%X, %" PRIuSIZE, buf, in_type, out_type, n);
+
+  if (in_type == out_type) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  if ((in_type | out_type) & GD_COMPLEX || out_type == GD_NULL ||
+      GD_SIZE(out_type) < GD_SIZE(in_type))
+  {
+    dreturn("%i", 1);
+    return 1;
+  }
+
+  if (_GD_KernelConvert(buf, in_type, buf, out_type, n)) {
+    dreturn("%i", 0);
+    return 0;
+  }
+
+  switch (in_type) {
+    case GD_INT8:    WIDEN(int8_t);   break;
+    case GD_UINT8:   WIDEN(uint8_t);  break;
+    case GD_INT16:   WIDEN(int16_t);  break;
+    case GD_UINT16:  WIDEN(uint16_t); break;
+    case GD_INT32:   WIDEN(int32_t);  break;
+    case GD_UINT32:  WIDEN(uint32_t); break;
+    case GD_INT64:   WIDEN(int64_t);  break;
+    case GD_UINT64:  WIDEN(uint64_t); break;
+    case GD_FLOAT32: WIDEN(float);    break;
+    case GD_FLOAT64: WIDEN(double);   break;
+    default:
+      dreturn("%i", 1);
+      return 1;
+  }
+
+  dreturn("%i", 0);
+  return 0;
+}
+
 /* vim: ts=2 sw=2 et tw=80
 */
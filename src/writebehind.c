@@ -0,0 +1,347 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Asynchronous writing of RAW data; see gd_write_behind */
+#include "internal.h"
+
+#ifdef USE_PTHREAD
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+/* A queued write: ns samples of type, to be written at sample s0 of E.  The
+ * data follow the header. */
+struct gd_wb_job_ {
+  gd_entry_t *E;
+  off64_t s0;
+  size_t ns;
+  size_t size; /* bytes of data */
+  gd_type_t type;
+  struct gd_wb_job_ *next;
+};
+
+#define GD_WB_DATA(j) ((char*)(j) + sizeof(struct gd_wb_job_))
+
+/* The write-behind queue.  The worker thread only touches the raw file
+ * structs of the fields it's writing.  Everything else in the DIRFILE belongs
+ * to the caller's thread, which waits for a field's queued writes to finish
+ * before doing anything else with its data file (see _GD_WBWait). */
+struct gd_wb_ {
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t work; /* signalled when a job is queued, or on stop */
+  pthread_cond_t done; /* signalled when a job is finished */
+  struct gd_wb_job_ *head, *tail; /* the head is being written */
+  size_t limit, queued; /* in bytes */
+  int stop;
+
+  /* The first error encountered by the worker, reported by the next call */
+  int error, suberror, stdlib_errno;
+  char *error_file;
+
+  /* index seeks made by the worker, not yet added to D->counter */
+  uint64_t index_seeks;
+};
+
+static void *_GD_WBWorker(void *arg)
+{
+  DIRFILE *D = (DIRFILE*)arg;
+  struct gd_wb_ *wb = D->wb;
+  struct gd_wb_job_ *job;
+  const struct encoding_t *enc;
+  struct gd_raw_file_ *file;
+  int error, suberror;
+
+  pthread_mutex_lock(&wb->lock);
+  for (;;) {
+    while (wb->head == NULL && !wb->stop)
+      pthread_cond_wait(&wb->work, &wb->lock);
+
+    if (wb->head == NULL)
+      break;
+
+    job = wb->head;
+    pthread_mutex_unlock(&wb->lock);
+
+    /* do the I/O */
+    file = job->E->e->u.raw.file;
+    enc = _GD_ef + file->subenc;
+    errno = 0;
+    error = 0;
+    file->wb = 1;
+    if ((*enc->seek)(file, job->s0, job->type, GD_FILE_WRITE) < 0) {
+      error = errno;
+      suberror = GD_E_IO_WRITE;
+    } else if ((*enc->write)(file, GD_WB_DATA(job), job->type, job->ns) < 0) {
+      error = errno;
+      suberror = GD_E_IO_WRITE;
+    }
+    file->wb = 0;
+
+    pthread_mutex_lock(&wb->lock);
+    wb->index_seeks += file->wb_seeks;
+    file->wb_seeks = 0;
+    if (error && wb->error == 0) {
+      wb->error = GD_E_IO;
+      wb->suberror = suberror;
+      wb->stdlib_errno = error;
+      free(wb->error_file);
+      wb->error_file = strdup(file->name);
+    }
+
+    wb->head = job->next;
+    if (wb->head == NULL)
+      wb->tail = NULL;
+    wb->queued -= job->size;
+    job->E->e->u.raw.wb_pending--;
+    pthread_cond_broadcast(&wb->done);
+    free(job);
+  }
+  pthread_mutex_unlock(&wb->lock);
+
+  return NULL;
+}
+
+/* Report the worker's error, if any, unless another error is already pending;
+ * call with the lock held */
+static int _GD_WBError(DIRFILE *D)
+{
+  struct gd_wb_ *wb = D->wb;
+
+  dtrace("%p", D);
+
+  if (wb->error && !D->error) {
+    _GD_SetError2(D, wb->error, wb->suberror, wb->error_file, 0, NULL,
+        wb->stdlib_errno);
+    wb->error = 0;
+  }
+
+  dreturn("%i", D->error);
+  return D->error;
+}
+
+/* Add the worker's counts to D->counter; call with the lock held */
+static void _GD_WBCount(DIRFILE *D)
+{
+  dtrace("%p", D);
+
+  D->counter[GD_COUNTER_INDEX_SEEK] += D->wb->index_seeks;
+  D->wb->index_seeks = 0;
+
+  dreturnvoid();
+}
+
+/* Wait for the queued writes to E to finish */
+void _GD_WBWait(DIRFILE *restrict D, const gd_entry_t *restrict E)
+{
+  struct gd_wb_ *wb = D->wb;
+
+  dtrace("%p, %p", D, E);
+
+  if (wb) {
+    pthread_mutex_lock(&wb->lock);
+    while (E->e->u.raw.wb_pending > 0)
+      pthread_cond_wait(&wb->done, &wb->lock);
+    _GD_WBCount(D);
+    pthread_mutex_unlock(&wb->lock);
+  }
+
+  dreturnvoid();
+}
+
+/* Wait for all queued writes to finish, and report any error */
+int _GD_WBDrain(DIRFILE *D)
+{
+  struct gd_wb_ *wb = D->wb;
+
+  dtrace("%p", D);
+
+  if (wb) {
+    pthread_mutex_lock(&wb->lock);
+    while (wb->head)
+      pthread_cond_wait(&wb->done, &wb->lock);
+    _GD_WBCount(D);
+    _GD_WBError(D);
+    pthread_mutex_unlock(&wb->lock);
+  }
+
+  dreturn("%i", D->error);
+  return D->error;
+}
+
+/* Finish the queued writes and stop the worker.  Errors are lost. */
+void _GD_WBStop(DIRFILE *D)
+{
+  struct gd_wb_ *wb = D->wb;
+
+  dtrace("%p", D);
+
+  if (wb) {
+    pthread_mutex_lock(&wb->lock);
+    wb->stop = 1;
+    pthread_cond_signal(&wb->work);
+    pthread_mutex_unlock(&wb->lock);
+
+    pthread_join(wb->thread, NULL);
+    _GD_WBCount(D);
+
+    pthread_cond_destroy(&wb->done);
+    pthread_cond_destroy(&wb->work);
+    pthread_mutex_destroy(&wb->lock);
+    free(wb->error_file);
+    free(wb);
+    D->wb = NULL;
+    D->counter[GD_COUNTER_WB_DEPTH] = 0;
+  }
+
+  dreturnvoid();
+}
+
+/* Queue a write of ns samples of the field's stored type, at sample s0.  The
+ * file must already be open for writing.  If the queue is full, this blocks
+ * until there's room. */
+int _GD_WBQueue(DIRFILE *restrict D, gd_entry_t *restrict E, off64_t s0,
+    size_t ns, gd_type_t type, const void *restrict data)
+{
+  struct gd_wb_ *wb = D->wb;
+  struct gd_wb_job_ *job;
+  const size_t size = ns * GD_SIZE(type);
+  struct timespec t0, t1;
+
+  dtrace("%p, %p, %" PRId64 ", %" PRIuSIZE ", 0x%X, %p", D, E, (int64_t)s0,
+      ns, type, data);
+
+  job = _GD_Malloc(D, sizeof(*job) + size);
+  if (job == NULL) {
+    dreturn("%i", D->error);
+    return D->error;
+  }
+
+  job->E = E;
+  job->s0 = s0;
+  job->ns = ns;
+  job->size = size;
+  job->type = type;
+  job->next = NULL;
+  memcpy(GD_WB_DATA(job), data, size);
+
+  pthread_mutex_lock(&wb->lock);
+
+  /* report an earlier failure instead of queueing more */
+  if (_GD_WBError(D)) {
+    pthread_mutex_unlock(&wb->lock);
+    free(job);
+    dreturn("%i", D->error);
+    return D->error;
+  }
+
+  /* backpressure: wait for room, unless this is the only job */
+  if (wb->head && wb->queued + size > wb->limit) {
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while (wb->head && wb->queued + size > wb->limit)
+      pthread_cond_wait(&wb->done, &wb->lock);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    D->counter[GD_COUNTER_WB_STALL] += (uint64_t)(t1.tv_sec - t0.tv_sec) *
+      1000000 + (t1.tv_nsec - t0.tv_nsec) / 1000;
+  }
+
+  if (wb->tail)
+    wb->tail->next = job;
+  else
+    wb->head = job;
+  wb->tail = job;
+  wb->queued += size;
+  E->e->u.raw.wb_pending++;
+  pthread_cond_signal(&wb->work);
+  _GD_WBCount(D);
+
+  pthread_mutex_unlock(&wb->lock);
+
+  dreturn("%i", 0);
+  return 0;
+}
+
+/* Bring the write-behind counters up to date: add the worker's counts, and
+ * record the current depth of the queue, which isn't a running total.  Only
+ * call this if write-behind is on. */
+void _GD_WBCounters(DIRFILE *D)
+{
+  dtrace("%p", D);
+
+  pthread_mutex_lock(&D->wb->lock);
+  _GD_WBCount(D);
+  D->counter[GD_COUNTER_WB_DEPTH] = D->wb->queued;
+  pthread_mutex_unlock(&D->wb->lock);
+
+  dreturnvoid();
+}
+#endif
+
+int gd_write_behind(DIRFILE *D, size_t queue_size)
+{
+  dtrace("%p, %" PRIuSIZE, D, queue_size);
+
+  GD_RETURN_ERR_IF_INVALID(D);
+
+  if ((D->flags & GD_ACCMODE) != GD_RDWR)
+    GD_SET_RETURN_ERROR(D, GD_E_ACCMODE, 0, NULL, 0, NULL);
+
+#ifdef USE_PTHREAD
+  if (queue_size == 0) {
+    /* turn write-behind off */
+    if (_GD_WBDrain(D) == 0)
+      _GD_WBStop(D);
+  } else if (D->wb) {
+    /* just change the limit; anything already queued stays queued */
+    pthread_mutex_lock(&D->wb->lock);
+    D->wb->limit = queue_size;
+    pthread_cond_broadcast(&D->wb->done);
+    pthread_mutex_unlock(&D->wb->lock);
+  } else {
+    struct gd_wb_ *wb = _GD_Malloc(D, sizeof(*wb));
+    if (wb == NULL)
+      GD_RETURN_ERROR(D);
+
+    memset(wb, 0, sizeof(*wb));
+    wb->limit = queue_size;
+    pthread_mutex_init(&wb->lock, NULL);
+    pthread_cond_init(&wb->work, NULL);
+    pthread_cond_init(&wb->done, NULL);
+
+    D->wb = wb;
+    if (pthread_create(&wb->thread, NULL, _GD_WBWorker, D)) {
+      pthread_cond_destroy(&wb->done);
+      pthread_cond_destroy(&wb->work);
+      pthread_mutex_destroy(&wb->lock);
+      free(wb);
+      D->wb = NULL;
+      _GD_SetError(D, GD_E_ALLOC, 0, NULL, 0, NULL);
+    }
+  }
+#else
+  if (queue_size > 0)
+    _GD_SetError(D, GD_E_UNSUPPORTED, GD_E_SUPPORT_THREADS, NULL, 0, NULL);
+#endif
+
+  GD_RETURN_ERROR(D);
+}
+/* vim: ts=2 sw=2 et tw=80
+*/
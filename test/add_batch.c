@@ -0,0 +1,109 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* A bulk addition appends fields unsorted; they must be found, and listed in
+ * order, all the same */
+#include "test.h"
+
+#define NF 5000
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  char name[20];
+  const char **fl;
+  const char *target;
+  int e1, e2, e3, e4, e5, e6, e7, e8, i, r = 0;
+  unsigned int n1, n2;
+  gd_entry_t E;
+  DIRFILE *D;
+
+  rmdirfile();
+
+  D = gd_open(filedir, GD_RDWR | GD_CREAT | GD_EXCL | GD_VERBOSE);
+  e1 = gd_add_begin(D);
+  CHECKI(e1, 0);
+
+  /* an alias to a field not yet added */
+  e2 = gd_add_alias(D, "alias", "c00007", 0);
+  CHECKI(e2, 0);
+
+  /* in reverse order, so each one goes before all the others */
+  for (i = NF - 1; i >= 0; --i) {
+    sprintf(name, "c%05i", i);
+    gd_add_const(D, name, GD_INT32, GD_INT_TYPE, &i, 0);
+  }
+  e3 = gd_error(D);
+  CHECKI(e3, 0);
+
+  /* duplicates are still caught */
+  gd_add_raw(D, "c01234", GD_UINT8, 1, 0);
+  e4 = gd_error(D);
+  CHECKI(e4, GD_E_DUPLICATE);
+
+  e5 = gd_madd_const(D, "c04321", "sub", GD_INT32, GD_INT_TYPE, &i);
+  CHECKI(e5, 0);
+
+  /* other calls still work during a bulk addition */
+  e6 = gd_delete(D, "c00100", 0);
+  CHECKI(e6, 0);
+
+  gd_add_const(D, "c00100", GD_INT32, GD_INT_TYPE, &i, 0);
+
+  e7 = gd_add_commit(D);
+  CHECKI(e7, 0);
+
+  /* INDEX, the alias and the CONSTs */
+  n1 = gd_nfields(D);
+  CHECKU(n1, NF + 2);
+
+  fl = gd_field_list(D);
+  for (i = 2; i < NF + 2; ++i)
+    if (strcmp(fl[i - 1], fl[i]) >= 0) {
+      CHECKSi(i, fl[i], "sorted");
+      break;
+    }
+
+  target = gd_alias_target(D, "alias");
+  CHECKS(target, "c00007");
+
+  gd_entry(D, "c04321/sub", &E);
+  e8 = gd_error(D);
+  CHECKI(e8, 0);
+  CHECKI(E.field_type, GD_CONST_ENTRY);
+  gd_free_entry_strings(&E);
+
+  gd_close(D);
+
+  /* and are written in order */
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+  n2 = gd_nfields(D);
+  CHECKU(n2, NF + 2);
+  gd_entry(D, "c00000", &E);
+  CHECKI(E.field_type, GD_CONST_ENTRY);
+  gd_free_entry_strings(&E);
+  gd_discard(D);
+
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,84 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Seeks in a long ASCII file start from the closest indexed line */
+#include "test.h"
+
+#define NLINE 5000
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data.txt";
+  double c[8];
+  int i, e1, e2, e3, r = 0;
+  size_t n1, n2, n3;
+  long long k;
+  DIRFILE *D;
+  FILE *stream;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "data RAW FLOAT64 1\n/ENCODING text\n");
+
+  stream = fopen(data, "w");
+  for (i = 0; i < NLINE; ++i)
+    fprintf(stream, "%i.25\n", i);
+  fclose(stream);
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+
+  /* read through the file, which indexes it */
+  n1 = gd_getdata(D, "data", 4000, 0, 8, 0, GD_FLOAT64, c);
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+  CHECKU(n1, 8);
+  for (i = 0; i < 8; ++i)
+    CHECKFi(i, c[i], 4000 + i + 0.25);
+
+  /* backwards, but not to the start */
+  n2 = gd_getdata(D, "data", 3000, 0, 8, 0, GD_FLOAT64, c);
+  e2 = gd_error(D);
+  CHECKI(e2, 0);
+  CHECKU(n2, 8);
+  for (i = 0; i < 8; ++i)
+    CHECKFi(i, c[i], 3000 + i + 0.25);
+
+  /* off the end */
+  n3 = gd_getdata(D, "data", NLINE - 4, 0, 8, 0, GD_FLOAT64, c);
+  e3 = gd_error(D);
+  CHECKI(e3, 0);
+  CHECKU(n3, 4);
+  for (i = 0; i < 4; ++i)
+    CHECKFi(i, c[i], NLINE - 4 + i + 0.25);
+
+  k = gd_counter(D, GD_COUNTER_INDEX_SEEK);
+  CHECKI(k, 2);
+
+  gd_discard(D);
+
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,118 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Seeks in a bzip2 file use, and save, an index of blocks */
+#include "test.h"
+
+#define N 3000000
+
+int main(void)
+{
+#if !defined TEST_BZIP2 || !defined USE_BZIP2
+  return 77;
+#else
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  const char *bzip2data = "dirfile/data.bz2";
+  const char *idxfile = "dirfile/data.bz2.gdidx";
+  char command[4096];
+  uint32_t c[10];
+  unsigned int i;
+  int e1, e2, e3, e4, e5, r = 0;
+  size_t n1, n2, n3, n4;
+  off_t nf;
+  int64_t c1, c2, c3, c4;
+  struct stat buf;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "data RAW UINT32 1\n");
+  MAKEDATAFILE(data, uint32_t, i * 7, N);
+
+  /* compress */
+  snprintf(command, 4096, "\"%s\" -f %s > %s", BZIP2, data, NULL_DEVICE);
+  if (gd_system(command))
+    return 1;
+
+  /* indices are only saved by dirfiles open for writing */
+  D = gd_open(filedir, GD_RDWR | GD_VERBOSE);
+
+  /* no index needed going forwards */
+  n1 = gd_getdata(D, "data", N - 10, 0, 10, 0, GD_UINT32, c);
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+  CHECKU(n1, 10);
+  for (i = 0; i < 10; ++i)
+    CHECKUi(i, c[i], (N - 10 + i) * 7);
+  c1 = gd_counter(D, GD_COUNTER_INDEX_SEEK);
+  CHECKI(c1, 0);
+  CHECKI(stat(idxfile, &buf), -1);
+
+  /* going back builds it */
+  n2 = gd_getdata(D, "data", N / 2, 0, 10, 0, GD_UINT32, c);
+  e2 = gd_error(D);
+  CHECKI(e2, 0);
+  CHECKU(n2, 10);
+  for (i = 0; i < 10; ++i)
+    CHECKUi(i, c[i], (N / 2 + i) * 7);
+  c2 = gd_counter(D, GD_COUNTER_INDEX_SEEK);
+  CHECKI(c2, 1);
+  CHECKI(stat(idxfile, &buf), 0);
+
+  e3 = gd_close(D);
+  CHECKI(e3, 0);
+
+  /* now the saved index is used */
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+
+  nf = gd_nframes(D);
+  CHECKI(nf, N);
+
+  n3 = gd_getdata(D, "data", N - 10, 0, 10, 0, GD_UINT32, c);
+  e4 = gd_error(D);
+  CHECKI(e4, 0);
+  CHECKU(n3, 10);
+  for (i = 0; i < 10; ++i)
+    CHECKUi(i, c[i], (N - 10 + i) * 7);
+  c3 = gd_counter(D, GD_COUNTER_INDEX_SEEK);
+  CHECKI(c3, 1);
+
+  n4 = gd_getdata(D, "data", 5, 0, 10, 0, GD_UINT32, c);
+  e5 = gd_error(D);
+  CHECKI(e5, 0);
+  CHECKU(n4, 10);
+  for (i = 0; i < 10; ++i)
+    CHECKUi(i, c[i], (5 + i) * 7);
+  c4 = gd_counter(D, GD_COUNTER_INDEX_SEEK);
+  CHECKI(c4, 2);
+
+  gd_discard(D);
+
+  unlink(idxfile);
+  unlink(bzip2data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+#endif
+}
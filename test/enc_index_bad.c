@@ -0,0 +1,87 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* A sidecar index which claims an impossible number of records is ignored */
+#include "test.h"
+
+int main(void)
+{
+#if (defined ENC_SKIP_TEST) || ! (defined USE_ENC)
+  return 77;
+#else
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  const char *encdata = "dirfile/data" ENC_SUFFIX;
+  const char *idxfile = "dirfile/data" ENC_SUFFIX ".gdidx";
+  const int64_t body[] = ENC_IDX_BODY;
+  unsigned char tail[8];
+  char command[4096];
+  uint16_t c[8];
+  int64_t v;
+  int fd, i, e1, r = 0;
+  size_t n;
+  struct stat buf;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "data RAW UINT16 8\n");
+  MAKEDATAFILE(data, uint16_t, i, 256);
+
+  ENC_COMPRESS;
+  if (gd_system(command))
+    return 1;
+
+  /* a sidecar which matches the data file */
+  stat(encdata, &buf);
+  fd = open(encdata, O_RDONLY | O_BINARY);
+  lseek(fd, -8, SEEK_END);
+  read(fd, tail, 8);
+  close(fd);
+
+  fd = open(idxfile, O_CREAT | O_EXCL | O_WRONLY | O_BINARY, 0666);
+  write(fd, ENC_IDX_MAGIC, 8);
+  v = buf.st_size;
+  write(fd, &v, 8);
+  v = buf.st_mtime;
+  write(fd, &v, 8);
+  write(fd, tail, 8);
+  write(fd, body, sizeof(body));
+  close(fd);
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+  n = gd_getdata(D, "data", 5, 0, 1, 0, GD_UINT16, c);
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+  CHECKU(n, 8);
+  for (i = 0; i < 8; ++i)
+    CHECKUi(i, c[i], 40 + i);
+  gd_discard(D);
+
+  unlink(idxfile);
+  unlink(encdata);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+#endif
+}
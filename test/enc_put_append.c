@@ -0,0 +1,122 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Writes at the end of the data append to the compressed file in place */
+#include "test.h"
+
+#define NS 3 /* sessions */
+#define NF 4 /* frames per session */
+
+int main(void)
+{
+#if (defined ENC_SKIP_TEST) || ! (defined USE_ENC)
+  return 77;
+#else
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *encdata = "dirfile/data" ENC_SUFFIX;
+  const char *data = "dirfile/data";
+  uint8_t c[8 * NF * NS], d;
+  char command[4096];
+  char *prev = NULL;
+  off_t prev_len = 0;
+  int fd, i, k, unlink_data, r = 0;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  for (i = 0; i < 8 * NF * NS; ++i)
+    c[i] = (uint8_t)(3 * i + 1);
+
+  MAKEFORMATFILE(format, "data RAW UINT8 8\n");
+
+  for (k = 0; k < NS; ++k) {
+    struct stat buf;
+    off_t nf;
+    size_t n;
+    int e1, e2, e3;
+    char *cur;
+
+    D = gd_open(filedir, GD_RDWR | ENC_ENCODING | GD_VERBOSE);
+    if (k > 0) {
+      nf = gd_nframes(D);
+      CHECKIi(k, nf, NF * k);
+    }
+    n = gd_putdata(D, "data", NF * k, 0, NF, 0, GD_UINT8, c + 8 * NF * k);
+    e1 = gd_error(D);
+    CHECKIi(k, e1, GD_E_OK);
+    CHECKUi(k, n, 8 * NF);
+    e2 = gd_close(D);
+    CHECKIi(k, e2, 0);
+
+    /* the earlier data haven't been rewritten */
+    e3 = stat(encdata, &buf);
+    CHECKIi(k, e3, 0);
+    CHECKIi(k, buf.st_size > prev_len, 1);
+
+    cur = malloc(buf.st_size);
+    fd = open(encdata, O_RDONLY | O_BINARY);
+    CHECKIi(k, read(fd, cur, buf.st_size), buf.st_size);
+    close(fd);
+    if (prev_len > 0)
+      CHECKIi(k, memcmp(prev, cur, prev_len), 0);
+    free(prev);
+    prev = cur;
+    prev_len = buf.st_size;
+  }
+  free(prev);
+
+  /* everything reads back */
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+  CHECKI(gd_nframes(D), NF * NS);
+  memset(c, 0, sizeof(c));
+  CHECKU(gd_getdata(D, "data", 0, 0, NF * NS, 0, GD_UINT8, c), 8 * NF * NS);
+  for (i = 0; i < 8 * NF * NS; ++i)
+    CHECKUi(i, c[i], (uint8_t)(3 * i + 1));
+  gd_discard(D);
+
+  /* and the compressor agrees */
+  ENC_COMPRESS;
+  if (gd_system(command)) {
+    r = 1;
+  } else {
+    fd = open(data, O_RDONLY | O_BINARY);
+    if (fd >= 0) {
+      i = 0;
+      while (read(fd, &d, sizeof(uint8_t))) {
+        CHECKUi(i, d, (uint8_t)(3 * i + 1));
+        i++;
+      }
+      CHECKI(i, 8 * NF * NS);
+      close(fd);
+    }
+  }
+
+  unlink_data = unlink(data);
+  unlink(encdata);
+  unlink(format);
+  rmdir(filedir);
+
+  CHECKI(unlink_data, 0);
+
+  return r;
+#endif
+}
@@ -0,0 +1,93 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Cancelling a recode part way through leaves the old data alone */
+#include "test.h"
+
+static int callback(const gd_move_data_t *pdata, void *extra)
+{
+  int *count = (int *)extra;
+
+  (*count)++;
+  return (pdata->n_done == 2) ? GD_MOVE_ABORT : GD_MOVE_CONTINUE;
+}
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  char data[20], txtdata[24], field[6];
+  uint16_t c[8];
+  int i, j, ret, e1, e2, n, count = 0, unlink_txtdata, unlink_data, r = 0;
+  unsigned long enc;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+      "ENCODING none\n"
+      "data0 RAW UINT16 8\n"
+      "data1 RAW UINT16 8\n"
+      "data2 RAW UINT16 8\n"
+      "data3 RAW UINT16 8\n"
+      );
+  for (j = 0; j < 4; ++j) {
+    sprintf(data, "dirfile/data%i", j);
+    MAKEDATAFILE(data, uint16_t, 0x201 * i + j, 128);
+  }
+
+  D = gd_open(filedir, GD_RDWR | GD_VERBOSE);
+  gd_move_callback(D, callback, &count);
+
+  ret = gd_alter_encoding(D, GD_TEXT_ENCODED, 0, 1);
+  e1 = gd_error(D);
+  CHECKI(ret, GD_E_CALLBACK);
+  CHECKI(e1, GD_E_CALLBACK);
+  CHECKI(count, 2);
+
+  enc = gd_encoding(D, 0);
+  CHECKX(enc, GD_UNENCODED);
+
+  for (j = 0; j < 4; ++j) {
+    sprintf(field, "data%i", j);
+    n = gd_getdata(D, field, 5, 0, 1, 0, GD_UINT16, c);
+    CHECKIi(j, n, 8);
+
+    for (i = 0; i < 8; ++i)
+      CHECKXi(j * 8 + i, c[i], (uint16_t)((40 + i) * 0x201 + j));
+  }
+
+  e2 = gd_close(D);
+  CHECKI(e2, 0);
+
+  for (j = 0; j < 4; ++j) {
+    sprintf(data, "dirfile/data%i", j);
+    sprintf(txtdata, "dirfile/data%i.txt", j);
+    unlink_txtdata = unlink(txtdata);
+    unlink_data = unlink(data);
+    CHECKIi(j, unlink_txtdata, -1);
+    CHECKIi(j, unlink_data, 0);
+  }
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
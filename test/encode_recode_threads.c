@@ -0,0 +1,110 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Recoding several fields on a worker pool */
+#include "test.h"
+
+#define NFIELD 6
+
+static int callback(const gd_move_data_t *pdata, void *extra)
+{
+  int *count = (int *)extra;
+
+  /* the callback is only ever called from the caller's thread */
+  if (pdata->n_fields != NFIELD || pdata->n_done != (unsigned)(*count + 1))
+    return GD_MOVE_ABORT;
+
+  (*count)++;
+  return GD_MOVE_CONTINUE;
+}
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  char data[20], txtdata[24], field[6];
+  uint16_t c[8];
+  int i, j, ret, e1, e2, e3, n, count = 0, unlink_txtdata, unlink_data, r = 0;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+      "ENCODING none\n"
+      "data0 RAW UINT16 8\n"
+      "data1 RAW UINT16 8\n"
+      "data2 RAW UINT16 8\n"
+      "data3 RAW UINT16 8\n"
+      "data4 RAW UINT16 8\n"
+      "data5 RAW UINT16 8\n"
+      );
+  for (j = 0; j < NFIELD; ++j) {
+    sprintf(data, "dirfile/data%i", j);
+    MAKEDATAFILE(data, uint16_t, 0x201 * i + j, 8192);
+  }
+
+  D = gd_open(filedir, GD_RDWR | GD_VERBOSE);
+  e1 = gd_move_threads(D, 4, 0);
+  if (e1 == GD_E_UNSUPPORTED) {
+    gd_discard(D);
+    for (j = 0; j < NFIELD; ++j) {
+      sprintf(data, "dirfile/data%i", j);
+      unlink(data);
+    }
+    unlink(format);
+    rmdir(filedir);
+    return 77;
+  }
+  CHECKI(e1, 0);
+
+  gd_move_callback(D, callback, &count);
+
+  ret = gd_alter_encoding(D, GD_TEXT_ENCODED, 0, 1);
+  e2 = gd_error(D);
+  CHECKI(ret, 0);
+  CHECKI(e2, 0);
+  CHECKI(count, NFIELD);
+
+  for (j = 0; j < NFIELD; ++j) {
+    sprintf(field, "data%i", j);
+    n = gd_getdata(D, field, 500, 0, 1, 0, GD_UINT16, c);
+    CHECKIi(j, n, 8);
+
+    for (i = 0; i < 8; ++i)
+      CHECKXi(j * 8 + i, c[i], (uint16_t)((4000 + i) * 0x201 + j));
+  }
+
+  e3 = gd_close(D);
+  CHECKI(e3, 0);
+
+  for (j = 0; j < NFIELD; ++j) {
+    sprintf(data, "dirfile/data%i", j);
+    sprintf(txtdata, "dirfile/data%i.txt", j);
+    unlink_txtdata = unlink(txtdata);
+    unlink_data = unlink(data);
+    CHECKIi(j, unlink_txtdata, 0);
+    CHECKIi(j, unlink_data, -1);
+  }
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,69 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Shifting unencoded data copies it verbatim, which the kernel may do for us */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  uint16_t c[8];
+  int i, ret, e1, e2, r = 0;
+  size_t n;
+  off_t nf;
+  gd_int64_t offload;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "data RAW UINT16 8\n");
+  MAKEDATAFILE(data, uint16_t, 0x201 * i, 8 * 1000);
+
+  D = gd_open(filedir, GD_RDWR | GD_UNENCODED | GD_VERBOSE);
+  ret = gd_alter_frameoffset(D, 3, 0, 1);
+  e1 = gd_error(D);
+  CHECKI(ret, 0);
+  CHECKI(e1, 0);
+
+  nf = gd_nframes(D);
+  CHECKI(nf, 1000);
+
+  n = gd_getdata(D, "data", 500, 0, 1, 0, GD_UINT16, c);
+  CHECKU(n, 8);
+  for (i = 0; i < 8; ++i)
+    CHECKXi(i, c[i], (uint16_t)((4000 + i) * 0x201));
+
+  /* either the kernel copied everything, or nothing */
+  offload = gd_counter(D, GD_COUNTER_COPY_OFFLOAD);
+  if (offload != 0)
+    CHECKI(offload, 2 * 8 * 997);
+
+  e2 = gd_close(D);
+  CHECKI(e2, 0);
+
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,109 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Bitfields of narrow integer inputs are extracted at the width of the input;
+ * the results must be the same as if the input were widened to 64 bits first
+ */
+#include "test.h"
+
+#define N 77
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *i8 = "dirfile/i8";
+  const char *i16 = "dirfile/i16";
+  const char *u32 = "dirfile/u32";
+  int8_t c1[N];
+  uint16_t c2[N];
+  double c3[N], c5[2 * N];
+  int64_t c4[N];
+  int e1, e2, e3, e4, e5, i, r = 0;
+  size_t n1, n2, n3, n4, n5;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+    "i8 RAW INT8 1\n"
+    "i16 RAW INT16 1\n"
+    "u32 RAW UINT32 1\n"
+    "sbit8 SBIT i8 1 7\n"
+    "bit16 BIT i16 3 13\n"
+    "sbit32 SBIT u32 0 32\n"
+    "over BIT i16 10 10\n" /* includes the sign-extension of i16 */
+    "cbit BIT u32 30 2\n"
+  );
+  MAKEDATAFILE(i8, int8_t, 37 * i, N);
+  MAKEDATAFILE(i16, int16_t, 0x3A1D * i, N);
+  MAKEDATAFILE(u32, uint32_t, 0x9E3779B9U * (uint32_t)i, N);
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+
+  /* narrower, the same width, wider, and complex return types */
+  n1 = gd_getdata(D, "sbit8", 0, 0, 0, N, GD_INT8, c1);
+  e1 = gd_error(D);
+  n2 = gd_getdata(D, "bit16", 0, 0, 0, N, GD_UINT16, c2);
+  e2 = gd_error(D);
+  n3 = gd_getdata(D, "sbit32", 0, 0, 0, N, GD_FLOAT64, c3);
+  e3 = gd_error(D);
+  n4 = gd_getdata(D, "over", 0, 0, 0, N, GD_INT64, c4);
+  e4 = gd_error(D);
+  n5 = gd_getdata(D, "cbit", 0, 0, 0, N, GD_COMPLEX128, c5);
+  e5 = gd_error(D);
+
+  gd_discard(D);
+
+  unlink(u32);
+  unlink(i16);
+  unlink(i8);
+  unlink(format);
+  rmdir(filedir);
+
+  CHECKI(e1, 0);
+  CHECKU(n1, N);
+  CHECKI(e2, 0);
+  CHECKU(n2, N);
+  CHECKI(e3, 0);
+  CHECKU(n3, N);
+  CHECKI(e4, 0);
+  CHECKU(n4, N);
+  CHECKI(e5, 0);
+  CHECKU(n5, N);
+
+  for (i = 0; i < N; ++i) {
+    const uint64_t a = (uint64_t)(int64_t)(int8_t)(37 * i);
+    const uint64_t b = (uint64_t)(int64_t)(int16_t)(0x3A1D * i);
+    const uint64_t c = 0x9E3779B9U * (uint32_t)i;
+    const uint64_t s7 = ~(uint64_t)0 << 6;
+    const uint64_t s32 = ~(uint64_t)0 << 31;
+
+    CHECKIi(i, c1[i], (int64_t)((((a >> 1) & 0x7F) + s7) ^ s7));
+    CHECKUi(i, c2[i], (b >> 3) & 0x1FFF);
+    CHECKFi(i, c3[i], (double)(int64_t)(((c & 0xFFFFFFFF) + s32) ^ s32));
+    CHECKIi(i, c4[i], (b >> 10) & 0x3FF);
+    CHECKFi(i, c5[2 * i], (double)(c >> 30));
+    CHECKFi(i, c5[2 * i + 1], 0);
+  }
+
+  return r;
+}
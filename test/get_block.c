@@ -0,0 +1,92 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* A long read of a derived field is evaluated in blocks; the result must not
+ * depend on that */
+#include "test.h"
+
+#define NF 3000
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  const char *cata = "dirfile/cata";
+  const double a[3] = {2, 1, 0.25};
+  double *c;
+  int e1, e2, e3, r = 0;
+  size_t i, n1, n2;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+    "data RAW UINT16 8\n"
+    "cata RAW FLOAT64 3\n"
+    "bit BIT data 2 6\n"
+    "poly POLYNOM bit 1 2 0.5\n"
+    "lincom LINCOM 2 poly 2 3 cata 1 0\n"
+  );
+  MAKEDATAFILE(data, uint16_t, i, 8 * NF);
+  MAKEDATAFILE(cata, double, i * 0.25, 3 * NF);
+
+  c = malloc(sizeof(*c) * 10 * NF);
+
+  D = gd_open(filedir, GD_RDWR | GD_VERBOSE);
+
+  /* not frame aligned; more than is available */
+  n1 = gd_getdata(D, "lincom", 0, 3, 0, 10 * NF, GD_FLOAT64, c);
+  e1 = gd_error(D);
+
+  CHECKI(e1, 0);
+  CHECKU(n1, 8 * NF - 3);
+  for (i = 0; i < n1; ++i) {
+    const double b = (double)(((3 + i) >> 2) & 0x3F);
+    const size_t j = 3 * 3 / 8 + i * 3 / 8;
+    CHECKFi(i, c[i], 2 * (1 + 2 * b + 0.5 * b * b) + 3 + j * 0.25);
+  }
+
+  /* after a metadata change */
+  e2 = gd_alter_polynom(D, "poly", 2, NULL, a);
+  CHECKI(e2, 0);
+
+  n2 = gd_getdata(D, "lincom", 10, 0, 1000, 0, GD_FLOAT64, c);
+  e3 = gd_error(D);
+
+  CHECKI(e3, 0);
+  CHECKU(n2, 8000);
+  for (i = 0; i < n2; ++i) {
+    const double b = (double)(((80 + i) >> 2) & 0x3F);
+    const size_t j = 30 + i * 3 / 8;
+    CHECKFi(i, c[i], 2 * (2 + b + 0.25 * b * b) + 3 + j * 0.25);
+  }
+
+  gd_discard(D);
+  free(c);
+
+  unlink(cata);
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
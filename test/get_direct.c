@@ -0,0 +1,101 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* RAW reads into the caller's buffer, with and without widening */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  int16_t i16[16];
+  int64_t i64[16];
+  double f64[16];
+  int8_t i8[16];
+  int n, e1, e2, e3, e4, e5, r = 0;
+  size_t n1, n2, n3, n4;
+  gd_int64_t c0, c1, c2, c3, c4, c5;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "data RAW INT16 8\n");
+  MAKEDATAFILE(data, int16_t, (i - 20) * 301, 64);
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+
+  c0 = gd_counter(D, GD_COUNTER_RAW_DIRECT);
+  CHECKI(c0, 0);
+
+  /* same type */
+  n1 = gd_getdata(D, "data", 1, 3, 0, 16, GD_INT16, i16);
+  e1 = gd_error(D);
+  c1 = gd_counter(D, GD_COUNTER_RAW_DIRECT);
+
+  /* wider */
+  n2 = gd_getdata(D, "data", 1, 3, 0, 16, GD_INT64, i64);
+  e2 = gd_error(D);
+  c2 = gd_counter(D, GD_COUNTER_RAW_DIRECT);
+
+  n3 = gd_getdata(D, "data", 1, 3, 0, 16, GD_FLOAT64, f64);
+  e3 = gd_error(D);
+  c3 = gd_counter(D, GD_COUNTER_RAW_DIRECT);
+
+  /* narrower: goes through a temporary buffer */
+  n4 = gd_getdata(D, "data", 1, 3, 0, 16, GD_INT8, i8);
+  e4 = gd_error(D);
+  c4 = gd_counter(D, GD_COUNTER_RAW_DIRECT);
+
+  CHECKI(e1, 0);
+  CHECKI(e2, 0);
+  CHECKI(e3, 0);
+  CHECKI(e4, 0);
+  CHECKU(n1, 16);
+  CHECKU(n2, 16);
+  CHECKU(n3, 16);
+  CHECKU(n4, 16);
+  CHECKI(c1, 1);
+  CHECKI(c2, 2);
+  CHECKI(c3, 3);
+  CHECKI(c4, 3);
+
+  for (n = 0; n < 16; ++n) {
+    const int16_t v = (int16_t)((n + 11 - 20) * 301);
+    CHECKIi(n, i16[n], v);
+    CHECKIi(n, i64[n], v);
+    CHECKFi(n, f64[n], v);
+    CHECKIi(n, i8[n], (int8_t)v);
+  }
+
+  c5 = gd_counter(D, 1000);
+  e5 = gd_error(D);
+  CHECKI(c5, GD_E_ARGUMENT);
+  CHECKI(e5, GD_E_ARGUMENT);
+
+  gd_discard(D);
+
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,108 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Read through field handles */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  uint8_t c[8], d[8];
+  int i, e1, e2, e3, e4, e5, e6, e7, r = 0;
+  size_t n1, n2, n3, n4, n5;
+  gd_field_handle_t h1, h2, h3, h4;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+    "data RAW UINT8 8\n"
+    "lincom LINCOM data 2 3\n"
+    "const CONST UINT8 1\n"
+  );
+  MAKEDATAFILE(data, unsigned char, i, 256);
+
+  D = gd_open(filedir, GD_RDWR);
+
+  h1 = gd_field_handle(D, "lincom");
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+  CHECKI(h1 >= 0, 1);
+
+  /* the same field gets the same handle */
+  h2 = gd_field_handle(D, "lincom");
+  CHECKI(h2, h1);
+
+  n1 = gd_getdata(D, "lincom", 5, 0, 1, 0, GD_UINT8, c);
+  n2 = gd_getdata_handle(D, h1, 5, 0, 1, 0, GD_UINT8, d);
+  e2 = gd_error(D);
+  CHECKI(e2, 0);
+  CHECKU(n1, 8);
+  CHECKU(n2, 8);
+  for (i = 0; i < 8; ++i) {
+    CHECKUi(i, c[i], 2 * (40 + i) + 3);
+    CHECKUi(i, d[i], c[i]);
+  }
+
+  /* handles follow renames */
+  gd_rename(D, "lincom", "renamed", 0);
+  n3 = gd_getdata_handle(D, h1, 6, 0, 1, 0, GD_UINT8, d);
+  e3 = gd_error(D);
+  CHECKI(e3, 0);
+  CHECKU(n3, 8);
+  for (i = 0; i < 8; ++i)
+    CHECKUi(i, d[i], 2 * (48 + i) + 3);
+
+  /* a scalar field can have a handle, but can't be read with one */
+  h3 = gd_field_handle(D, "const");
+  CHECKI(h3 >= 0 && h3 != h1, 1);
+  n4 = gd_getdata_handle(D, h3, 0, 0, 1, 0, GD_UINT8, d);
+  e4 = gd_error(D);
+  CHECKU(n4, 0);
+  CHECKI(e4, GD_E_DIMENSION);
+
+  /* not a handle */
+  n5 = gd_getdata_handle(D, h1 + h3 + 1, 0, 0, 1, 0, GD_UINT8, d);
+  e5 = gd_error(D);
+  CHECKU(n5, 0);
+  CHECKI(e5, GD_E_ARGUMENT);
+
+  /* the handle of a deleted field is no longer valid */
+  gd_delete(D, "renamed", 0);
+  gd_getdata_handle(D, h1, 0, 0, 1, 0, GD_UINT8, d);
+  e6 = gd_error(D);
+  CHECKI(e6, GD_E_ARGUMENT);
+
+  h4 = gd_field_handle(D, "renamed");
+  e7 = gd_error(D);
+  CHECKI(h4, GD_E_BAD_CODE);
+  CHECKI(e7, GD_E_BAD_CODE);
+
+  gd_discard(D);
+
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
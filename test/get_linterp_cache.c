@@ -0,0 +1,103 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* A LINTERP table is cached after it's first read, and the cache is used
+ * until the table changes */
+#include "test.h"
+
+static double val(int sign, double x)
+{
+  /* the table is y = sign * x^2 at the integers, so interpolate that */
+  const double k = (x < 0) ? 0 : (x > 18) ? 18 : (double)(int)x;
+  return sign * (k * k + (2 * k + 1) * (x - k));
+}
+
+static void write_table(const char *table, int sign)
+{
+  int i;
+  FILE *t = fopen(table, "wt");
+  for (i = 0; i < 20; ++i)
+    fprintf(t, "%i %i\n", i, sign * i * i);
+  fclose(t);
+}
+
+int main(void)
+{
+#if !defined HAVE_SYS_MMAN_H || !defined HAVE_MMAP
+  return 77;
+#else
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  const char *table = "dirfile/table";
+  const char *cache = "dirfile/table.gdidx";
+  double c[4][8];
+  int i, j, e[4], r = 0;
+  size_t n[4];
+  gd_int64_t m[4];
+  struct stat buf;
+  FILE *t;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "lut LINTERP data ./table\ndata RAW FLOAT64 1\n");
+  MAKEDATAFILE(data, double, i * 2.75 - 1, 8);
+
+  write_table(table, 1);
+
+  for (j = 0; j < 4; ++j) {
+    if (j == 2) /* a changed table */
+      write_table(table, -1);
+    else if (j == 3) { /* a broken cache */
+      t = fopen(cache, "wb");
+      fputs("GDLUTC01 is not a cache", t);
+      fclose(t);
+    }
+
+    D = gd_open(filedir, GD_RDWR | GD_VERBOSE);
+    n[j] = gd_getdata(D, "lut", 0, 0, 0, 8, GD_FLOAT64, c[j]);
+    e[j] = gd_error(D);
+    m[j] = gd_counter(D, GD_COUNTER_LUT_CACHE);
+    gd_discard(D);
+
+    CHECKIi(j, e[j], 0);
+    CHECKUi(j, n[j], 8);
+    CHECKIi(j, stat(cache, &buf), 0);
+    for (i = 0; i < 8; ++i)
+      CHECKFi(j * 8 + i, c[j][i], val(j >= 2 ? -1 : 1, i * 2.75 - 1));
+  }
+
+  /* only the second read could use the cache */
+  CHECKI(m[0], 0);
+  CHECKI(m[1], 1);
+  CHECKI(m[2], 0);
+  CHECKI(m[3], 0);
+
+  unlink(cache);
+  unlink(table);
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+#endif
+}
@@ -0,0 +1,102 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* LINTERP lookups on a large, unevenly spaced table, with inputs that jump
+ * about, and on the same table written in reverse order */
+#include "test.h"
+
+#define NT 1000
+#define NS 5000
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  const char *table = "dirfile/table";
+  const char *rtable = "dirfile/rtable";
+  double *c, *d;
+  int e1, e2, i, r = 0;
+  size_t n1, n2;
+  DIRFILE *D;
+  FILE *t;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+    "lut LINTERP data ./table\n"
+    "rlut LINTERP data ./rtable\n"
+    "data RAW FLOAT64 1\n"
+  );
+  MAKEDATAFILE(data, double, (i * 7919) % 10103 - 50.5, NS);
+
+  /* x = i^2 / 100, y = 3i */
+  t = fopen(table, "wt");
+  for (i = 0; i < NT; ++i)
+    fprintf(t, "%.17g %i\n", i * i / 100., 3 * i);
+  fclose(t);
+
+  t = fopen(rtable, "wt");
+  for (i = NT; i-- > 0; )
+    fprintf(t, "%.17g %i\n", i * i / 100., 3 * i);
+  fclose(t);
+
+  c = malloc(sizeof(*c) * NS);
+  d = malloc(sizeof(*d) * NS);
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+  n1 = gd_getdata(D, "lut", 0, 0, 0, NS, GD_FLOAT64, c);
+  e1 = gd_error(D);
+  n2 = gd_getdata(D, "rlut", 0, 0, 0, NS, GD_FLOAT64, d);
+  e2 = gd_error(D);
+
+  CHECKI(e1, 0);
+  CHECKI(e2, 0);
+  CHECKU(n1, NS);
+  CHECKU(n2, NS);
+
+  for (i = 0; i < NS; ++i) {
+    const double x = (i * 7919) % 10103 - 50.5;
+    int k = 0;
+    double v;
+
+    /* the segment; the first and last extrapolate */
+    while (k < NT - 2 && (k + 1) * (k + 1) / 100. <= x)
+      k++;
+    v = 3 * k + 3 / ((k + 1) * (k + 1) / 100. - k * k / 100.) *
+      (x - k * k / 100.);
+
+    CHECKFi(i, c[i], v);
+    CHECKFi(i, d[i], c[i]);
+  }
+
+  gd_discard(D);
+  free(c);
+  free(d);
+
+  unlink(rtable);
+  unlink(table);
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
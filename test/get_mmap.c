@@ -0,0 +1,100 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Read an unencoded RAW field through a memory mapping */
+#include "test.h"
+
+int main(void)
+{
+#if !defined HAVE_SYS_MMAN_H || !defined HAVE_MMAP
+  return 77;
+#else
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  uint16_t c[32], d[8];
+  int fd, i, e1, e2, e3, e4, r = 0;
+  size_t n1, n2, n3, n4;
+  gd_int64_t m1, m2;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "data RAW UINT16 8\n");
+  MAKEDATAFILE(data, uint16_t, i, 32);
+
+  D = gd_open(filedir, GD_RDWR | GD_MMAP | GD_VERBOSE);
+
+  n1 = gd_getdata(D, "data", 2, 0, 2, 0, GD_UINT16, c);
+  e1 = gd_error(D);
+  m1 = gd_counter(D, GD_COUNTER_RAW_MMAP);
+
+  CHECKI(e1, 0);
+  CHECKU(n1, 16);
+  CHECKI(m1, 1);
+  for (i = 0; i < 16; ++i)
+    CHECKUi(i, c[i], 16 + i);
+
+  /* the file grows behind our back */
+  fd = open(data, O_WRONLY | O_APPEND | O_BINARY);
+  for (i = 32; i < 48; ++i) {
+    uint16_t v = (uint16_t)i;
+    if (write(fd, &v, sizeof(v)) != sizeof(v))
+      r = 1;
+  }
+  close(fd);
+
+  n2 = gd_getdata(D, "data", 3, 0, 4, 0, GD_UINT16, c);
+  e2 = gd_error(D);
+  m2 = gd_counter(D, GD_COUNTER_RAW_MMAP);
+
+  CHECKI(e2, 0);
+  CHECKU(n2, 24);
+  CHECKI(m2, 2);
+  for (i = 0; i < 24; ++i)
+    CHECKUi(i, c[i], 24 + i);
+
+  /* writing reopens the file without the mapping */
+  for (i = 0; i < 8; ++i)
+    d[i] = (uint16_t)(1000 + i);
+  n3 = gd_putdata(D, "data", 1, 0, 1, 0, GD_UINT16, d);
+  e3 = gd_error(D);
+  CHECKI(e3, 0);
+  CHECKU(n3, 8);
+
+  n4 = gd_getdata(D, "data", 0, 6, 0, 4, GD_UINT16, c);
+  e4 = gd_error(D);
+  CHECKI(e4, 0);
+  CHECKU(n4, 4);
+  CHECKU(c[0], 6);
+  CHECKU(c[1], 7);
+  CHECKU(c[2], 1000);
+  CHECKU(c[3], 1001);
+
+  gd_discard(D);
+
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+#endif
+}
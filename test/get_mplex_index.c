@@ -0,0 +1,92 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* MPLEX look-backs use the positions of the count value already read, and
+ * notice when the count field changes */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  const char *count = "dirfile/count";
+  uint16_t c[1000];
+  const uint8_t five = 5;
+  int i, e1, e2, e3, e4, e5, r = 0;
+  size_t n1, n2, n3, n4, n5;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+    "mplex MPLEX data count 0 10\n"
+    "count RAW UINT8 1\n"
+    "data RAW UINT16 1\n"
+  );
+  MAKEDATAFILE(data, uint16_t, i, 1000);
+  MAKEDATAFILE(count, uint8_t, i % 10, 1000);
+
+  D = gd_open(filedir, GD_RDWR | GD_VERBOSE);
+
+  /* read the whole thing */
+  n1 = gd_getdata(D, "mplex", 0, 0, 0, 1000, GD_UINT16, c);
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+  CHECKU(n1, 1000);
+  for (i = 0; i < 1000; ++i)
+    CHECKUi(i, c[i], i - i % 10);
+
+  /* now jump around */
+  n2 = gd_getdata(D, "mplex", 0, 503, 0, 1, GD_UINT16, c);
+  e2 = gd_error(D);
+  CHECKI(e2, 0);
+  CHECKU(n2, 1);
+  CHECKU(c[0], 500);
+
+  n3 = gd_getdata(D, "mplex", 0, 259, 0, 3, GD_UINT16, c);
+  e3 = gd_error(D);
+  CHECKI(e3, 0);
+  CHECKU(n3, 3);
+  CHECKUi(0, c[0], 250);
+  CHECKUi(1, c[1], 260);
+  CHECKUi(2, c[2], 260);
+
+  /* remove a count value */
+  n4 = gd_putdata(D, "count", 0, 250, 0, 1, GD_UINT8, &five);
+  CHECKU(n4, 1);
+
+  n5 = gd_getdata(D, "mplex", 0, 253, 0, 1, GD_UINT16, c);
+  e5 = gd_error(D);
+  CHECKI(e5, 0);
+  CHECKU(n5, 1);
+  CHECKU(c[0], 240);
+
+  e4 = gd_close(D);
+  CHECKI(e4, 0);
+
+  unlink(count);
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,140 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Read several fields with shared inputs in one call */
+#include "test.h"
+
+#define NF 20
+#define NFIELDS 5
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  const char *cata = "dirfile/cata";
+  const char *field_code[NFIELDS] = {"bit1", "bit2", "phase", "lincom", "cata"};
+  const gd_type_t type[NFIELDS] = {GD_UINT16, GD_UINT16, GD_INT32, GD_FLOAT64,
+    GD_FLOAT64};
+  const char *bad_code[2] = {"bit1", "nope"};
+  uint16_t b1[8 * NF], b2[8 * NF];
+  int32_t p[8 * NF];
+  double l[8 * NF], c[3 * NF], ref[8 * NF];
+  void *out[NFIELDS];
+  size_t i, j, n[NFIELDS], nr;
+  int e1, e2, e3, e4, r = 0;
+  off_t pos;
+  DIRFILE *D;
+
+  out[0] = b1;
+  out[1] = b2;
+  out[2] = p;
+  out[3] = l;
+  out[4] = c;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+    "data RAW UINT16 8\n"
+    "cata RAW FLOAT64 3\n"
+    "bit1 BIT data 0 4\n"
+    "bit2 BIT data 4 4\n"
+    "phase PHASE data 3\n"
+    "lincom LINCOM 2 bit1 1 0 data 0.5 1\n"
+  );
+  MAKEDATAFILE(data, uint16_t, i, 8 * NF);
+  MAKEDATAFILE(cata, double, i * 0.25, 3 * NF);
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+
+  /* runs off the end of the dirfile */
+  e1 = gd_getdata_multi(D, NFIELDS, field_code, 12, 2, 10, 0, type, out, n);
+  CHECKI(e1, 0);
+
+  CHECKU(n[0], 8 * NF - 98);
+  CHECKU(n[1], 8 * NF - 98);
+  CHECKU(n[2], 8 * NF - 101);
+  CHECKU(n[3], 8 * NF - 98);
+  CHECKU(n[4], 3 * NF - 38);
+
+  for (i = 0; i < n[0]; ++i) {
+    CHECKUi(i, b1[i], (98 + i) & 0xF);
+    CHECKUi(i, b2[i], ((98 + i) >> 4) & 0xF);
+    CHECKFi(i, l[i], ((98 + i) & 0xF) + 0.5 * (98 + i) + 1);
+  }
+
+  for (i = 0; i < n[2]; ++i)
+    CHECKIi(i, p[i], 101 + i);
+
+  for (i = 0; i < n[4]; ++i)
+    CHECKFi(i, c[i], (38 + i) * 0.25);
+
+  /* results must be the same as individual reads */
+  for (j = 0; j < NFIELDS; ++j) {
+    nr = gd_getdata(D, field_code[j], 12, 2, 10, 0, GD_FLOAT64, ref);
+    CHECKU(nr, n[j]);
+    for (i = 0; i < nr; ++i) {
+      double v = 0;
+      switch (j) {
+        case 0: v = b1[i]; break;
+        case 1: v = b2[i]; break;
+        case 2: v = p[i]; break;
+        case 3: v = l[i]; break;
+        case 4: v = c[i]; break;
+      }
+      CHECKFi(j * 1000 + i, ref[i], v);
+    }
+  }
+
+  /* the I/O pointer is left where individual reads would have left it: after
+   * the last read of lincom, not after the phase-shifted read of data */
+  e4 = gd_getdata_multi(D, 4, field_code, 2, 0, 5, 0, type, out, n);
+  CHECKI(e4, 0);
+  pos = gd_tell(D, "data");
+  CHECKI(pos, 56);
+
+  /* relative to the I/O pointer */
+  gd_seek(D, "data", 1, 0, GD_SEEK_SET);
+  e2 = gd_getdata_multi(D, 2, field_code, GD_HERE, 0, 1, 0, type, out, n);
+  CHECKI(e2, 0);
+  CHECKU(n[0], 8);
+  CHECKU(n[1], 8);
+  for (i = 0; i < 8; ++i) {
+    CHECKUi(i, b1[i], (8 + i) & 0xF);
+    CHECKUi(i, b2[i], ((16 + i) >> 4) & 0xF);
+  }
+
+  /* bad field code: nothing is read */
+  n[0] = n[1] = 99;
+  e3 = gd_getdata_multi(D, 2, bad_code, 0, 0, 1, 0, type, out, n);
+  CHECKI(e3, GD_E_BAD_CODE);
+  CHECKU(n[0], 0);
+  CHECKU(n[1], 0);
+
+  gd_discard(D);
+
+  unlink(cata);
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
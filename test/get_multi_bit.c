@@ -0,0 +1,130 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Many bitfields of the same status word, read together, are extracted in a
+ * single pass over their input; the results must be the same as reading them
+ * one at a time */
+#include "test.h"
+
+#define NF 2000
+#define NBITS 16
+#define NFIELDS (NBITS + 3)
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  char name[NFIELDS][10];
+  const char *field_code[NFIELDS];
+  gd_type_t type[NFIELDS];
+  void *out[NFIELDS];
+  double *ref;
+  size_t i, j, n[NFIELDS], nr;
+  int e1, r = 0;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+    "data RAW UINT16 4\n"
+    "bit0 BIT data 0\n" "bit1 BIT data 1\n" "bit2 BIT data 2\n"
+    "bit3 BIT data 3\n" "bit4 BIT data 4\n" "bit5 BIT data 5\n"
+    "bit6 BIT data 6\n" "bit7 BIT data 7\n" "bit8 BIT data 8\n"
+    "bit9 BIT data 9\n" "bit10 BIT data 10\n" "bit11 BIT data 11\n"
+    "bit12 BIT data 12\n" "bit13 BIT data 13\n" "bit14 BIT data 14\n"
+    "bit15 BIT data 15\n"
+    "sbit SBIT data 4 8\n"
+    "wide BIT data 12 8\n" /* extends past the top of data */
+    "cbit BIT data 2 3\n"
+  );
+  MAKEDATAFILE(data, uint16_t, 0x9E37 * i, 4 * NF);
+
+  for (j = 0; j < NBITS; ++j) {
+    sprintf(name[j], "bit%i", (int)j);
+    type[j] = (j % 2) ? GD_UINT8 : GD_FLOAT32;
+  }
+  strcpy(name[NBITS], "sbit");
+  type[NBITS] = GD_INT64;
+  strcpy(name[NBITS + 1], "wide");
+  type[NBITS + 1] = GD_UINT32;
+  strcpy(name[NBITS + 2], "cbit");
+  type[NBITS + 2] = GD_COMPLEX128;
+
+  for (j = 0; j < NFIELDS; ++j) {
+    field_code[j] = name[j];
+    out[j] = malloc(16 * 4 * NF);
+  }
+  ref = malloc(16 * 4 * NF);
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+
+  /* longer than one block; runs off the end of the dirfile */
+  e1 = gd_getdata_multi(D, NFIELDS, field_code, 3, 1, 3 * NF, 0, type, out,
+      n);
+  CHECKI(e1, 0);
+
+  for (j = 0; j < NFIELDS; ++j) {
+    CHECKUi(j, n[j], 4 * NF - 13);
+
+    nr = gd_getdata(D, field_code[j], 3, 1, 3 * NF, 0, GD_FLOAT64, ref);
+    CHECKUi(j, nr, n[j]);
+
+    for (i = 0; i < nr; ++i) {
+      double v;
+      switch (type[j]) {
+        case GD_UINT8:
+          v = ((uint8_t *)out[j])[i];
+          break;
+        case GD_FLOAT32:
+          v = ((float *)out[j])[i];
+          break;
+        case GD_INT64:
+          v = (double)((int64_t *)out[j])[i];
+          break;
+        case GD_UINT32:
+          v = ((uint32_t *)out[j])[i];
+          break;
+        default:
+          v = ((double *)out[j])[2 * i];
+          CHECKFi(j * 100000 + i, ((double *)out[j])[2 * i + 1], 0);
+          break;
+      }
+      CHECKFi(j * 100000 + i, v, ref[i]);
+    }
+  }
+
+  /* spot checks */
+  CHECKI(((int64_t *)out[NBITS])[0], (int8_t)(((0x9E37 * 13) & 0xFFFF) >> 4));
+  CHECKU(((uint32_t *)out[NBITS + 1])[1], ((0x9E37 * 14) & 0xFFFF) >> 12);
+
+  gd_discard(D);
+
+  for (j = 0; j < NFIELDS; ++j)
+    free(out[j]);
+  free(ref);
+
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,82 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* A POLYNOM of a narrow integer input, returned as floating point, is
+ * evaluated directly from the input; the length is more than one chunk */
+#include "test.h"
+
+#define N 1300
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  const double a[6] = {3.9, 0.25, -1.5e-3, 2e-7, 1.5e-11, -1e-15};
+  double c1[N];
+  float c2[N];
+  int16_t c3[N];
+  int e1, e2, e3, i, r = 0;
+  size_t n1, n2, n3;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+    "data RAW INT16 1\n"
+    "polynom POLYNOM data 3.9 0.25 -1.5e-3 2e-7 1.5e-11 -1e-15\n"
+  );
+  MAKEDATAFILE(data, int16_t, 48 * i - 31000, N);
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+
+  n1 = gd_getdata(D, "polynom", 0, 3, 0, N, GD_FLOAT64, c1);
+  e1 = gd_error(D);
+  n2 = gd_getdata(D, "polynom", 0, 3, 0, N, GD_FLOAT32, c2);
+  e2 = gd_error(D);
+  n3 = gd_getdata(D, "polynom", 0, 3, 0, N, GD_INT16, c3);
+  e3 = gd_error(D);
+
+  gd_discard(D);
+
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  CHECKI(e1, 0);
+  CHECKU(n1, N - 3);
+  CHECKI(e2, 0);
+  CHECKU(n2, N - 3);
+  CHECKI(e3, 0);
+  CHECKU(n3, N - 3);
+
+  for (i = 0; i < N - 3; ++i) {
+    const double x = 48 * (i + 3) - 31000;
+    const double v = a[0] + x * (a[1] + x * (a[2] + x * (a[3] + x * (a[4] +
+              x * a[5]))));
+    CHECKFi(i, c1[i], v);
+    CHECKFi(i, c2[i], (float)v);
+    if (fabs(v) < 32000)
+      CHECKIi(i, c3[i], (int16_t)v);
+  }
+
+  return r;
+}
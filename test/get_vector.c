@@ -0,0 +1,105 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Reads which go through the vectorised kernels; the lengths are chosen so
+ * that every kernel also has a scalar remainder to deal with */
+#include "test.h"
+
+#define N 103
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *swapped = "dirfile/swapped";
+  const char *u32 = "dirfile/u32";
+  const char *i16 = "dirfile/i16";
+  const char *f64 = "dirfile/f64";
+  const uint16_t one = 1;
+  double c1[N], c4[N];
+  float c2[N];
+  int64_t c3[N];
+  int e1, e2, e3, e4, i, r = 0;
+  size_t n1, n2, n3, n4;
+  char fmt[100];
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+    "u32 RAW UINT32 1\n"
+    "f64 RAW FLOAT64 1\n"
+    "sbit SBIT u32 3 29\n"
+    "lincom LINCOM u32 0.5 1.5 i16 -2 3 f64 0.25 -0.5\n"
+    "/INCLUDE swapped\n"
+  );
+  /* i16 is stored in the opposite byte order to the native one */
+  sprintf(fmt, "/ENDIAN %s\ni16 RAW INT16 1\n",
+      *(const char *)&one ? "big" : "little");
+  MAKERAWFILE(swapped, fmt, strlen(fmt));
+  MAKEDATAFILE(u32, uint32_t, 0xFFFFFFF0U - 0x01234567U * (uint32_t)i, N);
+  MAKEDATAFILE(i16, int16_t, 0x1234 - 0x0123 * (int16_t)i, N);
+  MAKEDATAFILE(f64, double, 1.25 * i, N);
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+
+  n1 = gd_getdata(D, "u32", 0, 0, 0, N, GD_FLOAT64, c1);
+  e1 = gd_error(D);
+  n2 = gd_getdata(D, "i16", 0, 0, 0, N, GD_FLOAT32, c2);
+  e2 = gd_error(D);
+  n3 = gd_getdata(D, "sbit", 0, 0, 0, N, GD_INT64, c3);
+  e3 = gd_error(D);
+  n4 = gd_getdata(D, "lincom", 0, 0, 0, N, GD_FLOAT64, c4);
+  e4 = gd_error(D);
+
+  gd_discard(D);
+
+  unlink(f64);
+  unlink(i16);
+  unlink(u32);
+  unlink(swapped);
+  unlink(format);
+  rmdir(filedir);
+
+  CHECKI(e1, 0);
+  CHECKU(n1, N);
+  CHECKI(e2, 0);
+  CHECKU(n2, N);
+  CHECKI(e3, 0);
+  CHECKU(n3, N);
+  CHECKI(e4, 0);
+  CHECKU(n4, N);
+
+  for (i = 0; i < N; ++i) {
+    const uint32_t u = 0xFFFFFFF0U - 0x01234567U * (uint32_t)i;
+    const uint16_t x = (uint16_t)(0x1234 - 0x0123 * (int16_t)i);
+    const int16_t s = (int16_t)((x >> 8) | (x << 8));
+    const int64_t b = (int64_t)((u >> 3) & 0x1FFFFFFF);
+
+    CHECKFi(i, c1[i], (double)u);
+    CHECKFi(i, c2[i], (float)s);
+    CHECKIi(i, c3[i], (b & 0x10000000) ? b - 0x20000000 : b);
+    CHECKFi(i, c4[i] / (double)u, (u * 0.5 + (s * -2. + 1.25 * i * 0.25 +
+          1.5 + 3 + -0.5)) / (double)u);
+  }
+
+  return r;
+}
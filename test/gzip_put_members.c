@@ -0,0 +1,87 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* A write into a file of many gzip members, whose size isn't known exactly,
+ * isn't mistaken for an append */
+#include "test.h"
+
+int main(void)
+{
+#if !defined TEST_GZIP || !defined USE_GZIP
+  return 77;
+#else
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  const char *data2 = "dirfile/data2";
+  const char *gzipdata = "dirfile/data.gz";
+  uint8_t c[8], d[150];
+  char command[4096];
+  int i, e1, e2, e3, r = 0;
+  size_t n1, n2;
+  off_t nf;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "data RAW UINT8 1\n");
+
+  /* two members: 100 bytes, then 50; the trailer of the last one only knows
+   * about the 50 */
+  MAKEDATAFILE(data, uint8_t, i, 100);
+  MAKEDATAFILE(data2, uint8_t, 100 + i, 50);
+  snprintf(command, 4096, "\"%s\" -f %s > %s", GZIP, data, NULL_DEVICE);
+  if (gd_system(command))
+    return 1;
+  snprintf(command, 4096, "\"%s\" -c %s >> %s", GZIP, data2, gzipdata);
+  if (gd_system(command))
+    return 1;
+  unlink(data2);
+
+  for (i = 0; i < 8; ++i)
+    c[i] = (uint8_t)(200 + i);
+
+  D = gd_open(filedir, GD_RDWR | GD_VERBOSE);
+  n1 = gd_putdata(D, "data", 60, 0, 0, 8, GD_UINT8, c);
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+  CHECKU(n1, 8);
+  e2 = gd_close(D);
+  CHECKI(e2, 0);
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+  nf = gd_nframes(D);
+  CHECKI(nf, 150);
+  n2 = gd_getdata(D, "data", 0, 0, 150, 0, GD_UINT8, d);
+  e3 = gd_error(D);
+  CHECKI(e3, 0);
+  CHECKU(n2, 150);
+  for (i = 0; i < 150; ++i)
+    CHECKUi(i, d[i], (i >= 60 && i < 68) ? 200 + i - 60 : i);
+  gd_discard(D);
+
+  unlink(gzipdata);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+#endif
+}
@@ -0,0 +1,92 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* With GD_LAZY_INCLUDE, a fragment is only parsed when it's needed */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *format1 = "dirfile/format1";
+  const char *format2 = "dirfile/format2";
+  const char *format3 = "dirfile/format3";
+  int e1, e2, e3, e4, e5, i1, n1, n2, r = 0;
+  unsigned int nf;
+  uint8_t c1 = 0, c2 = 0;
+  gd_entype_t t;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+      "/VERSION 10\n"
+      "data RAW UINT8 1\n"
+      "/INCLUDE format1 a.\n"
+      "/INCLUDE format2 b.\n"
+      );
+  MAKEFORMATFILE(format1, "x RAW UINT8 1\n/INCLUDE format3 c.\n");
+  /* the syntax error is only reported once this is parsed */
+  MAKEFORMATFILE(format2, "y CONST UINT8 3\nbad line\n");
+  MAKEFORMATFILE(format3, "z CONST UINT8 5\n");
+
+  D = gd_open(filedir, GD_RDONLY | GD_LAZY_INCLUDE);
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+
+  /* parses format1, then format3, but not format2 */
+  gd_get_constant(D, "a.c.z", GD_UINT8, &c1);
+  e2 = gd_error(D);
+  CHECKI(e2, 0);
+  CHECKU(c1, 5);
+
+  i1 = gd_fragment_index(D, "a.c.z");
+  CHECKI(i1, 3);
+
+  /* not found anywhere */
+  t = gd_entry_type(D, "a.nothing");
+  e3 = gd_error(D);
+  CHECKI(e3, GD_E_BAD_CODE);
+  CHECKI(t, GD_NO_ENTRY);
+
+  /* now parse format2 */
+  gd_get_constant(D, "b.y", GD_UINT8, &c2);
+  e4 = gd_error(D);
+  CHECKI(e4, GD_E_FORMAT);
+
+  n1 = gd_nfragments(D);
+  nf = gd_nfields(D);
+  e5 = gd_error(D);
+  CHECKI(e5, 0);
+  CHECKI(n1, 4);
+  CHECKU(nf, 5);
+
+  n2 = gd_discard(D);
+  CHECKI(n2, 0);
+
+  unlink(format3);
+  unlink(format2);
+  unlink(format1);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
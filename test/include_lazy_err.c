@@ -0,0 +1,76 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* With GD_LAZY_INCLUDE, a field lookup reports a syntax error in a fragment
+ * it parses, rather than a missing field code */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *format1 = "dirfile/format1";
+  const char *format2 = "dirfile/format2";
+  int e1, e2, e3, e4, i1, r = 0;
+  gd_entype_t t;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+      "/VERSION 10\n"
+      "data RAW UINT8 1\n"
+      "/INCLUDE format1 a.\n"
+      "/INCLUDE format2 b.\n"
+      );
+  MAKEFORMATFILE(format1, "x CONST UINT8 3\nbad line\n");
+  MAKEFORMATFILE(format2, "y CONST UINT8 5\n");
+
+  D = gd_open(filedir, GD_RDONLY | GD_LAZY_INCLUDE);
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+
+  /* parses format1, which is broken */
+  t = gd_entry_type(D, "a.nothing");
+  e2 = gd_error(D);
+  CHECKI(e2, GD_E_FORMAT);
+  CHECKI(t, GD_NO_ENTRY);
+
+  /* format1 isn't parsed again; format2 is fine */
+  i1 = gd_fragment_index(D, "b.nothing");
+  e3 = gd_error(D);
+  CHECKI(e3, GD_E_BAD_CODE);
+  CHECKI(i1, GD_E_BAD_CODE);
+
+  t = gd_entry_type(D, "b.y");
+  e4 = gd_error(D);
+  CHECKI(e4, 0);
+  CHECKI(t, GD_CONST_ENTRY);
+
+  gd_discard(D);
+
+  unlink(format2);
+  unlink(format1);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,67 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* A metadata write parses everything deferred by GD_LAZY_INCLUDE */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *format1 = "dirfile/format1";
+  int e1, e2, e3, e4, r = 0;
+  uint8_t c = 0;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "/VERSION 10\n/INCLUDE format1 a.\n");
+  MAKEFORMATFILE(format1, "x CONST UINT8 1\n");
+
+  D = gd_open(filedir, GD_RDWR | GD_LAZY_INCLUDE);
+
+  /* the duplicate is only found if format1 is parsed */
+  gd_add_spec(D, "a.x CONST UINT8 2", 0);
+  e1 = gd_error(D);
+  CHECKI(e1, GD_E_FORMAT);
+
+  /* format1 mustn't be truncated */
+  gd_rewrite_fragment(D, GD_ALL_FRAGMENTS);
+  e2 = gd_error(D);
+  CHECKI(e2, 0);
+
+  gd_discard(D);
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+  gd_get_constant(D, "a.x", GD_UINT8, &c);
+  e3 = gd_error(D);
+  CHECKI(e3, 0);
+  CHECKU(c, 1);
+
+  e4 = gd_discard(D);
+  CHECKI(e4, 0);
+
+  unlink(format1);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,108 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* .xz files are written in blocks, and seeks use the index to go straight to
+ * the right one */
+#include "test.h"
+
+#define N 2500000
+
+int main(void)
+{
+#if !defined USE_LZMA || !defined HAVE_LZMA_FILE_INFO_DECODER || \
+  !defined HAVE_LZMA_STREAM_ENCODER_MT
+  return 77;
+#else
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *xzdata = "dirfile/data.xz";
+  uint32_t *d, c[10];
+  unsigned int i;
+  int e1, e2, e3, e4, e5, r = 0;
+  size_t n1, n2, n3, n4;
+  off_t nf;
+  int64_t c1, c2, c3;
+  DIRFILE *D;
+
+  rmdirfile();
+
+  d = malloc(sizeof(*d) * N);
+  for (i = 0; i < N; ++i)
+    d[i] = i * 7;
+
+  D = gd_open(filedir, GD_RDWR | GD_CREAT | GD_LZMA_ENCODED | GD_VERBOSE);
+  gd_add_raw(D, "data", GD_UINT32, 1, 0);
+  n1 = gd_putdata(D, "data", 0, 0, 0, N, GD_UINT32, d);
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+  CHECKU(n1, N);
+  e2 = gd_close(D);
+  CHECKI(e2, 0);
+  free(d);
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+
+  nf = gd_nframes(D);
+  CHECKI(nf, N);
+
+  /* forwards, past the first block */
+  n2 = gd_getdata(D, "data", N - 10, 0, 10, 0, GD_UINT32, c);
+  e3 = gd_error(D);
+  CHECKI(e3, 0);
+  CHECKU(n2, 10);
+  for (i = 0; i < 10; ++i)
+    CHECKUi(i, c[i], (N - 10 + i) * 7);
+  c1 = gd_counter(D, GD_COUNTER_INDEX_SEEK);
+  CHECKI(c1, 1);
+
+  /* backwards */
+  n3 = gd_getdata(D, "data", N / 2, 0, 10, 0, GD_UINT32, c);
+  e4 = gd_error(D);
+  CHECKI(e4, 0);
+  CHECKU(n3, 10);
+  for (i = 0; i < 10; ++i)
+    CHECKUi(i, c[i], (N / 2 + i) * 7);
+  c2 = gd_counter(D, GD_COUNTER_INDEX_SEEK);
+  CHECKI(c2, 2);
+
+  /* a long read, across block boundaries */
+  d = malloc(sizeof(*d) * N);
+  n4 = gd_getdata(D, "data", 3, 0, N, 0, GD_UINT32, d);
+  e5 = gd_error(D);
+  CHECKI(e5, 0);
+  CHECKU(n4, N - 3);
+  for (i = 0; i < N - 3; ++i)
+    if (d[i] != (uint32_t)(3 + i) * 7) {
+      CHECKUi(i, d[i], (3 + i) * 7);
+      break;
+    }
+  c3 = gd_counter(D, GD_COUNTER_INDEX_SEEK);
+  CHECKI(c3, 3);
+  free(d);
+
+  gd_discard(D);
+
+  unlink(xzdata);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+#endif
+}
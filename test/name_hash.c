@@ -0,0 +1,111 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Field lookups stay right as fields are added, deleted and renamed */
+#include "test.h"
+
+#define N 2000
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  char code[20], new_code[20];
+  unsigned int i;
+  int e1, e2, e3, e4, r = 0;
+  uint32_t v;
+  FILE *f;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  f = fopen(format, "wt");
+  fprintf(f, "/VERSION 10\n");
+  for (i = 0; i < N; ++i)
+    fprintf(f, "c%u CONST UINT32 %u\n", i, i);
+  fprintf(f, "c7/sub CONST UINT32 77\n/ALIAS alias c7\n");
+  fclose(f);
+
+  D = gd_open(filedir, GD_RDWR);
+
+  /* the first lookups build the hash */
+  for (i = 0; i < N; ++i) {
+    sprintf(code, "c%u", i);
+    v = 0;
+    e1 = gd_get_constant(D, code, GD_UINT32, &v);
+    CHECKIi(i, e1, 0);
+    CHECKUi(i, v, i);
+  }
+  v = 0;
+  gd_get_constant(D, "alias/sub", GD_UINT32, &v);
+  CHECKU(v, 77);
+
+  /* now change things */
+  for (i = 0; i < N; ++i) {
+    sprintf(code, "c%u", i);
+    if (i % 3 == 0) {
+      e2 = gd_delete(D, code, 0);
+      CHECKIi(i, e2, 0);
+    } else if (i % 3 == 1 && i % 100 == 1) {
+      sprintf(new_code, "r%u", i);
+      e3 = gd_rename(D, code, new_code, 0);
+      CHECKIi(i, e3, 0);
+    }
+    sprintf(code, "d%u", i);
+    e4 = gd_add_const(D, code, GD_UINT32, GD_UINT32, &i, 0);
+    CHECKIi(i, e4, 0);
+  }
+
+  for (i = 0; i < N; ++i) {
+    const int deleted = (i % 3 == 0);
+    const int renamed = (i % 3 == 1 && i % 100 == 1);
+
+    sprintf(code, "c%u", i);
+    v = 0;
+    e1 = gd_get_constant(D, code, GD_UINT32, &v);
+    CHECKIi(i, e1, (deleted || renamed) ? GD_E_BAD_CODE : 0);
+    if (!deleted && !renamed)
+      CHECKUi(i, v, i);
+
+    sprintf(code, "r%u", i);
+    v = 0;
+    e2 = gd_get_constant(D, code, GD_UINT32, &v);
+    CHECKIi(i, e2, renamed ? 0 : GD_E_BAD_CODE);
+    if (renamed)
+      CHECKUi(i, v, i);
+
+    sprintf(code, "d%u", i);
+    v = 0;
+    e3 = gd_get_constant(D, code, GD_UINT32, &v);
+    CHECKIi(i, e3, 0);
+    CHECKUi(i, v, i);
+  }
+  v = 0;
+  gd_get_constant(D, "alias/sub", GD_UINT32, &v);
+  CHECKU(v, 77);
+
+  gd_discard(D);
+
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,86 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* When the limit is reached, the least recently used file is closed */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data1 = "dirfile/data1";
+  const char *data2 = "dirfile/data2";
+  const char *data3 = "dirfile/data3";
+  unsigned char c[8];
+  int e1, e2, r = 0;
+  long no;
+  size_t n1, n2;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+      "data1 RAW UINT8 8\n"
+      "data2 RAW UINT8 8\n"
+      "data3 RAW UINT8 8\n"
+      );
+  MAKEDATAFILE(data1, unsigned char, i, 256);
+  MAKEDATAFILE(data2, unsigned char, i, 256);
+  MAKEDATAFILE(data3, unsigned char, i, 256);
+
+  D = gd_open(filedir, GD_RDONLY);
+
+  gd_open_limit(D, 2);
+
+  gd_getdata(D, "data1", 5, 0, 1, 0, GD_NULL, NULL);
+  gd_getdata(D, "data2", 5, 0, 1, 0, GD_NULL, NULL);
+  /* data1 is now the most recently used */
+  gd_getdata(D, "data1", 6, 0, 1, 0, GD_NULL, NULL);
+  /* this should close data2 */
+  gd_getdata(D, "data3", 5, 0, 1, 0, GD_NULL, NULL);
+
+  no = gd_open_limit(D, GD_OLIMIT_COUNT);
+  CHECKI(no, 2);
+
+  /* data1 can still be read through its open descriptor; data2 can't be
+   * reopened */
+  unlink(data1);
+  unlink(data2);
+
+  n1 = gd_getdata(D, "data1", 7, 0, 1, 0, GD_UINT8, c);
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+  CHECKU(n1, 8);
+  CHECKU(c[0], 56);
+
+  n2 = gd_getdata(D, "data2", 7, 0, 1, 0, GD_UINT8, c);
+  e2 = gd_error(D);
+  CHECKI(e2, GD_E_IO);
+  CHECKU(n2, 0);
+
+  gd_discard(D);
+
+  unlink(data3);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
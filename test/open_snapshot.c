@@ -0,0 +1,183 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* With GD_SNAPSHOT, the parsed metadata are saved when the dirfile is opened
+ * read-write, and the next open uses them instead of parsing the format */
+#include "test.h"
+
+int main(void)
+{
+#if !defined HAVE_SYS_MMAN_H || !defined HAVE_MMAP
+  return 77;
+#else
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *format1 = "dirfile/format1";
+  const char *data = "dirfile/data";
+  const char *table = "dirfile/table";
+  const char *snap = "dirfile/format.gdidx";
+  const char *ref[2], *alias[2], *str[2];
+  char *prefix[2], *suffix[2], label[2][10];
+  const char **names;
+  char *fl[20];
+  double lin[2][4], lut[2][4], gain[2];
+  int32_t list[2][3];
+  uint8_t off[2];
+  unsigned int nf[2], nm[2];
+  int i, j, e[2], hid[2], prot[2], frag[2], nfrag[2], n[2], r = 0;
+  unsigned long end[2];
+  gd_entry_t E[2];
+  gd_entype_t t[2];
+  size_t len[2];
+  gd_int64_t cnt[3];
+  struct stat buf;
+  FILE *f;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEDATAFILE(data, uint8_t, i * 2, 8);
+  MAKEFORMATFILE(format,
+      "/VERSION 10\n"
+      "/ENDIAN little\n"
+      "data RAW UINT8 1\n"
+      "/REFERENCE data\n"
+      "scale CONST FLOAT64 2.5\n"
+      "list CARRAY INT32 1 2 3\n"
+      "names SARRAY alpha beta\n"
+      "label STRING hello\n"
+      "lin LINCOM data scale 1\n"
+      "lin/off CONST UINT8 3\n"
+      "/META lin gain CONST FLOAT32 1.5\n"
+      "/ALIAS al lin\n"
+      "lut LINTERP data ./table\n"
+      "bits BIT data 1 2\n"
+      "/HIDDEN bits\n"
+      "/INCLUDE format1 ns.px_ _sx\n"
+      );
+  MAKEFORMATFILE(format1,
+      "/ENDIAN big\n"
+      "/PROTECT data\n"
+      "raw RAW UINT16 1\n"
+      "phase PHASE raw 1\n"
+      );
+
+  f = fopen(table, "wt");
+  for (i = 0; i < 10; ++i)
+    fprintf(f, "%i %i\n", i, i * i);
+  fclose(f);
+
+  /* the first open parses the format and saves the snapshot; the second one
+   * loads it */
+  for (j = 0; j < 2; ++j) {
+    D = gd_open(filedir, j ? GD_RDONLY | GD_SNAPSHOT : GD_RDWR | GD_SNAPSHOT);
+    e[j] = gd_error(D);
+    cnt[j] = gd_counter(D, GD_COUNTER_SNAPSHOT);
+
+    nf[j] = gd_nentries(D, NULL, GD_ALL_ENTRIES, GD_ENTRIES_HIDDEN);
+    nm[j] = gd_nmfields(D, "lin");
+    names = gd_field_list(D);
+    ref[j] = gd_reference(D, NULL);
+    alias[j] = gd_alias_target(D, "al");
+    hid[j] = gd_hidden(D, "bits");
+    frag[j] = gd_fragment_index(D, "ns.px_raw_sx");
+    nfrag[j] = gd_nfragments(D);
+    prot[j] = gd_protection(D, 1);
+    end[j] = gd_endianness(D, 1);
+    gd_fragment_affixes(D, 1, prefix + j, suffix + j);
+
+    gd_get_constant(D, "lin/off", GD_UINT8, off + j);
+    gd_get_constant(D, "lin/gain", GD_FLOAT64, gain + j);
+    gd_get_carray(D, "list", GD_INT32, list[j]);
+    gd_get_sarray(D, "names", str);
+    len[j] = gd_get_string(D, "label", 10, label[j]);
+    gd_getdata(D, "lin", 0, 0, 0, 4, GD_FLOAT64, lin[j]);
+    gd_getdata(D, "lut", 0, 0, 0, 4, GD_FLOAT64, lut[j]);
+    t[j] = gd_entry_type(D, "ns.px_phase_sx");
+    gd_entry(D, "lin", E + j);
+
+    CHECKSi(j, str[0], "alpha");
+    CHECKSi(j, str[1], "beta");
+    CHECKIi(j, e[j], 0);
+    CHECKUi(j, nf[j], 12);
+    CHECKUi(j, nm[j], 2);
+    CHECKSi(j, ref[j], "data");
+    CHECKSi(j, alias[j], "lin");
+    CHECKIi(j, hid[j], 1);
+    CHECKIi(j, frag[j], 1);
+    CHECKIi(j, nfrag[j], 2);
+    CHECKXi(j, prot[j], GD_PROTECT_DATA);
+    CHECKXi(j, end[j], GD_BIG_ENDIAN);
+    CHECKSi(j, prefix[j], "px_");
+    CHECKSi(j, suffix[j], "_sx");
+    CHECKUi(j, off[j], 3);
+    CHECKFi(j, gain[j], 1.5);
+    CHECKIi(j, list[j][0], 1);
+    CHECKIi(j, list[j][2], 3);
+    CHECKUi(j, len[j], 6);
+    CHECKSi(j, label[j], "hello");
+    CHECKIi(j, t[j], GD_PHASE_ENTRY);
+    CHECKSi(j, E[j].scalar[0], "scale");
+    CHECKIi(j, E[j].EN(lincom,n_fields), 1);
+    for (i = 0; i < 4; ++i) {
+      CHECKFi(i + 4 * j, lin[j][i], 5. * i + 1);
+      CHECKFi(i + 4 * j, lut[j][i], 4. * i * i);
+    }
+    for (i = 0; names[i] && i < 20; ++i) {
+      if (j == 0)
+        fl[i] = strdup(names[i]);
+      else {
+        CHECKSi(i, names[i], fl[i]);
+        free(fl[i]);
+      }
+    }
+    CHECKIi(j, i, 11);
+
+    gd_free_entry_strings(E + j);
+    free(prefix[j]);
+    free(suffix[j]);
+    gd_discard(D);
+  }
+
+  /* a snapshot is only used when asked for */
+  D = gd_open(filedir, GD_RDONLY);
+  cnt[2] = gd_counter(D, GD_COUNTER_SNAPSHOT);
+  gd_discard(D);
+
+  n[0] = stat(snap, &buf);
+  n[1] = unlink(snap);
+
+  CHECKI(cnt[0], 0);
+  CHECKI(cnt[1], 1);
+  CHECKI(cnt[2], 0);
+  CHECKI(n[0], 0);
+  CHECKI(n[1], 0);
+
+  unlink("dirfile/table.gdidx");
+  unlink(table);
+  unlink(data);
+  unlink(format1);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+#endif
+}
@@ -0,0 +1,144 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* A damaged GD_SNAPSHOT is ignored, and the format is parsed instead */
+#include "test.h"
+
+#define HEADER 56 /* the sidecar header, then layout, checksum, and length */
+
+static uint64_t sum(const char *buf, size_t len)
+{
+  uint64_t h = 14695981039346656037ULL, w;
+  size_t i;
+
+  for (i = 0; i + 8 <= len; i += 8) {
+    memcpy(&w, buf + i, 8);
+    h = (h ^ w) * 1099511628211ULL;
+  }
+
+  return h;
+}
+
+static void write_snap(const char *snap, const char *buf, size_t len)
+{
+  int fd = open(snap, O_CREAT | O_WRONLY | O_TRUNC | O_BINARY, 0666);
+  write(fd, buf, len);
+  close(fd);
+}
+
+int main(void)
+{
+#if !defined HAVE_SYS_MMAN_H || !defined HAVE_MMAP
+  return 77;
+#else
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *format1 = "dirfile/format1";
+  const char *snap = "dirfile/format.gdidx";
+  char *good, *buf;
+  int fd, i, e[8], r = 0;
+  uint8_t b[8];
+  unsigned int nf[8];
+  int64_t h[2];
+  gd_int64_t cnt[8];
+  size_t len;
+  struct stat st;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "a RAW UINT8 1\nb CONST UINT8 7\n"
+      "/INCLUDE format1\n");
+  MAKEFORMATFILE(format1, "c LINCOM a 2 b\nc/d STRING meta\n");
+
+  D = gd_open(filedir, GD_RDWR | GD_SNAPSHOT);
+  gd_discard(D);
+
+  /* keep a copy of the good snapshot */
+  stat(snap, &st);
+  len = (size_t)st.st_size;
+  good = malloc(len);
+  buf = malloc(len);
+  fd = open(snap, O_RDONLY | O_BINARY);
+  read(fd, good, len);
+  close(fd);
+
+  for (i = 0; i < 8; ++i) {
+    memcpy(buf, good, len);
+    switch (i) {
+      case 0: /* intact */
+        write_snap(snap, buf, len);
+        break;
+      case 1: /* a byte in the body is flipped */
+        buf[HEADER + (len - HEADER) / 2] ^= 0x10;
+        write_snap(snap, buf, len);
+        break;
+      case 2: /* truncated */
+        write_snap(snap, buf, len / 2);
+        break;
+      case 3: /* a word short, but otherwise consistent */
+        memcpy(h, buf + 40, sizeof(h));
+        h[1] -= 8;
+        h[0] = (int64_t)sum(buf + HEADER, (size_t)h[1]);
+        memcpy(buf + 40, h, sizeof(h));
+        write_snap(snap, buf, len - 8);
+        break;
+      case 4: /* just a header */
+        write_snap(snap, buf, HEADER);
+        break;
+      case 5: /* an appended word */
+        write_snap(snap, good, len);
+        fd = open(snap, O_WRONLY | O_APPEND | O_BINARY);
+        write(fd, buf, 8);
+        close(fd);
+        break;
+      case 6: /* something else */
+        write_snap(snap, "not a snapshot\n", 15);
+        break;
+      case 7: /* empty */
+        write_snap(snap, buf, 0);
+        break;
+    }
+
+    D = gd_open(filedir, GD_RDONLY | GD_SNAPSHOT);
+    e[i] = gd_error(D);
+    cnt[i] = gd_counter(D, GD_COUNTER_SNAPSHOT);
+    nf[i] = gd_nfields(D);
+    b[i] = 0;
+    gd_get_constant(D, "b", GD_UINT8, b + i);
+    gd_discard(D);
+
+    CHECKIi(i, e[i], 0);
+    CHECKIi(i, cnt[i], i ? 0 : 1);
+    CHECKUi(i, nf[i], 4);
+    CHECKUi(i, b[i], 7);
+  }
+
+  free(buf);
+  free(good);
+  unlink(snap);
+  unlink(format1);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+#endif
+}
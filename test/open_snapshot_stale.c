@@ -0,0 +1,123 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* A GD_SNAPSHOT is ignored once any of the fragments it was made from
+ * changes */
+#include "test.h"
+
+static void open_check(int i, int flags, const char *field, int64_t c,
+    uint8_t v, int *r)
+{
+  uint8_t b = 0;
+  DIRFILE *D = gd_open("dirfile", flags | GD_SNAPSHOT);
+  int e = gd_error(D);
+  gd_int64_t cnt = gd_counter(D, GD_COUNTER_SNAPSHOT);
+
+  gd_get_constant(D, field, GD_UINT8, &b);
+  gd_discard(D);
+
+  if (e) {
+    fprintf(stderr, "e[%i] = %i (expected 0)\n", i, e);
+    *r = 1;
+  }
+  if (cnt != c) {
+    fprintf(stderr, "cnt[%i] = %" PRId64 " (expected %" PRId64 ")\n", i,
+        (int64_t)cnt, c);
+    *r = 1;
+  }
+  if (b != v) {
+    fprintf(stderr, "b[%i] = %i (expected %i)\n", i, b, v);
+    *r = 1;
+  }
+}
+
+int main(void)
+{
+#if !defined HAVE_SYS_MMAN_H || !defined HAVE_MMAP
+  return 77;
+#else
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *format1 = "dirfile/format1";
+  const char *snap = "dirfile/format.gdidx";
+  int e1, e2, e3, r = 0;
+  gd_int64_t cnt;
+  FILE *f;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "/INCLUDE format1\na RAW UINT8 1\n");
+  MAKEFORMATFILE(format1, "b CONST UINT8 1\n");
+
+  /* the first open saves the snapshot; the second uses it */
+  open_check(0, GD_RDWR, "b", 0, 1, &r);
+  open_check(1, GD_RDONLY, "b", 1, 1, &r);
+
+  /* an included fragment changes without changing size */
+  unlink(format1);
+  MAKEFORMATFILE(format1, "b CONST UINT8 2\n");
+  open_check(2, GD_RDONLY, "b", 0, 2, &r);
+
+  /* a read-only open doesn't replace the stale snapshot */
+  open_check(3, GD_RDONLY, "b", 0, 2, &r);
+  open_check(4, GD_RDWR, "b", 0, 2, &r);
+  open_check(5, GD_RDONLY, "b", 1, 2, &r);
+
+  /* the snapshot is only good for the open flags it was made with */
+  open_check(6, GD_RDONLY | GD_IGNORE_DUPS, "b", 0, 2, &r);
+
+  /* the format file changes */
+  f = fopen(format, "at");
+  fputs("c CONST UINT8 3\n", f);
+  fclose(f);
+  open_check(7, GD_RDONLY, "c", 0, 3, &r);
+  open_check(8, GD_RDWR, "c", 0, 3, &r);
+  open_check(9, GD_RDONLY, "c", 1, 3, &r);
+
+  /* metadata are changed through the library */
+  D = gd_open(filedir, GD_RDWR | GD_SNAPSHOT);
+  gd_add_spec(D, "d CONST UINT8 4", 1);
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+  e2 = gd_close(D);
+  CHECKI(e2, 0);
+
+  open_check(10, GD_RDONLY, "d", 0, 4, &r);
+  open_check(11, GD_RDWR, "d", 0, 4, &r);
+  open_check(12, GD_RDONLY, "d", 1, 4, &r);
+
+  /* an included fragment disappears */
+  unlink(format1);
+  D = gd_open(filedir, GD_RDONLY | GD_SNAPSHOT);
+  e3 = gd_error(D);
+  cnt = gd_counter(D, GD_COUNTER_SNAPSHOT);
+  gd_discard(D);
+  CHECKI(e3, GD_E_IO);
+  CHECKI(cnt, 0);
+
+  unlink(snap);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+#endif
+}
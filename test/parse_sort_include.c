@@ -0,0 +1,83 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Fields parsed out of order, from several fragments, are sorted; duplicates
+ * are found wherever they occur */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *format1 = "dirfile/format1";
+  int e1, e2, e3, i, r = 0;
+  const char **fl;
+  gd_entry_t E;
+  DIRFILE *D;
+#define NFIELDS 7
+  const char *field_list[NFIELDS] = {
+    "a", "b", "c", "d", "e", "f", "INDEX"
+  };
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+      "/VERSION 10\n"
+      "f RAW UINT8 1\n"
+      "c RAW UINT8 1\n"
+      "/INCLUDE format1\n"
+      "a RAW UINT8 1\n"
+      "a/m CONST UINT8 3\n"
+      "e RAW UINT8 1\n");
+  MAKEFORMATFILE(format1, "d RAW UINT8 1\nb RAW UINT8 1\n");
+
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+  fl = gd_field_list(D);
+
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+
+  for (i = 0; fl[i]; ++i)
+    CHECKSi(i, fl[i], field_list[i]);
+  CHECKI(i, NFIELDS);
+
+  gd_entry(D, "a/m", &E);
+  e2 = gd_error(D);
+  CHECKI(e2, 0);
+  CHECKI(E.field_type, GD_CONST_ENTRY);
+  gd_free_entry_strings(&E);
+  gd_discard(D);
+
+  /* a duplicate of a field in another fragment */
+  unlink(format1);
+  MAKEFORMATFILE(format1, "d RAW UINT8 1\nb RAW UINT8 1\nf RAW UINT8 1\n");
+
+  D = gd_open(filedir, GD_RDONLY);
+  e3 = gd_error(D);
+  CHECKI(e3, GD_E_FORMAT);
+  gd_discard(D);
+
+  unlink(format1);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
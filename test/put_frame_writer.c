@@ -0,0 +1,118 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* A frame writer buffers whole frames of several fields */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data1 = "dirfile/data1";
+  const char *data2 = "dirfile/data2";
+  const char *fields[3] = {"data1", "data2", "lincom"};
+  const gd_type_t types[3] = {GD_UINT8, GD_FLOAT64, GD_INT32};
+  uint8_t c1[2], d1[20];
+  double c2[4], d2[40];
+  int32_t c3[2];
+  int16_t d3[16];
+  const void *data[3];
+  gd_frame_writer_t *W;
+  int i, j, e1, e2, e3, e4, e5, r = 0;
+  size_t n1, n2;
+  off_t nf1, nf2;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format,
+      "data1 RAW UINT8 2\n"
+      "data2 RAW FLOAT64 4\n"
+      "lincom LINCOM data3 2 1\n"
+      "data3 RAW INT16 2\n"
+      );
+
+  D = gd_open(filedir, GD_RDWR | GD_CREAT | GD_UNENCODED | GD_VERBOSE);
+
+  data[0] = c1;
+  data[1] = c2;
+  data[2] = c3;
+
+  /* three frames in the buffer at a time, starting at frame 2 */
+  W = gd_frame_writer_open(D, 3, fields, 2, types, 3);
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+  CHECKPN(W);
+
+  for (i = 0; i < 8; ++i) {
+    for (j = 0; j < 2; ++j) {
+      c1[j] = (uint8_t)(2 * i + j);
+      c3[j] = 2 * (2 * i + j) + 1;
+    }
+    for (j = 0; j < 4; ++j)
+      c2[j] = 4 * i + j + 0.5;
+
+    e2 = gd_write_frame(W, data);
+    CHECKIi(i, e2, 0);
+
+    /* only whole buffers have been written so far */
+    if (i == 4) {
+      nf1 = gd_nframes(D);
+      CHECKI(nf1, 5);
+    }
+  }
+
+  e3 = gd_frame_writer_close(W);
+  CHECKI(e3, 0);
+
+  nf2 = gd_nframes(D);
+  CHECKI(nf2, 10);
+
+  n1 = gd_getdata(D, "data1", 0, 0, 10, 0, GD_UINT8, d1);
+  e4 = gd_error(D);
+  CHECKI(e4, 0);
+  CHECKU(n1, 20);
+  for (i = 0; i < 20; ++i)
+    CHECKIi(i, d1[i], (i < 4) ? 0 : i - 4);
+
+  n2 = gd_getdata(D, "data2", 0, 0, 10, 0, GD_FLOAT64, d2);
+  e5 = gd_error(D);
+  CHECKI(e5, 0);
+  CHECKU(n2, 40);
+  for (i = 0; i < 40; ++i)
+    CHECKFi(i, d2[i], (i < 8) ? 0 : i - 8 + 0.5);
+
+  /* the LINCOM was inverted */
+  n1 = gd_getdata(D, "data3", 2, 0, 8, 0, GD_INT16, d3);
+  CHECKU(n1, 16);
+  for (i = 0; i < 16; ++i)
+    CHECKIi(i, d3[i], i);
+
+  gd_discard(D);
+
+  unlink(data1);
+  unlink(data2);
+  unlink("dirfile/data3");
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
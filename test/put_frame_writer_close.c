@@ -0,0 +1,75 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Closing the dirfile flushes its frame writers */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  const char *field = "data";
+  const gd_type_t type = GD_UINT16;
+  uint16_t c[3];
+  const void *ptr = c;
+  gd_frame_writer_t *W;
+  int i, e1, e2, e3, e4, r = 0;
+  struct stat buf;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "data RAW UINT16 3\n");
+
+  D = gd_open(filedir, GD_RDWR | GD_UNENCODED | GD_VERBOSE);
+
+  W = gd_frame_writer_open(D, 1, &field, 0, &type, 100);
+  CHECKPN(W);
+
+  for (i = 0; i < 5; ++i) {
+    c[0] = c[1] = c[2] = (uint16_t)i;
+    e1 = gd_write_frame(W, &ptr);
+    CHECKIi(i, e1, 0);
+  }
+
+  e2 = gd_close(D);
+  CHECKI(e2, 0);
+
+  /* the writer no longer has a dirfile */
+  e3 = gd_write_frame(W, &ptr);
+  CHECKI(e3, GD_E_BAD_DIRFILE);
+
+  e4 = gd_frame_writer_close(W);
+  CHECKI(e4, 0);
+
+  if (stat(data, &buf)) {
+    perror("stat");
+    r = 1;
+  } else
+    CHECKI(buf.st_size, 15 * sizeof(uint16_t));
+
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,108 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* A frame writer whose flush fails part way keeps its frames, and carries on
+ * where it stopped */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *format1 = "dirfile/format1";
+  const char *a_data = "dirfile/a";
+  const char *b_data = "dirfile/b";
+  const char *field[2] = {"a", "b"};
+  const gd_type_t type[2] = {GD_UINT8, GD_UINT8};
+  uint8_t a, b, ca[4], cb[4];
+  const void *ptr[2] = {&a, &b};
+  gd_frame_writer_t *W;
+  int i, e1, e2, e3, e4, e5, e6, e7, e8, r = 0;
+  size_t n1, n2;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "a RAW UINT8 1\nINCLUDE format1\n");
+  MAKEFORMATFILE(format1, "b RAW UINT8 1\n");
+  MAKEEMPTYFILE(a_data, 0600);
+  MAKEEMPTYFILE(b_data, 0600);
+
+  D = gd_open(filedir, GD_RDWR | GD_UNENCODED | GD_VERBOSE);
+
+  /* b can't be written */
+  e1 = gd_alter_protection(D, GD_PROTECT_DATA, 1);
+  CHECKI(e1, 0);
+
+  W = gd_frame_writer_open(D, 2, field, GD_HERE, type, 2);
+  CHECKPN(W);
+
+  /* the second frame fills the buffers; a is written, b isn't */
+  for (i = 0; i < 2; ++i) {
+    a = (uint8_t)(10 + i);
+    b = (uint8_t)(20 + i);
+    e2 = gd_write_frame(W, ptr);
+    CHECKIi(i, e2, (i == 1) ? GD_E_PROTECTED : 0);
+  }
+
+  /* the buffers are still full, so this frame is refused */
+  a = 99;
+  b = 99;
+  e3 = gd_write_frame(W, ptr);
+  CHECKI(e3, GD_E_PROTECTED);
+
+  e4 = gd_alter_protection(D, GD_PROTECT_NONE, 1);
+  CHECKI(e4, 0);
+
+  /* now the rest of the flush succeeds, and the frame is taken */
+  a = 12;
+  b = 22;
+  e5 = gd_write_frame(W, ptr);
+  CHECKI(e5, 0);
+
+  e6 = gd_frame_writer_close(W);
+  CHECKI(e6, 0);
+
+  /* nothing was written twice */
+  n1 = gd_getdata(D, "a", 0, 0, 0, 4, GD_UINT8, ca);
+  e7 = gd_error(D);
+  CHECKI(e7, 0);
+  n2 = gd_getdata(D, "b", 0, 0, 0, 4, GD_UINT8, cb);
+  e8 = gd_error(D);
+  CHECKI(e8, 0);
+
+  CHECKU(n1, 3);
+  CHECKU(n2, 3);
+  for (i = 0; i < 3; ++i) {
+    CHECKUi(i, ca[i], 10 + i);
+    CHECKUi(i, cb[i], 20 + i);
+  }
+
+  gd_discard(D);
+
+  unlink(a_data);
+  unlink(b_data);
+  unlink(format1);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,82 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Reading a field waits for its queued writes */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  uint16_t c[8], d[40];
+  int i, j, e1, e2, e3, e4, r = 0;
+  size_t n1, n2;
+  gd_int64_t depth;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "data RAW UINT16 8\n");
+
+  D = gd_open(filedir, GD_RDWR | GD_UNENCODED | GD_VERBOSE);
+
+  /* room for one write at a time */
+  e1 = gd_write_behind(D, sizeof(c));
+  if (e1 == GD_E_UNSUPPORTED) {
+    gd_discard(D);
+    unlink(format);
+    rmdir(filedir);
+    return 77;
+  }
+  CHECKI(e1, 0);
+
+  for (i = 0; i < 5; ++i) {
+    for (j = 0; j < 8; ++j)
+      c[j] = (uint16_t)(8 * i + j);
+    n1 = gd_putdata(D, "data", i, 0, 1, 0, GD_UINT16, c);
+    CHECKUi(i, n1, 8);
+  }
+
+  n2 = gd_getdata(D, "data", 0, 0, 5, 0, GD_UINT16, d);
+  CHECKU(n2, 40);
+  for (i = 0; i < 40; ++i)
+    CHECKUi(i, d[i], i);
+
+  e2 = gd_flush(D, NULL);
+  CHECKI(e2, 0);
+
+  depth = gd_counter(D, GD_COUNTER_WB_DEPTH);
+  CHECKI(depth, 0);
+
+  /* turn it off again */
+  e3 = gd_write_behind(D, 0);
+  CHECKI(e3, 0);
+
+  e4 = gd_close(D);
+  CHECKI(e4, 0);
+
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
@@ -0,0 +1,78 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Closing the dirfile finishes its queued writes */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data";
+  uint16_t c[3], d[300];
+  int fd, i, e1, e2, r = 0;
+  size_t n;
+  ssize_t n_read;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "data RAW UINT16 3\n");
+
+  D = gd_open(filedir, GD_RDWR | GD_UNENCODED | GD_VERBOSE);
+
+  e1 = gd_write_behind(D, 1000000);
+  if (e1 == GD_E_UNSUPPORTED) {
+    gd_discard(D);
+    unlink(format);
+    rmdir(filedir);
+    return 77;
+  }
+  CHECKI(e1, 0);
+
+  for (i = 0; i < 100; ++i) {
+    c[0] = c[1] = c[2] = (uint16_t)i;
+    n = gd_putdata(D, "data", i, 0, 1, 0, GD_UINT16, c);
+    CHECKUi(i, n, 3);
+  }
+
+  e2 = gd_close(D);
+  CHECKI(e2, 0);
+
+  fd = open(data, O_RDONLY | O_BINARY);
+  if (fd < 0) {
+    perror("open");
+    r = 1;
+  } else {
+    n_read = read(fd, d, sizeof(d));
+    close(fd);
+
+    CHECKI(n_read, sizeof(d));
+    for (i = 0; i < 300; ++i)
+      CHECKUi(i, d[i], i / 3);
+  }
+
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
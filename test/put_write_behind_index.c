@@ -0,0 +1,87 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Index seeks made by the write-behind worker are counted */
+#include "test.h"
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data.txt";
+  uint16_t c[8], d[8];
+  int i, e1, e2, e3, r = 0;
+  size_t n1, n2, n3;
+  gd_int64_t k1, k2;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "data RAW UINT16 1\n/ENCODING text\n");
+  MAKEEMPTYFILE(data, 0600);
+
+  D = gd_open(filedir, GD_RDWR | GD_VERBOSE);
+
+  e1 = gd_write_behind(D, 1000);
+  if (e1 == GD_E_UNSUPPORTED) {
+    gd_discard(D);
+    unlink(data);
+    unlink(format);
+    rmdir(filedir);
+    return 77;
+  }
+  CHECKI(e1, 0);
+
+  for (i = 0; i < 8; ++i)
+    c[i] = (uint16_t)(100 + i);
+
+  /* the padding indexes the file as it goes */
+  n1 = gd_putdata(D, "data", 0, 3000, 0, 8, GD_UINT16, c);
+  CHECKU(n1, 8);
+
+  /* this overwrites the padding; the worker gets there with the index */
+  n2 = gd_putdata(D, "data", 0, 2100, 0, 8, GD_UINT16, c);
+  CHECKU(n2, 8);
+
+  /* while the worker may still be at it */
+  k1 = gd_counter(D, GD_COUNTER_INDEX_SEEK);
+  CHECK((k1 < 0 || k1 > 1),k1,"%" PRId64,"%s",(int64_t)k1,"0 or 1");
+
+  e2 = gd_flush(D, NULL);
+  CHECKI(e2, 0);
+
+  k2 = gd_counter(D, GD_COUNTER_INDEX_SEEK);
+  CHECKI(k2, 1);
+
+  n3 = gd_getdata(D, "data", 0, 2100, 0, 8, GD_UINT16, d);
+  CHECKU(n3, 8);
+  for (i = 0; i < 8; ++i)
+    CHECKUi(i, d[i], 100 + i);
+
+  e3 = gd_close(D);
+  CHECKI(e3, 0);
+
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
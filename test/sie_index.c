@@ -0,0 +1,103 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* Seeks in a long SIE file use the record index, which is saved and reused */
+#include "test.h"
+
+#define NREC 10000
+
+int main(void)
+{
+  const char *filedir = "dirfile";
+  const char *format = "dirfile/format";
+  const char *data = "dirfile/data.sie";
+  const char *sidecar = "dirfile/data.sie.gdidx";
+  uint8_t rec[9], c[8];
+  int fd, i, e1, e2, e3, r = 0;
+  size_t n1, n2, n3;
+  long long k1, k2;
+  struct stat buf;
+  DIRFILE *D;
+
+  rmdirfile();
+  mkdir(filedir, 0700);
+
+  MAKEFORMATFILE(format, "data RAW UINT8 1\n/ENCODING sie\n/ENDIAN little\n");
+
+  /* a header, then record i holds i & 0xFF for samples 3i to 3i+2 */
+  fd = open(data, O_CREAT | O_EXCL | O_WRONLY | O_BINARY, 0666);
+  memset(rec, 0xff, 8);
+  rec[8] = 0x82;
+  write(fd, rec, 9);
+  for (i = 0; i < NREC; ++i) {
+    const uint64_t s = 3 * i + 2;
+    int j;
+    for (j = 0; j < 8; ++j)
+      rec[j] = (uint8_t)(s >> (8 * j));
+    rec[8] = (uint8_t)i;
+    write(fd, rec, 9);
+  }
+  close(fd);
+
+  /* indices are only saved by dirfiles open for writing */
+  D = gd_open(filedir, GD_RDWR | GD_VERBOSE);
+
+  /* far in */
+  n1 = gd_getdata(D, "data", 3 * 9000 + 1, 0, 8, 0, GD_UINT8, c);
+  e1 = gd_error(D);
+  CHECKI(e1, 0);
+  CHECKU(n1, 8);
+  for (i = 0; i < 8; ++i)
+    CHECKUi(i, c[i], (uint8_t)((3 * 9000 + 1 + i) / 3));
+
+  /* backwards */
+  n2 = gd_getdata(D, "data", 10, 0, 8, 0, GD_UINT8, c);
+  e2 = gd_error(D);
+  CHECKI(e2, 0);
+  CHECKU(n2, 8);
+  for (i = 0; i < 8; ++i)
+    CHECKUi(i, c[i], (uint8_t)((10 + i) / 3));
+
+  k1 = gd_counter(D, GD_COUNTER_INDEX_SEEK);
+  CHECKI(k1, 2);
+  gd_discard(D);
+
+  CHECKI(stat(sidecar, &buf), 0);
+
+  /* the saved index is picked up */
+  D = gd_open(filedir, GD_RDONLY | GD_VERBOSE);
+  n3 = gd_getdata(D, "data", 3 * NREC - 4, 0, 8, 0, GD_UINT8, c);
+  e3 = gd_error(D);
+  CHECKI(e3, 0);
+  CHECKU(n3, 4);
+  for (i = 0; i < 4; ++i)
+    CHECKUi(i, c[i], (uint8_t)((3 * NREC - 4 + i) / 3));
+
+  k2 = gd_counter(D, GD_COUNTER_INDEX_SEEK);
+  CHECKI(k2, 1);
+  gd_discard(D);
+
+  unlink(sidecar);
+  unlink(data);
+  unlink(format);
+  rmdir(filedir);
+
+  return r;
+}
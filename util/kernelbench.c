@@ -0,0 +1,190 @@
+/* Copyright (C) 2026 G. Smecher
+ *
+ ***************************************************************************
+ *
+ * This file is part of the GetData project.
+ *
+ * GetData is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * GetData is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with GetData; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* kernelbench: measure the throughput of the library's vectorised inner loops
+ * (see src/kernel.c) at each level supported by this machine.
+ *
+ * This uses library internals, so it must be linked statically.
+ */
+#include "internal.h"
+
+#include <time.h>
+
+#define NBYTES (8 << 20) /* the size of each buffer */
+#define NREP 32 /* the number of passes over the buffers */
+
+static void *buf1, *buf2, *buf3, *buf4;
+
+/* the segments of a LUT of length NLUT */
+#define NLUT 1000
+static double sx[NLUT - 1], sy[NLUT - 1], slope[NLUT - 1];
+
+/* prepare the buffers: none of them contain NaNs or denormals */
+static void prepare(void)
+{
+  size_t i;
+
+  for (i = 0; i < NBYTES / sizeof(double); ++i) {
+    ((double *)buf1)[i] = (double)(i % 1000);
+    ((double *)buf2)[i] = (double)(i % 997) * 0.5;
+    ((double *)buf3)[i] = (double)(i % 991) * 0.25;
+  }
+}
+
+/* report the throughput of NREP passes, each touching nbytes */
+static void report(const char *kernel, const char *level, clock_t t0,
+    size_t nbytes)
+{
+  double s = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+  if (s <= 0)
+    printf("%-20s %-7s        -\n", kernel, level);
+  else
+    printf("%-20s %-7s %8.2f GB/s\n", kernel, level,
+        (double)nbytes * NREP / s * 1e-9);
+}
+
+static void bench(int level)
+{
+  const char *name = _GD_KernelName(level);
+  const double m[3] = { 1.5, 0.5, 2. }, b[3] = { 1., -2., 0.25 };
+  const double m5[6] = { 1., 1e-3, -2e-6, 3e-9, 1e-12, -1e-15 };
+  const size_t n64 = NBYTES / 8;
+  size_t i;
+  clock_t t0;
+  int r;
+
+  for (r = 2; r <= 8; r *= 2) {
+    char kernel[40];
+    int k;
+    prepare();
+    snprintf(kernel, sizeof kernel, "swap%i", r * 8);
+    t0 = clock();
+    for (k = 0; k < NREP; ++k)
+      _GD_KernelSwap(buf1, NBYTES / r, r);
+    report(kernel, name, t0, 2 * NBYTES);
+  }
+
+  /* the conversions report the size of the output */
+  prepare();
+  t0 = clock();
+  for (r = 0; r < NREP; ++r)
+    if (!_GD_KernelConvert(buf4, GD_INT16, buf2, GD_FLOAT64, n64))
+      _GD_ConvertType(NULL, buf4, GD_INT16, buf2, GD_FLOAT64, n64);
+  report("int16->float64", name, t0, NBYTES);
+
+  t0 = clock();
+  for (r = 0; r < NREP; ++r)
+    if (!_GD_KernelConvert(buf4, GD_INT32, buf2, GD_FLOAT64, n64))
+      _GD_ConvertType(NULL, buf4, GD_INT32, buf2, GD_FLOAT64, n64);
+  report("int32->float64", name, t0, NBYTES);
+
+  t0 = clock();
+  for (r = 0; r < NREP; ++r)
+    if (!_GD_KernelConvert(buf4, GD_FLOAT32, buf2, GD_FLOAT64, n64))
+      _GD_ConvertType(NULL, buf4, GD_FLOAT32, buf2, GD_FLOAT64, n64);
+  report("float32->float64", name, t0, NBYTES);
+
+  t0 = clock();
+  for (r = 0; r < NREP; ++r)
+    if (!_GD_KernelConvert(buf1, GD_FLOAT64, buf4, GD_FLOAT32, n64))
+      _GD_ConvertType(NULL, buf1, GD_FLOAT64, buf4, GD_FLOAT32, n64);
+  report("float64->float32", name, t0, NBYTES / 2);
+
+  for (r = 1; r <= 3; ++r) {
+    char kernel[40];
+    int k;
+    prepare();
+    snprintf(kernel, sizeof kernel, "lincom%i", r);
+    t0 = clock();
+    for (k = 0; k < NREP; ++k)
+      _GD_KernelLincom(r, (double *)buf1, (double *)buf2, (double *)buf3, m,
+          b, n64);
+    report(kernel, name, t0, (size_t)(r + 1) * NBYTES);
+  }
+
+  /* a POLYNOM of order 5 */
+  prepare();
+  t0 = clock();
+  for (r = 0; r < NREP; ++r)
+    _GD_KernelPolynom(5, m5, buf1, GD_FLOAT64, buf1, GD_FLOAT64, n64);
+  report("polynom5", name, t0, 2 * NBYTES);
+
+  t0 = clock();
+  for (r = 0; r < NREP; ++r)
+    if (!_GD_KernelPolynom(5, m5, buf4, GD_INT16, buf2, GD_FLOAT64, n64))
+      break;
+  if (r == NREP)
+    report("polynom5 int16", name, t0, NBYTES + NBYTES / 4);
+
+  /* LINTERP interpolation, given the segments, which jump about */
+  prepare();
+  for (r = 0; r < NLUT - 1; ++r) {
+    sx[r] = r;
+    sy[r] = r * 0.5;
+    slope[r] = 0.5;
+  }
+  for (i = 0; i < n64; ++i)
+    ((int32_t *)buf3)[i] = (int32_t)((i * 7919) % (NLUT - 1));
+  t0 = clock();
+  for (r = 0; r < NREP; ++r)
+    _GD_KernelLinterp((double *)buf2, (double *)buf1, (int32_t *)buf3, n64,
+        sx, sy, slope);
+  report("linterp", name, t0, 2 * NBYTES + NBYTES / 2);
+
+  for (r = 1; r <= 8; r *= 2) {
+    char kernel[40];
+    int k;
+    snprintf(kernel, sizeof kernel, "sbit%i (with copy)", r * 8);
+    t0 = clock();
+    for (k = 0; k < NREP; ++k) {
+      memcpy(buf1, buf4, NBYTES);
+      _GD_KernelBits(buf1, NBYTES / r, r, 3, 5, 1);
+    }
+    report(kernel, name, t0, 3 * NBYTES);
+  }
+}
+
+int main(void)
+{
+  int level;
+
+  buf1 = malloc(NBYTES);
+  buf2 = malloc(NBYTES);
+  buf3 = malloc(NBYTES);
+  buf4 = malloc(NBYTES);
+
+  if (buf1 == NULL || buf2 == NULL || buf3 == NULL || buf4 == NULL) {
+    fputs("kernelbench: out of memory\n", stderr);
+    return 1;
+  }
+  memset(buf4, 0x5A, NBYTES);
+
+  for (level = 0; level < GD_N_KERNELS; ++level)
+    if (_GD_KernelInit(level) == level)
+      bench(level);
+
+  free(buf1);
+  free(buf2);
+  free(buf3);
+  free(buf4);
+
+  return 0;
+}